@@ -10,12 +10,55 @@
 #include "src/Utility/Vec.hpp"
 #include "src/Utility/Utility.hpp"
 #include "src/GameController/GameMain.hpp"
+#include <cstring>
+#ifdef _DEBUG
+#include "src/Renderer/RenderReplayBenchmark.hpp"
+#include <sstream>
+#include <string>
+#endif
+#ifdef COLLISION_VERIFY
+#include "src/Collision/CollisionVerifier.hpp"
+#include "src/Collision/BroadPhaseBenchmark.hpp"
+#endif
+#ifdef RENDER_VERIFY
+#include "src/Renderer/SpriteBatchVerifier.hpp"
+#include "src/Renderer/SoftwareRasterizerVerifier.hpp"
+#include "src/Renderer/DebugDrawVerifier.hpp"
+#endif
 
-int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR, _In_ int)
+int WINAPI WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ LPSTR cmdLine, _In_ int)
 {
 	_CrtSetDbgFlag(_CRTDBG_ALLOC_MEM_DF | _CRTDBG_LEAK_CHECK_DF);
 	//_CrtSetBreakAlloc(98);
 	ShowConsole();
-	GameMain main;
+#ifdef COLLISION_VERIFY
+	//プリプロセッサの定義にCOLLISION_VERIFYを追加すると、起動時に当たり判定の検証と計測を行います
+	CollisionVerifier::Run();
+	BroadPhaseBenchmark::Run();
+#endif
+#ifdef RENDER_VERIFY
+	//プリプロセッサの定義にRENDER_VERIFYを追加すると、起動時に描画のまとめ処理、ソフトウェアラスタライザ、デバッグ表示の検証を行います
+	SpriteBatchVerifier::Run();
+	SoftwareRasterizerVerifier::Run();
+	DebugDrawVerifier::Run();
+#endif
+#ifdef _DEBUG
+	//起動時の引数に--replay <ファイル>を付けると、ゲームでF3を押して保存した描画命令のキャプチャを流して描画の時間を計測します。
+	//ファイルを省略するとrender_capture.rcapを読み込みます
+	const char* replay = cmdLine != nullptr ? std::strstr(cmdLine, "--replay") : nullptr;
+	if (replay != nullptr)
+	{
+		std::istringstream args(replay + std::strlen("--replay"));
+		std::string path;
+		if (!(args >> path) || path.compare(0, 2, "--") == 0)
+		{
+			path = "render_capture.rcap";
+		}
+		RenderReplayBenchmark::Run(path);
+	}
+#endif
+	//起動時の引数に--pipelineを付けると、更新と描画を別のスレッドで重ねて行います
+	const bool isPipelined = cmdLine != nullptr && std::strstr(cmdLine, "--pipeline") != nullptr;
+	GameMain main(isPipelined ? GameMain::LoopMode::PIPELINED : GameMain::LoopMode::SEQUENTIAL);
 	main.run();
 }
@@ -4,6 +4,7 @@
 #include "../Components/Renderer.hpp"
 #include "../Components/BackGround.hpp"
 #include "../Components/MoveComponent.hpp"
+#include "../Components/ParallaxBackground.hpp"
 namespace ECS
 {
 	class CharacterArcheType
@@ -41,6 +42,13 @@ namespace ECS
 			background->addComponent<ECS::BGMove>();
 			
 
+			return background;
+		}
+		//^C}bvd˂dXN[wiEntity
+		static Entity* CreateParallaxBG(ECS::EntityManager &manager, const std::string& stagePath)
+		{
+			auto background = &manager.addEntity(ENTITY_GROUP::BACKGROUND);
+			background->addComponent<ECS::ParallaxBackground>(stagePath);
 			return background;
 		}
 	private:
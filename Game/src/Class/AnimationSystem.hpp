@@ -0,0 +1,383 @@
+﻿/**
+* @file AnimationSystem.hpp
+* @brief JSONから読み込んだアニメーションのクリップと、再生中のアニメーションをまとめて進める処理です
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "../Utility/Utility.hpp"
+#include "../Utility/picojson.h"
+#include <memory>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+/**
+* @brief 再生中のアニメーションを指すIDです
+* @details 破棄すると世代が進み、古いIDは無効になります
+*/
+struct AnimatorId
+{
+	static constexpr uint32_t INVALID_INDEX = 0xffffffff;
+	uint32_t index = INVALID_INDEX;
+	uint32_t generation = 0;
+};
+
+/**
+* @brief アニメーションのクリップと再生中のアニメーションを管理します
+* @details クリップはloadDivで読み込んだ分割画像の要素番号の並びと、各コマのフレーム数と、繰り返し方を持ちます。
+* 読み込むときに経過フレーム数からコマを引く表を作るので、再生中のコマは経過フレーム数から表を引くだけで決まります
+* - 再生中のアニメーションは経過フレーム数、表の位置、周期などを別々の配列に詰めて持ちます(SoA)。
+*   update()は全部のアニメーションを1つのループで進め、コマの切り替えや繰り返しで分岐しません
+* - 破棄したアニメーションの場所には最後のものを移すので、配列は常に詰まっています
+*/
+class AnimationSystem final
+{
+public:
+	//!クリップの繰り返し方です
+	enum class LoopMode
+	{
+		ONCE,		//最後のコマで止まります
+		LOOP,		//最初のコマに戻ります
+		PING_PONG,	//最後のコマまで進んだら最初のコマまで戻ります
+	};
+	//!読み込んだクリップです
+	struct Clip
+	{
+		std::string name;
+		//!loadDivで読み込んだ分割画像の登録名
+		std::string sheet;
+		LoopMode mode = LoopMode::ONCE;
+		//!コマを引く表の先頭
+		uint32_t tableOffset = 0;
+		//!表の長さ。1周のフレーム数です
+		uint32_t cycle = 1;
+	};
+private:
+	AnimationSystem() = delete;
+	class Singleton final
+	{
+	private:
+		//!IDの番号から詰めた配列の位置を引くための場所です
+		struct Slot
+		{
+			uint32_t dense = 0;
+			uint32_t generation = 0;
+			bool isAlive = false;
+		};
+		std::vector<Clip> clips_;
+		std::unordered_map<std::string, uint32_t> clipIds_;
+		//!全クリップの経過フレーム数ごとの分割画像の要素番号
+		std::vector<uint16_t> frameTable_;
+		std::vector<Slot> slots_;
+		std::vector<uint32_t> freeSlots_;
+
+		//以下は再生中のアニメーションごとの値。同じ位置が同じアニメーションです
+		std::vector<uint32_t> elapsed_;
+		//!1フレームに進めるフレーム数。止めている間は0です
+		std::vector<uint32_t> step_;
+		std::vector<uint32_t> cycle_;
+		//!繰り返すなら1、最後のコマで止まるなら0
+		std::vector<uint32_t> loop_;
+		std::vector<uint32_t> tableOffset_;
+		std::vector<uint32_t> clip_;
+		//!今のコマの分割画像の要素番号
+		std::vector<uint16_t> frame_;
+		//!詰めた位置からIDの番号を引きます
+		std::vector<uint32_t> owner_;
+
+		[[nodiscard]] const Slot* findSlot(const AnimatorId& id) const
+		{
+			if (id.index >= slots_.size())
+			{
+				return nullptr;
+			}
+			const Slot& slot = slots_[id.index];
+			return slot.isAlive && slot.generation == id.generation ? &slot : nullptr;
+		}
+		[[nodiscard]] uint32_t denseOf(const AnimatorId& id) const
+		{
+			const Slot* slot = findSlot(id);
+			assert(slot != nullptr && "AnimatorId is invalid");
+			return slot->dense;
+		}
+		//!クリップの最初のコマから始めるように値を入れます
+		void setClip(const uint32_t dense, const uint32_t clip)
+		{
+			const Clip& c = clips_[clip];
+			elapsed_[dense] = 0;
+			cycle_[dense] = c.cycle;
+			loop_[dense] = c.mode == LoopMode::ONCE ? 0u : 1u;
+			tableOffset_[dense] = c.tableOffset;
+			clip_[dense] = clip;
+			frame_[dense] = frameTable_[c.tableOffset];
+		}
+		//!クリップを1つ読み込んで表を作ります。書式が違えばfalse
+		bool loadClip(picojson::object& clip)
+		{
+			if (!clip["name"].is<std::string>() || !clip["sheet"].is<std::string>() || !clip["frames"].is<picojson::array>())
+			{
+				return false;
+			}
+			const auto& frames = clip["frames"].get<picojson::array>();
+			const bool hasDurations = clip["durations"].is<picojson::array>();
+			const uint32_t duration = clip["duration"].is<double>() ? uint32_t(std::max(1.0, clip["duration"].get<double>())) : 1u;
+			std::vector<uint16_t> indices;
+			std::vector<uint32_t> durations;
+			for (size_t i = 0; i < frames.size(); ++i)
+			{
+				if (!frames[i].is<double>())
+				{
+					return false;
+				}
+				indices.emplace_back(uint16_t(std::clamp(frames[i].get<double>(), 0.0, 65535.0)));
+				uint32_t d = duration;
+				if (hasDurations)
+				{
+					const auto& list = clip["durations"].get<picojson::array>();
+					if (i >= list.size() || !list[i].is<double>())
+					{
+						return false;
+					}
+					d = uint32_t(std::max(1.0, list[i].get<double>()));
+				}
+				durations.emplace_back(d);
+			}
+			if (indices.empty())
+			{
+				return false;
+			}
+			Clip c;
+			c.name = clip["name"].get<std::string>();
+			c.sheet = clip["sheet"].get<std::string>();
+			const std::string mode = clip["mode"].is<std::string>() ? clip["mode"].get<std::string>() : "once";
+			c.mode = mode == "loop" ? LoopMode::LOOP : mode == "pingpong" ? LoopMode::PING_PONG : LoopMode::ONCE;
+			//往復は最後のコマまで進んだ後、両端を除いて逆に並べたコマを足した周期で繰り返す
+			if (c.mode == LoopMode::PING_PONG)
+			{
+				for (size_t i = indices.size() - 1; i-- > 1;)
+				{
+					indices.emplace_back(indices[i]);
+					durations.emplace_back(durations[i]);
+				}
+			}
+			c.tableOffset = uint32_t(frameTable_.size());
+			for (size_t i = 0; i < indices.size(); ++i)
+			{
+				frameTable_.insert(frameTable_.end(), durations[i], indices[i]);
+			}
+			c.cycle = uint32_t(frameTable_.size()) - c.tableOffset;
+			const auto it = clipIds_.find(c.name);
+			if (it != clipIds_.end())
+			{
+				//同じ名前は上書きする。前の表は使われなくなるだけで残る
+				clips_[it->second] = c;
+				return true;
+			}
+			clipIds_.emplace(c.name, uint32_t(clips_.size()));
+			clips_.emplace_back(c);
+			return true;
+		}
+	public:
+		/**
+		* @brief JSONからクリップを読み込みます
+		* @param path JSONのパス
+		* @return 読み込んだクリップの数
+		* @details 書式は次の通りです。durationsの代わりにdurationで全部のコマのフレーム数を指定できます。modeはonce, loop, pingpongです
+		* {"clips": [{"name": "explosion", "sheet": "explosion", "frames": [0, 1, 2, 3], "durations": [3, 3, 3, 6], "mode": "once"}]}
+		*/
+		size_t loadClips(const std::string& path)
+		{
+			std::ifstream ifs(path);
+			picojson::value v;
+			if (ifs.fail() || !picojson::parse(v, ifs).empty() || !v.is<picojson::object>() ||
+				!v.get<picojson::object>()["clips"].is<picojson::array>())
+			{
+				DOUT << path + " animation load is failed" << std::endl;
+				assert(false && "animation load is failed");
+				return 0;
+			}
+			size_t num = 0;
+			for (auto& it : v.get<picojson::object>()["clips"].get<picojson::array>())
+			{
+				if (!it.is<picojson::object>() || !loadClip(it.get<picojson::object>()))
+				{
+					DOUT << path + " has an invalid clip" << std::endl;
+					continue;
+				}
+				++num;
+			}
+			return num;
+		}
+		//!クリップがあればtrue
+		[[nodiscard]] bool hasClip(const std::string& name) const
+		{
+			return clipIds_.count(name) != 0;
+		}
+		//!クリップを返します。無い名前を指定するとエラーになります
+		[[nodiscard]] const Clip& getClip(const std::string& name) const
+		{
+			const auto it = clipIds_.find(name);
+			if (it == clipIds_.end())
+			{
+				DOUT << "Animation clip :" + name + " is not found" << std::endl;
+				assert(false);
+			}
+			return clips_[it->second];
+		}
+		/**
+		* @brief クリップを再生するアニメーションを作ります
+		* @param clip クリップの名前
+		* @param isPlay すぐに再生するならtrue
+		*/
+		[[nodiscard]] AnimatorId create(const std::string& clip, const bool isPlay = true)
+		{
+			const auto it = clipIds_.find(clip);
+			if (it == clipIds_.end())
+			{
+				DOUT << "Animation clip :" + clip + " is not found" << std::endl;
+				assert(false);
+				return AnimatorId();
+			}
+			uint32_t index;
+			if (freeSlots_.empty())
+			{
+				index = uint32_t(slots_.size());
+				slots_.emplace_back();
+			}
+			else
+			{
+				index = freeSlots_.back();
+				freeSlots_.pop_back();
+			}
+			const uint32_t dense = uint32_t(elapsed_.size());
+			Slot& slot = slots_[index];
+			slot.dense = dense;
+			slot.isAlive = true;
+			elapsed_.emplace_back(0);
+			step_.emplace_back(isPlay ? 1u : 0u);
+			cycle_.emplace_back(1);
+			loop_.emplace_back(0);
+			tableOffset_.emplace_back(0);
+			clip_.emplace_back(0);
+			frame_.emplace_back(uint16_t(0));
+			owner_.emplace_back(index);
+			setClip(dense, it->second);
+			return AnimatorId{ index, slot.generation };
+		}
+		//!アニメーションを破棄します。IDは無効になります
+		void destroy(AnimatorId& id)
+		{
+			const Slot* found = findSlot(id);
+			if (found == nullptr)
+			{
+				return;
+			}
+			//最後のアニメーションを空いた位置に移して詰める
+			const uint32_t dense = found->dense;
+			const uint32_t last = uint32_t(elapsed_.size() - 1);
+			elapsed_[dense] = elapsed_[last];
+			step_[dense] = step_[last];
+			cycle_[dense] = cycle_[last];
+			loop_[dense] = loop_[last];
+			tableOffset_[dense] = tableOffset_[last];
+			clip_[dense] = clip_[last];
+			frame_[dense] = frame_[last];
+			owner_[dense] = owner_[last];
+			slots_[owner_[dense]].dense = dense;
+			elapsed_.pop_back();
+			step_.pop_back();
+			cycle_.pop_back();
+			loop_.pop_back();
+			tableOffset_.pop_back();
+			clip_.pop_back();
+			frame_.pop_back();
+			owner_.pop_back();
+			Slot& slot = slots_[id.index];
+			slot.isAlive = false;
+			++slot.generation;
+			freeSlots_.emplace_back(id.index);
+			id = AnimatorId();
+		}
+		//!IDが指すアニメーションがあればtrue
+		[[nodiscard]] bool isAlive(const AnimatorId& id) const
+		{
+			return findSlot(id) != nullptr;
+		}
+		//!クリップを最初から再生します
+		void play(const AnimatorId& id, const std::string& clip)
+		{
+			const auto it = clipIds_.find(clip);
+			assert(it != clipIds_.end() && "animation clip is not found");
+			const uint32_t dense = denseOf(id);
+			setClip(dense, it->second);
+			step_[dense] = 1;
+		}
+		//!今のコマで止めます
+		void stop(const AnimatorId& id)
+		{
+			step_[denseOf(id)] = 0;
+		}
+		//!止めた位置から再生します
+		void resume(const AnimatorId& id)
+		{
+			step_[denseOf(id)] = 1;
+		}
+		//!今のコマの分割画像の要素番号を返します
+		[[nodiscard]] int getFrame(const AnimatorId& id) const
+		{
+			return frame_[denseOf(id)];
+		}
+		//!繰り返さないクリップが最後のコマまで再生し終わっていればtrue
+		[[nodiscard]] bool isFinished(const AnimatorId& id) const
+		{
+			const uint32_t dense = denseOf(id);
+			return loop_[dense] == 0 && elapsed_[dense] >= cycle_[dense];
+		}
+		//!再生中のクリップを返します
+		[[nodiscard]] const Clip& getPlayingClip(const AnimatorId& id) const
+		{
+			return clips_[clip_[denseOf(id)]];
+		}
+		//!アニメーションの数を返します
+		[[nodiscard]] size_t size() const
+		{
+			return elapsed_.size();
+		}
+		/**
+		* @brief すべてのアニメーションを進めます
+		* @param frames 進めるフレーム数
+		* @details 経過フレーム数を周期で割った余り(繰り返さないものは周期で止めた値)で表を引くだけなので、コマごとの分岐がありません
+		*/
+		void update(const uint32_t frames = 1)
+		{
+			const size_t n = elapsed_.size();
+			uint32_t* elapsed = elapsed_.data();
+			const uint32_t* step = step_.data();
+			const uint32_t* cycle = cycle_.data();
+			const uint32_t* loop = loop_.data();
+			const uint32_t* tableOffset = tableOffset_.data();
+			const uint16_t* table = frameTable_.data();
+			uint16_t* frame = frame_.data();
+			for (size_t i = 0; i < n; ++i)
+			{
+				const uint32_t t = elapsed[i] + step[i] * frames;
+				//繰り返すなら周期で割った余り、繰り返さないならそのまま
+				const uint32_t local = t - cycle[i] * (t / cycle[i]) * loop[i];
+				elapsed[i] = std::min(local, cycle[i]);
+				frame[i] = table[tableOffset[i] + std::min(local, cycle[i] - 1)];
+			}
+		}
+	};
+public:
+	static Singleton& Get()
+	{
+		static std::unique_ptr<Singleton> instance = std::make_unique<Singleton>();
+		return *instance;
+	}
+};
@@ -7,6 +7,12 @@
 - 2018/10/14 tonarinohito
 -# load系メソッドが戻り値を返すようにした
 -# load系メソッドにて登録の重複がある場合、そのハンドルを返すようにした
+- 2026/10/18 tonarinohito
+-# 画像と同時にピクセル単位の当たり判定用マスクを作るloadWithMaskを追加
+-# 読み込んだ画像を大きなページにまとめるbuildAtlasを追加
+-# 登録名を毎回引かずに画像を参照できるGraphicIdを追加
+-# 乗算済みアルファへの変換と余白の切り詰めをして読み込むloadProcessedを追加
+-# 読み込んだときに求めた画像の大きさを返すfindSizeを追加
 */
 #pragma once
 #include <DxLib.h>
@@ -14,7 +20,15 @@
 #include <unordered_map>
 #include <string>
 #include <cassert>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <fstream>
 #include "../Utility/Utility.hpp"
+#include "../Utility/picojson.h"
+#include "../Collision/CollisionMask.hpp"
+#include "../Renderer/AtlasPacker.hpp"
+#include "../Renderer/ImageProcess.hpp"
 
 //!サウンドの種類
 enum class SoundType
@@ -23,6 +37,29 @@ enum class SoundType
 	SE
 };
 
+//!アトラスのページの中で画像が置かれている範囲です
+struct AtlasRegion
+{
+	//!ページの画像ハンドル
+	int handle = -1;
+	int x = 0;
+	int y = 0;
+	int w = 0;
+	int h = 0;
+};
+
+/**
+* @brief 登録名の代わりに画像を引くためのIDです
+* @details GraphicManager::findId()などで一度だけ登録名から引いておけば、以降は文字列を使わずにハンドルを引けます。
+* 画像が解放されるとIDは無効になり、同じ名前で読み直しても古いIDは有効になりません
+*/
+struct GraphicId
+{
+	static constexpr uint32_t INVALID_INDEX = 0xffffffff;
+	uint32_t index = INVALID_INDEX;
+	uint32_t generation = 0;
+};
+
 //!グラフィックやサウンドのハンドル管理をします
 class ResourceManager final
 {
@@ -36,8 +73,330 @@ private:
 	private:
 		typedef std::unordered_map<std::string, int> GraphMap;
 		typedef std::unordered_map<std::string, std::pair<int*, size_t>> DivGraphMap;
+		typedef std::unordered_map<std::string, std::unique_ptr<CollisionMaskSet>> MaskMap;
+		//!アトラスを作るときに読み直す分割画像の情報です
+		struct DivSource
+		{
+			std::string path;
+			int allNum = 0;
+			int xNum = 0;
+			int yNum = 0;
+			int xSize = 0;
+			int ySize = 0;
+		};
+		//!アトラスに入れる画像一枚分の情報です
+		struct AtlasEntry
+		{
+			std::string name;
+			bool isDiv = false;
+			std::string path;
+			//!読み込むときの処理の指定。変わったらページを作り直します
+			std::string option;
+			int softImage = -1;
+			int w = 0;
+			int h = 0;
+			MaxRectsPacker::Placement placement;
+		};
+		//!GraphicIdから引く画像の情報です。解放するとgenerationが進み、古いIDは無効になります
+		struct GraphicSlot
+		{
+			uint32_t generation = 0;
+			bool isAlive = false;
+			bool isDiv = false;
+			bool isAtlas = false;
+			int handle = -1;
+			const int* divHandles = nullptr;
+			int divNum = 0;
+			int xNum = 1;
+			int xSize = 0;
+			int ySize = 0;
+			AtlasRegion region;
+			//!loadProcessedで余白を切り詰めたか、乗算済みアルファに直したか
+			bool isTrimmed = false;
+			bool isPremultiplied = false;
+			ImageTrim trim;
+			//!画像の大きさです。分割画像は1枚分です。描画の出力先に問い合わせずに引けるように読み込んだときに求めます
+			int w = 0;
+			int h = 0;
+		};
+		static constexpr int ATLAS_CACHE_VERSION = 2;
 		GraphMap graphs_;
 		DivGraphMap divGraphs_;
+		MaskMap masks_;
+		std::unordered_map<std::string, std::string> paths_;
+		std::unordered_map<std::string, DivSource> divSources_;
+		//!loadProcessedで読み込んだ画像の処理の指定です。アトラスに入れるときも同じ処理で読み直します
+		std::unordered_map<std::string, ImageLoadOption> loadOptions_;
+		std::vector<GraphicSlot> slots_;
+		std::vector<uint32_t> freeSlots_;
+		std::unordered_map<std::string, uint32_t> graphIds_;
+		std::unordered_map<std::string, uint32_t> divIds_;
+		std::vector<int> atlasPages_;
+		std::string atlasKey_;
+
+		//!キャッシュに保存した配置が今の画像の並びと同じなら読み込みます
+		[[nodiscard]] static bool LoadAtlasCache(const std::string& cachePath, const int pageSize, const int padding,
+			std::vector<AtlasEntry>& entries)
+		{
+			std::ifstream ifs(cachePath);
+			if (!ifs)
+			{
+				return false;
+			}
+			picojson::value v;
+			if (!picojson::parse(v, ifs).empty() || !v.is<picojson::object>())
+			{
+				return false;
+			}
+			auto& root = v.get<picojson::object>();
+			if (!root["version"].is<double>() || int(root["version"].get<double>()) != ATLAS_CACHE_VERSION ||
+				!root["pageSize"].is<double>() || int(root["pageSize"].get<double>()) != pageSize ||
+				!root["padding"].is<double>() || int(root["padding"].get<double>()) != padding ||
+				!root["images"].is<picojson::array>())
+			{
+				return false;
+			}
+			auto& images = root["images"].get<picojson::array>();
+			if (images.size() != entries.size())
+			{
+				return false;
+			}
+			std::vector<MaxRectsPacker::Placement> placements(entries.size());
+			for (size_t i = 0; i < entries.size(); ++i)
+			{
+				if (!images[i].is<picojson::object>())
+				{
+					return false;
+				}
+				auto& image = images[i].get<picojson::object>();
+				const auto& e = entries[i];
+				if (!image["name"].is<std::string>() || image["name"].get<std::string>() != e.name ||
+					!image["path"].is<std::string>() || image["path"].get<std::string>() != e.path ||
+					!image["div"].is<bool>() || image["div"].get<bool>() != e.isDiv ||
+					!image["option"].is<std::string>() || image["option"].get<std::string>() != e.option ||
+					!image["w"].is<double>() || int(image["w"].get<double>()) != e.w ||
+					!image["h"].is<double>() || int(image["h"].get<double>()) != e.h ||
+					!image["page"].is<double>() || !image["x"].is<double>() || !image["y"].is<double>())
+				{
+					return false;
+				}
+				placements[i].page = int(image["page"].get<double>());
+				placements[i].x = int(image["x"].get<double>());
+				placements[i].y = int(image["y"].get<double>());
+				//壊れたキャッシュでページの外に書き込まないようにする
+				if (placements[i].page >= 0 &&
+					(placements[i].x < 0 || placements[i].y < 0 ||
+					placements[i].x + e.w + padding * 2 > pageSize || placements[i].y + e.h + padding * 2 > pageSize))
+				{
+					return false;
+				}
+			}
+			for (size_t i = 0; i < entries.size(); ++i)
+			{
+				entries[i].placement = placements[i];
+			}
+			return true;
+		}
+		//!配置をキャッシュに保存します
+		static void SaveAtlasCache(const std::string& cachePath, const int pageSize, const int padding,
+			const std::vector<AtlasEntry>& entries)
+		{
+			picojson::array images;
+			for (const auto& e : entries)
+			{
+				picojson::object image;
+				image["name"] = picojson::value(e.name);
+				image["path"] = picojson::value(e.path);
+				image["div"] = picojson::value(e.isDiv);
+				image["option"] = picojson::value(e.option);
+				image["w"] = picojson::value(double(e.w));
+				image["h"] = picojson::value(double(e.h));
+				image["page"] = picojson::value(double(e.placement.page));
+				image["x"] = picojson::value(double(e.placement.x));
+				image["y"] = picojson::value(double(e.placement.y));
+				images.emplace_back(image);
+			}
+			picojson::object root;
+			root["version"] = picojson::value(double(ATLAS_CACHE_VERSION));
+			root["pageSize"] = picojson::value(double(pageSize));
+			root["padding"] = picojson::value(double(padding));
+			root["images"] = picojson::value(images);
+			std::ofstream ofs(cachePath);
+			if (!ofs)
+			{
+				DOUT << cachePath + " save is failed" << std::endl;
+				return;
+			}
+			ofs << picojson::value(root).serialize(true);
+		}
+		//!余白を画像の端の色で埋めながらページに書き込みます
+		static void BlitExtruded(const int src, const int w, const int h,
+			const int page, const int destX, const int destY, const int padding)
+		{
+			for (int y = -padding; y < h + padding; ++y)
+			{
+				for (int x = -padding; x < w + padding; ++x)
+				{
+					int r, g, b, a;
+					GetPixelSoftImage(src, std::clamp(x, 0, w - 1), std::clamp(y, 0, h - 1), &r, &g, &b, &a);
+					DrawPixelSoftImage(page, destX + padding + x, destY + padding + y, r, g, b, a);
+				}
+			}
+		}
+		//!ImageProcess::Load()の結果から画像を作り、ソフトイメージを解放します
+		[[nodiscard]] static int CreateProcessedGraph(const ImageProcess::Result& result)
+		{
+			if (result.softImage == -1)
+			{
+				return -1;
+			}
+			const int handle = CreateGraphFromSoftImage(result.softImage);
+			DeleteSoftImage(result.softImage);
+			return handle;
+		}
+		//!アトラスに入れる画像をソフトイメージで読み込みます。loadProcessedで読み込んだ画像は同じ処理をします
+		[[nodiscard]] int loadAtlasSoftImage(const AtlasEntry& e) const
+		{
+			const auto it = loadOptions_.find(e.name);
+			if (e.isDiv || it == loadOptions_.end())
+			{
+				return LoadSoftImage(e.path.c_str());
+			}
+			return ImageProcess::Load(e.path, it->second).softImage;
+		}
+		//!アトラスに入れる画像を読み込むときの処理の指定を、キャッシュと比べられる文字列にします
+		[[nodiscard]] std::string atlasOptionKey(const AtlasEntry& e) const
+		{
+			std::string key = !e.isDiv && masks_.count(e.name) ? "mask" : "";
+			const auto it = loadOptions_.find(e.name);
+			if (!e.isDiv && it != loadOptions_.end())
+			{
+				const ImageLoadOption& option = it->second;
+				key += std::string(key.empty() ? "" : ",") +
+					"premultiply:" + (option.isPremultiply ? "1" : "0") +
+					",trim:" + (option.isTrim ? "1" : "0") +
+					",format:" + std::to_string(int(option.format));
+			}
+			return key;
+		}
+		//!画像を読み直します。loadProcessedで読み込んだ画像は同じ処理をします
+		[[nodiscard]] int reloadGraph(const std::string& name, const std::string& path) const
+		{
+			const auto it = loadOptions_.find(name);
+			if (it == loadOptions_.end())
+			{
+				return LoadGraph(path.c_str());
+			}
+			return CreateProcessedGraph(ImageProcess::Load(path, it->second));
+		}
+		//!画像のアルファ値から当たり判定用マスクを作ります
+		void createMask(const std::string& path, const std::string& name, const int alphaThreshold)
+		{
+			if (masks_.count(name))
+			{
+				return;
+			}
+			const int softImage = LoadSoftImage(path.c_str());
+			if (softImage == -1)
+			{
+				DOUT << path + " mask load is failed" << std::endl;
+				assert(false && " mask load is failed");
+				return;
+			}
+			int w = 0, h = 0;
+			GetSoftImageSize(softImage, &w, &h);
+			std::vector<uint8_t> alpha(size_t(w) * size_t(h));
+			for (int y = 0; y < h; ++y)
+			{
+				for (int x = 0; x < w; ++x)
+				{
+					int r, g, b, a;
+					GetPixelSoftImage(softImage, x, y, &r, &g, &b, &a);
+					alpha[size_t(y) * size_t(w) + size_t(x)] = static_cast<uint8_t>(a);
+				}
+			}
+			DeleteSoftImage(softImage);
+			masks_[name] = std::make_unique<CollisionMaskSet>(w, h, alpha, alphaThreshold);
+		}
+		//!アトラスのページを解放します。ページから作ったハンドルは先に解放してください
+		void deleteAtlasPages()
+		{
+			for (const int page : atlasPages_)
+			{
+				DeleteGraph(page);
+			}
+			atlasPages_.clear();
+			for (auto& slot : slots_)
+			{
+				slot.isAtlas = false;
+			}
+			atlasKey_.clear();
+		}
+		//!登録名にスロットを割り当てます。空いたスロットがあれば使い回します
+		GraphicSlot& allocateSlot(std::unordered_map<std::string, uint32_t>& ids, const std::string& name)
+		{
+			uint32_t index = 0;
+			if (!freeSlots_.empty())
+			{
+				index = freeSlots_.back();
+				freeSlots_.pop_back();
+			}
+			else
+			{
+				index = static_cast<uint32_t>(slots_.size());
+				slots_.emplace_back();
+			}
+			auto& slot = slots_[index];
+			const uint32_t generation = slot.generation;
+			slot = GraphicSlot();
+			slot.generation = generation;
+			slot.isAlive = true;
+			ids[name] = index;
+			return slot;
+		}
+		//!分割画像のスロットを割り当てます
+		void allocateDivSlot(const std::string& name, const int allNum, const int xNum, const int xSize, const int ySize)
+		{
+			auto& slot = allocateSlot(divIds_, name);
+			slot.isDiv = true;
+			slot.handle = divGraphs_[name].first[0];
+			slot.divHandles = divGraphs_[name].first;
+			slot.divNum = allNum;
+			slot.xNum = xNum;
+			slot.xSize = xSize;
+			slot.ySize = ySize;
+			slot.w = xSize;
+			slot.h = ySize;
+		}
+		//!スロットを解放し、そのスロットを指していたIDを無効にします
+		void releaseSlot(const uint32_t index)
+		{
+			auto& slot = slots_[index];
+			slot.isAlive = false;
+			++slot.generation;
+			freeSlots_.emplace_back(index);
+		}
+		//!登録名のスロットを解放します
+		void releaseSlot(std::unordered_map<std::string, uint32_t>& ids, const std::string& name)
+		{
+			const auto it = ids.find(name);
+			if (it == ids.end())
+			{
+				return;
+			}
+			releaseSlot(it->second);
+			ids.erase(it);
+		}
+		//!IDが指すスロットを返します。無効なIDならnullptrが返ります
+		[[nodiscard]] const GraphicSlot* findSlot(const GraphicId& id) const
+		{
+			if (id.index >= slots_.size())
+			{
+				return nullptr;
+			}
+			const auto& slot = slots_[id.index];
+			return slot.isAlive && slot.generation == id.generation ? &slot : nullptr;
+		}
 	public:
 		~GraphicManager()
 		{
@@ -69,13 +428,87 @@ private:
 				DOUT << path + " load is failed" << std::endl;
 				assert(false && " load is failed");
 			}
+			paths_[name] = path;
+			auto& slot = allocateSlot(graphIds_, name);
+			slot.handle = graphs_[name];
+			GetGraphSize(slot.handle, &slot.w, &slot.h);
+			return graphs_[name];
+		}
+		/**
+		* @brief  画像をロードし、アルファ値からピクセル単位の当たり判定用マスクを作ります
+		* @param  path ファイルパス
+		* @param  name 登録名
+		* @param  alphaThreshold この値以上のアルファ値のピクセルを当たりにします
+		* @detail マスクはMaskColliderで使います。回転したマスクもここで作るので、ゲーム中には呼ばないでください
+		* @return 登録したハンドルが返ります。
+		* - すでに登録した名前を指定したらそのハンドルが返ります
+		*/
+		int loadWithMask(const std::string& path, const std::string& name, const int alphaThreshold = 128)
+		{
+			const int handle = load(path, name);
+			createMask(path, name, alphaThreshold);
+			return handle;
+		}
+		/**
+		* @brief  画像を読み込むときに乗算済みアルファへの変換、透明な余白の切り詰め、画素の形式の選択をしてロードします
+		* @param  path ファイルパス
+		* @param  name 登録名
+		* @param  option 行う処理
+		* @detail SpriteDrawは切り詰めた余白を基準座標に足し、乗算済みアルファの画像は乗算済みα用のブレンドで描画します。
+		* - 直接描画する場合はfindTrim()とisPremultiplied()で合わせてください
+		* - buildAtlasでページに入れるときも同じ処理をして読み直します
+		* @return 登録したハンドルが返ります。
+		* - すでに登録した名前を指定したらそのハンドルが返ります
+		*/
+		int loadProcessed(const std::string& path, const std::string& name, const ImageLoadOption& option = ImageLoadOption())
+		{
+			//名前の重複防止
+			if (graphs_.count(name))
+			{
+				DOUT << "GraphicHandle :" + name + " add is failed" << std::endl;
+				return graphs_[name];
+			}
+			const auto result = ImageProcess::Load(path, option);
+			graphs_[name] = CreateProcessedGraph(result);
+			if (graphs_[name] == -1)
+			{
+				DOUT << path + " load is failed" << std::endl;
+				assert(false && " load is failed");
+			}
+			paths_[name] = path;
+			loadOptions_[name] = option;
+			auto& slot = allocateSlot(graphIds_, name);
+			slot.handle = graphs_[name];
+			slot.isTrimmed = result.isTrimmed;
+			slot.isPremultiplied = result.isPremultiplied;
+			slot.trim = result.trim;
+			slot.w = result.trim.w;
+			slot.h = result.trim.h;
 			return graphs_[name];
 		}
 		/**
+		* @brief  loadProcessedでロードし、アルファ値からピクセル単位の当たり判定用マスクを作ります
+		* @param  path ファイルパス
+		* @param  name 登録名
+		* @param  option 行う処理
+		* @param  alphaThreshold この値以上のアルファ値のピクセルを当たりにします
+		* @detail マスクは余白を切り詰める前の画像の大きさで作ります
+		* @return 登録したハンドルが返ります。
+		* - すでに登録した名前を指定したらそのハンドルが返ります
+		*/
+		int loadProcessedWithMask(const std::string& path, const std::string& name,
+			const ImageLoadOption& option = ImageLoadOption(), const int alphaThreshold = 128)
+		{
+			const int handle = loadProcessed(path, name, option);
+			createMask(path, name, alphaThreshold);
+			return handle;
+		}
+		/**
 		* @brief  画像を非同期でロードします
 		* @param  path ファイルパス
 		* @param  name 登録名
-		* @detail 既に登録した名前は使えません。非同期なのでこのメソッドで処理が止まることはありません
+		* @detail 既に登録した名前は使えません。非同期なのでこのメソッドで処理が止まることはありません。
+		* - 画像の大きさはisLoaded()で読み込みが済んだのを確かめたときに求めます
 		* @return 正常に読み込めたら1が返ります
 		* - すでに登録した名前を指定したらそのハンドルが返ります
 		*/
@@ -94,6 +527,7 @@ private:
 				DOUT << path + " load is failed" << std::endl;
 				assert(false && " load is failed");
 			}
+			allocateSlot(graphIds_, name).handle = graphs_[name];
 			SetUseASyncLoadFlag(FALSE); // 非同期読み込みフラグOFF
 			return 1;
 		}
@@ -114,7 +548,15 @@ private:
 				}
 				break;
 
-			case FALSE: return true;	//非同期読み込み済み
+			case FALSE:	//非同期読み込み済み
+			{
+				const auto it = graphIds_.find(name);
+				if (it != graphIds_.end() && slots_[it->second].w == 0)
+				{
+					GetGraphSize(graphs_[name], &slots_[it->second].w, &slots_[it->second].h);
+				}
+				return true;
+			}
 			case TRUE:  return false;	//まだ
 
 			}
@@ -172,6 +614,8 @@ private:
 				DOUT << path + " load is failed" << std::endl;
 				assert(false && " load is failed");
 			}
+			divSources_[name] = DivSource{ path, allNum, xNum, yNum, xSize, ySize };
+			allocateDivSlot(name, allNum, xNum, xSize, ySize);
 			return divGraphs_[name].first[0];
 		}
 		/**
@@ -206,10 +650,73 @@ private:
 				DOUT << path + " loadAsync is failed" << std::endl;
 				assert(false && " loadAsync is failed");
 			}
+			allocateDivSlot(name, allNum, xNum, xSize, ySize);
 			SetUseASyncLoadFlag(FALSE); // 非同期読み込みフラグOFF
 			return 1;
 		}
 		/**
+		* @brief  登録名からGraphicIdを引きます
+		* @param  name 登録名
+		* @return 登録されていなければ無効なIDが返ります
+		* @detail 描画のたびに登録名を引かずに済むよう、初期化時に一度だけ呼んでください
+		*/
+		[[nodiscard]] GraphicId findId(const std::string& name) const
+		{
+			const auto it = graphIds_.find(name);
+			if (it == graphIds_.end())
+			{
+				return GraphicId();
+			}
+			return GraphicId{ it->second, slots_[it->second].generation };
+		}
+		/**
+		* @brief  分割画像の登録名からGraphicIdを引きます
+		* @param  name 登録名
+		* @return 登録されていなければ無効なIDが返ります
+		*/
+		[[nodiscard]] GraphicId findDivId(const std::string& name) const
+		{
+			const auto it = divIds_.find(name);
+			if (it == divIds_.end())
+			{
+				return GraphicId();
+			}
+			return GraphicId{ it->second, slots_[it->second].generation };
+		}
+		/**
+		* @brief  IDが指す画像がまだ有効か返します
+		* @param  id 画像のID
+		* @return 画像が解放されていればfalse
+		*/
+		[[nodiscard]] bool isAlive(const GraphicId& id) const
+		{
+			return findSlot(id) != nullptr;
+		}
+		/**
+		* @brief  IDが指す画像のハンドルを返します
+		* @param  id findId()で引いたID
+		* @detail 無効なIDを指定するとエラーになります
+		*/
+		[[nodiscard]] int getHandle(const GraphicId& id) const
+		{
+			const auto* slot = findSlot(id);
+			assert(slot != nullptr && !slot->isDiv && "GraphicId is invalid");
+			return slot->handle;
+		}
+		/**
+		* @brief  IDが指す分割画像のハンドルを返します
+		* @param  id findDivId()で引いたID
+		* @param  index 配列の要素数
+		* @detail 無効なIDを指定するか分割数を超えた値を指定するとエラーになります
+		*/
+		[[nodiscard]] int getDivHandle(const GraphicId& id, const int index) const
+		{
+			const auto* slot = findSlot(id);
+			assert(slot != nullptr && slot->isDiv && "GraphicId is invalid");
+			assert(index >= 0 && index < slot->divNum && "index is out of range");
+			return slot->divHandles[index];
+		}
+		/**
 		* @brief  メモリに読み込んだ画像のハンドルを返します
 		* @param  name 登録名
 		* @return 成功したらハンドルが返ります
@@ -259,6 +766,30 @@ private:
 			return false;
 		}
 		/**
+		* @brief  loadWithMaskで作ったマスクが存在するか返します
+		* @param  name 登録名
+		* @return マスクが存在したらtrue
+		*/
+		[[nodiscard]] bool hasMask(const std::string& name) const
+		{
+			return masks_.count(name) != 0;
+		}
+		/**
+		* @brief  loadWithMaskで作ったマスクを返します
+		* @param  name 登録名
+		* @detail 存在しない名前にアクセスするとエラーになります
+		*/
+		[[nodiscard]] const CollisionMaskSet& getMask(const std::string& name) const
+		{
+			const auto it = masks_.find(name);
+			if (it == masks_.end())
+			{
+				DOUT << "Registered mask :" + name + " is not found" << std::endl;
+				assert(false);
+			}
+			return *it->second;
+		}
+		/**
 		* @brief  メモリに読み込んだ分割画像のハンドルが存在するか返します
 		* @param  name 登録名
 		* @return ハンドルが存在したらtrue
@@ -272,6 +803,309 @@ private:
 			return false;
 		}
 		/**
+		* @brief  load、loadWithMask、loadProcessed、loadDivで読み込んだ画像を大きなページにまとめます
+		* @param  cachePath 配置を保存するファイルパス
+		* @param  pageSize ページの一辺の最大の大きさ。2のn乗にしてください
+		* @param  padding 画像の周りの余白。バイリニア補間で隣の画像がにじまないように画像の端の色で埋めます
+		* @return 作ったページの数が返ります
+		* @detail 登録済みのハンドルはページから切り出したハンドルに差し替わるので、今まで通り使えます。
+		* - 配置は登録名の順に決まるので、同じ画像なら毎回同じになります。画像の並び、大きさ、読み込むときの処理がキャッシュと同じなら詰め直しません
+		* - キャッシュはデバッグビルドでだけ書き出します。リリースビルドはデバッグビルドで作ったものを読むだけです
+		* - ページは使った範囲を囲む2のn乗の大きさにするので、DXライブラリがテクスチャを広げることはありません
+		* - 非同期で読み込んだ画像とページに入らない大きさの画像はそのままです。ロード時に呼んでください
+		*/
+		int buildAtlas(const std::string& cachePath, const int pageSize = 2048, const int padding = 2)
+		{
+			assert(pageSize > 0 && (pageSize & (pageSize - 1)) == 0 && "pageSize must be a power of two");
+			std::vector<AtlasEntry> entries;
+			for (const auto&[name, path] : paths_)
+			{
+				AtlasEntry e;
+				e.name = name;
+				e.path = path;
+				entries.emplace_back(e);
+			}
+			for (const auto&[name, source] : divSources_)
+			{
+				AtlasEntry e;
+				e.name = name;
+				e.isDiv = true;
+				e.path = source.path;
+				entries.emplace_back(e);
+			}
+			//unordered_mapの順番は決まっていないので登録名で並べる
+			std::sort(entries.begin(), entries.end(), [](const AtlasEntry& a, const AtlasEntry& b)
+			{
+				return a.name != b.name ? a.name < b.name : a.isDiv < b.isDiv;
+			});
+			std::string key = std::to_string(pageSize) + ":" + std::to_string(padding);
+			for (auto& e : entries)
+			{
+				e.option = atlasOptionKey(e);
+				key += "|" + e.name + (e.isDiv ? "*" : ":") + e.path + "?" + e.option;
+			}
+			if (!atlasPages_.empty() && key == atlasKey_)
+			{
+				return int(atlasPages_.size());
+			}
+			for (auto& e : entries)
+			{
+				e.softImage = loadAtlasSoftImage(e);
+				if (e.softImage == -1)
+				{
+					DOUT << e.path + " atlas load is failed" << std::endl;
+					assert(false && " atlas load is failed");
+					continue;
+				}
+				GetSoftImageSize(e.softImage, &e.w, &e.h);
+			}
+			entries.erase(std::remove_if(entries.begin(), entries.end(),
+				[](const AtlasEntry& e) { return e.softImage == -1; }), entries.end());
+
+			if (!LoadAtlasCache(cachePath, pageSize, padding, entries))
+			{
+				std::vector<std::pair<int, int>> sizes;
+				for (const auto& e : entries)
+				{
+					sizes.emplace_back(e.w + padding * 2, e.h + padding * 2);
+				}
+				int packedNum = 0;
+				const auto placements = MaxRectsPacker::PackPages(sizes, pageSize, pageSize, packedNum);
+				for (size_t i = 0; i < entries.size(); ++i)
+				{
+					entries[i].placement = placements[i];
+				}
+#ifdef _DEBUG
+				//リリースビルドではResource/の下に書き込まない
+				SaveAtlasCache(cachePath, pageSize, padding, entries);
+#endif
+				DOUT << "Atlas is packed :" + std::to_string(packedNum) + " pages" << std::endl;
+			}
+
+			//前のページから切り出したハンドルを差し替えてからページを解放する
+			const std::vector<int> oldPages = atlasPages_;
+			atlasPages_.clear();
+			int pageNum = 0;
+			for (const auto& e : entries)
+			{
+				pageNum = std::max(pageNum, e.placement.page + 1);
+			}
+			for (int page = 0; page < pageNum; ++page)
+			{
+				//最後のページが小さく済むように、使った範囲を囲む2のn乗の大きさにする
+				int usedW = 1, usedH = 1;
+				for (const auto& e : entries)
+				{
+					if (e.placement.page == page)
+					{
+						usedW = std::max(usedW, e.placement.x + e.w + padding * 2);
+						usedH = std::max(usedH, e.placement.y + e.h + padding * 2);
+					}
+				}
+				int w = 1, h = 1;
+				while (w < usedW)
+				{
+					w *= 2;
+				}
+				while (h < usedH)
+				{
+					h *= 2;
+				}
+				const int softPage = MakeARGB8ColorSoftImage(w, h);
+				FillSoftImage(softPage, 0, 0, 0, 0);
+				for (const auto& e : entries)
+				{
+					if (e.placement.page == page)
+					{
+						BlitExtruded(e.softImage, e.w, e.h, softPage, e.placement.x, e.placement.y, padding);
+					}
+				}
+				atlasPages_.emplace_back(CreateGraphFromSoftImage(softPage));
+				DeleteSoftImage(softPage);
+			}
+			for (const auto& e : entries)
+			{
+				DeleteSoftImage(e.softImage);
+				if (e.placement.page < 0)
+				{
+					DOUT << e.path + " is too large for atlas" << std::endl;
+				}
+				auto& slot = slots_[(e.isDiv ? divIds_ : graphIds_).at(e.name)];
+				const bool wasAtlas = slot.isAtlas;
+				slot.isAtlas = false;
+				if (!e.isDiv)
+				{
+					if (e.placement.page < 0)
+					{
+						//前のページから切り出していたなら元の画像を読み直す
+						if (wasAtlas)
+						{
+							DeleteGraph(graphs_[e.name]);
+							graphs_[e.name] = reloadGraph(e.name, e.path);
+							slot.handle = graphs_[e.name];
+						}
+						continue;
+					}
+					const AtlasRegion region{ atlasPages_[size_t(e.placement.page)],
+						e.placement.x + padding, e.placement.y + padding, e.w, e.h };
+					DeleteGraph(graphs_[e.name]);
+					graphs_[e.name] = DerivationGraph(region.x, region.y, region.w, region.h, region.handle);
+					slot.handle = graphs_[e.name];
+					slot.isAtlas = true;
+					slot.region = region;
+					continue;
+				}
+				const auto& source = divSources_[e.name];
+				auto& handles = divGraphs_[e.name];
+				if (e.placement.page < 0)
+				{
+					if (wasAtlas)
+					{
+						for (size_t i = 0; i < handles.second; ++i)
+						{
+							DeleteGraph(handles.first[i]);
+						}
+						LoadDivGraph(source.path.c_str(), source.allNum, source.xNum, source.yNum,
+							source.xSize, source.ySize, handles.first);
+						slot.handle = handles.first[0];
+					}
+					continue;
+				}
+				const AtlasRegion region{ atlasPages_[size_t(e.placement.page)],
+					e.placement.x + padding, e.placement.y + padding, e.w, e.h };
+				for (size_t i = 0; i < handles.second; ++i)
+				{
+					DeleteGraph(handles.first[i]);
+					handles.first[i] = DerivationGraph(
+						region.x + int(i) % source.xNum * source.xSize,
+						region.y + int(i) / source.xNum * source.ySize,
+						source.xSize, source.ySize, region.handle);
+				}
+				slot.handle = handles.first[0];
+				slot.isAtlas = true;
+				slot.region = region;
+			}
+			for (const int page : oldPages)
+			{
+				DeleteGraph(page);
+			}
+			atlasKey_ = key;
+			return pageNum;
+		}
+		/**
+		* @brief  buildAtlasでページに入れた画像の範囲を返します
+		* @param  id findId()で引いたID
+		* @param  region ページの画像ハンドルと範囲が返ります
+		* @return ページに入っていないか無効なIDならfalse
+		*/
+		[[nodiscard]] bool findAtlasRegion(const GraphicId& id, AtlasRegion& region) const
+		{
+			const auto* slot = findSlot(id);
+			if (slot == nullptr || !slot->isAtlas || slot->isDiv)
+			{
+				return false;
+			}
+			region = slot->region;
+			return true;
+		}
+		/**
+		* @brief  buildAtlasでページに入れた画像の範囲を返します
+		* @param  name 登録名
+		* @param  region ページの画像ハンドルと範囲が返ります
+		* @return ページに入っていなければfalse
+		*/
+		[[nodiscard]] bool findAtlasRegion(const std::string& name, AtlasRegion& region) const
+		{
+			return findAtlasRegion(findId(name), region);
+		}
+		/**
+		* @brief  buildAtlasでページに入れた分割画像の一枚分の範囲を返します
+		* @param  id findDivId()で引いたID
+		* @param  index 配列の要素数
+		* @param  region ページの画像ハンドルと範囲が返ります
+		* @return ページに入っていないか、無効なIDか分割数を超えた値を指定したらfalse
+		*/
+		[[nodiscard]] bool findAtlasDivRegion(const GraphicId& id, const int index, AtlasRegion& region) const
+		{
+			const auto* slot = findSlot(id);
+			if (slot == nullptr || !slot->isAtlas || !slot->isDiv || index < 0 || index >= slot->divNum)
+			{
+				return false;
+			}
+			region = slot->region;
+			region.x += index % slot->xNum * slot->xSize;
+			region.y += index / slot->xNum * slot->ySize;
+			region.w = slot->xSize;
+			region.h = slot->ySize;
+			return true;
+		}
+		/**
+		* @brief  buildAtlasでページに入れた分割画像の一枚分の範囲を返します
+		* @param  name 登録名
+		* @param  index 配列の要素数
+		* @param  region ページの画像ハンドルと範囲が返ります
+		* @return ページに入っていないか分割数を超えた値を指定したらfalse
+		*/
+		[[nodiscard]] bool findAtlasDivRegion(const std::string& name, const int index, AtlasRegion& region) const
+		{
+			return findAtlasDivRegion(findDivId(name), index, region);
+		}
+		/**
+		* @brief  loadProcessedで切り詰めた余白を返します
+		* @param  id findId()で引いたID
+		* @param  trim 切り詰めた画像の元の画像での位置が返ります
+		* @return 切り詰めていないか無効なIDならfalse
+		*/
+		[[nodiscard]] bool findTrim(const GraphicId& id, ImageTrim& trim) const
+		{
+			const auto* slot = findSlot(id);
+			if (slot == nullptr || !slot->isTrimmed)
+			{
+				return false;
+			}
+			trim = slot->trim;
+			return true;
+		}
+		/**
+		* @brief  loadProcessedで切り詰めた余白を返します
+		* @param  name 登録名
+		* @param  trim 切り詰めた画像の元の画像での位置が返ります
+		* @return 切り詰めていなければfalse
+		*/
+		[[nodiscard]] bool findTrim(const std::string& name, ImageTrim& trim) const
+		{
+			return findTrim(findId(name), trim);
+		}
+		/**
+		* @brief  loadProcessedで乗算済みアルファに直した画像か返します
+		* @param  id findId()で引いたID
+		* @return 直していないか無効なIDならfalse
+		*/
+		[[nodiscard]] bool isPremultiplied(const GraphicId& id) const
+		{
+			const auto* slot = findSlot(id);
+			return slot != nullptr && slot->isPremultiplied;
+		}
+		/**
+		* @brief  画像の大きさを返します
+		* @param  id findId()で引いたID
+		* @param  w 幅が返ります。分割画像は1枚分です
+		* @param  h 高さが返ります
+		* @detail 読み込んだときに求めた値なので、描画の出力先に触れないスレッドからも呼べます
+		* @return 無効なIDか、非同期で読み込み中ならfalse
+		*/
+		[[nodiscard]] bool findSize(const GraphicId& id, int& w, int& h) const
+		{
+			const auto* slot = findSlot(id);
+			if (slot == nullptr || slot->w == 0)
+			{
+				return false;
+			}
+			w = slot->w;
+			h = slot->h;
+			return true;
+		}
+		/**
 		* @brief  メモリに読み込んだ画像リソースを解放します
 		* @param  name 登録名
 		* @detail 登録名が存在しない場合何も起きません
@@ -286,6 +1120,8 @@ private:
 			DeleteGraph(*divGraphs_[name].first);
 			Utility::SafeDeleteArray(divGraphs_[name].first);
 			divGraphs_.erase(name);
+			divSources_.erase(name);
+			releaseSlot(divIds_, name);
 		}
 		/**
 		* @brief  メモリに読み込んだ分割画像リソースを解放します
@@ -301,6 +1137,10 @@ private:
 			}
 			DeleteGraph(graphs_[name]);
 			graphs_.erase(name);
+			masks_.erase(name);
+			paths_.erase(name);
+			loadOptions_.erase(name);
+			releaseSlot(graphIds_, name);
 		}
 		/**
 		* @brief  メモリに読み込んだ画像リソースをすべて解放します
@@ -319,9 +1159,23 @@ private:
 			{
 				Utility::SafeDeleteArray(it.second.first);
 			}
+			for (const auto&[key, index] : graphIds_)
+			{
+				releaseSlot(index);
+			}
+			for (const auto&[key, index] : divIds_)
+			{
+				releaseSlot(index);
+			}
+			graphIds_.clear();
+			divIds_.clear();
 			divGraphs_.clear();
 			graphs_.clear();
-
+			masks_.clear();
+			paths_.clear();
+			loadOptions_.clear();
+			divSources_.clear();
+			deleteAtlasPages();
 		}
 	};
 
@@ -0,0 +1,913 @@
+﻿/**
+* @file BroadPhase.hpp
+* @brief 一様グリッドでコリジョンの候補ペアを絞り込むクラスです
+* @author tonarinohito
+* @date 2026/10/18
+* @par History
+- 2026/10/18 tonarinohito
+-# findPairsをスレッドプールで並列に処理するfindPairsParallelを追加
+-# 呼び出し側のバッファに結果を書き込む範囲検索(queryBox, queryCircle)と近傍検索(nearest)を追加
+-# グリッドをDDAでたどるレイキャスト(raycast, raycastAll, raycastBatch)を追加
+-# CompoundColliderはバウンディング円を囲む範囲1つで登録し、レイキャストでは各部位と判定するようにした
+-# 範囲検索の範囲をDebugDrawのQUERYで表示できるようにした
+*/
+#pragma once
+#include "../ECS/ECS.hpp"
+#include "Collision.hpp"
+#include "../System/System.hpp"
+#include "../Utility/ThreadPool.hpp"
+#include "../Renderer/DebugDraw.hpp"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <initializer_list>
+#include <cfloat>
+
+/**
+* @brief 画面を一定サイズのセルに分割し、コリジョンの候補ペアを返します
+* @details 毎フレームbuild()で作り直してから使います
+* - 円はsweepEnable()されていれば前フレームからの軌跡全体を範囲として登録します
+* - 同じペアは1度しか返りません。2つの範囲が重なる領域の左上のセルでのみ返します
+* - 画面外にはみ出たコライダーは端のセルに登録されます
+* - 候補ペアの詳細な判定はCollisionのメソッドで行ってください
+*/
+class BroadPhase final
+{
+public:
+	//!グリッドに登録される範囲です
+	struct Proxy
+	{
+		ECS::Entity* entity;
+		ECS::Group group;
+		float minX, minY, maxX, maxY;
+	};
+	//!衝突候補のペアです
+	struct Pair
+	{
+		ECS::Entity* a;
+		ECS::Entity* b;
+	};
+	//!レイキャストで飛ばす半直線です
+	struct Ray
+	{
+		Vec2 origin;
+		Vec2 dir;
+		float maxDistance;
+	};
+	//!レイキャストで当たった結果です
+	struct RayHit
+	{
+		ECS::Entity* entity;
+		float distance;
+		Vec2 point;
+	};
+private:
+	float cellSize_;
+	float invCellSize_;
+	int cols_;
+	int rows_;
+	std::vector<Proxy> proxies_;
+	//セルごとのproxies_の添字。cellItems_[cellStart_[i]]からcellItems_[cellStart_[i + 1]]までがセルiに入っている
+	std::vector<uint32_t> cellStart_;
+	std::vector<uint32_t> cellItems_;
+	std::vector<uint32_t> cellCursor_;
+	//並列処理で使う分割ごとのセルの範囲と結果
+	std::vector<uint64_t> cellCost_;
+	std::vector<int> chunkStart_;
+	std::vector<std::vector<Pair>> chunkPairs_;
+	//グリッドと登録されている範囲をすべて覆う範囲。レイキャストで使う
+	float boundsMinX_ = 0.f, boundsMinY_ = 0.f, boundsMaxX_ = 0.f, boundsMaxY_ = 0.f;
+
+	[[nodiscard]] int cellX(const float x) const noexcept
+	{
+		const int c = static_cast<int>(floorf(x * invCellSize_));
+		return c < 0 ? 0 : (c >= cols_ ? cols_ - 1 : c);
+	}
+	[[nodiscard]] int cellY(const float y) const noexcept
+	{
+		const int c = static_cast<int>(floorf(y * invCellSize_));
+		return c < 0 ? 0 : (c >= rows_ ? rows_ - 1 : c);
+	}
+	[[nodiscard]] static bool Overlap(const Proxy& p1, const Proxy& p2) noexcept
+	{
+		return p1.minX <= p2.maxX && p2.minX <= p1.maxX &&
+			p1.minY <= p2.maxY && p2.minY <= p1.maxY;
+	}
+	//!2つの範囲が重なる領域の左上のセルを返します
+	[[nodiscard]] int ownerCell(const Proxy& p1, const Proxy& p2) const noexcept
+	{
+		const float x = p1.minX > p2.minX ? p1.minX : p2.minX;
+		const float y = p1.minY > p2.minY ? p1.minY : p2.minY;
+		return cellY(y) * cols_ + cellX(x);
+	}
+	//!点から範囲までの距離の2乗を返します。範囲の中なら0です
+	[[nodiscard]] static float DistanceSq(const Proxy& p, const Vec2& pos) noexcept
+	{
+		const float dx = pos.x < p.minX ? p.minX - pos.x : (pos.x > p.maxX ? pos.x - p.maxX : 0.f);
+		const float dy = pos.y < p.minY ? p.minY - pos.y : (pos.y > p.maxY ? pos.y - p.maxY : 0.f);
+		return dx * dx + dy * dy;
+	}
+	/**
+	* @brief 矩形の範囲と重なっている指定グループの範囲ごとにfuncを呼びます
+	* @details 同じ範囲に対しては1度しか呼ばれません
+	*/
+	template<class Func>
+	void forEachInBox(const Proxy& q, Func&& func) const
+	{
+		for (int y = cellY(q.minY); y <= cellY(q.maxY); ++y)
+		{
+			for (int x = cellX(q.minX); x <= cellX(q.maxX); ++x)
+			{
+				const int cell = y * cols_ + x;
+				for (uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i)
+				{
+					const auto& p = proxies_[cellItems_[i]];
+					if (p.group != q.group || !Overlap(p, q) || ownerCell(p, q) != cell)
+					{
+						continue;
+					}
+					func(p);
+				}
+			}
+		}
+	}
+	/**
+	* @brief 半直線とEntityのコライダーの当たり判定をします
+	* @details CircleColliderとBoxColliderは形状で、それ以外は登録されている範囲で判定します。複数持つ場合は近い方を返します
+	*/
+	[[nodiscard]] static bool RayTest(const Proxy& p, const Vec2& origin, const Vec2& dir, const float maxDistance, float& distance)
+	{
+		bool isHit = false;
+		bool hasShape = false;
+		float best = maxDistance;
+		float hitDistance = 0.f;
+		if (p.entity != nullptr && p.entity->hasComponent<ECS::CircleCollider>())
+		{
+			hasShape = true;
+			const auto& c = p.entity->getComponent<ECS::CircleCollider>();
+			if (Collision::RayAndCircle(origin, dir, best, Vec2(c.x(), c.y()), c.radius(), hitDistance))
+			{
+				best = hitDistance;
+				isHit = true;
+			}
+		}
+		if (p.entity != nullptr && p.entity->hasComponent<ECS::BoxCollider>())
+		{
+			hasShape = true;
+			const auto& b = p.entity->getComponent<ECS::BoxCollider>();
+			if (Collision::RayAndBox(origin, dir, best, Vec2(b.x(), b.y()), Vec2(b.w(), b.h()), hitDistance))
+			{
+				best = hitDistance;
+				isHit = true;
+			}
+		}
+		if (p.entity != nullptr && p.entity->hasComponent<ECS::CompoundCollider>())
+		{
+			hasShape = true;
+			const auto& c = p.entity->getComponent<ECS::CompoundCollider>();
+			//バウンディング円に当たらなければ部位は調べない
+			if (Collision::RayAndCircle(origin, dir, best, c.boundCenter(), c.boundRadius(), hitDistance))
+			{
+				for (size_t i = 0; i < c.size(); ++i)
+				{
+					const auto& part = c.part(int(i));
+					if (!part.isActive)
+					{
+						continue;
+					}
+					bool isPartHit = false;
+					switch (part.type)
+					{
+					case ECS::CompoundPart::Type::CIRCLE:
+						isPartHit = Collision::RayAndCircle(origin, dir, best, part.center, part.radius, hitDistance);
+						break;
+					case ECS::CompoundPart::Type::OBB:
+						isPartHit = Collision::RayAndOBB(origin, dir, best, part.obb, hitDistance);
+						break;
+					case ECS::CompoundPart::Type::CAPSULE:
+						isPartHit = Collision::RayAndCapsule(origin, dir, best, part.capsule, hitDistance);
+						break;
+					}
+					if (isPartHit)
+					{
+						best = hitDistance;
+						isHit = true;
+					}
+				}
+			}
+		}
+		//形状が無いものは登録されている範囲で判定する
+		if (!hasShape &&
+			Collision::RayAndBox(origin, dir, maxDistance, Vec2(p.minX, p.minY), Vec2(p.maxX - p.minX, p.maxY - p.minY), hitDistance))
+		{
+			best = hitDistance;
+			isHit = true;
+		}
+		if (isHit)
+		{
+			distance = best;
+		}
+		return isHit;
+	}
+	/**
+	* @brief 半直線が通るセルを始点に近い順にたどります
+	* @param func 範囲ごとに呼ばれ、これ以上の距離は調べなくて良い距離を返す関数
+	* @details DDA(セルの境界を順に越えていく方法)でたどります。
+	* グリッドの外は端のセルに登録されているので、グリッドの外を通る部分は端のセルを調べます
+	*/
+	template<class Func>
+	void traverseRay(const Vec2& origin, const Vec2& dir, const float maxDistance, Func&& func) const
+	{
+		//登録されている範囲すべてを覆う矩形と交わる区間だけをたどる
+		float tEnter = 0.f;
+		if (!Collision::RayAndBox(origin, dir, maxDistance, Vec2(boundsMinX_, boundsMinY_),
+			Vec2(boundsMaxX_ - boundsMinX_, boundsMaxY_ - boundsMinY_), tEnter))
+		{
+			return;
+		}
+		float tExit = maxDistance;
+		if (dir.x > 0.f) { tExit = std::min(tExit, (boundsMaxX_ - origin.x) / dir.x); }
+		if (dir.x < 0.f) { tExit = std::min(tExit, (boundsMinX_ - origin.x) / dir.x); }
+		if (dir.y > 0.f) { tExit = std::min(tExit, (boundsMaxY_ - origin.y) / dir.y); }
+		if (dir.y < 0.f) { tExit = std::min(tExit, (boundsMinY_ - origin.y) / dir.y); }
+		const float startX = origin.x + dir.x * tEnter;
+		const float startY = origin.y + dir.y * tEnter;
+		int ix = static_cast<int>(floorf(startX * invCellSize_));
+		int iy = static_cast<int>(floorf(startY * invCellSize_));
+		const int stepX = dir.x > 0.f ? 1 : -1;
+		const int stepY = dir.y > 0.f ? 1 : -1;
+		//次のセルの境界を越える距離と、セル1つ分進むのにかかる距離
+		float tMaxX = FLT_MAX, tMaxY = FLT_MAX, tDeltaX = FLT_MAX, tDeltaY = FLT_MAX;
+		if (dir.x != 0.f)
+		{
+			tMaxX = (float(dir.x > 0.f ? ix + 1 : ix) * cellSize_ - origin.x) / dir.x;
+			tDeltaX = cellSize_ / fabsf(dir.x);
+		}
+		if (dir.y != 0.f)
+		{
+			tMaxY = (float(dir.y > 0.f ? iy + 1 : iy) * cellSize_ - origin.y) / dir.y;
+			tDeltaY = cellSize_ / fabsf(dir.y);
+		}
+		int prevCell = -1;
+		float limit = FLT_MAX;
+		while (true)
+		{
+			const float cellExit = std::min(std::min(tMaxX, tMaxY), tExit);
+			const int cell = (iy < 0 ? 0 : (iy >= rows_ ? rows_ - 1 : iy)) * cols_ + (ix < 0 ? 0 : (ix >= cols_ ? cols_ - 1 : ix));
+			//グリッドの外では同じ端のセルが続くので1度だけ調べる
+			if (cell != prevCell)
+			{
+				for (uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i)
+				{
+					limit = func(cellItems_[i]);
+				}
+				prevCell = cell;
+			}
+			//これより先のセルにはlimitより近いものは無い。ちょうど境界の距離なら、次のセルに登録順で先のものがあるかもしれないので調べる
+			if (limit < cellExit || cellExit >= tExit)
+			{
+				break;
+			}
+			if (tMaxX < tMaxY)
+			{
+				ix += stepX;
+				tMaxX += tDeltaX;
+			}
+			else
+			{
+				iy += stepY;
+				tMaxY += tDeltaY;
+			}
+		}
+	}
+	//!cellBeginからcellEndまでのセルで見つかったペアをpairsの後ろに追加します
+	void findPairsInCells(const ECS::Group a, const ECS::Group b, const int cellBegin, const int cellEnd, std::vector<Pair>& pairs) const
+	{
+		for (int cell = cellBegin; cell < cellEnd; ++cell)
+		{
+			const uint32_t begin = cellStart_[cell];
+			const uint32_t end = cellStart_[cell + 1];
+			for (uint32_t i = begin; i < end; ++i)
+			{
+				const auto& p1 = proxies_[cellItems_[i]];
+				if (p1.group != a)
+				{
+					continue;
+				}
+				for (uint32_t j = (a == b ? i + 1 : begin); j < end; ++j)
+				{
+					const auto& p2 = proxies_[cellItems_[j]];
+					if (p2.group != b ||
+						p1.entity == p2.entity ||
+						!Overlap(p1, p2) ||
+						ownerCell(p1, p2) != cell)
+					{
+						continue;
+					}
+					pairs.emplace_back(Pair{ p1.entity, p2.entity });
+				}
+			}
+		}
+	}
+public:
+	/**
+	* @brief グリッドを作成します
+	* @param cellSize セル1つの大きさ。よく使うコライダーの大きさより少し大きい値が目安です
+	* @param width グリッドで覆う幅
+	* @param height グリッドで覆う高さ
+	*/
+	explicit BroadPhase(const float cellSize = 64.f,
+		const int width = System::SCREEN_WIDIH, const int height = System::SCREEN_HEIGHT) :
+		cellSize_(cellSize),
+		invCellSize_(1.f / cellSize),
+		cols_(static_cast<int>(std::ceil(float(width) / cellSize))),
+		rows_(static_cast<int>(std::ceil(float(height) / cellSize)))
+	{
+		if (cols_ < 1) { cols_ = 1; }
+		if (rows_ < 1) { rows_ = 1; }
+		cellStart_.resize(size_t(cols_) * size_t(rows_) + 1);
+	}
+
+	//!登録されている範囲をすべて消します
+	void clear()
+	{
+		proxies_.clear();
+	}
+
+	/**
+	* @brief Entityについているコライダーから範囲を求めて登録します
+	* @param e Entity
+	* @param group 属するグループ
+	* @return コライダーが無く登録できなかった場合false
+	* @details CircleColliderとBoxColliderなど複数持つ場合はすべてを覆う範囲になります
+	*/
+	bool add(ECS::Entity* e, const ECS::Group group)
+	{
+		bool isFound = false;
+		Proxy p{ e, group, 0.f, 0.f, 0.f, 0.f };
+		auto merge = [&p, &isFound](const float minX, const float minY, const float maxX, const float maxY)
+		{
+			if (!isFound)
+			{
+				p.minX = minX; p.minY = minY; p.maxX = maxX; p.maxY = maxY;
+				isFound = true;
+				return;
+			}
+			if (minX < p.minX) { p.minX = minX; }
+			if (minY < p.minY) { p.minY = minY; }
+			if (maxX > p.maxX) { p.maxX = maxX; }
+			if (maxY > p.maxY) { p.maxY = maxY; }
+		};
+		if (e->hasComponent<ECS::CircleCollider>())
+		{
+			const auto& c = e->getComponent<ECS::CircleCollider>();
+			const float r = c.radius();
+			merge(c.x() - r, c.y() - r, c.x() + r, c.y() + r);
+			//軌跡全体を覆う
+			merge(c.prevX() - r, c.prevY() - r, c.prevX() + r, c.prevY() + r);
+		}
+		if (e->hasComponent<ECS::BoxCollider>())
+		{
+			const auto& b = e->getComponent<ECS::BoxCollider>();
+			merge(b.x(), b.y(), b.x() + b.w(), b.y() + b.h());
+		}
+		if (e->hasComponent<ECS::MaskCollider>())
+		{
+			const auto& m = e->getComponent<ECS::MaskCollider>();
+			merge(m.x(), m.y(), m.x() + m.w(), m.y() + m.h());
+		}
+		if (e->hasComponent<ECS::OBBCollider>())
+		{
+			const auto& o = e->getComponent<ECS::OBBCollider>();
+			merge(o.x(), o.y(), o.x() + o.w(), o.y() + o.h());
+		}
+		if (e->hasComponent<ECS::CapsuleCollider>())
+		{
+			const auto& c = e->getComponent<ECS::CapsuleCollider>();
+			const Vec2 min = c.boundsMin();
+			const Vec2 max = c.boundsMax();
+			merge(min.x, min.y, max.x, max.y);
+		}
+		if (e->hasComponent<ECS::CompoundCollider>())
+		{
+			//部位がいくつあってもバウンディング円を囲む範囲1つだけを登録する
+			const auto& c = e->getComponent<ECS::CompoundCollider>();
+			const Vec2& center = c.boundCenter();
+			const float r = c.boundRadius();
+			merge(center.x - r, center.y - r, center.x + r, center.y + r);
+		}
+		if (isFound)
+		{
+			proxies_.emplace_back(p);
+		}
+		return isFound;
+	}
+
+	/**
+	* @brief 範囲を直接指定して登録します
+	* @param e Entity
+	* @param group 属するグループ
+	* @param min 範囲の左上
+	* @param max 範囲の右下
+	*/
+	void addBounds(ECS::Entity* e, const ECS::Group group, const Vec2& min, const Vec2& max)
+	{
+		proxies_.emplace_back(Proxy{ e, group, min.x, min.y, max.x, max.y });
+	}
+
+	//!登録した範囲からグリッドを作ります。add()の後、findPairs()の前に呼んでください
+	void build()
+	{
+		const size_t cellNum = cellStart_.size() - 1;
+		std::fill(cellStart_.begin(), cellStart_.end(), 0u);
+		//セルごとの数を数えて先頭位置を決める
+		for (const auto& p : proxies_)
+		{
+			for (int y = cellY(p.minY); y <= cellY(p.maxY); ++y)
+			{
+				for (int x = cellX(p.minX); x <= cellX(p.maxX); ++x)
+				{
+					++cellStart_[size_t(y) * size_t(cols_) + size_t(x) + 1];
+				}
+			}
+		}
+		for (size_t i = 0; i < cellNum; ++i)
+		{
+			cellStart_[i + 1] += cellStart_[i];
+		}
+		cellItems_.resize(cellStart_[cellNum]);
+		boundsMinX_ = 0.f;
+		boundsMinY_ = 0.f;
+		boundsMaxX_ = float(cols_) * cellSize_;
+		boundsMaxY_ = float(rows_) * cellSize_;
+		for (const auto& p : proxies_)
+		{
+			boundsMinX_ = std::min(boundsMinX_, p.minX);
+			boundsMinY_ = std::min(boundsMinY_, p.minY);
+			boundsMaxX_ = std::max(boundsMaxX_, p.maxX);
+			boundsMaxY_ = std::max(boundsMaxY_, p.maxY);
+		}
+		cellCursor_.assign(cellStart_.begin(), cellStart_.end() - 1);
+		//登録順を保ったまま詰める
+		for (uint32_t i = 0; i < uint32_t(proxies_.size()); ++i)
+		{
+			const auto& p = proxies_[i];
+			for (int y = cellY(p.minY); y <= cellY(p.maxY); ++y)
+			{
+				for (int x = cellX(p.minX); x <= cellX(p.maxX); ++x)
+				{
+					cellItems_[cellCursor_[size_t(y) * size_t(cols_) + size_t(x)]++] = i;
+				}
+			}
+		}
+	}
+
+	/**
+	* @brief 指定したグループのEntityを登録し直してグリッドを作ります
+	* @param manager EntityManager
+	* @param groups 登録するグループ
+	*/
+	void build(ECS::EntityManager& manager, std::initializer_list<ECS::Group> groups)
+	{
+		clear();
+		for (const auto& group : groups)
+		{
+			for (auto* e : manager.getEntitiesByGroup(group))
+			{
+				add(e, group);
+			}
+		}
+		build();
+	}
+
+	/**
+	* @brief 範囲が重なっているペアを返します
+	* @param a グループ1
+	* @param b グループ2。グループ1と同じ場合はグループ内のペアになります
+	* @param pairs 結果を格納するvector。中身は消されます
+	* @details 結果の順番は常に同じです。Pair::aがグループ1、Pair::bがグループ2のEntityです
+	*/
+	void findPairs(const ECS::Group a, const ECS::Group b, std::vector<Pair>& pairs) const
+	{
+		pairs.clear();
+		findPairsInCells(a, b, 0, cols_ * rows_, pairs);
+	}
+
+	/**
+	* @brief 範囲が重なっているペアをスレッドプールで並列に求めて返します
+	* @param a グループ1
+	* @param b グループ2。グループ1と同じ場合はグループ内のペアになります
+	* @param pairs 結果を格納するvector。中身は消されます
+	* @param threadNum 使うスレッドの数。0ならThreadPoolのスレッド数になります
+	* @details セルを連続した範囲に分け、範囲ごとに別々のvectorへ書き込んでから範囲の順に結合します。
+	* そのため結果の順番はfindPairs()と完全に同じです。
+	* 範囲はセルに入っている数の2乗がおおよそ均等になるように分けます
+	*/
+	void findPairsParallel(const ECS::Group a, const ECS::Group b, std::vector<Pair>& pairs, const size_t threadNum = 0)
+	{
+		pairs.clear();
+		const int cellNum = cols_ * rows_;
+		const size_t useThreadNum = threadNum == 0 ? ThreadPool::Get().size() : threadNum;
+		const int chunkNum = std::max(1, std::min(int(useThreadNum), cellNum));
+		cellCost_.resize(size_t(cellNum) + 1);
+		cellCost_[0] = 0;
+		for (int cell = 0; cell < cellNum; ++cell)
+		{
+			const uint64_t n = cellStart_[cell + 1] - cellStart_[cell];
+			cellCost_[cell + 1] = cellCost_[cell] + n * n;
+		}
+		const uint64_t total = cellCost_[cellNum];
+		chunkStart_.resize(size_t(chunkNum) + 1);
+		for (int i = 0; i <= chunkNum; ++i)
+		{
+			const uint64_t target = total * uint64_t(i) / uint64_t(chunkNum);
+			chunkStart_[i] = int(std::lower_bound(cellCost_.begin(), cellCost_.end(), target) - cellCost_.begin());
+		}
+		chunkStart_[0] = 0;
+		chunkStart_[chunkNum] = cellNum;
+		if (chunkPairs_.size() < size_t(chunkNum))
+		{
+			chunkPairs_.resize(size_t(chunkNum));
+		}
+		ThreadPool::Get().parallelFor(size_t(chunkNum), size_t(chunkNum), [this, a, b](const size_t begin, const size_t end, const size_t)
+		{
+			for (size_t chunk = begin; chunk < end; ++chunk)
+			{
+				auto& buffer = chunkPairs_[chunk];
+				buffer.clear();
+				findPairsInCells(a, b, chunkStart_[chunk], chunkStart_[chunk + 1], buffer);
+			}
+		});
+		size_t pairNum = 0;
+		for (int i = 0; i < chunkNum; ++i)
+		{
+			pairNum += chunkPairs_[i].size();
+		}
+		pairs.reserve(pairNum);
+		for (int i = 0; i < chunkNum; ++i)
+		{
+			pairs.insert(pairs.end(), chunkPairs_[i].begin(), chunkPairs_[i].end());
+		}
+	}
+
+	/**
+	* @brief 矩形の範囲と重なっているEntityを返します
+	* @param min 範囲の左上
+	* @param max 範囲の右下
+	* @param group 対象のグループ
+	* @param entities 結果を格納するvector。中身は消されます
+	* @details 同じEntityは1度しか返りません。グリッドはbuild()した時点の範囲で判定されます
+	*/
+	void queryBox(const Vec2& min, const Vec2& max, const ECS::Group group, std::vector<ECS::Entity*>& entities) const
+	{
+#ifdef DEBUG_DRAW_ENABLE
+		DebugDraw::Get().box(DebugDraw::Category::QUERY, min.x, min.y, max.x, max.y, GetColor(255, 255, 0));
+#endif
+		entities.clear();
+		forEachInBox(Proxy{ nullptr, group, min.x, min.y, max.x, max.y }, [&entities](const Proxy& p)
+		{
+			entities.emplace_back(p.entity);
+		});
+	}
+
+	/**
+	* @brief 矩形の範囲と重なっているEntityを呼び出し側のバッファに書き込みます
+	* @param min 範囲の左上
+	* @param max 範囲の右下
+	* @param group 対象のグループ
+	* @param out 結果を書き込むバッファ
+	* @param capacity バッファの大きさ
+	* @return 見つかった数。capacityより大きい場合、書き込まれるのは先頭のcapacity個だけです
+	* @details メモリの確保は行いません。結果の順番は常に同じです
+	*/
+	size_t queryBox(const Vec2& min, const Vec2& max, const ECS::Group group, ECS::Entity** out, const size_t capacity) const
+	{
+#ifdef DEBUG_DRAW_ENABLE
+		DebugDraw::Get().box(DebugDraw::Category::QUERY, min.x, min.y, max.x, max.y, GetColor(255, 255, 0));
+#endif
+		size_t num = 0;
+		forEachInBox(Proxy{ nullptr, group, min.x, min.y, max.x, max.y }, [out, capacity, &num](const Proxy& p)
+		{
+			if (num < capacity)
+			{
+				out[num] = p.entity;
+			}
+			++num;
+		});
+		return num;
+	}
+
+	/**
+	* @brief 円の範囲と重なっているEntityを呼び出し側のバッファに書き込みます
+	* @param pos 円の中心
+	* @param radius 円の半径
+	* @param group 対象のグループ
+	* @param out 結果を書き込むバッファ
+	* @param capacity バッファの大きさ
+	* @return 見つかった数。capacityより大きい場合、書き込まれるのは先頭のcapacity個だけです
+	* @details 登録されている範囲(矩形)と円で判定します。メモリの確保は行いません。
+	* 正確な形状での判定が必要な場合は、結果に対してCollisionのメソッドを使ってください
+	*/
+	size_t queryCircle(const Vec2& pos, const float radius, const ECS::Group group, ECS::Entity** out, const size_t capacity) const
+	{
+#ifdef DEBUG_DRAW_ENABLE
+		DebugDraw::Get().circle(DebugDraw::Category::QUERY, pos.x, pos.y, radius, GetColor(255, 255, 0));
+#endif
+		size_t num = 0;
+		const float radiusSq = radius * radius;
+		forEachInBox(Proxy{ nullptr, group, pos.x - radius, pos.y - radius, pos.x + radius, pos.y + radius },
+			[&pos, radiusSq, out, capacity, &num](const Proxy& p)
+		{
+			if (DistanceSq(p, pos) > radiusSq)
+			{
+				return;
+			}
+			if (num < capacity)
+			{
+				out[num] = p.entity;
+			}
+			++num;
+		});
+		return num;
+	}
+
+	//!nearest()で一度に求められる最大の数です
+	static constexpr size_t NEAREST_MAX = 32;
+
+	/**
+	* @brief 指定した座標に近い順にEntityを呼び出し側のバッファに書き込みます
+	* @param pos 基準の座標
+	* @param group 対象のグループ
+	* @param k 求める数。NEAREST_MAXより大きい場合はNEAREST_MAXになります
+	* @param out 結果を書き込むバッファ。k個以上必要です
+	* @param maxDistance これより遠いEntityは対象外になります
+	* @return 書き込んだ数
+	* @details 距離は登録されている範囲(矩形)までの距離です。距離が同じ場合は登録順になります。
+	* 基準の座標のセルから外側へ1周ずつ調べ、それより外側にk個より近いものが無くなった時点で終了します。メモリの確保は行いません
+	*/
+	size_t nearest(const Vec2& pos, const ECS::Group group, size_t k, ECS::Entity** out, const float maxDistance = FLT_MAX) const
+	{
+		if (k > NEAREST_MAX)
+		{
+			k = NEAREST_MAX;
+		}
+		if (k == 0)
+		{
+			return 0;
+		}
+		float distance[NEAREST_MAX];
+		uint32_t order[NEAREST_MAX];
+		size_t num = 0;
+		const float maxDistanceSq = maxDistance < FLT_MAX ? maxDistance * maxDistance : FLT_MAX;
+		auto visit = [&](const uint32_t index)
+		{
+			const auto& p = proxies_[index];
+			if (p.group != group)
+			{
+				return;
+			}
+			const float d = DistanceSq(p, pos);
+			if (d > maxDistanceSq)
+			{
+				return;
+			}
+			//複数のセルに入っているものは1度だけ数える
+			for (size_t i = 0; i < num; ++i)
+			{
+				if (out[i] == p.entity)
+				{
+					return;
+				}
+			}
+			//距離、登録順で挿入する位置を探す
+			size_t at = num;
+			while (at > 0 && (distance[at - 1] > d || (distance[at - 1] == d && order[at - 1] > index)))
+			{
+				--at;
+			}
+			if (at >= k)
+			{
+				return;
+			}
+			const size_t last = num < k ? num : k - 1;
+			for (size_t i = last; i > at; --i)
+			{
+				distance[i] = distance[i - 1];
+				order[i] = order[i - 1];
+				out[i] = out[i - 1];
+			}
+			distance[at] = d;
+			order[at] = index;
+			out[at] = p.entity;
+			if (num < k)
+			{
+				++num;
+			}
+		};
+		auto visitCell = [&](const int x, const int y)
+		{
+			const int cell = y * cols_ + x;
+			for (uint32_t i = cellStart_[cell]; i < cellStart_[cell + 1]; ++i)
+			{
+				visit(cellItems_[i]);
+			}
+		};
+		const int cx = cellX(pos.x);
+		const int cy = cellY(pos.y);
+		const int ringMax = std::max(std::max(cx, cols_ - 1 - cx), std::max(cy, rows_ - 1 - cy));
+		for (int ring = 0; ring <= ringMax; ++ring)
+		{
+			//このリング以降のセルまでの距離は(ring - 1) * cellSize_以上になる
+			if (num == k && ring > 0)
+			{
+				const float bound = float(ring - 1) * cellSize_;
+				if (bound * bound > distance[k - 1])
+				{
+					break;
+				}
+			}
+			if (ring > 0)
+			{
+				const float bound = float(ring - 1) * cellSize_;
+				if (bound * bound > maxDistanceSq)
+				{
+					break;
+				}
+			}
+			const int x0 = cx - ring, x1 = cx + ring;
+			const int y0 = cy - ring, y1 = cy + ring;
+			for (int x = std::max(x0, 0); x <= std::min(x1, cols_ - 1); ++x)
+			{
+				if (y0 >= 0) { visitCell(x, y0); }
+				if (y1 < rows_ && ring > 0) { visitCell(x, y1); }
+			}
+			for (int y = std::max(y0 + 1, 0); y <= std::min(y1 - 1, rows_ - 1); ++y)
+			{
+				if (x0 >= 0) { visitCell(x0, y); }
+				if (x1 < cols_) { visitCell(x1, y); }
+			}
+		}
+		return num;
+	}
+
+	//!グループからレイキャストで使うマスクを作ります
+	[[nodiscard]] static constexpr uint32_t GroupMask(const ECS::Group group) noexcept
+	{
+		return uint32_t(1) << group;
+	}
+
+	/**
+	* @brief 半直線と最初に当たったEntityを返します
+	* @param origin 始点
+	* @param dir 向き。正規化されていなくても構いません
+	* @param maxDistance 判定する最大の距離
+	* @param groupMask 対象のグループのマスク。GroupMask()を論理和で組み合わせて作ります
+	* @param hit 当たった結果が返ります
+	* @return 当たった場合true
+	* @details 始点から近いセルから順に調べ、それより先に近いものが無くなった時点で終了します。
+	* 距離が同じ場合は登録順で先のものになります。メモリの確保は行いません
+	*/
+	bool raycast(const Vec2& origin, const Vec2& dir, const float maxDistance, const uint32_t groupMask, RayHit& hit) const
+	{
+		const float length = dir.length();
+		if (length == 0.f || maxDistance < 0.f)
+		{
+			return false;
+		}
+		const Vec2 unitDir(dir.x / length, dir.y / length);
+		float best = maxDistance;
+		uint32_t bestIndex = UINT32_MAX;
+		traverseRay(origin, unitDir, maxDistance, [&](const uint32_t index)
+		{
+			const auto& p = proxies_[index];
+			float distance = 0.f;
+			if (((groupMask >> p.group) & 1u) &&
+				RayTest(p, origin, unitDir, best, distance) &&
+				(distance < best || (distance == best && index < bestIndex)))
+			{
+				best = distance;
+				bestIndex = index;
+			}
+			return bestIndex == UINT32_MAX ? FLT_MAX : best;
+		});
+		if (bestIndex == UINT32_MAX)
+		{
+			return false;
+		}
+		hit.entity = proxies_[bestIndex].entity;
+		hit.distance = best;
+		hit.point = Vec2(origin.x + unitDir.x * best, origin.y + unitDir.y * best);
+		return true;
+	}
+
+	/**
+	* @brief 半直線と当たったEntityを近い順に呼び出し側のバッファに書き込みます
+	* @param origin 始点
+	* @param dir 向き。正規化されていなくても構いません
+	* @param maxDistance 判定する最大の距離
+	* @param groupMask 対象のグループのマスク
+	* @param out 結果を書き込むバッファ
+	* @param capacity バッファの大きさ。近い方からこの数だけ求めます
+	* @return 書き込んだ数
+	* @details 貫通する弾やレーザーに使います。メモリの確保は行いません
+	*/
+	size_t raycastAll(const Vec2& origin, const Vec2& dir, const float maxDistance, const uint32_t groupMask,
+		RayHit* out, const size_t capacity) const
+	{
+		const float length = dir.length();
+		if (length == 0.f || maxDistance < 0.f || capacity == 0)
+		{
+			return 0;
+		}
+		const Vec2 unitDir(dir.x / length, dir.y / length);
+		size_t num = 0;
+		traverseRay(origin, unitDir, maxDistance, [&](const uint32_t index)
+		{
+			const auto& p = proxies_[index];
+			const float limit = num == capacity ? out[num - 1].distance : maxDistance;
+			float distance = 0.f;
+			if (!((groupMask >> p.group) & 1u) || !RayTest(p, origin, unitDir, limit, distance))
+			{
+				return num == capacity ? out[num - 1].distance : FLT_MAX;
+			}
+			//複数のセルに入っているものは1度だけ数える
+			for (size_t i = 0; i < num; ++i)
+			{
+				if (out[i].entity == p.entity)
+				{
+					return num == capacity ? out[num - 1].distance : FLT_MAX;
+				}
+			}
+			size_t at = num;
+			while (at > 0 && out[at - 1].distance > distance)
+			{
+				--at;
+			}
+			if (at < capacity)
+			{
+				const size_t last = num < capacity ? num : capacity - 1;
+				for (size_t i = last; i > at; --i)
+				{
+					out[i] = out[i - 1];
+				}
+				out[at] = RayHit{ p.entity, distance, Vec2(origin.x + unitDir.x * distance, origin.y + unitDir.y * distance) };
+				if (num < capacity)
+				{
+					++num;
+				}
+			}
+			return num == capacity ? out[num - 1].distance : FLT_MAX;
+		});
+		return num;
+	}
+
+	/**
+	* @brief 複数の半直線それぞれについて最初に当たったEntityを求めます
+	* @param rays 半直線の配列
+	* @param rayNum 半直線の数
+	* @param groupMask 対象のグループのマスク
+	* @param hits 結果を書き込む配列。rayNum個必要です。当たらなかった場合entityがnullptrになります
+	* @param threadNum 使うスレッドの数。0ならThreadPoolのスレッド数になります
+	* @details 半直線ごとにスレッドプールで並列に処理します。結果はraycast()を順に呼んだ場合と同じです
+	*/
+	void raycastBatch(const Ray* rays, const size_t rayNum, const uint32_t groupMask, RayHit* hits, const size_t threadNum = 0) const
+	{
+		ThreadPool::Get().parallelFor(rayNum, threadNum, [this, rays, groupMask, hits](const size_t begin, const size_t end, const size_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				if (!raycast(rays[i].origin, rays[i].dir, rays[i].maxDistance, groupMask, hits[i]))
+				{
+					hits[i] = RayHit{ nullptr, 0.f, Vec2() };
+				}
+			}
+		});
+	}
+
+	/**
+	* @brief 登録されている円の現在の座標を前フレームの座標として記録します
+	* @details 連続的な当たり判定が終わった後、フレームの最後に呼んでください
+	*/
+	void commitPositions()
+	{
+		for (auto& p : proxies_)
+		{
+			if (p.entity != nullptr && p.entity->hasComponent<ECS::CircleCollider>())
+			{
+				p.entity->getComponent<ECS::CircleCollider>().commitPosition();
+			}
+		}
+	}
+
+	//!登録されている範囲を返します
+	[[nodiscard]] const std::vector<Proxy>& getProxies() const
+	{
+		return proxies_;
+	}
+	//!セルの大きさを返します
+	[[nodiscard]] float getCellSize() const
+	{
+		return cellSize_;
+	}
+};
@@ -0,0 +1,78 @@
+﻿/**
+* @file BroadPhaseBenchmark.hpp
+* @brief BroadPhaseの並列処理がスレッド数に対してどれだけ速くなるかを計測します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "BroadPhase.hpp"
+#include "../Utility/Utility.hpp"
+#include <random>
+#include <chrono>
+#include <cassert>
+
+/**
+* @brief BroadPhaseの性能計測です
+* @details 結果はコンソールに出力されます。計測中にゲームは止まるのでデバッグ時に明示的に呼んでください
+*/
+class BroadPhaseBenchmark final
+{
+private:
+	BroadPhaseBenchmark() = delete;
+public:
+	/**
+	* @brief 1スレッドからThreadPoolのスレッド数まで、findPairsParallelにかかる時間を計測します
+	* @param colliderNum 円のコライダーの数
+	* @param loopNum 1つのスレッド数あたりの計測回数
+	* @param cellSize BroadPhaseのセルの大きさ
+	* @details 画面内に半径2から8の円をランダムに配置し、グループ内のペアを求めます。
+	* すべてのスレッド数でfindPairs()と結果が一致するかも確認します
+	*/
+	static void Run(const int colliderNum = 20000, const int loopNum = 30, const float cellSize = 16.f)
+	{
+		constexpr ECS::Group group = 0;
+		ECS::EntityManager entityManager;
+		std::mt19937 mt(2026);
+		std::uniform_real_distribution<float> rangeX(0.f, float(System::SCREEN_WIDIH));
+		std::uniform_real_distribution<float> rangeY(0.f, float(System::SCREEN_HEIGHT));
+		std::uniform_real_distribution<float> rangeR(2.f, 8.f);
+		for (int i = 0; i < colliderNum; ++i)
+		{
+			auto& e = entityManager.addEntity(group);
+			e.addComponent<ECS::Position>(rangeX(mt), rangeY(mt));
+			e.addComponent<ECS::CircleCollider>(rangeR(mt));
+		}
+		BroadPhase broadPhase(cellSize);
+		broadPhase.build(entityManager, { group });
+
+		std::vector<BroadPhase::Pair> expected;
+		std::vector<BroadPhase::Pair> pairs;
+		broadPhase.findPairs(group, group, expected);
+		DOUT << "BroadPhase benchmark : " << colliderNum << " colliders, " << expected.size() << " pairs" << std::endl;
+
+		double baseTime = 0.0;
+		for (size_t threadNum = 1; threadNum <= ThreadPool::Get().size(); ++threadNum)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < loopNum; ++i)
+			{
+				broadPhase.findPairsParallel(group, group, pairs, threadNum);
+			}
+			const auto end = std::chrono::steady_clock::now();
+			const double ms = std::chrono::duration<double, std::milli>(end - start).count() / double(loopNum);
+			if (threadNum == 1)
+			{
+				baseTime = ms;
+			}
+			bool isSame = pairs.size() == expected.size();
+			for (size_t i = 0; isSame && i < pairs.size(); ++i)
+			{
+				isSame = pairs[i].a == expected[i].a && pairs[i].b == expected[i].b;
+			}
+			assert(isSame && "findPairsParallel result is different from findPairs");
+			DOUT << "  threads " << threadNum << " : " << ms << " [milliseconds] x" << baseTime / ms
+				<< (isSame ? "" : " (mismatch)") << std::endl;
+		}
+		entityManager.removeAll();
+	}
+};
@@ -3,11 +3,24 @@
 * @brief Collisionの式をまとめたファイルです
 * @author tonarinohito
 * @date 2018/10/05
+* @par History
+- 2026/10/18 tonarinohito
+-# 移動する円の連続的な当たり判定(SweptCircleAndCircle,SweptCircleAndBox)追加
+-# ピクセル単位のマスク同士の当たり判定(MaskAndMask)追加
+-# CirecleAndLineで平方根を使わないようにした
+-# 半直線と円、矩形の当たり判定(RayAndCircle,RayAndBox)追加
+-# CircleAndPointが存在しないメソッドを呼んでいたのを修正
+-# 回転する矩形とカプセルの当たり判定(OBBAndOBB,OBBAndCircle,CapsuleAndCircle,CapsuleAndCapsule,CapsuleAndOBB)追加
+-# 半直線と回転する矩形、カプセルの当たり判定(RayAndOBB,RayAndCapsule)追加
 */
 #pragma once
 #include "../ECS/ECS.hpp"
 #include "../Components/BasicComponents.hpp"
 #include "../Components/Collider.hpp"
+#include "CollisionMask.hpp"
+#include <cmath>
+#include <utility>
+#include <algorithm>
 
 /**
 * @brief Collisionの式をまとめたクラスです。
@@ -151,6 +164,639 @@ public:
 
 	}
 
+	/**
+	* @brief 移動する円と円の連続的なあたり判定
+	* @param e1 Entity
+	* @param e2 Entity
+	* @param toi 衝突した時刻(0~1)が返ります。前フレームの座標が0、現在の座標が1です
+	* @return bool
+	* @details テンプレート引数にはICircleColliderを継承したコンポーネントを指定してください
+	* 前フレームの座標から現在の座標までの軌跡で判定するため、半径より速い弾でもすり抜けません
+	*/
+	template<class T = ECS::CircleCollider, class T2 = ECS::CircleCollider>
+	[[nodiscard]] inline static bool SweptCircleAndCircle(const ECS::Entity* e1, const ECS::Entity* e2, float& toi)
+	{
+		if (!e1->hasComponent<T>() || !e2->hasComponent<T2>())
+		{
+			return false;
+		}
+		const auto& c1 = e1->getComponent<T>();
+		const auto& c2 = e2->getComponent<T2>();
+		//相手の移動を差し引いた相対的な移動で判定する
+		const Vec2 start(c1.prevX() - c2.prevX(), c1.prevY() - c2.prevY());
+		const Vec2 end(c1.x() - c2.x(), c1.y() - c2.y());
+		return SweptCircleAndCircle(start, end, c1.radius(), Vec2(0.f, 0.f), c2.radius(), toi);
+	}
+
+	/**
+	* @brief 移動する円と静止した円の連続的なあたり判定
+	* @param start 移動する円の前フレームの座標
+	* @param end 移動する円の現在の座標
+	* @param radius 移動する円の半径
+	* @param circlePos 静止した円の座標
+	* @param circleRadius 静止した円の半径
+	* @param toi 衝突した時刻(0~1)が返ります
+	* @return bool
+	* @details 半径の和を持つ円と線分の交差を解くので、移動量に関係なく1回の計算で済みます
+	*/
+	[[nodiscard]] inline static bool SweptCircleAndCircle(const Vec2& start, const Vec2& end, const float radius,
+		const Vec2& circlePos, const float circleRadius, float& toi) noexcept
+	{
+		const float r = radius + circleRadius;
+		const float fx = start.x - circlePos.x;
+		const float fy = start.y - circlePos.y;
+		const float c = fx * fx + fy * fy - r * r;
+		//開始時点ですでに重なっている
+		if (c <= 0.f)
+		{
+			toi = 0.f;
+			return true;
+		}
+		const float dx = end.x - start.x;
+		const float dy = end.y - start.y;
+		const float a = dx * dx + dy * dy;
+		const float b = fx * dx + fy * dy;
+		//移動していないか遠ざかっている
+		if (a == 0.f || b >= 0.f)
+		{
+			return false;
+		}
+		const float disc = b * b - a * c;
+		if (disc < 0.f)
+		{
+			return false;
+		}
+		const float t = (-b - sqrtf(disc)) / a;
+		if (t > 1.f)
+		{
+			return false;
+		}
+		toi = t;
+		return true;
+	}
+
+	/**
+	* @brief 移動する円と矩形の連続的なあたり判定
+	* @param e1 Entity
+	* @param e2 Entity
+	* @param toi 衝突した時刻(0~1)が返ります。前フレームの座標が0、現在の座標が1です
+	* @details テンプレート第一引数にはICircleColliderを、第二引数にはIBoxCollider継承したコンポーネントを指定してください
+	* 矩形は現在の座標で静止しているものとして扱います
+	* @return bool
+	*/
+	template<class T1 = ECS::CircleCollider, class T2 = ECS::BoxCollider>
+	[[nodiscard]] inline static bool SweptCircleAndBox(const ECS::Entity* e1, const ECS::Entity* e2, float& toi)
+	{
+		if (!e1->hasComponent<T1>() || !e2->hasComponent<T2>())
+		{
+			return false;
+		}
+		const auto& c = e1->getComponent<T1>();
+		const auto& b = e2->getComponent<T2>();
+		return SweptCircleAndBox(Vec2(c.prevX(), c.prevY()), Vec2(c.x(), c.y()), c.radius(), Vec2(b.x(), b.y()), Vec2(b.w(), b.h()), toi);
+	}
+
+	/**
+	* @brief 移動する円と矩形の連続的なあたり判定
+	* @param start 円の前フレームの座標
+	* @param end 円の現在の座標
+	* @param radius 円の半径
+	* @param boxPos 矩形の座標
+	* @param boxSize 矩形のサイズ
+	* @param toi 衝突した時刻(0~1)が返ります
+	* @return bool
+	* @details CircleAndBoxと同じく円の外接矩形で判定します。半径分広げた矩形と線分のスラブ判定です
+	*/
+	[[nodiscard]] inline static bool SweptCircleAndBox(const Vec2& start, const Vec2& end, const float radius,
+		const Vec2& boxPos, const Vec2& boxSize, float& toi) noexcept
+	{
+		const float minX = boxPos.x - radius;
+		const float minY = boxPos.y - radius;
+		const float maxX = boxPos.x + boxSize.x + radius;
+		const float maxY = boxPos.y + boxSize.y + radius;
+		const float dx = end.x - start.x;
+		const float dy = end.y - start.y;
+		float enter = 0.f;
+		float exit = 1.f;
+		//CircleAndBoxと合わせて境界上は当たりにしない
+		auto slab = [&enter, &exit](const float p, const float d, const float lo, const float hi)
+		{
+			if (d == 0.f)
+			{
+				return lo < p && p < hi;
+			}
+			float t1 = (lo - p) / d;
+			float t2 = (hi - p) / d;
+			if (t1 > t2) { std::swap(t1, t2); }
+			if (t1 > enter) { enter = t1; }
+			if (t2 < exit) { exit = t2; }
+			return enter < exit;
+		};
+		if (!slab(start.x, dx, minX, maxX) || !slab(start.y, dy, minY, maxY))
+		{
+			return false;
+		}
+		toi = enter;
+		return true;
+	}
+
+	/**
+	* @brief マスクとマスクのピクセル単位のあたり判定
+	* @param e1 Entity
+	* @param e2 Entity
+	* @return bool
+	* @details テンプレート引数にはMaskColliderを指定してください
+	* 外接矩形が重なっている場合のみピクセルの判定を行います。BroadPhaseで絞り込んだペアに使ってください
+	*/
+	template<class T = ECS::MaskCollider, class T2 = ECS::MaskCollider>
+	[[nodiscard]] inline static bool MaskAndMask(const ECS::Entity* e1, const ECS::Entity* e2)
+	{
+		if (!e1->hasComponent<T>() || !e2->hasComponent<T2>())
+		{
+			return false;
+		}
+		const auto& m1 = e1->getComponent<T>();
+		const auto& m2 = e2->getComponent<T2>();
+		const int index1 = m1.rotationIndex();
+		const int index2 = m2.rotationIndex();
+		return MaskAndMask(m1.getMask(index1), m1.maskPosition(index1), m2.getMask(index2), m2.maskPosition(index2));
+	}
+
+	/**
+	* @brief マスクとマスクのピクセル単位のあたり判定
+	* @param m1 マスク1
+	* @param pos1 マスク1の左上の座標
+	* @param m2 マスク2
+	* @param pos2 マスク2の左上の座標
+	* @return bool
+	* @details 重なっている行ごとに、マスク1の64ピクセル分のワードとシフトしたマスク2のワードの論理積を取ります
+	*/
+	[[nodiscard]] inline static bool MaskAndMask(const CollisionMask& m1, const Vec2_i& pos1, const CollisionMask& m2, const Vec2_i& pos2) noexcept
+	{
+		//外接矩形の判定
+		const int top = pos1.y > pos2.y ? pos1.y : pos2.y;
+		const int bottom = pos1.y + m1.h() < pos2.y + m2.h() ? pos1.y + m1.h() : pos2.y + m2.h();
+		const int left = pos1.x > pos2.x ? pos1.x : pos2.x;
+		const int right = pos1.x + m1.w() < pos2.x + m2.w() ? pos1.x + m1.w() : pos2.x + m2.w();
+		if (top >= bottom || left >= right)
+		{
+			return false;
+		}
+		//重なっている範囲のマスク1のワードだけを調べる
+		const int firstWord = (left - pos1.x) >> 6;
+		const int lastWord = (right - pos1.x - 1) >> 6;
+		const int dx = pos1.x - pos2.x;
+		for (int y = top; y < bottom; ++y)
+		{
+			const uint64_t* row = m1.row(y - pos1.y);
+			const int y2 = y - pos2.y;
+			for (int word = firstWord; word <= lastWord; ++word)
+			{
+				if (row[word] & m2.fetch(y2, word * 64 + dx))
+				{
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+
+	/**
+	* @brief 回転する矩形同士の当たり判定
+	* @param e1 Entity
+	* @param e2 Entity
+	* @return bool
+	* @details テンプレート引数にはOBBColliderを指定してください
+	*/
+	template<class T1 = ECS::OBBCollider, class T2 = ECS::OBBCollider>
+	[[nodiscard]] inline static bool OBBAndOBB(const ECS::Entity* e1, const ECS::Entity* e2)
+	{
+		if (!e1->hasComponent<T1>() || !e2->hasComponent<T2>())
+		{
+			return false;
+		}
+		return OBBAndOBB(e1->getComponent<T1>().shape(), e2->getComponent<T2>().shape());
+	}
+
+	/**
+	* @brief 回転する矩形同士の当たり判定
+	* @param b1 矩形1
+	* @param b2 矩形2
+	* @return bool
+	* @details 分離軸定理で判定します。両方とも回転が90度の倍数なら、BoxAndBoxと同じく軸に平行な矩形として判定します。
+	* BoxAndBoxと同じく辺が接しているだけの場合は当たりになりません
+	*/
+	[[nodiscard]] inline static bool OBBAndOBB(const ECS::OBBShape& b1, const ECS::OBBShape& b2) noexcept
+	{
+		const float dx = b2.center.x - b1.center.x;
+		const float dy = b2.center.y - b1.center.y;
+		if (b1.isAxisAligned && b2.isAxisAligned)
+		{
+			//90度、270度なら幅と高さが入れ替わる
+			const float e1x = b1.axis.x != 0.f ? b1.half.x : b1.half.y;
+			const float e1y = b1.axis.x != 0.f ? b1.half.y : b1.half.x;
+			const float e2x = b2.axis.x != 0.f ? b2.half.x : b2.half.y;
+			const float e2y = b2.axis.x != 0.f ? b2.half.y : b2.half.x;
+			return fabsf(dx) < e1x + e2x && fabsf(dy) < e1y + e2y;
+		}
+		const Vec2 axes[4] =
+		{
+			b1.axis, Vec2(-b1.axis.y, b1.axis.x),
+			b2.axis, Vec2(-b2.axis.y, b2.axis.x)
+		};
+		for (const auto& axis : axes)
+		{
+			const float r1 = b1.half.x * fabsf(Vec2::Dot(b1.axis, axis)) + b1.half.y * fabsf(Vec2::Cross(b1.axis, axis));
+			const float r2 = b2.half.x * fabsf(Vec2::Dot(b2.axis, axis)) + b2.half.y * fabsf(Vec2::Cross(b2.axis, axis));
+			if (fabsf(dx * axis.x + dy * axis.y) >= r1 + r2)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	* @brief 回転する矩形と円の当たり判定
+	* @param e1 Entity
+	* @param e2 Entity
+	* @return bool
+	* @details テンプレート第一引数にはOBBColliderを、第二引数にはICircleColliderを継承したコンポーネントを指定してください
+	*/
+	template<class T1 = ECS::OBBCollider, class T2 = ECS::CircleCollider>
+	[[nodiscard]] inline static bool OBBAndCircle(const ECS::Entity* e1, const ECS::Entity* e2)
+	{
+		if (!e1->hasComponent<T1>() || !e2->hasComponent<T2>())
+		{
+			return false;
+		}
+		const auto& c = e2->getComponent<T2>();
+		return OBBAndCircle(e1->getComponent<T1>().shape(), Vec2(c.x(), c.y()), c.radius());
+	}
+
+	/**
+	* @brief 回転する矩形と円の当たり判定
+	* @param box 矩形
+	* @param circlePos 円の座標
+	* @param circleRadius 円の半径
+	* @return bool
+	* @details 円の中心を矩形のローカル座標に直し、矩形上の最も近い点との距離で判定します
+	*/
+	[[nodiscard]] inline static bool OBBAndCircle(const ECS::OBBShape& box, const Vec2& circlePos, const float circleRadius) noexcept
+	{
+		const Vec2 d = circlePos - box.center;
+		float lx = Vec2::Dot(d, box.axis);
+		float ly = Vec2::Cross(box.axis, d);
+		lx = fabsf(lx) - box.half.x;
+		ly = fabsf(ly) - box.half.y;
+		if (lx < 0.f) { lx = 0.f; }
+		if (ly < 0.f) { ly = 0.f; }
+		return lx * lx + ly * ly <= circleRadius * circleRadius;
+	}
+
+	/**
+	* @brief 点と線分の最短距離の2乗を返します
+	* @param p 点
+	* @param a 線分の始点
+	* @param b 線分の終点
+	*/
+	[[nodiscard]] inline static float PointAndSegmentDistanceSq(const Vec2& p, const Vec2& a, const Vec2& b) noexcept
+	{
+		const Vec2 ab = b - a;
+		const Vec2 ap = p - a;
+		const float lengthSq = Vec2::Dot(ab, ab);
+		float t = lengthSq > 0.f ? Vec2::Dot(ap, ab) / lengthSq : 0.f;
+		if (t < 0.f) { t = 0.f; }
+		if (t > 1.f) { t = 1.f; }
+		const float x = ap.x - ab.x * t;
+		const float y = ap.y - ab.y * t;
+		return x * x + y * y;
+	}
+
+	/**
+	* @brief 線分と線分の最短距離の2乗を返します
+	* @details 交差している場合は0です
+	*/
+	[[nodiscard]] inline static float SegmentAndSegmentDistanceSq(const Vec2& p1, const Vec2& q1, const Vec2& p2, const Vec2& q2) noexcept
+	{
+		const Vec2 d1 = q1 - p1;
+		const Vec2 d2 = q2 - p2;
+		//端点同士が互いをまたいでいれば交差している
+		const float c1 = Vec2::Cross(d2, p1 - p2);
+		const float c2 = Vec2::Cross(d2, q1 - p2);
+		const float c3 = Vec2::Cross(d1, p2 - p1);
+		const float c4 = Vec2::Cross(d1, q2 - p1);
+		if (c1 * c2 < 0.f && c3 * c4 < 0.f)
+		{
+			return 0.f;
+		}
+		//交差していなければ、最短距離はどちらかの端点ともう一方の線分の間にある
+		float result = PointAndSegmentDistanceSq(p1, p2, q2);
+		const float d[3] =
+		{
+			PointAndSegmentDistanceSq(q1, p2, q2),
+			PointAndSegmentDistanceSq(p2, p1, q1),
+			PointAndSegmentDistanceSq(q2, p1, q1)
+		};
+		for (const float it : d)
+		{
+			if (it < result) { result = it; }
+		}
+		return result;
+	}
+
+	/**
+	* @brief カプセルと円の当たり判定
+	* @param e1 Entity
+	* @param e2 Entity
+	* @return bool
+	* @details テンプレート第一引数にはCapsuleColliderを、第二引数にはICircleColliderを継承したコンポーネントを指定してください
+	*/
+	template<class T1 = ECS::CapsuleCollider, class T2 = ECS::CircleCollider>
+	[[nodiscard]] inline static bool CapsuleAndCircle(const ECS::Entity* e1, const ECS::Entity* e2)
+	{
+		if (!e1->hasComponent<T1>() || !e2->hasComponent<T2>())
+		{
+			return false;
+		}
+		const auto& c = e2->getComponent<T2>();
+		return CapsuleAndCircle(e1->getComponent<T1>().shape(), Vec2(c.x(), c.y()), c.radius());
+	}
+
+	/**
+	* @brief カプセルと円の当たり判定
+	* @param capsule カプセル
+	* @param circlePos 円の座標
+	* @param circleRadius 円の半径
+	* @return bool
+	*/
+	[[nodiscard]] inline static bool CapsuleAndCircle(const ECS::CapsuleShape& capsule, const Vec2& circlePos, const float circleRadius) noexcept
+	{
+		const float r = capsule.radius + circleRadius;
+		return PointAndSegmentDistanceSq(circlePos, capsule.p1, capsule.p2) <= r * r;
+	}
+
+	/**
+	* @brief カプセル同士の当たり判定
+	* @param e1 Entity
+	* @param e2 Entity
+	* @return bool
+	* @details テンプレート引数にはCapsuleColliderを指定してください
+	*/
+	template<class T1 = ECS::CapsuleCollider, class T2 = ECS::CapsuleCollider>
+	[[nodiscard]] inline static bool CapsuleAndCapsule(const ECS::Entity* e1, const ECS::Entity* e2)
+	{
+		if (!e1->hasComponent<T1>() || !e2->hasComponent<T2>())
+		{
+			return false;
+		}
+		return CapsuleAndCapsule(e1->getComponent<T1>().shape(), e2->getComponent<T2>().shape());
+	}
+
+	/**
+	* @brief カプセル同士の当たり判定
+	* @param c1 カプセル1
+	* @param c2 カプセル2
+	* @return bool
+	*/
+	[[nodiscard]] inline static bool CapsuleAndCapsule(const ECS::CapsuleShape& c1, const ECS::CapsuleShape& c2) noexcept
+	{
+		const float r = c1.radius + c2.radius;
+		return SegmentAndSegmentDistanceSq(c1.p1, c1.p2, c2.p1, c2.p2) <= r * r;
+	}
+
+	/**
+	* @brief カプセルと回転する矩形の当たり判定
+	* @param e1 Entity
+	* @param e2 Entity
+	* @return bool
+	* @details テンプレート第一引数にはCapsuleColliderを、第二引数にはOBBColliderを指定してください
+	*/
+	template<class T1 = ECS::CapsuleCollider, class T2 = ECS::OBBCollider>
+	[[nodiscard]] inline static bool CapsuleAndOBB(const ECS::Entity* e1, const ECS::Entity* e2)
+	{
+		if (!e1->hasComponent<T1>() || !e2->hasComponent<T2>())
+		{
+			return false;
+		}
+		return CapsuleAndOBB(e1->getComponent<T1>().shape(), e2->getComponent<T2>().shape());
+	}
+
+	/**
+	* @brief カプセルと回転する矩形の当たり判定
+	* @param capsule カプセル
+	* @param box 矩形
+	* @return bool
+	* @details 線分を矩形のローカル座標に直し、線分と矩形の最短距離を半径と比べます
+	*/
+	[[nodiscard]] inline static bool CapsuleAndOBB(const ECS::CapsuleShape& capsule, const ECS::OBBShape& box) noexcept
+	{
+		auto toLocal = [&box](const Vec2& p)
+		{
+			const Vec2 d = p - box.center;
+			return Vec2(Vec2::Dot(d, box.axis), Vec2::Cross(box.axis, d));
+		};
+		const Vec2 a = toLocal(capsule.p1);
+		const Vec2 b = toLocal(capsule.p2);
+		const Vec2& h = box.half;
+		//線分が矩形と交差していれば距離は0
+		{
+			float enter = 0.f;
+			float exit = 1.f;
+			auto slab = [&enter, &exit](const float p, const float d, const float half)
+			{
+				if (d == 0.f)
+				{
+					return -half <= p && p <= half;
+				}
+				float t1 = (-half - p) / d;
+				float t2 = (half - p) / d;
+				if (t1 > t2) { std::swap(t1, t2); }
+				if (t1 > enter) { enter = t1; }
+				if (t2 < exit) { exit = t2; }
+				return enter <= exit;
+			};
+			if (slab(a.x, b.x - a.x, h.x) && slab(a.y, b.y - a.y, h.y))
+			{
+				return true;
+			}
+		}
+		//交差していなければ、最短距離は線分の端点か矩形の角のどちらかにある
+		auto pointAndBoxDistanceSq = [&h](const Vec2& p)
+		{
+			float x = fabsf(p.x) - h.x;
+			float y = fabsf(p.y) - h.y;
+			if (x < 0.f) { x = 0.f; }
+			if (y < 0.f) { y = 0.f; }
+			return x * x + y * y;
+		};
+		float distanceSq = pointAndBoxDistanceSq(a);
+		distanceSq = std::min(distanceSq, pointAndBoxDistanceSq(b));
+		const Vec2 corners[4] = { Vec2(-h.x, -h.y), Vec2(h.x, -h.y), Vec2(h.x, h.y), Vec2(-h.x, h.y) };
+		for (const auto& corner : corners)
+		{
+			distanceSq = std::min(distanceSq, PointAndSegmentDistanceSq(corner, a, b));
+		}
+		return distanceSq <= capsule.radius * capsule.radius;
+	}
+
+	/**
+	* @brief 半直線と円の当たり判定
+	* @param origin 始点
+	* @param dir 向き。正規化してください
+	* @param maxDistance 判定する最大の距離
+	* @param circlePos 円の座標
+	* @param circleRadius 円の半径
+	* @param distance 当たった場合、始点から当たった位置までの距離が返ります
+	* @return bool
+	* @details 始点が円の中にある場合は距離0で当たりになります
+	*/
+	[[nodiscard]] inline static bool RayAndCircle(const Vec2& origin, const Vec2& dir, const float maxDistance,
+		const Vec2& circlePos, const float circleRadius, float& distance) noexcept
+	{
+		const Vec2 m = origin - circlePos;
+		const float c = Vec2::Dot(m, m) - circleRadius * circleRadius;
+		if (c <= 0.f)
+		{
+			distance = 0.f;
+			return true;
+		}
+		const float b = Vec2::Dot(m, dir);
+		//円の外から遠ざかっている
+		if (b > 0.f)
+		{
+			return false;
+		}
+		const float discriminant = b * b - c;
+		if (discriminant < 0.f)
+		{
+			return false;
+		}
+		const float t = -b - sqrtf(discriminant);
+		if (t > maxDistance)
+		{
+			return false;
+		}
+		distance = t < 0.f ? 0.f : t;
+		return true;
+	}
+
+	/**
+	* @brief 半直線と矩形の当たり判定
+	* @param origin 始点
+	* @param dir 向き。正規化してください
+	* @param maxDistance 判定する最大の距離
+	* @param boxPos 矩形の左上の座標
+	* @param boxSize 矩形の大きさ
+	* @param distance 当たった場合、始点から当たった位置までの距離が返ります
+	* @return bool
+	* @details 始点が矩形の中にある場合は距離0で当たりになります。辺をかすめた場合も当たりになります
+	*/
+	[[nodiscard]] inline static bool RayAndBox(const Vec2& origin, const Vec2& dir, const float maxDistance,
+		const Vec2& boxPos, const Vec2& boxSize, float& distance) noexcept
+	{
+		float tMin = 0.f;
+		float tMax = maxDistance;
+		const float o[2] = { origin.x, origin.y };
+		const float d[2] = { dir.x, dir.y };
+		const float lo[2] = { boxPos.x, boxPos.y };
+		const float hi[2] = { boxPos.x + boxSize.x, boxPos.y + boxSize.y };
+		for (int i = 0; i < 2; ++i)
+		{
+			if (d[i] == 0.f)
+			{
+				if (o[i] < lo[i] || o[i] > hi[i])
+				{
+					return false;
+				}
+				continue;
+			}
+			const float inv = 1.f / d[i];
+			float t1 = (lo[i] - o[i]) * inv;
+			float t2 = (hi[i] - o[i]) * inv;
+			if (t1 > t2)
+			{
+				std::swap(t1, t2);
+			}
+			if (t1 > tMin) { tMin = t1; }
+			if (t2 < tMax) { tMax = t2; }
+			if (tMin > tMax)
+			{
+				return false;
+			}
+		}
+		distance = tMin;
+		return true;
+	}
+
+	/**
+	* @brief 半直線と回転する矩形の当たり判定
+	* @param origin 始点
+	* @param dir 向き。正規化してください
+	* @param maxDistance 判定する最大の距離
+	* @param obb 回転する矩形
+	* @param distance 当たった場合、始点から当たった位置までの距離が返ります
+	* @return bool
+	* @details 半直線を矩形のローカル座標に移してRayAndBoxで判定します
+	*/
+	[[nodiscard]] inline static bool RayAndOBB(const Vec2& origin, const Vec2& dir, const float maxDistance,
+		const ECS::OBBShape& obb, float& distance) noexcept
+	{
+		const Vec2 d = origin - obb.center;
+		const Vec2 localOrigin(d.x * obb.axis.x + d.y * obb.axis.y, -d.x * obb.axis.y + d.y * obb.axis.x);
+		const Vec2 localDir(dir.x * obb.axis.x + dir.y * obb.axis.y, -dir.x * obb.axis.y + dir.y * obb.axis.x);
+		return RayAndBox(localOrigin, localDir, maxDistance,
+			Vec2(-obb.half.x, -obb.half.y), Vec2(obb.half.x * 2.f, obb.half.y * 2.f), distance);
+	}
+
+	/**
+	* @brief 半直線とカプセルの当たり判定
+	* @param origin 始点
+	* @param dir 向き。正規化してください
+	* @param maxDistance 判定する最大の距離
+	* @param capsule カプセル
+	* @param distance 当たった場合、始点から当たった位置までの距離が返ります
+	* @return bool
+	* @details カプセルを両端の円と線分を太らせた矩形に分けて、最も近いものの距離を返します
+	*/
+	[[nodiscard]] inline static bool RayAndCapsule(const Vec2& origin, const Vec2& dir, const float maxDistance,
+		const ECS::CapsuleShape& capsule, float& distance) noexcept
+	{
+		bool isHit = false;
+		float best = maxDistance;
+		float t = 0.f;
+		if (RayAndCircle(origin, dir, best, capsule.p1, capsule.radius, t))
+		{
+			best = t;
+			isHit = true;
+		}
+		if (RayAndCircle(origin, dir, best, capsule.p2, capsule.radius, t))
+		{
+			best = t;
+			isHit = true;
+		}
+		const Vec2 seg = capsule.p2 - capsule.p1;
+		const float length = seg.length();
+		if (length > 0.f)
+		{
+			ECS::OBBShape body;
+			body.center = Vec2((capsule.p1.x + capsule.p2.x) * 0.5f, (capsule.p1.y + capsule.p2.y) * 0.5f);
+			body.half = Vec2(length * 0.5f, capsule.radius);
+			body.axis = Vec2(seg.x / length, seg.y / length);
+			body.isAxisAligned = false;
+			if (RayAndOBB(origin, dir, best, body, t))
+			{
+				best = t;
+				isHit = true;
+			}
+		}
+		if (isHit)
+		{
+			distance = best;
+		}
+		return isHit;
+	}
+
 	/**
 	* @brief 円と点の当たり判定
 	* @param e1 Entity
@@ -170,8 +816,8 @@ public:
 		const auto& point = e2->getComponent<T2>();
 
 		Vec2 buttonPos = Vec2(circle.x(), circle.y());
-		Vec2 distance = buttonPos - point.val();
-		if (distance.Length() <= circle.radius())
+		Vec2 distance = buttonPos - point.val;
+		if (distance.length() <= circle.radius())
 		{
 			return true;
 		}
@@ -311,17 +957,19 @@ public:
 		const Vec2 B = { l.p2.x - l.p1.x,l.p2.y - l.p1.y };		//線分の始点から線分の終点までのベクトルB
 		const Vec2 C = { c.x() - l.p2.x, c.y() - l.p2.y };		//線分の終点から円の中心点までのベクトルC
 
+		const float radiusSq = c.radius() * c.radius();
+		const float lengthSq = Vec2::Dot(B, B);
+		//長さ0の線分は点として扱う
+		if (lengthSq == 0.f)
+		{
+			return Vec2::Dot(A, A) <= radiusSq;
+		}
 		//円の中心が線分の中（端点の間）に入っている
 		if (Vec2::Dot(A, B) * Vec2::Dot(B, C) <= 0)
 		{
-			//線分のベクトル（ベクトルB）を単位ベクトルに変換
-			Vec2 temp = B.getNormalize();
-			//円の中心と線分の距離を外積を使って計算
-			float dist = Vec2::Cross(A, temp);
-			//外積がマイナス値だったら符号を変える
-			if (dist < 0) { dist *= -1; }
-			//半径との比較
-			if (dist <= c.radius())
+			//円の中心と線分の距離は 外積 / 線分の長さ なので、両辺を2乗して平方根を使わずに半径と比較する
+			const float cross = Vec2::Cross(A, B);
+			if (cross * cross <= radiusSq * lengthSq)
 			{
 				return true;
 			}
@@ -329,7 +977,7 @@ public:
 		else
 		{
 			//端点との距離をそれぞれ計算
-			if (A.length() <= c.radius() || C.length() <= c.radius())
+			if (Vec2::Dot(A, A) <= radiusSq || Vec2::Dot(C, C) <= radiusSq)
 			{
 				return true;
 			}
@@ -350,17 +998,19 @@ public:
 		const Vec2 B = { l.p2.x - l.p1.x,l.p2.y - l.p1.y };		//線分の始点から線分の終点までのベクトルB
 		const Vec2 C = { pos.x - l.p2.x, pos.y - l.p2.y };		//線分の終点から円の中心点までのベクトルC
 
+		const float radiusSq = r * r;
+		const float lengthSq = Vec2::Dot(B, B);
+		//長さ0の線分は点として扱う
+		if (lengthSq == 0.f)
+		{
+			return Vec2::Dot(A, A) <= radiusSq;
+		}
 		//円の中心が線分の中（端点の間）に入っている
 		if (Vec2::Dot(A, B) * Vec2::Dot(B, C) <= 0)
 		{
-			//線分のベクトル（ベクトルB）を単位ベクトルに変換
-			Vec2 temp = B.getNormalize();
-			//円の中心と線分の距離を外積を使って計算
-			float dist = Vec2::Cross(A, temp);
-			//外積がマイナス値だったら符号を変える
-			if (dist < 0) { dist *= -1; }
-			//半径との比較
-			if (dist <= r)
+			//円の中心と線分の距離は 外積 / 線分の長さ なので、両辺を2乗して平方根を使わずに半径と比較する
+			const float cross = Vec2::Cross(A, B);
+			if (cross * cross <= radiusSq * lengthSq)
 			{
 				return true;
 			}
@@ -368,7 +1018,7 @@ public:
 		else
 		{
 			//端点との距離をそれぞれ計算
-			if (A.length() <= r || C.length() <= r)
+			if (Vec2::Dot(A, A) <= radiusSq || Vec2::Dot(C, C) <= radiusSq)
 			{
 				return true;
 			}
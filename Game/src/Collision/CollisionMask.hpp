@@ -0,0 +1,167 @@
+﻿/**
+* @file CollisionMask.hpp
+* @brief 画像のアルファ値から作るピクセル単位の当たり判定用マスクです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "../Utility/Vec.hpp"
+#include <vector>
+#include <array>
+#include <cstdint>
+#include <cmath>
+#include <utility>
+
+/**
+* @brief 1ピクセル1ビットのマスクです
+* @details 1行を64ビット単位のワードで持ちます。ワードの最下位ビットが左端のピクセルです
+*/
+class CollisionMask final
+{
+private:
+	int w_ = 0;
+	int h_ = 0;
+	int wordsPerRow_ = 0;
+	Vec2 offset_;
+	std::vector<uint64_t> bits_;
+public:
+	CollisionMask() = default;
+	/**
+	* @brief 空のマスクを作ります
+	* @param w 幅
+	* @param h 高さ
+	* @param offset 元画像の中心からマスクの左上までのオフセット
+	*/
+	CollisionMask(const int w, const int h, const Vec2& offset) :
+		w_(w),
+		h_(h),
+		wordsPerRow_((w + 63) / 64),
+		offset_(offset),
+		bits_(size_t(wordsPerRow_) * size_t(h), 0)
+	{}
+	//!指定したピクセルを当たりにします
+	void set(const int x, const int y)
+	{
+		bits_[size_t(y) * size_t(wordsPerRow_) + size_t(x >> 6)] |= uint64_t(1) << (x & 63);
+	}
+	//!指定したピクセルが当たりか返します
+	[[nodiscard]] bool get(const int x, const int y) const
+	{
+		if (x < 0 || y < 0 || x >= w_ || y >= h_)
+		{
+			return false;
+		}
+		return (bits_[size_t(y) * size_t(wordsPerRow_) + size_t(x >> 6)] >> (x & 63)) & 1;
+	}
+	/**
+	* @brief 指定した行のbitX番目のピクセルから64ピクセル分を取り出します
+	* @details マスクの範囲外は0になります
+	*/
+	[[nodiscard]] uint64_t fetch(const int y, const int bitX) const
+	{
+		const uint64_t* row = &bits_[size_t(y) * size_t(wordsPerRow_)];
+		//負の値でも切り捨てになるように算術シフトを使う
+		const int word = bitX >> 6;
+		const int shift = bitX & 63;
+		const uint64_t lo = (word >= 0 && word < wordsPerRow_) ? row[word] : 0;
+		if (shift == 0)
+		{
+			return lo;
+		}
+		const uint64_t hi = (word + 1 >= 0 && word + 1 < wordsPerRow_) ? row[word + 1] : 0;
+		return (lo >> shift) | (hi << (64 - shift));
+	}
+	//!指定した行の先頭のワードを返します
+	[[nodiscard]] const uint64_t* row(const int y) const
+	{
+		return &bits_[size_t(y) * size_t(wordsPerRow_)];
+	}
+	[[nodiscard]] int w() const { return w_; }
+	[[nodiscard]] int h() const { return h_; }
+	[[nodiscard]] int wordsPerRow() const { return wordsPerRow_; }
+	//!元画像の中心からマスクの左上までのオフセットを返します
+	[[nodiscard]] const Vec2& offset() const { return offset_; }
+};
+
+/**
+* @brief 一定の角度ごとに回転させたマスクをまとめたものです
+* @details ロード時にすべての角度のマスクを作っておき、判定時は最も近い角度のものを使います
+*/
+class CollisionMaskSet final
+{
+public:
+	//!回転の分割数です。360 / ROTATION_NUM度ごとにマスクを作ります
+	static constexpr int ROTATION_NUM = 32;
+private:
+	int w_ = 0;
+	int h_ = 0;
+	std::array<CollisionMask, ROTATION_NUM> rotations_;
+	std::array<float, ROTATION_NUM> sin_{};
+	std::array<float, ROTATION_NUM> cos_{};
+public:
+	/**
+	* @brief アルファ値からマスクを作ります
+	* @param w 画像の幅
+	* @param h 画像の高さ
+	* @param alpha 画像のアルファ値。w * h個を行優先で並べたものです
+	* @param threshold この値以上のアルファ値を当たりにします
+	*/
+	CollisionMaskSet(const int w, const int h, const std::vector<uint8_t>& alpha, const int threshold) :
+		w_(w),
+		h_(h)
+	{
+		const float cx = float(w) * 0.5f;
+		const float cy = float(h) * 0.5f;
+		for (int i = 0; i < ROTATION_NUM; ++i)
+		{
+			const float rad = 2.f * 3.14159265f * float(i) / float(ROTATION_NUM);
+			//0度、90度などで誤差が出ないように丸める
+			sin_[i] = roundf(sinf(rad) * 65536.f) / 65536.f;
+			cos_[i] = roundf(cosf(rad) * 65536.f) / 65536.f;
+			const float s = sin_[i];
+			const float c = cos_[i];
+			const int rw = int(ceilf(fabsf(float(w) * c) + fabsf(float(h) * s)));
+			const int rh = int(ceilf(fabsf(float(w) * s) + fabsf(float(h) * c)));
+			CollisionMask mask(rw, rh, Vec2(-float(rw) * 0.5f, -float(rh) * 0.5f));
+			//回転後の各ピクセルの中心を逆回転して元画像を参照する
+			for (int y = 0; y < rh; ++y)
+			{
+				for (int x = 0; x < rw; ++x)
+				{
+					const float dx = float(x) + 0.5f - float(rw) * 0.5f;
+					const float dy = float(y) + 0.5f - float(rh) * 0.5f;
+					const int sx = int(floorf(dx * c + dy * s + cx));
+					const int sy = int(floorf(-dx * s + dy * c + cy));
+					if (sx < 0 || sy < 0 || sx >= w || sy >= h)
+					{
+						continue;
+					}
+					if (alpha[size_t(sy) * size_t(w) + size_t(sx)] >= threshold)
+					{
+						mask.set(x, y);
+					}
+				}
+			}
+			rotations_[i] = std::move(mask);
+		}
+	}
+	//!角度(度数法)から使うマスクの番号を返します
+	[[nodiscard]] static int RotationIndex(const float degree)
+	{
+		const int index = int(floorf(degree * (float(ROTATION_NUM) / 360.f) + 0.5f)) % ROTATION_NUM;
+		return index < 0 ? index + ROTATION_NUM : index;
+	}
+	//!指定した番号のマスクを返します
+	[[nodiscard]] const CollisionMask& get(const int index) const
+	{
+		return rotations_[index];
+	}
+	//!指定した番号の回転角のsinを返します
+	[[nodiscard]] float sin(const int index) const { return sin_[index]; }
+	//!指定した番号の回転角のcosを返します
+	[[nodiscard]] float cos(const int index) const { return cos_[index]; }
+	//!元画像の幅を返します
+	[[nodiscard]] int w() const { return w_; }
+	//!元画像の高さを返します
+	[[nodiscard]] int h() const { return h_; }
+};
@@ -0,0 +1,798 @@
+﻿/**
+* @file CollisionVerifier.hpp
+* @brief BroadPhaseとNarrowPhaseを使った当たり判定の結果が総当たりと一致するかを検証し、処理速度を計測します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "BroadPhase.hpp"
+#include "NarrowPhase.hpp"
+#include "../Utility/Utility.hpp"
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <random>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <cfloat>
+#include <cmath>
+#include <cassert>
+
+/**
+* @brief 当たり判定の検証と計測です
+* @details ランダムな配置と、密集した弾・画面より大きい矩形・大きさ0のコライダー・辺が接している矩形・画面外の配置などの
+* 意地の悪い配置を作り、総当たりのCollision::BoxAndBox, CircleAndCircle, CircleAndBoxの結果と
+* BroadPhaseの各メソッドで候補を絞り込んだ結果が完全に一致するか確認します。
+* - nearest(), raycast(), raycastAll(), raycastBatch()は、ランダムな点と半直線で登録されている範囲をすべて調べた結果と比べます
+* - 回転する矩形、カプセル、複数の形状をまとめたコライダーの配置では、findPairs()とNarrowPhase::filter()の結果を
+*   すべての組み合わせをNarrowPhase::Test()で判定した結果と比べます
+* 結果はコンソールに出力されます。計測中にゲームは止まるのでデバッグ時に明示的に呼んでください
+*/
+class CollisionVerifier final
+{
+private:
+	CollisionVerifier() = delete;
+	using PairSet = std::vector<std::pair<size_t, size_t>>;
+	static constexpr ECS::Group GROUP_A = 0;
+	static constexpr ECS::Group GROUP_B = 1;
+
+	//!検証用の配置です
+	struct Scene
+	{
+		const char* name = "";
+		std::unique_ptr<ECS::EntityManager> manager = std::make_unique<ECS::EntityManager>();
+		std::unordered_map<const ECS::Entity*, size_t> ids;
+		std::vector<ECS::Entity*> entities;
+
+		void addCircle(const ECS::Group group, const float x, const float y, const float r)
+		{
+			auto& e = manager->addEntity(group);
+			e.addComponent<ECS::Position>(x, y);
+			e.addComponent<ECS::CircleCollider>(r);
+			ids[&e] = entities.size();
+			entities.emplace_back(&e);
+		}
+		void addBox(const ECS::Group group, const float x, const float y, const float w, const float h)
+		{
+			auto& e = manager->addEntity(group);
+			e.addComponent<ECS::Position>(x, y);
+			e.addComponent<ECS::BoxCollider>(w, h);
+			ids[&e] = entities.size();
+			entities.emplace_back(&e);
+		}
+		void addOBB(const ECS::Group group, const float x, const float y, const float w, const float h, const float degree)
+		{
+			auto& e = manager->addEntity(group);
+			e.addComponent<ECS::Position>(x, y);
+			e.addComponent<ECS::Rotation>(degree);
+			e.addComponent<ECS::OBBCollider>(w, h);
+			ids[&e] = entities.size();
+			entities.emplace_back(&e);
+		}
+		void addCapsule(const ECS::Group group, const float x, const float y, const float length, const float r, const float degree)
+		{
+			auto& e = manager->addEntity(group);
+			e.addComponent<ECS::Position>(x, y);
+			e.addComponent<ECS::Rotation>(degree);
+			e.addComponent<ECS::CapsuleCollider>(length, r);
+			ids[&e] = entities.size();
+			entities.emplace_back(&e);
+		}
+		//!追加したCompoundColliderに部位を追加してください
+		[[nodiscard]] ECS::CompoundCollider& addCompound(const ECS::Group group, const float x, const float y, const float degree)
+		{
+			auto& e = manager->addEntity(group);
+			e.addComponent<ECS::Position>(x, y);
+			e.addComponent<ECS::Rotation>(degree);
+			auto& compound = e.addComponent<ECS::CompoundCollider>();
+			ids[&e] = entities.size();
+			entities.emplace_back(&e);
+			return compound;
+		}
+		[[nodiscard]] std::vector<ECS::Entity*>& group(const ECS::Group group)
+		{
+			return manager->getEntitiesByGroup(group);
+		}
+	};
+
+	//!計測結果です
+	struct Result
+	{
+		PairSet pairs;
+		double ms = 0.0;
+		size_t tested = 0;
+	};
+
+	//!比べる値を順番に積みます。値の並びがそのまま比べられます
+	static void Push(Result& result, const size_t value)
+	{
+		result.pairs.emplace_back(result.pairs.size(), value);
+	}
+	[[nodiscard]] static size_t FloatBits(const float value)
+	{
+		uint32_t bits;
+		std::memcpy(&bits, &value, sizeof(bits));
+		return size_t(bits);
+	}
+
+	//!コライダーの種類に合わせたCollisionのメソッドで判定します
+	[[nodiscard]] static bool Narrow(const ECS::Entity* e1, const ECS::Entity* e2)
+	{
+		const bool isCircle1 = e1->hasComponent<ECS::CircleCollider>();
+		const bool isCircle2 = e2->hasComponent<ECS::CircleCollider>();
+		if (isCircle1 && isCircle2)
+		{
+			return Collision::CircleAndCircle(e1, e2);
+		}
+		if (isCircle1)
+		{
+			return Collision::CircleAndBox(e1, e2);
+		}
+		if (isCircle2)
+		{
+			return Collision::CircleAndBox(e2, e1);
+		}
+		return Collision::BoxAndBox(e1, e2);
+	}
+
+	static void AddPair(Scene& scene, const ECS::Entity* a, const ECS::Entity* b, const bool isSameGroup, PairSet& pairs)
+	{
+		size_t idA = scene.ids[a];
+		size_t idB = scene.ids[b];
+		if (isSameGroup && idA > idB)
+		{
+			std::swap(idA, idB);
+		}
+		pairs.emplace_back(idA, idB);
+	}
+
+	static void Sort(PairSet& pairs)
+	{
+		std::sort(pairs.begin(), pairs.end());
+		pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+	}
+
+	template<class Func>
+	[[nodiscard]] static Result Measure(Func&& func)
+	{
+		Result result;
+		const auto start = std::chrono::steady_clock::now();
+		func(result);
+		const auto end = std::chrono::steady_clock::now();
+		result.ms = std::chrono::duration<double, std::milli>(end - start).count();
+		Sort(result.pairs);
+		return result;
+	}
+
+	static Scene MakeScene(const int type, const int num, std::mt19937& mt)
+	{
+		Scene scene;
+		auto range = [&mt](const float min, const float max)
+		{
+			return std::uniform_real_distribution<float>(min, max)(mt);
+		};
+		auto rangeInt = [&mt](const int min, const int max)
+		{
+			return std::uniform_int_distribution<int>(min, max)(mt);
+		};
+		const float w = float(System::SCREEN_WIDIH);
+		const float h = float(System::SCREEN_HEIGHT);
+		for (int i = 0; i < num; ++i)
+		{
+			const ECS::Group group = i % 4 == 0 ? GROUP_A : GROUP_B;
+			const bool isCircle = i % 2 == 0;
+			switch (type)
+			{
+			case 0:
+				scene.name = "random";
+				if (isCircle) { scene.addCircle(group, range(0.f, w), range(0.f, h), range(1.f, 16.f)); }
+				else { scene.addBox(group, range(0.f, w), range(0.f, h), range(1.f, 32.f), range(1.f, 32.f)); }
+				break;
+			case 1:
+			{
+				//数か所に弾が密集している
+				scene.name = "clustered bullets";
+				const int cluster = i % 6;
+				std::normal_distribution<float> spread(0.f, 8.f);
+				const float x = float(60 + cluster * 60) + spread(mt);
+				const float y = float(100 + (cluster % 3) * 180) + spread(mt);
+				if (isCircle) { scene.addCircle(group, x, y, range(2.f, 4.f)); }
+				else { scene.addBox(group, x, y, 4.f, 4.f); }
+				break;
+			}
+			case 2:
+				//画面やグリッドより大きい矩形が混ざっている
+				scene.name = "huge boxes";
+				if (i % 50 == 0) { scene.addBox(group, range(-800.f, w), range(-800.f, h), range(300.f, 2000.f), range(300.f, 2000.f)); }
+				else if (isCircle) { scene.addCircle(group, range(0.f, w), range(0.f, h), range(1.f, 8.f)); }
+				else { scene.addBox(group, range(0.f, w), range(0.f, h), range(1.f, 16.f), range(1.f, 16.f)); }
+				break;
+			case 3:
+			{
+				//大きさ0のコライダーが同じ座標に重なっている
+				scene.name = "zero size";
+				const float x = float(rangeInt(0, 20) * 20);
+				const float y = float(rangeInt(0, 30) * 20);
+				if (i % 3 == 0) { scene.addCircle(group, x, y, 0.f); }
+				else if (i % 3 == 1) { scene.addBox(group, x, y, 0.f, 0.f); }
+				else { scene.addBox(group, x, y, float(rangeInt(0, 1) * 20), float(rangeInt(0, 1) * 20)); }
+				break;
+			}
+			case 4:
+			{
+				//辺やセルの境界でちょうど接している
+				scene.name = "edge touching";
+				const float x = float(rangeInt(0, 26) * 16);
+				const float y = float(rangeInt(0, 37) * 16);
+				if (isCircle) { scene.addCircle(group, x, y, 8.f); }
+				else { scene.addBox(group, x, y, 16.f, 16.f); }
+				break;
+			}
+			default:
+				//画面の外まで散らばっている
+				scene.name = "outside screen";
+				if (isCircle) { scene.addCircle(group, range(-600.f, w + 600.f), range(-600.f, h + 600.f), range(1.f, 24.f)); }
+				else { scene.addBox(group, range(-600.f, w + 600.f), range(-600.f, h + 600.f), range(1.f, 48.f), range(1.f, 48.f)); }
+				break;
+			}
+		}
+		return scene;
+	}
+
+	//!BroadPhase::DistanceSqと同じく、登録されている範囲までの距離の2乗を求めます
+	[[nodiscard]] static float DistanceSq(const BroadPhase::Proxy& p, const Vec2& pos)
+	{
+		const float dx = pos.x < p.minX ? p.minX - pos.x : (pos.x > p.maxX ? pos.x - p.maxX : 0.f);
+		const float dy = pos.y < p.minY ? p.minY - pos.y : (pos.y > p.maxY ? pos.y - p.maxY : 0.f);
+		return dx * dx + dy * dy;
+	}
+	/**
+	* @brief 半直線と1つの登録されている範囲のEntityを判定します
+	* @details BroadPhaseと同じく、円、矩形、CompoundColliderは形状で、それ以外は登録されている範囲で判定します。
+	* 形状ごとの判定はCollisionのメソッドをそのまま使い、BroadPhaseのセルの走査や打ち切りを通さずに求めます
+	*/
+	[[nodiscard]] static bool RayTest(const BroadPhase::Proxy& p, const Vec2& origin, const Vec2& dir, const float maxDistance, float& distance)
+	{
+		const ECS::Entity* e = p.entity;
+		bool isHit = false;
+		float best = maxDistance;
+		float d = 0.f;
+		const auto hit = [&](const bool isPartHit)
+		{
+			if (isPartHit)
+			{
+				best = d;
+				isHit = true;
+			}
+		};
+		if (e->hasComponent<ECS::CircleCollider>())
+		{
+			const auto& c = e->getComponent<ECS::CircleCollider>();
+			hit(Collision::RayAndCircle(origin, dir, best, Vec2(c.x(), c.y()), c.radius(), d));
+		}
+		if (e->hasComponent<ECS::BoxCollider>())
+		{
+			const auto& b = e->getComponent<ECS::BoxCollider>();
+			hit(Collision::RayAndBox(origin, dir, best, Vec2(b.x(), b.y()), Vec2(b.w(), b.h()), d));
+		}
+		if (e->hasComponent<ECS::CompoundCollider>())
+		{
+			const auto& c = e->getComponent<ECS::CompoundCollider>();
+			if (Collision::RayAndCircle(origin, dir, best, c.boundCenter(), c.boundRadius(), d))
+			{
+				for (size_t i = 0; i < c.size(); ++i)
+				{
+					const auto& part = c.part(int(i));
+					if (!part.isActive)
+					{
+						continue;
+					}
+					switch (part.type)
+					{
+					case ECS::CompoundPart::Type::CIRCLE:
+						hit(Collision::RayAndCircle(origin, dir, best, part.center, part.radius, d));
+						break;
+					case ECS::CompoundPart::Type::OBB:
+						hit(Collision::RayAndOBB(origin, dir, best, part.obb, d));
+						break;
+					case ECS::CompoundPart::Type::CAPSULE:
+						hit(Collision::RayAndCapsule(origin, dir, best, part.capsule, d));
+						break;
+					}
+				}
+			}
+		}
+		if (!e->hasComponent<ECS::CircleCollider>() && !e->hasComponent<ECS::BoxCollider>() && !e->hasComponent<ECS::CompoundCollider>())
+		{
+			hit(Collision::RayAndBox(origin, dir, maxDistance, Vec2(p.minX, p.minY), Vec2(p.maxX - p.minX, p.maxY - p.minY), d));
+		}
+		distance = best;
+		return isHit;
+	}
+	//!総当たりで半直線と当たるEntityの番号と距離を近い順に求めます。距離が同じ場合は登録順です
+	static void RayAll(const BroadPhase& broadPhase, const BroadPhase::Ray& ray, const uint32_t groupMask,
+		std::vector<std::pair<float, size_t>>& hits)
+	{
+		hits.clear();
+		const float length = ray.dir.length();
+		const Vec2 unitDir(ray.dir.x / length, ray.dir.y / length);
+		const auto& proxies = broadPhase.getProxies();
+		for (size_t i = 0; i < proxies.size(); ++i)
+		{
+			float distance = 0.f;
+			if (((groupMask >> proxies[i].group) & 1u) && RayTest(proxies[i], ray.origin, unitDir, ray.maxDistance, distance))
+			{
+				hits.emplace_back(distance, i);
+			}
+		}
+		std::sort(hits.begin(), hits.end());
+	}
+
+	/**
+	* @brief nearest()とレイキャストの結果を、登録されている範囲をすべて調べた結果と比べます
+	* @details 半直線の一部は軸に沿った向きにして、セルの境界をちょうどたどる場合も調べます
+	*/
+	[[nodiscard]] static bool VerifyQueries(Scene& scene, const BroadPhase& broadPhase, std::mt19937& mt)
+	{
+		constexpr size_t QUERY_NUM = 300;
+		constexpr size_t RAY_NUM = 500;
+		constexpr size_t PARTIAL_CAPACITY = 4;
+		auto range = [&mt](const float min, const float max)
+		{
+			return std::uniform_real_distribution<float>(min, max)(mt);
+		};
+		const float w = float(System::SCREEN_WIDIH);
+		const float h = float(System::SCREEN_HEIGHT);
+		const size_t colliderNum = scene.ids.size();
+		const auto& proxies = broadPhase.getProxies();
+		bool isOk = true;
+
+		struct NearestQuery
+		{
+			Vec2 pos;
+			ECS::Group group;
+			size_t k;
+			float maxDistance;
+		};
+		std::vector<NearestQuery> queries(QUERY_NUM);
+		for (size_t i = 0; i < QUERY_NUM; ++i)
+		{
+			queries[i].pos = Vec2(range(-200.f, w + 200.f), range(-200.f, h + 200.f));
+			queries[i].group = i % 2 == 0 ? GROUP_A : GROUP_B;
+			queries[i].k = i % 3 == 0 ? 1 : (i % 3 == 1 ? 5 : BroadPhase::NEAREST_MAX);
+			queries[i].maxDistance = i % 4 == 0 ? FLT_MAX : range(0.f, 200.f);
+		}
+		const auto bruteNearest = Measure([&](Result& r)
+		{
+			std::vector<std::pair<float, size_t>> found;
+			for (const auto& q : queries)
+			{
+				found.clear();
+				const float maxDistanceSq = q.maxDistance < FLT_MAX ? q.maxDistance * q.maxDistance : FLT_MAX;
+				for (size_t i = 0; i < proxies.size(); ++i)
+				{
+					++r.tested;
+					const float d = DistanceSq(proxies[i], q.pos);
+					if (proxies[i].group == q.group && d <= maxDistanceSq)
+					{
+						found.emplace_back(d, i);
+					}
+				}
+				std::sort(found.begin(), found.end());
+				Push(r, std::min(found.size(), q.k));
+				for (size_t i = 0; i < std::min(found.size(), q.k); ++i)
+				{
+					Push(r, scene.ids[proxies[found[i].second].entity]);
+				}
+			}
+		});
+		isOk &= Check(scene.name, "nearest", bruteNearest, Measure([&](Result& r)
+		{
+			ECS::Entity* out[BroadPhase::NEAREST_MAX];
+			r.tested = queries.size();
+			for (const auto& q : queries)
+			{
+				const size_t num = broadPhase.nearest(q.pos, q.group, q.k, out, q.maxDistance);
+				Push(r, num);
+				for (size_t i = 0; i < num; ++i)
+				{
+					Push(r, scene.ids[out[i]]);
+				}
+			}
+		}), colliderNum);
+
+		std::vector<BroadPhase::Ray> rays(RAY_NUM);
+		for (size_t i = 0; i < RAY_NUM; ++i)
+		{
+			rays[i].origin = Vec2(range(-200.f, w + 200.f), range(-200.f, h + 200.f));
+			static constexpr float AXES[4][2] = { { 1.f, 0.f }, { -1.f, 0.f }, { 0.f, 1.f }, { 0.f, -1.f } };
+			if (i % 8 == 0)
+			{
+				rays[i].dir = Vec2(AXES[i / 8 % 4][0], AXES[i / 8 % 4][1]);
+			}
+			else
+			{
+				const float angle = range(-3.14159265f, 3.14159265f);
+				rays[i].dir = Vec2(std::cos(angle) * range(0.5f, 2.f), std::sin(angle) * range(0.5f, 2.f));
+			}
+			rays[i].maxDistance = i % 5 == 0 ? 2000.f : range(0.f, 600.f);
+		}
+		const uint32_t groupMask = BroadPhase::GroupMask(GROUP_A) | BroadPhase::GroupMask(GROUP_B);
+		std::vector<std::pair<float, size_t>> hits;
+		const auto pushFirst = [&](Result& r, const ECS::Entity* entity, const float distance)
+		{
+			Push(r, entity != nullptr ? scene.ids[entity] : SIZE_MAX);
+			Push(r, entity != nullptr ? FloatBits(distance) : 0);
+		};
+		const auto bruteRaycast = Measure([&](Result& r)
+		{
+			for (const auto& ray : rays)
+			{
+				r.tested += proxies.size();
+				RayAll(broadPhase, ray, groupMask, hits);
+				pushFirst(r, hits.empty() ? nullptr : proxies[hits.front().second].entity, hits.empty() ? 0.f : hits.front().first);
+			}
+		});
+		isOk &= Check(scene.name, "raycast", bruteRaycast, Measure([&](Result& r)
+		{
+			r.tested = rays.size();
+			for (const auto& ray : rays)
+			{
+				BroadPhase::RayHit hit{};
+				const bool isHit = broadPhase.raycast(ray.origin, ray.dir, ray.maxDistance, groupMask, hit);
+				pushFirst(r, isHit ? hit.entity : nullptr, hit.distance);
+			}
+		}), colliderNum);
+		std::vector<BroadPhase::RayHit> batch(rays.size());
+		isOk &= Check(scene.name, "raycastBatch", bruteRaycast, Measure([&](Result& r)
+		{
+			r.tested = rays.size();
+			broadPhase.raycastBatch(rays.data(), rays.size(), groupMask, batch.data(), 3);
+			for (const auto& hit : batch)
+			{
+				pushFirst(r, hit.entity, hit.distance);
+			}
+		}), colliderNum);
+
+		//すべて求める場合は距離と登録順で並べて比べ、数を絞る場合は距離だけを比べる
+		std::vector<BroadPhase::RayHit> all(colliderNum + 1);
+		const auto bruteAll = Measure([&](Result& r)
+		{
+			for (const auto& ray : rays)
+			{
+				r.tested += proxies.size();
+				RayAll(broadPhase, ray, groupMask, hits);
+				Push(r, hits.size());
+				for (const auto& it : hits)
+				{
+					Push(r, scene.ids[proxies[it.second].entity]);
+					Push(r, FloatBits(it.first));
+				}
+				Push(r, std::min(hits.size(), PARTIAL_CAPACITY));
+				for (size_t i = 0; i < std::min(hits.size(), PARTIAL_CAPACITY); ++i)
+				{
+					Push(r, FloatBits(hits[i].first));
+				}
+			}
+		});
+		std::unordered_map<const ECS::Entity*, size_t> proxyIndex;
+		for (size_t i = 0; i < proxies.size(); ++i)
+		{
+			proxyIndex[proxies[i].entity] = i;
+		}
+		isOk &= Check(scene.name, "raycastAll", bruteAll, Measure([&](Result& r)
+		{
+			r.tested = rays.size();
+			for (const auto& ray : rays)
+			{
+				const size_t num = broadPhase.raycastAll(ray.origin, ray.dir, ray.maxDistance, groupMask, all.data(), all.size());
+				std::sort(all.begin(), all.begin() + num, [&](const BroadPhase::RayHit& a, const BroadPhase::RayHit& b)
+				{
+					return a.distance != b.distance ? a.distance < b.distance : proxyIndex[a.entity] < proxyIndex[b.entity];
+				});
+				Push(r, num);
+				for (size_t i = 0; i < num; ++i)
+				{
+					Push(r, scene.ids[all[i].entity]);
+					Push(r, FloatBits(all[i].distance));
+				}
+				const size_t partialNum = broadPhase.raycastAll(ray.origin, ray.dir, ray.maxDistance, groupMask, all.data(), PARTIAL_CAPACITY);
+				Push(r, partialNum);
+				for (size_t i = 0; i < partialNum; ++i)
+				{
+					Push(r, FloatBits(all[i].distance));
+				}
+			}
+		}), colliderNum);
+		return isOk;
+	}
+
+	[[nodiscard]] static bool Check(const char* sceneName, const char* pathName, const Result& expected, const Result& actual, const size_t colliderNum)
+	{
+		const bool isSame = expected.pairs == actual.pairs;
+		DOUT << "  " << pathName << " : " << actual.ms << " [milliseconds] "
+			<< actual.ms * 1000000.0 / double(colliderNum) << " [ns/collider] "
+			<< (actual.ms > 0.0 ? double(actual.tested) / actual.ms * 1000.0 : 0.0) << " [tested pairs/sec] "
+			<< actual.pairs.size() << " hits" << (isSame ? "" : " MISMATCH") << std::endl;
+		if (!isSame)
+		{
+			DOUT << "  " << sceneName << " / " << pathName << " expected " << expected.pairs.size()
+				<< " pairs but got " << actual.pairs.size() << std::endl;
+		}
+		return isSame;
+	}
+
+	//!1つの配置について、グループA同士とグループAとBのペア、近傍検索、レイキャストを検証します
+	[[nodiscard]] static bool VerifyScene(Scene& scene, const float cellSize, std::mt19937& mt)
+	{
+		bool isOk = true;
+		const size_t colliderNum = scene.ids.size();
+		auto& groupA = scene.group(GROUP_A);
+		auto& groupB = scene.group(GROUP_B);
+		BroadPhase broadPhase(cellSize);
+		const auto build = Measure([&](Result&) { broadPhase.build(*scene.manager, { GROUP_A, GROUP_B }); });
+		DOUT << scene.name << " : " << colliderNum << " colliders, build " << build.ms << " [milliseconds]" << std::endl;
+
+		for (const bool isSameGroup : { false, true })
+		{
+			const ECS::Group other = isSameGroup ? GROUP_A : GROUP_B;
+			auto& groupOther = isSameGroup ? groupA : groupB;
+			DOUT << (isSameGroup ? " A - A" : " A - B") << std::endl;
+			const auto brute = Measure([&](Result& r)
+			{
+				for (size_t i = 0; i < groupA.size(); ++i)
+				{
+					for (size_t j = isSameGroup ? i + 1 : 0; j < groupOther.size(); ++j)
+					{
+						++r.tested;
+						if (Narrow(groupA[i], groupOther[j]))
+						{
+							AddPair(scene, groupA[i], groupOther[j], isSameGroup, r.pairs);
+						}
+					}
+				}
+			});
+			isOk &= Check(scene.name, "brute force", brute, brute, colliderNum);
+
+			std::vector<BroadPhase::Pair> candidates;
+			const auto fromPairs = [&](Result& r)
+			{
+				for (const auto& it : candidates)
+				{
+					++r.tested;
+					if (Narrow(it.a, it.b))
+					{
+						AddPair(scene, it.a, it.b, isSameGroup, r.pairs);
+					}
+				}
+			};
+			isOk &= Check(scene.name, "findPairs", brute, Measure([&](Result& r)
+			{
+				broadPhase.findPairs(GROUP_A, other, candidates);
+				fromPairs(r);
+			}), colliderNum);
+			for (const size_t threadNum : { size_t(0), size_t(3), size_t(8) })
+			{
+				const std::string name = "findPairsParallel(" + std::to_string(threadNum == 0 ? ThreadPool::Get().size() : threadNum) + ")";
+				isOk &= Check(scene.name, name.c_str(), brute, Measure([&](Result& r)
+				{
+					broadPhase.findPairsParallel(GROUP_A, other, candidates, threadNum);
+					fromPairs(r);
+				}), colliderNum);
+			}
+
+			std::vector<ECS::Entity*> found;
+			isOk &= Check(scene.name, "queryBox", brute, Measure([&](Result& r)
+			{
+				for (const auto& p : broadPhase.getProxies())
+				{
+					if (p.group != GROUP_A)
+					{
+						continue;
+					}
+					broadPhase.queryBox(Vec2(p.minX, p.minY), Vec2(p.maxX, p.maxY), other, found);
+					for (auto* e : found)
+					{
+						if (e == p.entity)
+						{
+							continue;
+						}
+						++r.tested;
+						if (Narrow(p.entity, e))
+						{
+							AddPair(scene, p.entity, e, isSameGroup, r.pairs);
+						}
+					}
+				}
+			}), colliderNum);
+
+			//円の範囲検索は円同士のペアだけを比べる
+			Result bruteCircle;
+			for (const auto& it : brute.pairs)
+			{
+				if (scene.entities[it.first]->hasComponent<ECS::CircleCollider>() &&
+					scene.entities[it.second]->hasComponent<ECS::CircleCollider>())
+				{
+					bruteCircle.pairs.emplace_back(it);
+				}
+			}
+			std::vector<ECS::Entity*> buffer(scene.ids.size());
+			isOk &= Check(scene.name, "queryCircle", bruteCircle, Measure([&](Result& r)
+			{
+				for (auto* e : groupA)
+				{
+					if (!e->hasComponent<ECS::CircleCollider>())
+					{
+						continue;
+					}
+					const auto& c = e->getComponent<ECS::CircleCollider>();
+					const size_t num = broadPhase.queryCircle(Vec2(c.x(), c.y()), c.radius(), other, buffer.data(), buffer.size());
+					for (size_t i = 0; i < num; ++i)
+					{
+						if (buffer[i] == e || !buffer[i]->hasComponent<ECS::CircleCollider>())
+						{
+							continue;
+						}
+						++r.tested;
+						if (Collision::CircleAndCircle(e, buffer[i]))
+						{
+							AddPair(scene, e, buffer[i], isSameGroup, r.pairs);
+						}
+					}
+				}
+			}), colliderNum);
+		}
+		isOk &= VerifyQueries(scene, broadPhase, mt);
+		return isOk;
+	}
+
+	//!円、矩形、回転する矩形、カプセル、複数の形状をまとめたコライダーを回転させて配置します
+	static Scene MakeShapeScene(const int num, std::mt19937& mt)
+	{
+		Scene scene;
+		scene.name = "rotated shapes";
+		auto range = [&mt](const float min, const float max)
+		{
+			return std::uniform_real_distribution<float>(min, max)(mt);
+		};
+		const float w = float(System::SCREEN_WIDIH);
+		const float h = float(System::SCREEN_HEIGHT);
+		for (int i = 0; i < num; ++i)
+		{
+			const ECS::Group group = i % 4 == 0 ? GROUP_A : GROUP_B;
+			const float x = range(-50.f, w + 50.f);
+			const float y = range(-50.f, h + 50.f);
+			//一部は90度の倍数にして、軸に沿った場合の経路も通す
+			const float degree = i % 7 == 0 ? float((i / 7 % 4) * 90) : range(-180.f, 180.f);
+			switch (i % 5)
+			{
+			case 0:
+				scene.addCircle(group, x, y, range(1.f, 16.f));
+				break;
+			case 1:
+				scene.addBox(group, x, y, range(1.f, 32.f), range(1.f, 32.f));
+				break;
+			case 2:
+				scene.addOBB(group, x, y, range(1.f, 40.f), range(1.f, 40.f), degree);
+				break;
+			case 3:
+				scene.addCapsule(group, x, y, range(0.f, 60.f), range(1.f, 10.f), degree);
+				break;
+			default:
+			{
+				auto& compound = scene.addCompound(group, x, y, degree);
+				compound.addCircle(Vec2(range(-20.f, 20.f), range(-20.f, 20.f)), range(2.f, 12.f));
+				compound.addBox(Vec2(range(-30.f, 30.f), range(-30.f, 30.f)), Vec2(range(2.f, 30.f), range(2.f, 30.f)), range(-90.f, 90.f));
+				const int capsule = compound.addCapsule(Vec2(range(-30.f, 30.f), range(-30.f, 30.f)), range(0.f, 50.f), range(1.f, 8.f), range(-90.f, 90.f));
+				compound.setActive(capsule, i % 3 != 0);
+				break;
+			}
+			}
+		}
+		return scene;
+	}
+
+	/**
+	* @brief 回転する形状の配置で、findPairs()とNarrowPhase::filter()の結果をNarrowPhase::Test()の総当たりと比べます
+	* @details 当たった部位の番号は、残ったペアを1つずつNarrowPhase::Test()で判定し直したものと比べます
+	*/
+	[[nodiscard]] static bool VerifyShapeScene(Scene& scene, const float cellSize, std::mt19937& mt)
+	{
+		bool isOk = true;
+		const size_t colliderNum = scene.ids.size();
+		auto& groupA = scene.group(GROUP_A);
+		auto& groupB = scene.group(GROUP_B);
+		BroadPhase broadPhase(cellSize);
+		const auto build = Measure([&](Result&) { broadPhase.build(*scene.manager, { GROUP_A, GROUP_B }); });
+		DOUT << scene.name << " : " << colliderNum << " colliders, build " << build.ms << " [milliseconds]" << std::endl;
+
+		NarrowPhase narrowPhase;
+		for (const bool isSameGroup : { false, true })
+		{
+			const ECS::Group other = isSameGroup ? GROUP_A : GROUP_B;
+			auto& groupOther = isSameGroup ? groupA : groupB;
+			DOUT << (isSameGroup ? " A - A" : " A - B") << std::endl;
+			const auto brute = Measure([&](Result& r)
+			{
+				for (size_t i = 0; i < groupA.size(); ++i)
+				{
+					for (size_t j = isSameGroup ? i + 1 : 0; j < groupOther.size(); ++j)
+					{
+						++r.tested;
+						if (NarrowPhase::Test(groupA[i], groupOther[j]))
+						{
+							AddPair(scene, groupA[i], groupOther[j], isSameGroup, r.pairs);
+						}
+					}
+				}
+			});
+			isOk &= Check(scene.name, "brute force", brute, brute, colliderNum);
+
+			for (const size_t threadNum : { size_t(1), size_t(3) })
+			{
+				std::vector<BroadPhase::Pair> pairs;
+				const std::string name = "findPairs + filter(" + std::to_string(threadNum) + ")";
+				isOk &= Check(scene.name, name.c_str(), brute, Measure([&](Result& r)
+				{
+					broadPhase.findPairs(GROUP_A, other, pairs);
+					r.tested = pairs.size();
+					narrowPhase.filter(pairs, threadNum);
+					for (const auto& it : pairs)
+					{
+						AddPair(scene, it.a, it.b, isSameGroup, r.pairs);
+					}
+				}), colliderNum);
+				bool isPartOk = narrowPhase.hitParts().size() == pairs.size();
+				for (size_t i = 0; isPartOk && i < pairs.size(); ++i)
+				{
+					NarrowPhase::HitPart expected;
+					isPartOk = NarrowPhase::Test(pairs[i].a, pairs[i].b, &expected) &&
+						expected.part1 == narrowPhase.hitParts()[i].part1 && expected.part2 == narrowPhase.hitParts()[i].part2;
+				}
+				if (!isPartOk)
+				{
+					DOUT << "  " << scene.name << " / " << name << " hit parts MISMATCH" << std::endl;
+				}
+				isOk &= isPartOk;
+			}
+		}
+		isOk &= VerifyQueries(scene, broadPhase, mt);
+		return isOk;
+	}
+public:
+	/**
+	* @brief すべての配置で検証と計測を行います
+	* @param colliderNum 1つの配置あたりのコライダーの数。総当たりを行うので多すぎると時間がかかります
+	* @param seed 乱数のシード
+	* @return すべて一致したらtrue
+	*/
+	static bool Run(const int colliderNum = 3000, const unsigned int seed = 2026)
+	{
+		std::mt19937 mt(seed);
+		bool isOk = true;
+		constexpr int SCENE_NUM = 6;
+		for (int type = 0; type < SCENE_NUM; ++type)
+		{
+			for (const float cellSize : { 16.f, 64.f })
+			{
+				auto scene = MakeScene(type, colliderNum, mt);
+				DOUT << "cell size " << cellSize << " ";
+				isOk &= VerifyScene(scene, cellSize, mt);
+				scene.manager->removeAll();
+			}
+		}
+		for (const float cellSize : { 16.f, 64.f })
+		{
+			auto scene = MakeShapeScene(colliderNum, mt);
+			DOUT << "cell size " << cellSize << " ";
+			isOk &= VerifyShapeScene(scene, cellSize, mt);
+			scene.manager->removeAll();
+		}
+		DOUT << "CollisionVerifier : " << (isOk ? "all paths match brute force" : "MISMATCH FOUND") << std::endl;
+		assert(isOk && "broadphase or narrowphase result is different from brute force");
+		return isOk;
+	}
+};
@@ -0,0 +1,284 @@
+﻿/**
+* @file NarrowPhase.hpp
+* @brief BroadPhaseで絞り込んだ候補ペアを、コライダーの形状に合わせてまとめて判定します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "BroadPhase.hpp"
+#include "../Utility/ThreadPool.hpp"
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+/**
+* @brief 候補ペアをまとめて詳細に判定します
+* @details Entityごとに次の順で最初に見つかったコライダーを形状として使います
+* - CompoundCollider, OBBCollider, CapsuleCollider, CircleCollider, BoxCollider
+* - 円と矩形、矩形同士の判定はCollision::CircleAndBox, BoxAndBoxと同じ結果になります
+* - 矩形と回転する矩形、カプセルの判定では矩形を回転0度のOBBとして扱います
+* - CompoundColliderはバウンディング円で当たった場合だけ各部位を判定し、最初に当たった部位の番号を返します
+*/
+class NarrowPhase final
+{
+public:
+	//!判定に使う形状の種類です
+	enum class ShapeType : uint8_t
+	{
+		NONE,
+		CIRCLE,
+		BOX,
+		OBB,
+		CAPSULE,
+		COMPOUND,
+	};
+	//!Entityから取り出した形状です
+	struct Shape
+	{
+		ShapeType type = ShapeType::NONE;
+		//!円の中心、矩形の左上
+		Vec2 pos;
+		//!矩形の大きさ
+		Vec2 size;
+		float radius = 0.f;
+		ECS::OBBShape obb;
+		ECS::CapsuleShape capsule;
+		const ECS::CompoundCollider* compound = nullptr;
+	};
+	//!当たった部位の番号です。CompoundColliderでない場合や当たらなかった場合は-1です
+	struct HitPart
+	{
+		int part1 = -1;
+		int part2 = -1;
+	};
+private:
+	std::vector<uint8_t> results_;
+	std::vector<HitPart> hitParts_;
+
+	[[nodiscard]] static ECS::OBBShape BoxToOBB(const Shape& s) noexcept
+	{
+		ECS::OBBShape obb;
+		obb.half = Vec2(s.size.x / 2.f, s.size.y / 2.f);
+		obb.center = Vec2(s.pos.x + obb.half.x, s.pos.y + obb.half.y);
+		return obb;
+	}
+	[[nodiscard]] static Shape PartToShape(const ECS::CompoundPart& part) noexcept
+	{
+		Shape s;
+		switch (part.type)
+		{
+		case ECS::CompoundPart::Type::CIRCLE:
+			s.type = ShapeType::CIRCLE;
+			s.pos = part.center;
+			s.radius = part.radius;
+			break;
+		case ECS::CompoundPart::Type::OBB:
+			s.type = ShapeType::OBB;
+			s.obb = part.obb;
+			break;
+		case ECS::CompoundPart::Type::CAPSULE:
+			s.type = ShapeType::CAPSULE;
+			s.capsule = part.capsule;
+			break;
+		}
+		return s;
+	}
+	[[nodiscard]] static Shape BoundToShape(const ECS::CompoundCollider& c) noexcept
+	{
+		Shape s;
+		s.type = ShapeType::CIRCLE;
+		s.pos = c.boundCenter();
+		s.radius = c.boundRadius();
+		return s;
+	}
+	//!単純な形状同士の当たり判定をします
+	[[nodiscard]] static bool TestPrimitive(const Shape& shape1, const Shape& shape2) noexcept
+	{
+		//種類の番号が小さい方を先にして組み合わせを減らす
+		const bool isSwap = shape1.type > shape2.type;
+		const Shape& s1 = isSwap ? shape2 : shape1;
+		const Shape& s2 = isSwap ? shape1 : shape2;
+		if (s1.type == ShapeType::NONE)
+		{
+			return false;
+		}
+		switch (s2.type)
+		{
+		case ShapeType::CIRCLE:
+			return Collision::CircleAndCircle(s1.pos, s1.radius, s2.pos, s2.radius);
+		case ShapeType::BOX:
+			if (s1.type == ShapeType::CIRCLE)
+			{
+				return Collision::CircleAndBox(s1.pos, s1.radius, s2.pos, s2.size);
+			}
+			return Collision::BoxAndBox(s1.pos, s1.size, s2.pos, s2.size);
+		case ShapeType::OBB:
+			if (s1.type == ShapeType::CIRCLE)
+			{
+				return Collision::OBBAndCircle(s2.obb, s1.pos, s1.radius);
+			}
+			return Collision::OBBAndOBB(s1.type == ShapeType::BOX ? BoxToOBB(s1) : s1.obb, s2.obb);
+		case ShapeType::CAPSULE:
+			switch (s1.type)
+			{
+			case ShapeType::CIRCLE: return Collision::CapsuleAndCircle(s2.capsule, s1.pos, s1.radius);
+			case ShapeType::BOX: return Collision::CapsuleAndOBB(s2.capsule, BoxToOBB(s1));
+			case ShapeType::OBB: return Collision::CapsuleAndOBB(s2.capsule, s1.obb);
+			default: return Collision::CapsuleAndCapsule(s1.capsule, s2.capsule);
+			}
+		default:
+			return false;
+		}
+	}
+	/**
+	* @brief CompoundColliderと単純な形状の当たり判定をします
+	* @return 最初に当たった部位の番号。当たらなければ-1
+	*/
+	[[nodiscard]] static int TestCompound(const ECS::CompoundCollider& c, const Shape& other) noexcept
+	{
+		if (!TestPrimitive(BoundToShape(c), other))
+		{
+			return -1;
+		}
+		for (size_t i = 0; i < c.size(); ++i)
+		{
+			const auto& part = c.part(int(i));
+			if (part.isActive && TestPrimitive(PartToShape(part), other))
+			{
+				return int(i);
+			}
+		}
+		return -1;
+	}
+public:
+	//!Entityのコライダーから形状を取り出します
+	[[nodiscard]] static Shape GetShape(const ECS::Entity* e)
+	{
+		Shape s;
+		if (e->hasComponent<ECS::CompoundCollider>())
+		{
+			s.type = ShapeType::COMPOUND;
+			s.compound = &e->getComponent<ECS::CompoundCollider>();
+		}
+		else if (e->hasComponent<ECS::OBBCollider>())
+		{
+			s.type = ShapeType::OBB;
+			s.obb = e->getComponent<ECS::OBBCollider>().shape();
+		}
+		else if (e->hasComponent<ECS::CapsuleCollider>())
+		{
+			s.type = ShapeType::CAPSULE;
+			s.capsule = e->getComponent<ECS::CapsuleCollider>().shape();
+		}
+		else if (e->hasComponent<ECS::CircleCollider>())
+		{
+			const auto& c = e->getComponent<ECS::CircleCollider>();
+			s.type = ShapeType::CIRCLE;
+			s.pos = Vec2(c.x(), c.y());
+			s.radius = c.radius();
+		}
+		else if (e->hasComponent<ECS::BoxCollider>())
+		{
+			const auto& b = e->getComponent<ECS::BoxCollider>();
+			s.type = ShapeType::BOX;
+			s.pos = Vec2(b.x(), b.y());
+			s.size = Vec2(b.w(), b.h());
+		}
+		return s;
+	}
+
+	/**
+	* @brief 2つの形状の当たり判定をします
+	* @param shape1 形状
+	* @param shape2 形状
+	* @param hit 当たった部位の番号が返ります。不要ならnullptr
+	*/
+	[[nodiscard]] static bool Test(const Shape& shape1, const Shape& shape2, HitPart* hit = nullptr) noexcept
+	{
+		HitPart result;
+		bool isHit = false;
+		if (shape1.type == ShapeType::COMPOUND && shape2.type == ShapeType::COMPOUND)
+		{
+			//バウンディング円同士で外れていれば部位は調べない
+			if (TestPrimitive(BoundToShape(*shape1.compound), BoundToShape(*shape2.compound)))
+			{
+				for (size_t i = 0; i < shape1.compound->size() && !isHit; ++i)
+				{
+					const auto& part = shape1.compound->part(int(i));
+					if (!part.isActive)
+					{
+						continue;
+					}
+					result.part2 = TestCompound(*shape2.compound, PartToShape(part));
+					if (result.part2 >= 0)
+					{
+						result.part1 = int(i);
+						isHit = true;
+					}
+				}
+			}
+		}
+		else if (shape1.type == ShapeType::COMPOUND)
+		{
+			result.part1 = TestCompound(*shape1.compound, shape2);
+			isHit = result.part1 >= 0;
+		}
+		else if (shape2.type == ShapeType::COMPOUND)
+		{
+			result.part2 = TestCompound(*shape2.compound, shape1);
+			isHit = result.part2 >= 0;
+		}
+		else
+		{
+			isHit = TestPrimitive(shape1, shape2);
+		}
+		if (hit != nullptr)
+		{
+			*hit = isHit ? result : HitPart();
+		}
+		return isHit;
+	}
+
+	//!2つのEntityの当たり判定をします
+	[[nodiscard]] static bool Test(const ECS::Entity* e1, const ECS::Entity* e2, HitPart* hit = nullptr)
+	{
+		return Test(GetShape(e1), GetShape(e2), hit);
+	}
+
+	/**
+	* @brief 候補ペアのうち当たっていないものを取り除きます
+	* @param pairs BroadPhase::findPairs()などで求めた候補ペア。当たっているペアだけが元の順番で残ります
+	* @param threadNum 使うスレッドの数。0ならThreadPoolのスレッド数になります
+	* @details 判定はペアごとに独立しているのでスレッドプールで並列に行い、結果の詰め直しだけを元の順番で行います。
+	* 当たった部位の番号はhitParts()で取得できます。
+	* OBBColliderとCapsuleColliderのsin,cosはupdate()で求めたものを使うので、ここでは三角関数を計算しません
+	*/
+	void filter(std::vector<BroadPhase::Pair>& pairs, const size_t threadNum = 0)
+	{
+		results_.resize(pairs.size());
+		hitParts_.resize(pairs.size());
+		ThreadPool::Get().parallelFor(pairs.size(), threadNum, [this, &pairs](const size_t begin, const size_t end, const size_t)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				results_[i] = Test(pairs[i].a, pairs[i].b, &hitParts_[i]) ? 1 : 0;
+			}
+		});
+		size_t num = 0;
+		for (size_t i = 0; i < pairs.size(); ++i)
+		{
+			if (results_[i])
+			{
+				hitParts_[num] = hitParts_[i];
+				pairs[num++] = pairs[i];
+			}
+		}
+		pairs.resize(num);
+		hitParts_.resize(num);
+	}
+	//!直前のfilter()で残ったペアごとの当たった部位の番号を返します。part1がPair::a、part2がPair::bの部位です
+	[[nodiscard]] const std::vector<HitPart>& hitParts() const
+	{
+		return hitParts_;
+	}
+};
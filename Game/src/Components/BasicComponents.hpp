@@ -6,6 +6,8 @@
 * @par History
 - 2018/12/19 tonarinohito
 -# Canvas追加
+- 2026/10/18 tonarinohito
+-# PhysicsをPhysics.hppへ移動
 */
 #pragma once
 #include "../ECS/ECS.hpp"
@@ -99,122 +101,6 @@ namespace ECS
 		{}
 	};
 
-	/*
-	@brief Entityに重力を加えます。
-	また簡易的な衝突応答処理も含まれますが、これは明示的に呼び出してください
-	@details Gravity, Velocity, Positionが必要です。衝突応答を行う場合はColliderが必要です
-	@TODO 現状だと1つのグループとの衝突応答しかできないのでこれを別のコンポーネントにするかもしれない
-	*/
-	class Physics final : public ComponentSystem
-	{
-	private:
-
-		Gravity* gravity_ = nullptr;
-		Velocity* velocity_ = nullptr;
-		Position* pos_ = nullptr;
-		std::vector<Entity*> otherEntity_{};
-		std::function<bool(const Entity&, const Entity&)> collisionFunc_;
-		void checkMove(Vec2& pos, Vec2& velocity)
-		{
-			Vec2 pointEntityMove(velocity);
-			//横軸に対する移動
-			while (pointEntityMove.x != 0.f)
-			{
-				float preX = pos.x;
-
-				if (pointEntityMove.x >= 1)
-				{
-					pos.x += 1; pointEntityMove.x -= 1;
-				}
-				else if (pointEntityMove.x <= -1)
-				{
-					pos.x -= 1; pointEntityMove.x += 1;
-				}
-				else
-				{
-					pos.x += pointEntityMove.x;
-					pointEntityMove.x = 0;
-				}
-				for (const auto& it : otherEntity_)
-				{
-					if (collisionFunc_(*owner, *it))
-					{
-						velocity_->val.x = 0;
-						pos.x = preX;		//移動をキャンセル
-						break;
-					}
-				}
-
-			}
-			//縦軸に対する移動
-			while (pointEntityMove.y != 0.f)
-			{
-				float preY = pos.y;
-				if (pointEntityMove.y >= 1)
-				{
-					pos.y += 1; pointEntityMove.y -= 1;
-				}
-				else if (pointEntityMove.y <= -1)
-				{
-					pos.y -= 1; pointEntityMove.y += 1;
-				}
-				else
-				{
-					pos.y += pointEntityMove.y;
-					pointEntityMove.y = 0;
-				}
-				for (const auto& it : otherEntity_)
-				{
-					if (collisionFunc_(*owner, *it))
-					{
-						velocity_->val.y = 0;
-						pos.y = preY;		//移動をキャンセル
-						break;
-					}
-				}
-			}
-		}
-	public:
-		void initialize() override
-		{
-			if (!owner->hasComponent<Gravity>())
-			{
-				owner->addComponent<Gravity>();
-			}
-			if (!owner->hasComponent<Velocity>())
-			{
-				owner->addComponent<Velocity>();
-			}
-			velocity_ = &owner->getComponent<Velocity>();
-			gravity_ = &owner->getComponent<Gravity>();
-			pos_ = &owner->getComponent<Position>();
-		}
-		void update() override
-		{
-			velocity_->val.y += gravity_->val;
-			checkMove(pos_->val, velocity_->val);
-		}
-		void setVelocity(const float& x, const float& y)
-		{
-			velocity_->val.x = x;
-			velocity_->val.y = y;
-		}
-		void setGravity(const float& g = Gravity::DEFAULT)
-		{
-			gravity_->val = g;
-		}
-		//!あたり判定の関数をセットする
-		void setCollisionFunction(std::function<bool(const Entity&, const Entity&)> func)
-		{
-			collisionFunc_ = func;
-		}
-		//!引数に指定したEntityにめり込まないようにする
-		void pushOutEntity(std::vector<Entity*>&  e)
-		{
-			otherEntity_ = e;
-		}
-	};
-
 	/*!
 	@brief PositionとRotationとScaleの親子をsetParent()で作ります
 	@detail 親子関係を作ると生のPosition等のデータを直接変更できなくなります
@@ -3,15 +3,59 @@
 * @brief コリジョンに必要なコンポーネント群です。
 * @author tonarinohito
 * @date 2018/10/05
+* @par History
+- 2026/10/18 tonarinohito
+-# CircleColliderに前フレーム座標の記録(sweepEnable)を追加
+-# 画像のアルファ値によるピクセル単位の判定を行うMaskColliderを追加
+-# Rotationに追従するOBBColliderとCapsuleColliderを追加
+-# 複数の形状を1つのEntityにまとめるCompoundColliderを追加
+-# 当たり判定の表示をDebugDrawにまとめ、リリースビルドでは表示の処理を含めないようにした
 */
 #pragma once
 #include "../ECS/ECS.hpp"
 #include "BasicComponents.hpp"
 #include "../Collision/Collision.hpp"
+#include "../Collision/CollisionMask.hpp"
+#include "../Class/ResourceManager.hpp"
+#include "../Renderer/DebugDraw.hpp"
 #include <DxLib.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
 
 namespace ECS
 {
+	//!回転した矩形の形状です。Collisionの判定に使います
+	struct OBBShape
+	{
+		Vec2 center;
+		//!中心から辺までの距離(幅と高さの半分)
+		Vec2 half;
+		//!ローカルのx軸の向き(cos, sin)。y軸は(-sin, cos)です
+		Vec2 axis{ 1.f, 0.f };
+		//!回転が90度の倍数ならtrue
+		bool isAxisAligned = true;
+	};
+	//!カプセル(線分を半径分太らせた形)の形状です。Collisionの判定に使います
+	struct CapsuleShape
+	{
+		Vec2 p1;
+		Vec2 p2;
+		float radius = 0.f;
+	};
+
+	//!回転のsinとcosを求めます。90度の倍数では誤差が出ないように丸めます
+	inline void RotationToAxis(const float degree, Vec2& axis, bool& isAxisAligned)
+	{
+		const float rad = degree * (3.14159265f / 180.f);
+		axis.x = cosf(rad);
+		axis.y = sinf(rad);
+		constexpr float EPSILON = 1e-6f;
+		if (fabsf(axis.x) < EPSILON) { axis.x = 0.f; axis.y = axis.y > 0.f ? 1.f : -1.f; }
+		if (fabsf(axis.y) < EPSILON) { axis.y = 0.f; axis.x = axis.x > 0.f ? 1.f : -1.f; }
+		isAxisAligned = axis.x == 0.f || axis.y == 0.f;
+	}
+
 	class IBoxCollider
 	{
 	public:
@@ -62,6 +106,10 @@ namespace ECS
 		virtual float x() const = 0;
 		/** @brief y座標を返します、この値はオフセットされた値です*/
 		virtual float y() const = 0;
+		/** @brief 前フレームのx座標を返します、この値はオフセットされた値です*/
+		virtual float prevX() const = 0;
+		/** @brief 前フレームのy座標を返します、この値はオフセットされた値です*/
+		virtual float prevY() const = 0;
 	};
 
 	/*!
@@ -98,16 +146,18 @@ namespace ECS
 		}
 		void draw2D() override
 		{
+#ifdef DEBUG_DRAW_ENABLE
 			if (isDraw_)
 			{
 				auto convert = pos_->val.offsetCopy(offSetPos_.x, offSetPos_.y);
-				DrawBoxAA(
+				DebugDraw::Get().box(DebugDraw::Category::COLLIDER,
 					convert.x,
 					convert.y,
 					convert.x + w(),
 					convert.y + h(),
-					color_, isFill_, 2);
+					color_, isFill_);
 			}
+#endif
 		}
 		void setColor(const int r, const int g, const int b) override
 		{
@@ -132,16 +182,20 @@ namespace ECS
 	/*!
 	@brief 円です
 	@details  Positionが必要です
+	* - sweepEnable()で前フレームの座標を保持し、連続的な当たり判定(Collision::SweptCircleAndCircle等)に使えます
+	* - 前フレームの座標はcommitPosition()(通常はBroadPhase::commitPositions())で更新されます
 	*/
 	class CircleCollider final : public ComponentSystem, public ICircleCollider
 	{
 	private:
 		Position* pos_ = nullptr;
 		Vec2 offSetPos_;
+		Vec2 prevPos_;
 		float r_;
 		unsigned int color_ = 4294967295;
 		bool isFill_ = false;
 		bool isDraw_ = true;
+		bool isSweep_ = false;
 	public:
 		explicit CircleCollider(const float r)
 		{
@@ -154,19 +208,21 @@ namespace ECS
 		void initialize() override
 		{
 			pos_ = &owner->getComponent<Position>();
+			prevPos_ = pos_->val;
 		}
 		void draw2D() override
 		{
+#ifdef DEBUG_DRAW_ENABLE
 			if (isDraw_)
 			{
 				auto convert = pos_->val.offsetCopy(offSetPos_.x, offSetPos_.y);
-				DrawCircleAA(
+				DebugDraw::Get().circle(DebugDraw::Category::COLLIDER,
 					convert.x,
 					convert.y,
 					r_,
-					24,
-					color_, isFill_, 2);
+					color_, isFill_);
 			}
+#endif
 		}
 		void setColor(const int r, const int g, const int b) override
 		{
@@ -184,6 +240,551 @@ namespace ECS
 		float radius() const override { return r_; }
 		float x() const override { return pos_->val.x + offSetPos_.x; }
 		float y() const override { return pos_->val.y + offSetPos_.y; }
+		float prevX() const override { return (isSweep_ ? prevPos_.x : pos_->val.x) + offSetPos_.x; }
+		float prevY() const override { return (isSweep_ ? prevPos_.y : pos_->val.y) + offSetPos_.y; }
+		/** @brief 前フレームの座標を記録し、移動の軌跡で判定するようにします*/
+		void sweepEnable()
+		{
+			isSweep_ = true;
+			prevPos_ = pos_->val;
+		}
+		/** @brief 軌跡での判定を無効にします*/
+		void sweepDisable() { isSweep_ = false; }
+		/** @brief 軌跡での判定が有効か返します*/
+		bool isSweep() const { return isSweep_; }
+		/** @brief 現在の座標を前フレームの座標として記録します。ワープ直後に呼ぶと軌跡が途切れます*/
+		void commitPosition() { prevPos_ = pos_->val; }
+	};
+
+	/*!
+	@brief 画像のアルファ値から作ったマスクでピクセル単位の判定をします
+	@details  Positionが必要です。Rotationがあれば回転にも追従します
+	* - 画像はResourceManager::GetGraph().loadWithMask()でロードしてください
+	* - 回転は360 / CollisionMaskSet::ROTATION_NUM度刻みで扱います。拡大率には対応していません
+	* - 基準座標はSpriteDrawと同じく画像の中心です。SpriteDrawの基準座標を変えた場合はsetPivot()で合わせてください
+	* - 外接矩形を返すのでBoxColliderと同じように扱えます
+	*/
+	class MaskCollider final : public ComponentSystem, public IBoxCollider
+	{
+	private:
+		Position* pos_ = nullptr;
+		Rotation* rota_ = nullptr;
+		const CollisionMaskSet* masks_ = nullptr;
+		Vec2 offSetPos_;
+		Vec2 pivot_;
+		unsigned int color_ = 4294967295;
+		bool isFill_ = false;
+		bool isDraw_ = true;
+	public:
+		//!登録した画像名を指定して初期化します
+		explicit MaskCollider(const char* name)
+		{
+			assert(ResourceManager::GetGraph().hasMask(name) && "mask is not created");
+			masks_ = &ResourceManager::GetGraph().getMask(name);
+			pivot_.x = float(masks_->w()) / 2.f;
+			pivot_.y = float(masks_->h()) / 2.f;
+		}
+		~MaskCollider()
+		{
+			pos_ = nullptr;
+			rota_ = nullptr;
+		}
+		void initialize() override
+		{
+			pos_ = &owner->getComponent<Position>();
+			if (owner->hasComponent<Rotation>())
+			{
+				rota_ = &owner->getComponent<Rotation>();
+			}
+		}
+		void draw2D() override
+		{
+#ifdef DEBUG_DRAW_ENABLE
+			if (isDraw_)
+			{
+				DebugDraw::Get().box(DebugDraw::Category::COLLIDER, x(), y(), x() + w(), y() + h(), color_, isFill_);
+			}
+#endif
+		}
+		//!現在の回転に対応するマスクの番号を返します
+		[[nodiscard]] int rotationIndex() const
+		{
+			return rota_ != nullptr ? CollisionMaskSet::RotationIndex(rota_->val) : 0;
+		}
+		//!指定した番号のマスクを返します
+		[[nodiscard]] const CollisionMask& getMask(const int index) const
+		{
+			return masks_->get(index);
+		}
+		//!指定した番号のマスクを置いたときの左上の座標を返します
+		[[nodiscard]] Vec2_i maskPosition(const int index) const
+		{
+			const auto& mask = masks_->get(index);
+			//基準座標を中心に回転させた画像の中心
+			const float cx = float(masks_->w()) / 2.f - pivot_.x;
+			const float cy = float(masks_->h()) / 2.f - pivot_.y;
+			const float s = masks_->sin(index);
+			const float c = masks_->cos(index);
+			const float left = pos_->val.x + offSetPos_.x + cx * c - cy * s + mask.offset().x;
+			const float top = pos_->val.y + offSetPos_.y + cx * s + cy * c + mask.offset().y;
+			return Vec2_i(int(floorf(left + 0.5f)), int(floorf(top + 0.5f)));
+		}
+		//!基準座標を引数で指定します
+		void setPivot(const Vec2& pivot)
+		{
+			pivot_ = pivot;
+		}
+		void setColor(const int r, const int g, const int b) override
+		{
+			color_ = GetColor(r, g, b);
+		}
+		void setOffset(const float x, const float y) override
+		{
+			offSetPos_.x = x;
+			offSetPos_.y = y;
+		}
+		void fillEnable() override { isFill_ = true; }
+		void fillDisable() override { isFill_ = false; }
+		void drawEnable() override { isDraw_ = true; }
+		void drawDisable() override { isDraw_ = false; }
+		float w() const override { return float(masks_->get(rotationIndex()).w()); }
+		float h() const override { return float(masks_->get(rotationIndex()).h()); }
+		float x() const override { return float(maskPosition(rotationIndex()).x); }
+		float y() const override { return float(maskPosition(rotationIndex()).y); }
+	};
+
+	/*!
+	@brief 回転する矩形です
+	@details  Positionが必要です。Rotationがあれば回転に追従します
+	* - 中心が Position + オフセット です。SpriteDrawと同じく中心を基準に回転し、オフセットも一緒に回ります
+	* - 回転のsin,cosはupdate()で1フレームに1度だけ求めます。update()の後に回転を変えた場合はrefresh()を呼んでください
+	* - w(),h(),x(),y()は回転後の外接矩形を返すので、BroadPhaseやBoxAndBoxでの大まかな判定に使えます
+	*/
+	class OBBCollider final : public ComponentSystem, public IBoxCollider
+	{
+	private:
+		Position* pos_ = nullptr;
+		Rotation* rota_ = nullptr;
+		Vec2 offSetPos_;
+		Vec2 half_;
+		Vec2 axis_{ 1.f, 0.f };
+		bool isAxisAligned_ = true;
+		unsigned int color_ = 4294967295;
+		bool isFill_ = false;
+		bool isDraw_ = true;
+		//!外接矩形の中心から辺までの距離
+		[[nodiscard]] Vec2 extent() const
+		{
+			return Vec2(fabsf(axis_.x) * half_.x + fabsf(axis_.y) * half_.y, fabsf(axis_.y) * half_.x + fabsf(axis_.x) * half_.y);
+		}
+	public:
+		explicit OBBCollider(const Vec2& size) :
+			half_(size.x / 2.f, size.y / 2.f)
+		{}
+		explicit OBBCollider(const float ww, const float hh) :
+			half_(ww / 2.f, hh / 2.f)
+		{}
+		~OBBCollider()
+		{
+			pos_ = nullptr;
+			rota_ = nullptr;
+		}
+		void initialize() override
+		{
+			pos_ = &owner->getComponent<Position>();
+			if (owner->hasComponent<Rotation>())
+			{
+				rota_ = &owner->getComponent<Rotation>();
+			}
+			refresh();
+		}
+		void update() override
+		{
+			refresh();
+		}
+		void draw2D() override
+		{
+#ifdef DEBUG_DRAW_ENABLE
+			if (isDraw_)
+			{
+				const Vec2 c = center();
+				const Vec2 u(axis_.x * half_.x, axis_.y * half_.x);
+				const Vec2 v(-axis_.y * half_.y, axis_.x * half_.y);
+				DebugDraw::Get().quad(DebugDraw::Category::COLLIDER,
+					c.x - u.x - v.x, c.y - u.y - v.y,
+					c.x + u.x - v.x, c.y + u.y - v.y,
+					c.x + u.x + v.x, c.y + u.y + v.y,
+					c.x - u.x + v.x, c.y - u.y + v.y,
+					color_, isFill_);
+			}
+#endif
+		}
+		//!回転からsin,cosを求め直します
+		void refresh()
+		{
+			RotationToAxis(rota_ != nullptr ? rota_->val : 0.f, axis_, isAxisAligned_);
+		}
+		void setColor(const int r, const int g, const int b) override
+		{
+			color_ = GetColor(r, g, b);
+		}
+		void setOffset(const float x, const float y) override
+		{
+			offSetPos_.x = x;
+			offSetPos_.y = y;
+		}
+		void fillEnable() override { isFill_ = true; }
+		void fillDisable() override { isFill_ = false; }
+		void drawEnable() override { isDraw_ = true; }
+		void drawDisable() override { isDraw_ = false; }
+		float w() const override { return extent().x * 2.f; }
+		float h() const override { return extent().y * 2.f; }
+		float x() const override { return center().x - extent().x; }
+		float y() const override { return center().y - extent().y; }
+		/** @brief 回転の中心座標を返します。オフセットも回転させた値です*/
+		[[nodiscard]] Vec2 center() const
+		{
+			return Vec2(
+				pos_->val.x + offSetPos_.x * axis_.x - offSetPos_.y * axis_.y,
+				pos_->val.y + offSetPos_.x * axis_.y + offSetPos_.y * axis_.x);
+		}
+		/** @brief 判定に使う形状を返します*/
+		[[nodiscard]] OBBShape shape() const
+		{
+			return OBBShape{ center(), half_, axis_, isAxisAligned_ };
+		}
+	};
+
+	/*!
+	@brief カプセル(線分を半径分太らせた形)です。レーザーや細長い敵に使います
+	@details  Positionが必要です。Rotationがあれば回転に追従します
+	* - 線分の中点が Position + オフセット です。回転が0度のとき線分は横向きになります
+	* - 回転のsin,cosはupdate()で1フレームに1度だけ求めます。update()の後に回転を変えた場合はrefresh()を呼んでください
+	*/
+	class CapsuleCollider final : public ComponentSystem
+	{
+	private:
+		Position* pos_ = nullptr;
+		Rotation* rota_ = nullptr;
+		Vec2 offSetPos_;
+		float halfLength_;
+		float r_;
+		Vec2 axis_{ 1.f, 0.f };
+		bool isAxisAligned_ = true;
+		unsigned int color_ = 4294967295;
+		bool isDraw_ = true;
+	public:
+		/**
+		* @brief カプセルを作ります
+		* @param length 線分の長さ。全体の長さは length + 2 * r になります
+		* @param r 半径
+		*/
+		explicit CapsuleCollider(const float length, const float r) :
+			halfLength_(length / 2.f),
+			r_(r)
+		{}
+		~CapsuleCollider()
+		{
+			pos_ = nullptr;
+			rota_ = nullptr;
+		}
+		void initialize() override
+		{
+			pos_ = &owner->getComponent<Position>();
+			if (owner->hasComponent<Rotation>())
+			{
+				rota_ = &owner->getComponent<Rotation>();
+			}
+			refresh();
+		}
+		void update() override
+		{
+			refresh();
+		}
+		void draw2D() override
+		{
+#ifdef DEBUG_DRAW_ENABLE
+			if (isDraw_)
+			{
+				const auto s = shape();
+				DebugDraw::Get().capsule(DebugDraw::Category::COLLIDER, s.p1.x, s.p1.y, s.p2.x, s.p2.y, r_, color_);
+			}
+#endif
+		}
+		//!回転からsin,cosを求め直します
+		void refresh()
+		{
+			RotationToAxis(rota_ != nullptr ? rota_->val : 0.f, axis_, isAxisAligned_);
+		}
+		/** @brief コリジョンの色を指定します*/
+		void setColor(const int r, const int g, const int b)
+		{
+			color_ = GetColor(r, g, b);
+		}
+		/** @brief コリジョンの位置を変更します。回転前の値です*/
+		void setOffset(const float x, const float y)
+		{
+			offSetPos_.x = x;
+			offSetPos_.y = y;
+		}
+		/** @brief コリジョンの描画を有効にします*/
+		void drawEnable() { isDraw_ = true; }
+		/** @brief コリジョンの描画を無効にします*/
+		void drawDisable() { isDraw_ = false; }
+		/** @brief 半径を返します*/
+		[[nodiscard]] float radius() const { return r_; }
+		/** @brief 線分の中点を返します。オフセットも回転させた値です*/
+		[[nodiscard]] Vec2 center() const
+		{
+			return Vec2(
+				pos_->val.x + offSetPos_.x * axis_.x - offSetPos_.y * axis_.y,
+				pos_->val.y + offSetPos_.x * axis_.y + offSetPos_.y * axis_.x);
+		}
+		/** @brief 判定に使う形状を返します*/
+		[[nodiscard]] CapsuleShape shape() const
+		{
+			const Vec2 c = center();
+			const Vec2 d(axis_.x * halfLength_, axis_.y * halfLength_);
+			return CapsuleShape{ Vec2(c.x - d.x, c.y - d.y), Vec2(c.x + d.x, c.y + d.y), r_ };
+		}
+		/** @brief 外接矩形の左上を返します*/
+		[[nodiscard]] Vec2 boundsMin() const
+		{
+			const auto s = shape();
+			return Vec2((s.p1.x < s.p2.x ? s.p1.x : s.p2.x) - r_, (s.p1.y < s.p2.y ? s.p1.y : s.p2.y) - r_);
+		}
+		/** @brief 外接矩形の右下を返します*/
+		[[nodiscard]] Vec2 boundsMax() const
+		{
+			const auto s = shape();
+			return Vec2((s.p1.x > s.p2.x ? s.p1.x : s.p2.x) + r_, (s.p1.y > s.p2.y ? s.p1.y : s.p2.y) + r_);
+		}
+	};
+
+	//!CompoundColliderを構成する形状の1つです
+	struct CompoundPart
+	{
+		enum class Type : uint8_t
+		{
+			CIRCLE,
+			OBB,
+			CAPSULE,
+		};
+		Type type = Type::CIRCLE;
+		//!falseなら判定しません。壊れた部位などに使います
+		bool isActive = true;
+		//!Entityの回転の中心から形状の中心までのオフセット(回転前)
+		Vec2 offset;
+		//!矩形なら幅と高さの半分、カプセルならxが線分の長さの半分
+		Vec2 half;
+		//!円とカプセルの半径
+		float radius = 0.f;
+		//!Entityの回転に対する形状自体の向き
+		Vec2 localAxis{ 1.f, 0.f };
+		bool isLocalAxisAligned = true;
+		//!以下はrefresh()で求めたワールド座標での形状です
+		Vec2 center;
+		OBBShape obb;
+		CapsuleShape capsule;
+	};
+
+	/*!
+	@brief 複数の形状(円、回転する矩形、カプセル)をまとめたコライダーです。ボスの本体や腕、弱点などに使います
+	@details  Positionが必要です。Rotationがあれば全体が回転に追従します
+	* - 各形状はPositionを中心としたローカル座標で追加します。add〜()の戻り値が部位の番号です
+	* - 全体を囲む円(バウンディング円)を持ち、BroadPhaseにはこの円を囲む範囲が1つだけ登録されます
+	* - NarrowPhaseではバウンディング円で当たった場合だけ各形状を判定し、当たった部位の番号を返します
+	* - 部位は追加した順に判定されるので、弱点など優先したい部位を先に追加してください
+	* - 回転のsin,cosはupdate()で1フレームに1度だけ求めます。update()の後に回転を変えた場合はrefresh()を呼んでください
+	*/
+	class CompoundCollider final : public ComponentSystem
+	{
+	private:
+		Position* pos_ = nullptr;
+		Rotation* rota_ = nullptr;
+		std::vector<CompoundPart> parts_;
+		float boundRadius_ = 0.f;
+		Vec2 axis_{ 1.f, 0.f };
+		bool isAxisAligned_ = true;
+		unsigned int color_ = 4294967295;
+		bool isDraw_ = true;
+
+		//!ローカルの向きをEntityの向きで回します。どちらも90度の倍数なら結果も誤差無く90度の倍数になります
+		[[nodiscard]] Vec2 rotate(const Vec2& v) const
+		{
+			return Vec2(v.x * axis_.x - v.y * axis_.y, v.x * axis_.y + v.y * axis_.x);
+		}
+		int addPart(CompoundPart& part, const float degree, const float reach)
+		{
+			RotationToAxis(degree, part.localAxis, part.isLocalAxisAligned);
+			const float bound = part.offset.length() + reach;
+			if (bound > boundRadius_)
+			{
+				boundRadius_ = bound;
+			}
+			parts_.emplace_back(part);
+			if (pos_ != nullptr)
+			{
+				refreshPart(parts_.back());
+			}
+			return int(parts_.size()) - 1;
+		}
+		void refreshPart(CompoundPart& part) const
+		{
+			const Vec2 offset = rotate(part.offset);
+			part.center = Vec2(pos_->val.x + offset.x, pos_->val.y + offset.y);
+			switch (part.type)
+			{
+			case CompoundPart::Type::OBB:
+				part.obb = OBBShape{ part.center, part.half, rotate(part.localAxis), isAxisAligned_ && part.isLocalAxisAligned };
+				break;
+			case CompoundPart::Type::CAPSULE:
+			{
+				const Vec2 axis = rotate(part.localAxis);
+				const Vec2 d(axis.x * part.half.x, axis.y * part.half.x);
+				part.capsule = CapsuleShape{ Vec2(part.center.x - d.x, part.center.y - d.y), Vec2(part.center.x + d.x, part.center.y + d.y), part.radius };
+				break;
+			}
+			default:
+				break;
+			}
+		}
+	public:
+		~CompoundCollider()
+		{
+			pos_ = nullptr;
+			rota_ = nullptr;
+		}
+		void initialize() override
+		{
+			pos_ = &owner->getComponent<Position>();
+			if (owner->hasComponent<Rotation>())
+			{
+				rota_ = &owner->getComponent<Rotation>();
+			}
+			refresh();
+		}
+		void update() override
+		{
+			refresh();
+		}
+		void draw2D() override
+		{
+#ifdef DEBUG_DRAW_ENABLE
+			if (isDraw_ && DebugDraw::Get().isEnabled(DebugDraw::Category::COLLIDER))
+			{
+				for (const auto& it : parts_)
+				{
+					if (!it.isActive)
+					{
+						continue;
+					}
+					switch (it.type)
+					{
+					case CompoundPart::Type::CIRCLE:
+						DebugDraw::Get().circle(DebugDraw::Category::COLLIDER, it.center.x, it.center.y, it.radius, color_);
+						break;
+					case CompoundPart::Type::OBB:
+					{
+						const Vec2& c = it.obb.center;
+						const Vec2 u(it.obb.axis.x * it.obb.half.x, it.obb.axis.y * it.obb.half.x);
+						const Vec2 v(-it.obb.axis.y * it.obb.half.y, it.obb.axis.x * it.obb.half.y);
+						DebugDraw::Get().quad(DebugDraw::Category::COLLIDER,
+							c.x - u.x - v.x, c.y - u.y - v.y,
+							c.x + u.x - v.x, c.y + u.y - v.y,
+							c.x + u.x + v.x, c.y + u.y + v.y,
+							c.x - u.x + v.x, c.y - u.y + v.y,
+							color_);
+						break;
+					}
+					case CompoundPart::Type::CAPSULE:
+					{
+						const auto& s = it.capsule;
+						DebugDraw::Get().capsule(DebugDraw::Category::COLLIDER, s.p1.x, s.p1.y, s.p2.x, s.p2.y, s.radius, color_);
+						break;
+					}
+					}
+				}
+			}
+#endif
+		}
+		//!回転からsin,cosを求め直し、各形状のワールド座標を更新します
+		void refresh()
+		{
+			RotationToAxis(rota_ != nullptr ? rota_->val : 0.f, axis_, isAxisAligned_);
+			for (auto& it : parts_)
+			{
+				refreshPart(it);
+			}
+		}
+		/**
+		* @brief 円を追加します
+		* @param offset 回転の中心からのオフセット(回転前)
+		* @param r 半径
+		* @return 部位の番号
+		*/
+		int addCircle(const Vec2& offset, const float r)
+		{
+			CompoundPart part;
+			part.type = CompoundPart::Type::CIRCLE;
+			part.offset = offset;
+			part.radius = r;
+			return addPart(part, 0.f, r);
+		}
+		/**
+		* @brief 回転する矩形を追加します
+		* @param offset 回転の中心から矩形の中心までのオフセット(回転前)
+		* @param size 幅と高さ
+		* @param degree Entityの回転に加える矩形自体の回転(度数法)
+		* @return 部位の番号
+		*/
+		int addBox(const Vec2& offset, const Vec2& size, const float degree = 0.f)
+		{
+			CompoundPart part;
+			part.type = CompoundPart::Type::OBB;
+			part.offset = offset;
+			part.half = Vec2(size.x / 2.f, size.y / 2.f);
+			return addPart(part, degree, part.half.length());
+		}
+		/**
+		* @brief カプセルを追加します
+		* @param offset 回転の中心から線分の中点までのオフセット(回転前)
+		* @param length 線分の長さ
+		* @param r 半径
+		* @param degree Entityの回転に加えるカプセル自体の回転(度数法)。0度で横向きです
+		* @return 部位の番号
+		*/
+		int addCapsule(const Vec2& offset, const float length, const float r, const float degree = 0.f)
+		{
+			CompoundPart part;
+			part.type = CompoundPart::Type::CAPSULE;
+			part.offset = offset;
+			part.half = Vec2(length / 2.f, 0.f);
+			part.radius = r;
+			return addPart(part, degree, part.half.x + r);
+		}
+		/** @brief 部位の判定を有効、無効にします*/
+		void setActive(const int index, const bool isActive)
+		{
+			parts_[size_t(index)].isActive = isActive;
+		}
+		/** @brief コリジョンの色を指定します*/
+		void setColor(const int r, const int g, const int b)
+		{
+			color_ = GetColor(r, g, b);
+		}
+		/** @brief コリジョンの描画を有効にします*/
+		void drawEnable() { isDraw_ = true; }
+		/** @brief コリジョンの描画を無効にします*/
+		void drawDisable() { isDraw_ = false; }
+		/** @brief 部位の数を返します*/
+		[[nodiscard]] size_t size() const { return parts_.size(); }
+		/** @brief 部位を返します。形状はrefresh()の時点のワールド座標です*/
+		[[nodiscard]] const CompoundPart& part(const int index) const { return parts_[size_t(index)]; }
+		/** @brief バウンディング円の中心(回転の中心)を返します*/
+		[[nodiscard]] const Vec2& boundCenter() const { return pos_->val; }
+		/** @brief すべての部位を囲む円の半径を返します。部位の回転によらず一定です*/
+		[[nodiscard]] float boundRadius() const { return boundRadius_; }
 	};
 
 	/*!
@@ -221,12 +822,14 @@ namespace ECS
 		}
 		void draw2D() override
 		{
+#ifdef DEBUG_DRAW_ENABLE
 			if (isDraw_)
 			{
 				auto convert_p1 = line_->p1.offsetCopy(offSetPos1_.x, offSetPos1_.y);
 				auto convert_p2 = line_->p2.offsetCopy(offSetPos2_.x, offSetPos2_.y);
-				DrawLineAA(convert_p1.x, convert_p1.y, convert_p2.x, convert_p2.y,color_,1);
+				DebugDraw::Get().line(DebugDraw::Category::COLLIDER, convert_p1.x, convert_p1.y, convert_p2.x, convert_p2.y, color_);
 			}
+#endif
 		}
 		/** @brief 線分の色を指定します*/
 		void setColor(const int r, const int g, const int b) 
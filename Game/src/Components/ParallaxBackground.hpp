@@ -0,0 +1,58 @@
+﻿/**
+* @file ParallaxBackground.hpp
+* @brief タイルマップのレイヤーを重ねた多重スクロールの背景です
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "../ECS/ECS.hpp"
+#include "../Renderer/TileLayer.hpp"
+#include <vector>
+#include <string>
+#include <cassert>
+
+namespace ECS
+{
+	/**
+	* @brief ステージのJSONから読み込んだTileLayerを、レイヤーごとの速さでスクロールして奥から順に描画します
+	* @details レイヤーを増やしても、ステージを長くしても、描画の時間は見えているタイルの数で決まります
+	*/
+	class ParallaxBackground final : public ComponentSystem
+	{
+	private:
+		std::vector<TileLayer> layers_;
+	public:
+		//!ステージのJSONのパスを指定して読み込みます
+		explicit ParallaxBackground(const std::string& stagePath)
+		{
+			if (!TileLayer::LoadStage(stagePath, layers_))
+			{
+				assert(false && "stage load failed");
+			}
+		}
+		void update() override
+		{
+			for (auto& it : layers_)
+			{
+				it.scroll();
+			}
+		}
+		void draw2D() override
+		{
+			for (auto& it : layers_)
+			{
+				it.draw();
+			}
+		}
+		//!レイヤーの数を返します
+		[[nodiscard]] size_t layerNum() const
+		{
+			return layers_.size();
+		}
+		//!奥から数えてindex番目のレイヤーを返します
+		[[nodiscard]] TileLayer& getLayer(const size_t index)
+		{
+			return layers_[index];
+		}
+	};
+}
@@ -0,0 +1,357 @@
+﻿/**
+* @file Physics.hpp
+* @brief 重力と簡易的な衝突応答を行うコンポーネントです
+* @author tonarinohito
+* @date 2018/10/05
+* @par History
+- 2026/10/18 tonarinohito
+-# BasicComponents.hppから移動
+-# 1ピクセルずつ動かす判定をやめ、軸ごとの移動量を矩形から直接求めるようにした
+-# BroadPhaseから衝突相手の候補を取得できるようにした
+-# 衝突相手に自身が含まれていても自身とは判定しないようにした
+*/
+#pragma once
+#include "../ECS/ECS.hpp"
+#include "BasicComponents.hpp"
+#include "../Collision/BroadPhase.hpp"
+#include <vector>
+#include <cmath>
+#include <functional>
+
+namespace ECS
+{
+	/*
+	@brief Entityに重力を加えます。
+	また簡易的な衝突応答処理も含まれますが、これは明示的に呼び出してください
+	@details Gravity, Velocity, Positionが必要です。衝突応答を行う場合はColliderが必要です
+	- 衝突応答は軸ごとに行われ、ぶつかった軸の速度が0になります(壁や床に沿って滑ります)
+	- 止まる位置は従来の1ピクセルずつ動かす判定と同じになるように求めています
+	@TODO 現状だと1つのグループとの衝突応答しかできないのでこれを別のコンポーネントにするかもしれない
+	*/
+	class Physics final : public ComponentSystem
+	{
+	private:
+		using GetBoxFunc = bool(*)(const Entity&, Vec2&, Vec2&);
+		//押し出し判定に使う矩形
+		struct Box
+		{
+			Vec2 pos;
+			Vec2 size;
+		};
+
+		Gravity* gravity_ = nullptr;
+		Velocity* velocity_ = nullptr;
+		Position* pos_ = nullptr;
+		std::vector<Entity*> otherEntity_;
+		const BroadPhase* broadPhase_ = nullptr;
+		Group otherGroup_ = 0;
+		GetBoxFunc getBox_ = &GetBox<BoxCollider>;
+		GetBoxFunc getOtherBox_ = &GetBox<BoxCollider>;
+		std::function<bool(const Entity&, const Entity&)> collisionFunc_;
+		std::vector<Entity*> candidates_;
+		std::vector<Box> obstacles_;
+
+		template<class T>
+		static bool GetBox(const Entity& e, Vec2& pos, Vec2& size)
+		{
+			if (!e.hasComponent<T>())
+			{
+				return false;
+			}
+			const auto& box = e.getComponent<T>();
+			pos.x = box.x();
+			pos.y = box.y();
+			size.x = box.w();
+			size.y = box.h();
+			return true;
+		}
+
+		//!移動で通過する範囲にいる衝突相手を返します
+		const std::vector<Entity*>* getCandidates(const Vec2& velocity)
+		{
+			if (broadPhase_ == nullptr)
+			{
+				return &otherEntity_;
+			}
+			Vec2 pos, size;
+			if (!getBox_(*owner, pos, size))
+			{
+				return nullptr;
+			}
+			const Vec2 min(pos.x + (velocity.x < 0.f ? velocity.x : 0.f), pos.y + (velocity.y < 0.f ? velocity.y : 0.f));
+			const Vec2 max(pos.x + size.x + (velocity.x > 0.f ? velocity.x : 0.f), pos.y + size.y + (velocity.y > 0.f ? velocity.y : 0.f));
+			broadPhase_->queryBox(min, max, otherGroup_, candidates_);
+			return &candidates_;
+		}
+
+		/**
+		* @brief 1軸分の移動量を求めます
+		* @param move 移動したい量
+		* @param selfMin 移動する軸の自身の矩形の始点
+		* @param selfSize 移動する軸の自身の矩形の大きさ
+		* @param perpMin もう一方の軸の自身の矩形の始点
+		* @param perpSize もう一方の軸の自身の矩形の大きさ
+		* @param isX x軸ならtrue
+		* @param isHit 移動中にぶつかったらtrueが返ります
+		* @return 実際に移動できる量
+		* @details 1ピクセルずつ動かした場合と同じ結果になるよう、
+		* 整数ピクセル分の移動とその端数の移動それぞれで最初にぶつかる位置を矩形から直接求めます
+		*/
+		float solveAxis(const float move, const float selfMin, const float selfSize,
+			const float perpMin, const float perpSize, const bool isX, bool& isHit) const
+		{
+			isHit = false;
+			if (move == 0.f)
+			{
+				return 0.f;
+			}
+			const float dist = fabsf(move);
+			const float steps = floorf(dist);
+			const float frac = dist - steps;
+			//stepsより大きい値なら整数ピクセル分の移動は最後まで行える
+			float firstHitStep = steps + 1.f;
+			for (const auto& o : obstacles_)
+			{
+				const float oMin = isX ? o.pos.x : o.pos.y;
+				const float oSize = isX ? o.size.x : o.size.y;
+				const float oPerpMin = isX ? o.pos.y : o.pos.x;
+				const float oPerpSize = isX ? o.size.y : o.size.x;
+				if (!(perpMin < oPerpMin + oPerpSize && oPerpMin < perpMin + perpSize))
+				{
+					continue;
+				}
+				//移動方向の距離lo < s < hiの間は重なっている
+				float lo = oMin - selfMin - selfSize;
+				float hi = oMin + oSize - selfMin;
+				if (move < 0.f)
+				{
+					const float tmp = lo;
+					lo = -hi;
+					hi = -tmp;
+				}
+				//loより大きい最初の整数の位置でぶつかる
+				float step = floorf(lo) + 1.f;
+				if (step < 1.f) { step = 1.f; }
+				if (step < hi && step < firstHitStep)
+				{
+					firstHitStep = step;
+				}
+			}
+			float moved = firstHitStep - 1.f;
+			isHit = firstHitStep <= steps;
+			//ぶつかった後も残りの端数分の移動は試される
+			if (frac > 0.f)
+			{
+				const float s = moved + frac;
+				bool isFracHit = false;
+				for (const auto& o : obstacles_)
+				{
+					const float oMin = isX ? o.pos.x : o.pos.y;
+					const float oSize = isX ? o.size.x : o.size.y;
+					const float oPerpMin = isX ? o.pos.y : o.pos.x;
+					const float oPerpSize = isX ? o.size.y : o.size.x;
+					if (!(perpMin < oPerpMin + oPerpSize && oPerpMin < perpMin + perpSize))
+					{
+						continue;
+					}
+					const float offset = move < 0.f ? -s : s;
+					if (selfMin + offset < oMin + oSize && oMin < selfMin + offset + selfSize)
+					{
+						isFracHit = true;
+						break;
+					}
+				}
+				if (isFracHit)
+				{
+					isHit = true;
+				}
+				else
+				{
+					moved = s;
+				}
+			}
+			return move < 0.f ? -moved : moved;
+		}
+
+		void checkMove(Vec2& pos, Vec2& velocity)
+		{
+			const auto* others = getCandidates(velocity);
+			if (others == nullptr)
+			{
+				pos += velocity;
+				return;
+			}
+			Vec2 selfPos, selfSize;
+			if (collisionFunc_ || !getBox_(*owner, selfPos, selfSize))
+			{
+				stepMove(pos, velocity, *others);
+				return;
+			}
+			obstacles_.clear();
+			for (const auto& it : *others)
+			{
+				Box box;
+				if (it != owner && getOtherBox_(*it, box.pos, box.size))
+				{
+					obstacles_.emplace_back(box);
+				}
+			}
+			//横軸に対する移動
+			bool isHit = false;
+			const float moveX = solveAxis(velocity.x, selfPos.x, selfSize.x, selfPos.y, selfSize.y, true, isHit);
+			pos.x += moveX;
+			selfPos.x += moveX;
+			if (isHit)
+			{
+				velocity_->val.x = 0;
+			}
+			//縦軸に対する移動
+			const float moveY = solveAxis(velocity.y, selfPos.y, selfSize.y, selfPos.x, selfSize.x, false, isHit);
+			pos.y += moveY;
+			if (isHit)
+			{
+				velocity_->val.y = 0;
+			}
+		}
+
+		//!setCollisionFunction()で任意の判定を指定した場合は1ピクセルずつ動かして判定します
+		void stepMove(Vec2& pos, Vec2& velocity, const std::vector<Entity*>& others)
+		{
+			Vec2 pointEntityMove(velocity);
+			//横軸に対する移動
+			while (pointEntityMove.x != 0.f)
+			{
+				float preX = pos.x;
+
+				if (pointEntityMove.x >= 1)
+				{
+					pos.x += 1; pointEntityMove.x -= 1;
+				}
+				else if (pointEntityMove.x <= -1)
+				{
+					pos.x -= 1; pointEntityMove.x += 1;
+				}
+				else
+				{
+					pos.x += pointEntityMove.x;
+					pointEntityMove.x = 0;
+				}
+				for (const auto& it : others)
+				{
+					if (it != owner && collide(*it))
+					{
+						velocity_->val.x = 0;
+						pos.x = preX;		//移動をキャンセル
+						break;
+					}
+				}
+
+			}
+			//縦軸に対する移動
+			while (pointEntityMove.y != 0.f)
+			{
+				float preY = pos.y;
+				if (pointEntityMove.y >= 1)
+				{
+					pos.y += 1; pointEntityMove.y -= 1;
+				}
+				else if (pointEntityMove.y <= -1)
+				{
+					pos.y -= 1; pointEntityMove.y += 1;
+				}
+				else
+				{
+					pos.y += pointEntityMove.y;
+					pointEntityMove.y = 0;
+				}
+				for (const auto& it : others)
+				{
+					if (it != owner && collide(*it))
+					{
+						velocity_->val.y = 0;
+						pos.y = preY;		//移動をキャンセル
+						break;
+					}
+				}
+			}
+		}
+		bool collide(const Entity& other) const
+		{
+			if (collisionFunc_)
+			{
+				return collisionFunc_(*owner, other);
+			}
+			Vec2 pos1, size1, pos2, size2;
+			return getBox_(*owner, pos1, size1) && getOtherBox_(other, pos2, size2) &&
+				Collision::BoxAndBox(pos1, size1, pos2, size2);
+		}
+	public:
+		void initialize() override
+		{
+			if (!owner->hasComponent<Gravity>())
+			{
+				owner->addComponent<Gravity>();
+			}
+			if (!owner->hasComponent<Velocity>())
+			{
+				owner->addComponent<Velocity>();
+			}
+			velocity_ = &owner->getComponent<Velocity>();
+			gravity_ = &owner->getComponent<Gravity>();
+			pos_ = &owner->getComponent<Position>();
+		}
+		void update() override
+		{
+			velocity_->val.y += gravity_->val;
+			checkMove(pos_->val, velocity_->val);
+		}
+		void setVelocity(const float& x, const float& y)
+		{
+			velocity_->val.x = x;
+			velocity_->val.y = y;
+		}
+		void setGravity(const float& g = Gravity::DEFAULT)
+		{
+			gravity_->val = g;
+		}
+		/**
+		* @brief 押し出し判定に使う矩形を指定します
+		* @details テンプレート引数にはIBoxColliderを継承したコンポーネントを指定してください
+		* 第一引数が自身、第二引数が相手の矩形です。指定しない場合はどちらもBoxColliderです
+		*/
+		template<class T = BoxCollider, class T2 = BoxCollider>
+		void setCollisionBox()
+		{
+			getBox_ = &GetBox<T>;
+			getOtherBox_ = &GetBox<T2>;
+			collisionFunc_ = nullptr;
+		}
+		/**
+		* @brief あたり判定の関数をセットする
+		* @details 任意の判定を使う場合は1ピクセルずつ動かして判定するため重くなります。
+		* 矩形同士で良い場合はsetCollisionBox()を使ってください
+		*/
+		void setCollisionFunction(std::function<bool(const Entity&, const Entity&)> func)
+		{
+			collisionFunc_ = func;
+		}
+		//!引数に指定したEntityにめり込まないようにする。自身が含まれていても自身とは判定しません
+		void pushOutEntity(std::vector<Entity*>& e)
+		{
+			otherEntity_ = e;
+			broadPhase_ = nullptr;
+		}
+		/**
+		* @brief BroadPhaseに登録されている指定グループのEntityにめり込まないようにする
+		* @param broadPhase 毎フレームbuild()されるBroadPhase
+		* @param group 押し出し相手のグループ
+		* @details 移動で通過する範囲にいるEntityだけを判定するので、相手が多い場合に軽くなります
+		*/
+		void pushOutGroup(const BroadPhase& broadPhase, const Group group)
+		{
+			broadPhase_ = &broadPhase;
+			otherGroup_ = group;
+			otherEntity_.clear();
+		}
+	};
+}
@@ -9,13 +9,26 @@
 -# SpriteRectDraw追加
 - 2018/10/25 tonarinohito
 -# SpriteDrawもsetPivot()追加
+- 2026/10/18 tonarinohito
+-# RenderQueueが命令をため中なら、直接描画せずに描画命令を積むようにした
+-# アトラスに入っている画像はページの画像と範囲で描画命令を積むようにした
+-# 画像を毎フレーム登録名で引かず、初期化時に引いたGraphicIdで引くようにした
+-# 描画範囲の外にあるスプライトは描画しないようにした
+-# 描画をRenderBackend経由で行うようにした
+-# MultiSpriteDrawがAnimationSystemのアニメーションからコマを受け取れるようにした
+-# SpriteAnimator追加
+-# loadProcessedで余白を切り詰めた画像を元の画像の位置に、乗算済みアルファの画像を乗算済みα用のブレンドで描画するようにした
 */
 #pragma once
 #include "../ECS/ECS.hpp"
 #include "BasicComponents.hpp"
 #include "../Collision/Collision.hpp"
 #include "../Class/ResourceManager.hpp"
+#include "../Class/AnimationSystem.hpp"
 #include "../System/System.hpp"
+#include "../Renderer/RenderQueue.hpp"
+#include "../Renderer/Viewport.hpp"
+#include "../Renderer/RenderBackend.hpp"
 #include <DxLib.h>
 #include <DirectXMath.h>
 
@@ -110,7 +123,7 @@ namespace ECS
 			if (color != nullptr)
 			{
 				//RGBの設定
-				SetDrawBright(color->red, color->green, color->blue);
+				RenderBackend::Get().setBright(color->red, color->green, color->blue);
 			}
 		}
 		//!アルファブレンドを設定します
@@ -119,15 +132,46 @@ namespace ECS
 			if (blend != nullptr)
 			{
 				//ブレンドの設定
-				SetDrawBlendMode(blend->blendMode, blend->alpha);
+				RenderBackend::Get().setBlend(blend->blendMode, blend->alpha);
 			}
 		}
 		//!描画の状態をもとに戻します。必ず描画終了時に呼び出してください
 		static void ResetRenderState()
 		{
 			//変更した色の情報を元に戻す
-			SetDrawBlendMode(DX_BLENDMODE_NOBLEND, 255);
-			SetDrawBright(255, 255, 255);
+			RenderBackend::Get().setBlend(DX_BLENDMODE_NOBLEND, 255);
+			RenderBackend::Get().setBright(255, 255, 255);
+		}
+		//!乗算済みアルファの画像を描画するブレンドモードを返します。対応するモードが無いものはそのまま返します
+		static int ToPremultipliedBlend(const int blendMode)
+		{
+			switch (blendMode)
+			{
+			case DX_BLENDMODE_NOBLEND:
+			case DX_BLENDMODE_ALPHA: return DX_BLENDMODE_PMA_ALPHA;
+			case DX_BLENDMODE_ADD: return DX_BLENDMODE_PMA_ADD;
+			case DX_BLENDMODE_SUB: return DX_BLENDMODE_PMA_SUB;
+			case DX_BLENDMODE_INVSRC: return DX_BLENDMODE_PMA_INVSRC;
+			default: return blendMode;
+			}
+		}
+		//!色とブレンドと画像からRenderQueueのマテリアルを作ります。無いものは描画の初期状態と同じ値になります
+		static RenderQueue::Material MakeMaterial(const Color* color, const AlphaBlend* blend, const int handle)
+		{
+			RenderQueue::Material m;
+			if (color != nullptr)
+			{
+				m.red = color->red;
+				m.green = color->green;
+				m.blue = color->blue;
+			}
+			if (blend != nullptr)
+			{
+				m.blendMode = blend->blendMode;
+				m.alpha = blend->alpha;
+			}
+			m.handle = handle;
+			return m;
 		}
 		//!エンティティにColorとAlphaBlendを安全に参照させます。
 		static void SetRenderDetail(const Entity* entity, Color** color, AlphaBlend** blend)
@@ -151,12 +195,17 @@ namespace ECS
 	* - Transfromが必要です。
 	* - 色を変えたい場合はColorが必要です
 	* - アルファブレンドをしたい場合はAlphaBlendが必要です
+	* - RenderQueueが命令をため中(begin()からflush()の間)なら描画命令を積み、flush()でまとめて描画されます
+	* - Viewportの描画範囲の外にある場合は描画しません
+	* - loadProcessedで余白を切り詰めた画像は元の画像と同じ位置に、乗算済みアルファの画像は乗算済みα用のブレンドで描画します
 	*/
 	class SpriteDraw : public ComponentSystem
 	{
 	private:
 		bool isDiv_ = false;
+		RenderQueue::MaterialCache materialCache_;
 	protected:
+		GraphicId id_;
 		Position* pos_ = nullptr;
 		Scale* scale_ = nullptr;
 		Rotation* rota_ = nullptr;
@@ -167,6 +216,121 @@ namespace ECS
 		bool isDraw_ = true;
 		bool isTurn = false;
 		Vec2 pivot_;
+		ImageTrim trim_;
+		bool isTrimmed_ = false;
+		bool isPremultiplied_ = false;
+		//!切り詰めた余白と乗算済みアルファかどうかを引き直します
+		void resolveImageInfo()
+		{
+			isTrimmed_ = ResourceManager::GetGraph().findTrim(id_, trim_);
+			isPremultiplied_ = ResourceManager::GetGraph().isPremultiplied(id_);
+		}
+		/**
+		* @brief 描画する画像のIDが有効か確かめます
+		* @param isDiv 分割画像を描画するならtrue
+		* @return 描画できる画像があればtrue
+		* @details 画像が解放されたか読み直されたときだけ登録名で引き直します
+		*/
+		[[nodiscard]] bool resolveGraph(const bool isDiv)
+		{
+			if (isDiv != isDiv_)
+			{
+				return false;
+			}
+			auto& graph = ResourceManager::GetGraph();
+			if (!graph.isAlive(id_))
+			{
+				id_ = isDiv_ ? graph.findDivId(name_) : graph.findId(name_);
+				resolveImageInfo();
+			}
+			return graph.isAlive(id_);
+		}
+		//!画像が描画範囲に入っているか返し、範囲の外にあるかをエンティティに記録します
+		[[nodiscard]] bool isInViewport(const float w, const float h)
+		{
+			const bool isVisible = Viewport::Get().isVisible(pos_->val.x, pos_->val.y, pivot_.x, pivot_.y,
+				w, h, scale_->val.x, scale_->val.y, rota_->val);
+			owner->setCulled(!isVisible);
+			return isVisible;
+		}
+		/**
+		* @brief 元の画像での描画範囲と基準座標を、余白を切り詰めた画像での値に直します
+		* @param pivot 直した基準座標が返ります
+		* @return 範囲に描画する画素が無ければfalse
+		*/
+		[[nodiscard]] bool toTrimmedRect(int& srcX, int& srcY, int& srcW, int& srcH, Vec2& pivot) const
+		{
+			pivot = pivot_;
+			if (!isTrimmed_)
+			{
+				return true;
+			}
+			const int x0 = std::max(srcX, trim_.offsetX);
+			const int y0 = std::max(srcY, trim_.offsetY);
+			const int x1 = std::min(srcX + srcW, trim_.offsetX + trim_.w);
+			const int y1 = std::min(srcY + srcH, trim_.offsetY + trim_.h);
+			if (x1 <= x0 || y1 <= y0)
+			{
+				return false;
+			}
+			//反転すると右側で削った分だけ基準座標がずれる
+			pivot.x -= float(isTurn ? srcX + srcW - x1 : x0 - srcX);
+			pivot.y -= float(y0 - srcY);
+			srcX = x0 - trim_.offsetX;
+			srcY = y0 - trim_.offsetY;
+			srcW = x1 - x0;
+			srcH = y1 - y0;
+			return true;
+		}
+		//!直接描画するときのブレンドを設定します
+		void applyBlend() const
+		{
+			if (!isPremultiplied_)
+			{
+				RenderUtility::SetBlend(blend_);
+				return;
+			}
+			RenderBackend::Get().setBlend(
+				RenderUtility::ToPremultipliedBlend(blend_ != nullptr ? blend_->blendMode : DX_BLENDMODE_NOBLEND),
+				blend_ != nullptr ? blend_->alpha : 255);
+		}
+		//!RenderQueueに積む描画命令の共通部分を作ります
+		[[nodiscard]] RenderQueue::Command makeCommand(const int handle, const Vec2& pivot)
+		{
+			auto m = RenderUtility::MakeMaterial(color_, blend_, handle);
+			if (isPremultiplied_)
+			{
+				m.blendMode = RenderUtility::ToPremultipliedBlend(m.blendMode);
+			}
+			RenderQueue::Command c;
+			c.material = RenderQueue::Get().intern(m, materialCache_);
+			c.x = pos_->val.x;
+			c.y = pos_->val.y;
+			c.cx = pivot.x;
+			c.cy = pivot.y;
+			c.scaleX = scale_->val.x;
+			c.scaleY = scale_->val.y;
+			c.angle = DirectX::XMConvertToRadians(rota_->val);
+			c.isTurn = isTurn;
+			return c;
+		}
+		/**
+		* @brief 画像の範囲を描画する命令を作ります
+		* @param handle 画像ハンドル
+		* @param region アトラスに入っている場合はその範囲。入っていなければnullptr
+		* @details アトラスに入っていればページの画像から切り出すので、同じページの画像はまとめて描画できます
+		*/
+		[[nodiscard]] RenderQueue::Command makeRectCommand(const int handle, const AtlasRegion* region,
+			const int srcX, const int srcY, const int srcW, const int srcH, const Vec2& pivot)
+		{
+			auto c = makeCommand(region != nullptr ? region->handle : handle, pivot);
+			c.type = RenderQueue::CommandType::RECT_ROTA_GRAPH;
+			c.srcX = srcX + (region != nullptr ? region->x : 0);
+			c.srcY = srcY + (region != nullptr ? region->y : 0);
+			c.srcW = srcW;
+			c.srcH = srcH;
+			return c;
+		}
 	public:
 		//!登録した画像名を指定して初期化します
 		SpriteDraw(const char* name)
@@ -184,13 +348,18 @@ namespace ECS
 			pos_ = &owner->getComponent<Position>();
 			rota_ = &owner->getComponent<Rotation>();
 			scale_ = &owner->getComponent<Scale>();
-			if (isDiv_)
+			id_ = isDiv_ ? ResourceManager::GetGraph().findDivId(name_) : ResourceManager::GetGraph().findId(name_);
+			resolveImageInfo();
+			if (isTrimmed_)
 			{
-				GetGraphSize(ResourceManager::GetGraph().getDivHandle(name_, 0), &size_.x, &size_.y);
+				//余白を切り詰めた画像は元の画像の大きさで扱う
+				size_.x = trim_.sourceW;
+				size_.y = trim_.sourceH;
 			}
-			else
+			else if (!ResourceManager::GetGraph().findSize(id_, size_.x, size_.y))
 			{
-				GetGraphSize(ResourceManager::GetGraph().getHandle(name_), &size_.x, &size_.y);
+				//非同期で読み込み中の画像だけは大きさが分からないので問い合わせる
+				RenderBackend::Get().getGraphSize(ResourceManager::GetGraph().getHandle(name_), &size_.x, &size_.y);
 			}
 			pivot_.x = float(size_.x) / 2.f;
 			pivot_.y = float(size_.y) / 2.f;
@@ -198,20 +367,37 @@ namespace ECS
 		}
 		void draw2D() override
 		{
-			if (ResourceManager::GetGraph().hasHandle(name_) &&
-				isDraw_)
+			if (isDraw_ && resolveGraph(false) && isInViewport(float(size_.x), float(size_.y)))
 			{
+				const int handle = ResourceManager::GetGraph().getHandle(id_);
+				int srcX = 0, srcY = 0, srcW = size_.x, srcH = size_.y;
+				Vec2 pivot;
+				if (!toTrimmedRect(srcX, srcY, srcW, srcH, pivot))
+				{
+					return;
+				}
+				if (RenderQueue::Get().isRecording())
+				{
+					AtlasRegion region;
+					if (ResourceManager::GetGraph().findAtlasRegion(id_, region))
+					{
+						RenderQueue::Get().push(makeRectCommand(handle, &region, 0, 0, region.w, region.h, pivot));
+						return;
+					}
+					RenderQueue::Get().push(makeCommand(handle, pivot));
+					return;
+				}
 				RenderUtility::SetColor(color_);
-				RenderUtility::SetBlend(blend_);
-				DrawRotaGraph3F(
+				applyBlend();
+				RenderBackend::Get().drawRotaGraph(
 					pos_->val.x,
 					pos_->val.y,
-					pivot_.x,
-					pivot_.y,
+					pivot.x,
+					pivot.y,
 					scale_->val.x,
 					scale_->val.y,
 					DirectX::XMConvertToRadians(rota_->val),
-					ResourceManager::GetGraph().getHandle(name_), true, isTurn);
+					handle, isTurn);
 				RenderUtility::ResetRenderState();
 			}
 
@@ -221,10 +407,11 @@ namespace ECS
 		{
 			isDraw_ = true;
 		}
-		//!描画を無効にします
+		//!描画を無効にします。描画範囲の判定をしなくなるので、範囲の外にある扱いも解除します
 		void drawDisable()
 		{
 			isDraw_ = false;
+			owner->setCulled(false);
 		}
 		//!描画する基準座標を引数で指定します
 		void setPivot(const Vec2& pivot)
@@ -250,11 +437,13 @@ namespace ECS
 	* - 色を変えたい場合はColorが必要です
 	* - アルファブレンドをしたい場合はAlphaBlendが必要です
 	* - setPivotで基準座標を変更できます
+	* - SpriteAnimatorがあれば、そのアニメーションのコマを描画します
 	*/
 	class MultiSpriteDraw final : public SpriteDraw
 	{
 	private:
 		int index_ = 0;
+		AnimatorId animator_;
 	public:
 		//!登録した画像名を指定して初期化します
 		MultiSpriteDraw(const char* name) :
@@ -263,12 +452,25 @@ namespace ECS
 
 		void draw2D() override
 		{
-			if (ResourceManager::GetGraph().hasDivHandle(__super::name_) &&
-				__super::isDraw_)
+			if (__super::isDraw_ && __super::resolveGraph(true) &&
+				__super::isInViewport(float(__super::size_.x), float(__super::size_.y)))
 			{
+				const int index = getIndex();
+				const int handle = ResourceManager::GetGraph().getDivHandle(__super::id_, index);
+				if (RenderQueue::Get().isRecording())
+				{
+					AtlasRegion region;
+					if (ResourceManager::GetGraph().findAtlasDivRegion(__super::id_, index, region))
+					{
+						RenderQueue::Get().push(__super::makeRectCommand(handle, &region, 0, 0, region.w, region.h, __super::pivot_));
+						return;
+					}
+					RenderQueue::Get().push(__super::makeCommand(handle, __super::pivot_));
+					return;
+				}
 				RenderUtility::SetColor(__super::color_);
 				RenderUtility::SetBlend(__super::blend_);
-				DrawRotaGraph3F(
+				RenderBackend::Get().drawRotaGraph(
 					__super::pos_->val.x,
 					__super::pos_->val.y,
 					__super::pivot_.x,
@@ -276,7 +478,7 @@ namespace ECS
 					__super::scale_->val.x,
 					__super::scale_->val.y,
 					DirectX::XMConvertToRadians(__super::rota_->val),
-					ResourceManager::GetGraph().getDivHandle(__super::name_, index_), true, __super::isTurn);
+					handle, __super::isTurn);
 				RenderUtility::ResetRenderState();
 			}
 
@@ -289,8 +491,67 @@ namespace ECS
 		//!現在のインデックス値を取得する
 		int getIndex()
 		{
+			if (animator_.index != AnimatorId::INVALID_INDEX && AnimationSystem::Get().isAlive(animator_))
+			{
+				return AnimationSystem::Get().getFrame(animator_);
+			}
 			return index_;
 		}
+		//!コマを受け取るアニメーションを指定します。AnimatorId()を指定するとsetIndex()の値に戻ります
+		void setAnimator(const AnimatorId& animator)
+		{
+			animator_ = animator;
+		}
+	};
+
+	/*!
+	@brief JSONから読み込んだアニメーションのクリップを再生して、MultiSpriteDrawのコマを切り替えます
+	* - MultiSpriteDrawが必要です。クリップのsheetはMultiSpriteDrawの画像名と同じにしてください
+	* - クリップは事前にAnimationSystem::Get().loadClips()で読み込んでください
+	* - コマはAnimationSystem::Get().update()でまとめて進むので、このコンポーネントは毎フレーム何もしません
+	*/
+	class SpriteAnimator final : public ComponentSystem
+	{
+	private:
+		std::string clip_;
+		AnimatorId id_;
+		bool isPlay_;
+	public:
+		//!クリップの名前を指定して初期化します
+		explicit SpriteAnimator(const char* clip, const bool isPlay = true) :
+			clip_(clip),
+			isPlay_(isPlay)
+		{}
+		~SpriteAnimator()
+		{
+			AnimationSystem::Get().destroy(id_);
+		}
+		void initialize() override
+		{
+			id_ = AnimationSystem::Get().create(clip_, isPlay_);
+			owner->getComponent<MultiSpriteDraw>().setAnimator(id_);
+		}
+		//!クリップを最初から再生します
+		void play(const char* clip)
+		{
+			clip_ = clip;
+			AnimationSystem::Get().play(id_, clip_);
+		}
+		//!今のコマで止めます
+		void stop()
+		{
+			AnimationSystem::Get().stop(id_);
+		}
+		//!止めた位置から再生します
+		void resume()
+		{
+			AnimationSystem::Get().resume(id_);
+		}
+		//!繰り返さないクリップを最後のコマまで再生し終わっていればtrue
+		[[nodiscard]] bool isFinished() const
+		{
+			return AnimationSystem::Get().isFinished(id_);
+		}
 	};
 
 	/*!
@@ -317,28 +578,44 @@ namespace ECS
 			__super::scale_ = &owner->getComponent<Scale>();
 			rect_ = &owner->getComponent<Rectangle>();
 			RenderUtility::SetRenderDetail(owner, &color_, &blend_);
+			__super::id_ = ResourceManager::GetGraph().findId(name_);
+			__super::resolveImageInfo();
 		}
 		void draw2D() override
 		{
-			if (ResourceManager::GetGraph().hasHandle(name_) &&
-				isDraw_)
+			if (isDraw_ && __super::resolveGraph(false) &&
+				__super::isInViewport(float(rect_->w), float(rect_->h)))
 			{
+				const int handle = ResourceManager::GetGraph().getHandle(__super::id_);
+				int srcX = rect_->x, srcY = rect_->y, srcW = rect_->w, srcH = rect_->h;
+				Vec2 pivot;
+				if (!__super::toTrimmedRect(srcX, srcY, srcW, srcH, pivot))
+				{
+					return;
+				}
+				if (RenderQueue::Get().isRecording())
+				{
+					AtlasRegion region;
+					const bool isAtlas = ResourceManager::GetGraph().findAtlasRegion(__super::id_, region);
+					RenderQueue::Get().push(__super::makeRectCommand(handle, isAtlas ? &region : nullptr,
+						srcX, srcY, srcW, srcH, pivot));
+					return;
+				}
 				RenderUtility::SetColor(color_);
-				RenderUtility::SetBlend(blend_);
-				DrawRectRotaGraph3F(
+				__super::applyBlend();
+				RenderBackend::Get().drawRectRotaGraph(
 					__super::pos_->val.x,
 					__super::pos_->val.y,
-					rect_->x,
-					rect_->y,
-					rect_->w,
-					rect_->h,
-					__super::pivot_.x,
-					__super::pivot_.y,
+					srcX,
+					srcY,
+					srcW,
+					srcH,
+					pivot.x,
+					pivot.y,
 					__super::scale_->val.x,
 					__super::scale_->val.y,
 					DirectX::XMConvertToRadians(rota_->val),
-					ResourceManager::GetGraph().getHandle(name_),
-					true,
+					handle,
 					__super::isTurn);
 				RenderUtility::ResetRenderState();
 			}
@@ -0,0 +1,86 @@
+﻿/**
+* @file TextDraw.hpp
+* @brief ビットマップフォントで文字列を描画するコンポーネントです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "../ECS/ECS.hpp"
+#include "BasicComponents.hpp"
+#include "Renderer.hpp"
+#include "../Renderer/BitmapFont.hpp"
+#include <string>
+#include <cassert>
+
+namespace ECS
+{
+	/*!
+	@brief FontAtlasに登録したフォントで文字列を描画します。左上が基準です
+	* - Positionが必要です
+	* - 色を変えたい場合はColorが必要です
+	* - AlphaBlendが無ければアルファブレンドで描画します
+	* - 文字列はsetText()かsetNumber()で変わったときだけ並べ直すので、スコアなどを毎フレーム指定しても構いません
+	*/
+	class TextDraw final : public ComponentSystem
+	{
+	private:
+		Position* pos_ = nullptr;
+		Color* color_ = nullptr;
+		AlphaBlend* blend_ = nullptr;
+		std::string fontName_;
+		TextLayout layout_;
+		bool isDraw_ = true;
+	public:
+		//!登録したフォント名と最初の文字列を指定して初期化します
+		explicit TextDraw(const char* fontName, const char* text = "") :
+			fontName_(fontName),
+			layout_(FontAtlas::Get().find(fontName))
+		{
+			assert(FontAtlas::Get().hasFont(fontName) && "font is not loaded");
+			layout_.setText(text);
+		}
+		void initialize() override
+		{
+			pos_ = &owner->getComponent<Position>();
+			RenderUtility::SetRenderDetail(owner, &color_, &blend_);
+		}
+		void draw2D() override
+		{
+			if (!isDraw_)
+			{
+				return;
+			}
+			auto m = RenderUtility::MakeMaterial(color_, blend_, -1);
+			if (blend_ == nullptr)
+			{
+				m.blendMode = DX_BLENDMODE_ALPHA;
+			}
+			layout_.draw(pos_->val.x, pos_->val.y, m);
+		}
+		//!文字列を指定します。変わったときだけ並べ直します
+		void setText(const char* text)
+		{
+			layout_.setText(text);
+		}
+		//!整数を指定します。minDigitsに足りない桁は0で埋めます
+		void setNumber(const long long value, const int minDigits = 0)
+		{
+			layout_.setNumber(value, minDigits);
+		}
+		//!配置の結果を返します
+		[[nodiscard]] const TextLayout& getLayout() const
+		{
+			return layout_;
+		}
+		//!描画します
+		void drawEnable()
+		{
+			isDraw_ = true;
+		}
+		//!描画しません
+		void drawDisable()
+		{
+			isDraw_ = false;
+		}
+	};
+}
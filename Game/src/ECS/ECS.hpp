@@ -8,6 +8,9 @@
 -# すべてのエンティティを削除するallDestory()追加
 - 2018/10/16 tonarinohito
 -# コンポーネントをEntity::stopComponent<>()で停止できるようにした
+- 2026/10/18 tonarinohito
+-# グループごとの描画の前に関数を呼べるorderByDrawを追加
+-# 描画範囲の外にある間だけコンポーネントの更新処理を止めるstopWhileCulled()を追加
 * @note  参考元 https://github.com/SuperV1234/Tutorials
 */
 #pragma once
@@ -68,6 +71,7 @@ namespace ECS
 		bool active_ = true;
 		void removeThis() { active_ = false; }
 		bool isStop_ = false;
+		bool isCullStop_ = false;
 	public:
 		Entity* owner = nullptr;
 		virtual void initialize() {};
@@ -106,6 +110,7 @@ namespace ECS
 		EntityManager& manager_;
 		Group nowGroup_ = 0u;
 		bool isActive_ = true;
+		bool isCulled_ = false;
 		std::vector<std::unique_ptr<ComponentSystem>> components_;
 		ComponentArray  componentArray_{};
 		ComponentBitSet componentBitSet_;
@@ -136,7 +141,7 @@ namespace ECS
 			refreshComponent();
 			for (auto& c : components_)
 			{
-				if (c == nullptr || c->isStop_)
+				if (c == nullptr || c->isStop_ || (isCulled_ && c->isCullStop_))
 				{
 					continue;
 				}
@@ -252,6 +257,25 @@ namespace ECS
 		{
 			getComponent<T>().isStop_ = false;
 		}
+		/**
+		* @brief 描画範囲の外にある間、指定したコンポーネントの更新処理を止めます
+		* @details 描画範囲の外にあるかはSpriteDrawなどが描画時にsetCulled()で設定します。
+		* - 止めている間は動かないので、エンティティを動かすコンポーネントには使わないでください
+		*/
+		template<typename T> void stopWhileCulled() noexcept
+		{
+			getComponent<T>().isCullStop_ = true;
+		}
+		//!描画範囲の外にあるかを設定します
+		void setCulled(const bool isCulled) noexcept
+		{
+			isCulled_ = isCulled;
+		}
+		//!直前の描画で描画範囲の外にあったか返します
+		[[nodiscard]] bool isCulled() const noexcept
+		{
+			return isCulled_;
+		}
 
 		/**
 		* @brief 登録済みのコンポーネントを取得します
@@ -324,6 +348,25 @@ namespace ECS
 				}
 			}
 		}
+		/**
+		* @brief グループごとの描画を登録順に行います
+		* @param MaxGroup 最大グループ数
+		* @param beginGroup 各グループの描画の前に呼ばれる関数です。引数はグループの番号です
+		* @details RenderQueueのレイヤーをグループに合わせる場合などに使います
+		*/
+		template<class Func>
+		void orderByDraw(const Group& MaxGroup, Func&& beginGroup)
+		{
+			for (auto i(0u); i < MaxGroup; ++i)
+			{
+				beginGroup(i);
+				const auto& entity = groupedEntities_[i];
+				for (const auto& e : entity)
+				{
+					e->draw2D();
+				}
+			}
+		}
 		//!登録されているEntityの2D描画を行います
 		void draw2D()
 		{
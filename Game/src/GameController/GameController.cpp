@@ -5,6 +5,8 @@
 #include "Scene/Title.h"
 #include "Scene/Game.h"
 #include "../Class/Sound.hpp"
+#include "../Renderer/RenderQueue.hpp"
+#include "../Class/AnimationSystem.hpp"
 
 void GameController::resourceLoad()
 {
@@ -22,7 +24,20 @@ GameController::GameController()
 
 void GameController::onSceneChange(const Scene::SceneName& scene, const Scene::StackPopFlag stackClearFlag, const bool isInitialize)
 {
-	switch (stackClearFlag)
+	const SceneChange change{ scene, stackClearFlag, isInitialize };
+	if (isDeferSceneChange_)
+	{
+		pendingChange_ = change;
+		hasPendingChange_ = true;
+		return;
+	}
+	changeScene(change);
+}
+
+void GameController::changeScene(const SceneChange& change)
+{
+	const auto scene = change.scene;
+	switch (change.stackClear)
 	{
 	case Scene::StackPopFlag::NON:
 		break;
@@ -49,7 +64,7 @@ void GameController::onSceneChange(const Scene::SceneName& scene, const Scene::S
 		break;
 	}
 	MasterSound::Get().update();
-	if (isInitialize)
+	if (change.isInitialize)
 	{
 		sceneStack_.top()->initialize();
 	}
@@ -65,14 +80,45 @@ void GameController::stackClear()
 
 void GameController::update()
 {
-	MasterSound::Get().update();
 	entityManager_.refresh();
 	//シーン更新
 	sceneStack_.top()->update();
+	//再生中のアニメーションをまとめて進める
+	AnimationSystem::Get().update();
 }
 
-void GameController::draw()
+void GameController::setDeferSceneChange(const bool isDefer)
+{
+	isDeferSceneChange_ = isDefer;
+}
+
+void GameController::record()
+{
+	sceneStack_.top()->record();
+}
+
+void GameController::swap()
+{
+	//パイプラインで動かす場合もメインスレッドで呼ばれるので、DXライブラリの音量の変更はここで行う
+	MasterSound::Get().update();
+	RenderQueue::Get().swapSnapshot();
+	sceneStack_.top()->swapBuffers();
+	if (hasPendingChange_)
+	{
+		hasPendingChange_ = false;
+		changeScene(pendingChange_);
+	}
+}
+
+void GameController::submit()
 {
 	//シーン描画
-	sceneStack_.top()->draw();
+	sceneStack_.top()->submit();
+}
+
+void GameController::draw()
+{
+	record();
+	swap();
+	submit();
 }
\ No newline at end of file
@@ -6,6 +6,10 @@
  * @par History
  - 2018/10/14 tonarinohito
  -# このクラスでシーンのスタックを監視するように変更 
+ - 2026/10/18 tonarinohito
+ -# 描画を命令の作成と描画に分け、パイプラインで動かす場合はシーンの変更をフレームの同期まで遅らせるように変更
+ -# シーンの更新の後にAnimationSystemでアニメーションをまとめて進めるように変更
+ -# MasterSoundの更新をupdate()からswap()に移し、メインスレッドで行うように変更
  */
 #pragma once
 #include "../ECS/ECS.hpp"
@@ -19,7 +23,18 @@ class GameController final : public Scene::IOnSceneChangeCallback
 private:
 	ECS::EntityManager entityManager_;
 	std::stack<std::unique_ptr<Scene::AbstractScene>> sceneStack_;	//シーンのスタック
+	//!フレームの同期まで遅らせたシーンの変更です
+	struct SceneChange
+	{
+		Scene::SceneName scene = Scene::SceneName::TITLE;
+		Scene::StackPopFlag stackClear = Scene::StackPopFlag::NON;
+		bool isInitialize = false;
+	};
+	SceneChange pendingChange_;
+	bool hasPendingChange_ = false;
+	bool isDeferSceneChange_ = false;
 	void resourceLoad();
+	void changeScene(const SceneChange& change);
 public:
 
 	/**
@@ -48,6 +63,17 @@ public:
 	void stackClear() override;
 	//!Entityの更新処理を行います
 	void update();
-	//!Entityの描画を行います
+	/**
+	* @brief シーンの変更をswap()まで遅らせるかを指定します
+	* @details パイプラインで動かす場合に指定すると、シーンの作成と破棄、画像の読み込みがメインスレッドで行われます
+	*/
+	void setDeferSceneChange(const bool isDefer);
+	//!Entityの描画命令をためます
+	void record();
+	//!record()でためた描画を次のsubmit()で描画するものにして、音量の変更と遅らせたシーンの変更を行います
+	void swap();
+	//!swap()で決まったフレームを描画します
+	void submit();
+	//!record(), swap(), submit()を続けて行います
 	void draw();
 };
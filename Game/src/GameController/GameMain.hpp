@@ -3,46 +3,178 @@
  * @brief Dxlibの更新とアプリケーションの更新を行います
  * @author tonarinohito
  * @date 2018/10/05
+ * @par History
+ - 2026/10/18 tonarinohito
+ -# 更新と描画命令の作成を別のスレッドで行い、前のフレームの描画と重ねる動作を追加
  */
 #pragma once
 #include "../System/System.hpp"
 #include "../GameController/GameController.h"
 #include "../Utility/FPS.hpp"
+#include "../Utility/FrameProfiler.hpp"
 #include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cassert>
 
  //!アプリケーションを生成します
 class GameMain final
 {
+public:
+	//!1フレームの処理の進め方です
+	enum class LoopMode
+	{
+		//!更新、描画命令の作成、描画を1つのスレッドで順に行います
+		SEQUENTIAL,
+		/**
+		* 次のフレームの更新と描画命令の作成を別のスレッドで行い、その間にメインスレッドで前のフレームのスナップショットを描画します。
+		* スループットが上がる代わりに、入力が画面に出るまで1フレーム遅れます
+		*/
+		PIPELINED,
+	};
 private:
+	//!渡された処理を専用のスレッドで1つずつ動かします
+	class SimulationThread final
+	{
+	private:
+		std::mutex mutex_;
+		std::condition_variable condition_;
+		std::function<void()> task_;
+		bool hasTask_ = false;
+		bool isQuit_ = false;
+		//他のメンバを作ってから動かすので最後に置く
+		std::thread thread_;
+		void loop()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			for (;;)
+			{
+				condition_.wait(lock, [this]() { return hasTask_ || isQuit_; });
+				if (!hasTask_)
+				{
+					return;
+				}
+				lock.unlock();
+				task_();
+				lock.lock();
+				hasTask_ = false;
+				condition_.notify_all();
+			}
+		}
+	public:
+		SimulationThread() :
+			thread_([this]() { loop(); })
+		{}
+		~SimulationThread()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				isQuit_ = true;
+			}
+			condition_.notify_all();
+			thread_.join();
+		}
+		SimulationThread(const SimulationThread&) = delete;
+		SimulationThread& operator=(const SimulationThread&) = delete;
+		//!処理を始めます。前の処理はwait()で待ってから呼んでください
+		void start(std::function<void()> task)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				assert(!hasTask_ && "previous task is running");
+				task_ = std::move(task);
+				hasTask_ = true;
+			}
+			condition_.notify_all();
+		}
+		//!処理が終わるまで待ちます
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			condition_.wait(lock, [this]() { return !hasTask_; });
+		}
+	};
+
+	LoopMode mode_;
 	std::unique_ptr<System> system;
 	std::unique_ptr<GameController> game;
-	void update()
+	//!更新して描画命令をためます
+	void simulate()
 	{
+		FrameProfiler::Scope scope(FrameProfiler::Section::SIMULATION);
 		game->update();
+		game->record();
 	}
-	void draw()
+	//!swap()で決まったフレームを描画し、描画し終えた時刻を返します
+	FrameProfiler::Clock::time_point render()
 	{
-		game->draw();
+		FrameProfiler::Scope scope(FrameProfiler::Section::RENDER);
+		game->submit();
+		return FrameProfiler::Clock::now();
 	}
 	const bool pushEscape() const
 	{
 		return Input::Get().getKeyFrame(KEY_INPUT_ESCAPE) == 1;
 	}
+	void runSequential()
+	{
+		while (system->isOk() && !pushEscape())
+		{
+			Fps::Get().update();
+			const auto inputTime = FrameProfiler::Get().beginFrame();
+			simulate();
+			game->swap();
+			const auto presentTime = render();
+			FrameProfiler::Get().endFrame(inputTime, presentTime);
+			Fps::Get().wait();
+		}
+	}
+	/**
+	* @brief 更新と描画命令の作成を描画と重ねて行います
+	* @details 入力はメインスレッドでisOk()の中で読み、その後にシミュレーションを始めます。
+	* シミュレーションの間、メインスレッドは前のフレームで作ったスナップショットだけを描画します。
+	* 両方が終わってからswap()でスナップショットを入れ替えるので、Entityとスナップショットを同時に触ることはありません
+	*/
+	void runPipelined()
+	{
+		SimulationThread simulation;
+		//表のスナップショットを作るのに使った入力の時刻
+		FrameProfiler::Clock::time_point snapshotInputTime;
+		while (system->isOk() && !pushEscape())
+		{
+			Fps::Get().update();
+			const auto inputTime = FrameProfiler::Get().beginFrame();
+			simulation.start([this]() { simulate(); });
+			const auto presentTime = render();
+			simulation.wait();
+			game->swap();
+			FrameProfiler::Get().endFrame(snapshotInputTime, presentTime);
+			snapshotInputTime = inputTime;
+			Fps::Get().wait();
+		}
+	}
 public:
-	GameMain()
+	/**
+	* @brief DxLibとゲームを初期化します
+	* @param mode 1フレームの処理の進め方
+	*/
+	explicit GameMain(const LoopMode mode = LoopMode::SEQUENTIAL) :
+		mode_(mode)
 	{
-		system = std::make_unique<System>();
+		system = std::make_unique<System>(mode == LoopMode::PIPELINED);
 		game = std::make_unique<GameController>();
+		game->setDeferSceneChange(mode == LoopMode::PIPELINED);
 	}
 	//!アプリケーションの更新を行います
 	void run()
 	{
-		while (system->isOk() && !pushEscape())
+		if (mode_ == LoopMode::PIPELINED)
 		{
-			Fps::Get().update();
-			update();
-			draw();
-			Fps::Get().wait();
+			runPipelined();
+			return;
 		}
+		runSequential();
 	}
 };
\ No newline at end of file
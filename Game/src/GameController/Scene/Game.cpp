@@ -1,6 +1,12 @@
 ﻿#include "Game.h"
 #include "../GameController.h"
 #include "../../Input/Input.hpp"
+#include "../../Renderer/RenderQueue.hpp"
+#include "../../Renderer/Viewport.hpp"
+#include "../../Renderer/RenderBackend.hpp"
+#include "../../Renderer/ParallelDraw.hpp"
+#include "../../Renderer/DebugDraw.hpp"
+#include "../../Utility/FrameProfiler.hpp"
 
 namespace Scene
 {
@@ -13,24 +19,105 @@ namespace Scene
 
 	void Game::initialize()
 	{
-
+#ifdef _DEBUG
+		FontAtlas::Get().load("debug", "", 16, -1, DX_FONTTYPE_NORMAL);
+		for (auto& it : debugTexts_)
+		{
+			it.setFont(FontAtlas::Get().find("debug"));
+		}
+#endif
 	}
 	void Game::update()
 	{
 		entityManager_->update();
+#ifdef DEBUG_DRAW_ENABLE
+		//F1で当たり判定、F2で範囲検索の表示を切り替える
+		if (Input::Get().getKeyFrame(KEY_INPUT_F1) == 1)
+		{
+			DebugDraw::Get().toggle(DebugDraw::Category::COLLIDER);
+		}
+		if (Input::Get().getKeyFrame(KEY_INPUT_F2) == 1)
+		{
+			DebugDraw::Get().toggle(DebugDraw::Category::QUERY);
+		}
+#endif
+#ifdef _DEBUG
+		//F3で描画命令の記録を始め、もう一度押すとRenderReplayBenchmarkで流せるファイルに保存する
+		if (Input::Get().getKeyFrame(KEY_INPUT_F3) == 1)
+		{
+			isCapturing_ = !isCapturing_;
+			if (isCapturing_)
+			{
+				capture_.clear();
+				RenderQueue::Get().setCapture(&capture_);
+			}
+			else
+			{
+				RenderQueue::Get().setCapture(nullptr);
+				const bool isSaved = capture_.save("render_capture.rcap");
+				DOUT << "render capture : " << capture_.frameNum() << " frames, " << capture_.byteNum() << " bytes"
+					<< (isSaved ? " saved" : " save failed") << std::endl;
+			}
+		}
+#endif
 	}
 
-	void Game::draw()
+	void Game::record()
 	{
-		SetDrawMode(DX_DRAWMODE_BILINEAR);
-		//グループ順に描画
-		entityManager_->orderByDraw(ENTITY_GROUP::MAX);
-		SetDrawMode(DX_DRAWMODE_NEAREST);
+		Viewport::Get().begin();
+		//グループ順にレイヤーを分けて描画命令をスレッドごとに並列にため、描画の状態ごとに並べ替えてスナップショットに残す
+		RenderQueue::Get().begin();
+		ParallelDraw::Record(*entityManager_, ENTITY_GROUP::MAX);
+#ifdef _DEBUG
+		//デバッグ表示もRenderQueueに積み、すべてのグループより上のレイヤーに描画する
+		const auto& cull = Viewport::Get().stats();
+		char text[128];
+		snprintf(text, sizeof(text), "draw:%d batch:%d(%d) blend:%d bright:%d texture:%d unsorted:%d",
+			int(drawStats_.commandNum), int(drawStats_.batchNum), int(drawStats_.batchedCommandNum), int(drawStats_.blendChangeNum),
+			int(drawStats_.brightChangeNum), int(drawStats_.textureChangeNum), int(drawStats_.unsortedStateChangeNum));
+		debugTexts_[0].setText(text);
+		snprintf(text, sizeof(text), "drawn:%d culled:%d cached:%d cache hit:%d rebuild:%d bypass:%d", int(cull.drawnNum), int(cull.culledNum),
+			int(drawStats_.cachedCommandNum), int(layerCacheStats_.hitFrameNum), int(layerCacheStats_.rebuildNum), int(layerCacheStats_.bypassFrameNum));
+		debugTexts_[1].setText(text);
+		snprintf(text, sizeof(text), "sim:%.2fms render:%.2fms %.0ffps latency:%.2fms(+%.2f)",
+			frameReport_.simulationMs, frameReport_.renderMs, frameReport_.throughput, frameReport_.latencyMs, frameReport_.addedLatencyMs);
+		debugTexts_[2].setText(text);
+		RenderQueue::Get().setLayer(size_t(ENTITY_GROUP::MAX));
+		RenderQueue::Material m;
+		m.blendMode = DX_BLENDMODE_ALPHA;
+		for (size_t i = 0; i < debugTexts_.size(); ++i)
+		{
+			debugTexts_[i].draw(0.f, float(i * 16), m);
+		}
+#endif
+		RenderQueue::Get().publish();
 	}
 
-	Game::~Game()
+	void Game::swapBuffers()
+	{
+#ifdef _DEBUG
+		//描画の統計はsubmit()で決まるので、両方のスレッドが止まっている間に受け取る
+		drawStats_ = RenderQueue::Get().stats();
+		layerCacheStats_ = RenderQueue::Get().layerCacheStats();
+		frameReport_ = FrameProfiler::Get().report();
+#endif
+	}
+
+	void Game::submit()
 	{
+		RenderBackend::Get().setDrawMode(DX_DRAWMODE_BILINEAR);
+		RenderQueue::Get().submit();
+		RenderBackend::Get().setDrawMode(DX_DRAWMODE_NEAREST);
+	}
 
+	Game::~Game()
+	{
+#ifdef _DEBUG
+		if (isCapturing_)
+		{
+			RenderQueue::Get().setCapture(nullptr);
+		}
+#endif
 	}
 	
 }
\ No newline at end of file
@@ -7,6 +7,11 @@
 #pragma once
 #include "../../ECS/ECS.hpp"
 #include "../Scene/SceneManager.hpp"
+#include "../../Renderer/Viewport.hpp"
+#include "../../Renderer/BitmapFont.hpp"
+#include "../../Renderer/RenderCapture.hpp"
+#include "../../Utility/FrameProfiler.hpp"
+#include <array>
 
 namespace Scene
 {
@@ -14,12 +19,25 @@ namespace Scene
 	{
 	private:
 		ECS::EntityManager* entityManager_;
+#ifdef _DEBUG
+		//デバッグ表示の各行。文字列が変わった行だけ並べ直します
+		std::array<TextLayout, 3> debugTexts_;
+		//swapBuffers()で受け取り、次のrecord()でデバッグ表示に使う描画の統計
+		RenderQueue::Stats drawStats_;
+		RenderQueue::LayerCacheStats layerCacheStats_;
+		FrameProfiler::Report frameReport_;
+		//F3で記録を始め、もう一度押すとファイルに保存する描画命令のキャプチャ
+		RenderCapture capture_;
+		bool isCapturing_ = false;
+#endif
 	public:
 		Game(IOnSceneChangeCallback* sceneTitleChange, ECS::EntityManager* entityManager);
 		~Game();
 		virtual void initialize() override;
 		virtual void update() override;
-		virtual void draw() override;
+		virtual void record() override;
+		virtual void submit() override;
+		virtual void swapBuffers() override;
 	
 	};
 }
\ No newline at end of file
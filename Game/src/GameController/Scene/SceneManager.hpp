@@ -71,7 +71,12 @@ namespace Scene
 		virtual ~AbstractScene() = default;
 		virtual void initialize() = 0;
 		virtual void update() = 0;
-		virtual void draw() = 0;
+		//!描画命令をためます。パイプラインで動かす場合はupdate()と同じく描画しないスレッドで呼ばれます
+		virtual void record() = 0;
+		//!record()で作ったものを描画します。常にメインスレッドで呼ばれます
+		virtual void submit() = 0;
+		//!record()で集めた表示用の値をsubmit()で使う側に移します。record()とsubmit()のどちらも動いていないときに呼ばれます
+		virtual void swapBuffers() {}
 		IOnSceneChangeCallback& getCallBack() const { return *callBack; }
 	private:
 		IOnSceneChangeCallback* callBack;
@@ -6,6 +6,10 @@
 #include "../src/Utility/Parameter.hpp"
 #include "../src/Components/BackGround.hpp"
 #include "../src/ArcheType/CharacterArcheType.hpp"
+#include "../src/Renderer/RenderQueue.hpp"
+#include "../src/Renderer/Viewport.hpp"
+#include "../src/Renderer/RenderBackend.hpp"
+#include "../src/Renderer/ParallelDraw.hpp"
 namespace Scene
 {
 	Title::~Title()
@@ -17,8 +21,11 @@ namespace Scene
 		, entityManager_(entityManager)
 	{
 		ResourceManager::GetGraph().load("Resource/image/back.png", "BG");
-		ResourceManager::GetGraph().load("Resource/image/ship.png", "ship");
-		ResourceManager::GetGraph().load("Resource/image/enemy01.png", "enemy");
+		//キャラクターは乗算済みアルファに直し、透明な余白を切り詰めて読み込む
+		ResourceManager::GetGraph().loadProcessedWithMask("Resource/image/ship.png", "ship");
+		ResourceManager::GetGraph().loadProcessedWithMask("Resource/image/enemy01.png", "enemy");
+		//同じページの画像はまとめて描画できるので、読み込んだ画像を大きなページにまとめる
+		ResourceManager::GetGraph().buildAtlas("Resource/atlas_cache.json");
 	}
 
 	void Title::initialize()
@@ -27,9 +34,8 @@ namespace Scene
 		ECS::CharacterArcheType::CreatePlayer(*entityManager_);
 		//enemyを生成
 		ECS::CharacterArcheType::CreateEnemy(*entityManager_);
-		//BG2枚を生成
-		ECS::CharacterArcheType::CreateBG(*entityManager_);
-		ECS::CharacterArcheType::CreateBG(*entityManager_)->getComponent<ECS::Position>().val.y = -System::SCREEN_HEIGHT;
+		//ステージのタイルマップから背景を生成
+		ECS::CharacterArcheType::CreateParallaxBG(*entityManager_, "Resource/stage/stage1.json");
 
 		
 	}
@@ -39,12 +45,20 @@ namespace Scene
 		entityManager_->update();
 	}
 
-	void Title::draw()
+	void Title::record()
 	{
-		SetDrawMode(DX_DRAWMODE_BILINEAR);
-		//グループ順に描画
-		entityManager_->orderByDraw(ENTITY_GROUP::MAX);
-		SetDrawMode(DX_DRAWMODE_NEAREST);
+		Viewport::Get().begin();
+		//グループ順にレイヤーを分けて描画命令をスレッドごとに並列にため、描画の状態ごとに並べ替えてスナップショットに残す
+		RenderQueue::Get().begin();
+		ParallelDraw::Record(*entityManager_, ENTITY_GROUP::MAX);
+		RenderQueue::Get().publish();
+	}
+
+	void Title::submit()
+	{
+		RenderBackend::Get().setDrawMode(DX_DRAWMODE_BILINEAR);
+		RenderQueue::Get().submit();
+		RenderBackend::Get().setDrawMode(DX_DRAWMODE_NEAREST);
 	}
 
 }
\ No newline at end of file
@@ -27,7 +27,8 @@ namespace Scene
 		Title(IOnSceneChangeCallback* sceneTitleChange, ECS::EntityManager* entityManager);
 		virtual void initialize() override;
 		virtual void update() override;
-		virtual void draw() override;
+		virtual void record() override;
+		virtual void submit() override;
 	};
 
 }
\ No newline at end of file
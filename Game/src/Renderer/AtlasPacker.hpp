@@ -0,0 +1,195 @@
+﻿/**
+* @file AtlasPacker.hpp
+* @brief 複数の画像を大きなページに詰めるMaxRects法のパッカーです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <cstddef>
+
+/**
+* @brief 1枚のページに矩形を詰めていきます
+* @details 空いている領域を重なりを許した矩形の集合で持ち、
+* 短い方の辺の余りが最も小さくなる場所(Best Short Side Fit)に置きます。
+* 同じ評価の場所は上、左の順に優先するので、同じ入力なら必ず同じ結果になります
+*/
+class MaxRectsPacker final
+{
+public:
+	struct Rect
+	{
+		int x = 0;
+		int y = 0;
+		int w = 0;
+		int h = 0;
+	};
+	//!PackPages()の結果です
+	struct Placement
+	{
+		//!入らなかった場合は-1
+		int page = -1;
+		int x = 0;
+		int y = 0;
+	};
+private:
+	std::vector<Rect> free_;
+	std::vector<Rect> next_;
+
+	[[nodiscard]] static bool IsContained(const Rect& inner, const Rect& outer) noexcept
+	{
+		return inner.x >= outer.x && inner.y >= outer.y &&
+			inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+	}
+	//!置いた矩形と重なる空き領域を、重ならない部分の最大4つの矩形に分けます
+	void split(const Rect& used)
+	{
+		next_.clear();
+		for (const auto& f : free_)
+		{
+			if (used.x >= f.x + f.w || used.x + used.w <= f.x || used.y >= f.y + f.h || used.y + used.h <= f.y)
+			{
+				next_.emplace_back(f);
+				continue;
+			}
+			if (used.x > f.x)
+			{
+				next_.emplace_back(Rect{ f.x, f.y, used.x - f.x, f.h });
+			}
+			if (used.x + used.w < f.x + f.w)
+			{
+				next_.emplace_back(Rect{ used.x + used.w, f.y, f.x + f.w - used.x - used.w, f.h });
+			}
+			if (used.y > f.y)
+			{
+				next_.emplace_back(Rect{ f.x, f.y, f.w, used.y - f.y });
+			}
+			if (used.y + used.h < f.y + f.h)
+			{
+				next_.emplace_back(Rect{ f.x, used.y + used.h, f.w, f.y + f.h - used.y - used.h });
+			}
+		}
+		//他に含まれる空き領域を取り除く。同じものは先にある方を残す
+		free_.clear();
+		for (size_t i = 0; i < next_.size(); ++i)
+		{
+			bool isContained = false;
+			for (size_t j = 0; j < next_.size() && !isContained; ++j)
+			{
+				if (i != j && IsContained(next_[i], next_[j]) &&
+					(!IsContained(next_[j], next_[i]) || j < i))
+				{
+					isContained = true;
+				}
+			}
+			if (!isContained)
+			{
+				free_.emplace_back(next_[i]);
+			}
+		}
+	}
+public:
+	MaxRectsPacker(const int w, const int h) :
+		free_{ Rect{ 0, 0, w, h } }
+	{}
+	/**
+	* @brief 矩形を置きます
+	* @param w 幅
+	* @param h 高さ
+	* @param out 置いた位置が返ります
+	* @return 入る場所が無ければfalse
+	*/
+	bool insert(const int w, const int h, Rect& out)
+	{
+		bool isFound = false;
+		int bestShort = 0;
+		int bestLong = 0;
+		for (const auto& f : free_)
+		{
+			if (f.w < w || f.h < h)
+			{
+				continue;
+			}
+			const int dw = f.w - w;
+			const int dh = f.h - h;
+			const int shortSide = std::min(dw, dh);
+			const int longSide = std::max(dw, dh);
+			const bool isBetter = !isFound ||
+				shortSide < bestShort ||
+				(shortSide == bestShort && longSide < bestLong) ||
+				(shortSide == bestShort && longSide == bestLong && (f.y < out.y || (f.y == out.y && f.x < out.x)));
+			if (isBetter)
+			{
+				isFound = true;
+				bestShort = shortSide;
+				bestLong = longSide;
+				out = Rect{ f.x, f.y, w, h };
+			}
+		}
+		if (isFound)
+		{
+			split(out);
+		}
+		return isFound;
+	}
+	/**
+	* @brief 矩形をいくつかのページに詰めます
+	* @param sizes 詰める矩形の(幅, 高さ)
+	* @param pageW ページの幅
+	* @param pageH ページの高さ
+	* @param pageNum 使ったページの数が返ります
+	* @return sizesと同じ順番の置いた位置。ページより大きい矩形はpageが-1になります
+	* @details 長い辺、面積の大きい順に置き、入らなくなったら次のページを作ります。
+	* 並び順が同じ評価のものは元の順番で決まるので、同じ入力なら必ず同じ結果になります
+	*/
+	[[nodiscard]] static std::vector<Placement> PackPages(const std::vector<std::pair<int, int>>& sizes,
+		const int pageW, const int pageH, int& pageNum)
+	{
+		std::vector<size_t> order(sizes.size());
+		for (size_t i = 0; i < order.size(); ++i)
+		{
+			order[i] = i;
+		}
+		std::stable_sort(order.begin(), order.end(), [&sizes](const size_t a, const size_t b)
+		{
+			const int longA = std::max(sizes[a].first, sizes[a].second);
+			const int longB = std::max(sizes[b].first, sizes[b].second);
+			if (longA != longB)
+			{
+				return longA > longB;
+			}
+			return sizes[a].first * sizes[a].second > sizes[b].first * sizes[b].second;
+		});
+		std::vector<Placement> result(sizes.size());
+		std::vector<MaxRectsPacker> pages;
+		for (const size_t index : order)
+		{
+			const int w = sizes[index].first;
+			const int h = sizes[index].second;
+			if (w > pageW || h > pageH)
+			{
+				continue;
+			}
+			Rect rect;
+			bool isPlaced = false;
+			for (size_t p = 0; p < pages.size() && !isPlaced; ++p)
+			{
+				if (pages[p].insert(w, h, rect))
+				{
+					result[index] = Placement{ int(p), rect.x, rect.y };
+					isPlaced = true;
+				}
+			}
+			if (!isPlaced)
+			{
+				pages.emplace_back(pageW, pageH);
+				pages.back().insert(w, h, rect);
+				result[index] = Placement{ int(pages.size()) - 1, rect.x, rect.y };
+			}
+		}
+		pageNum = int(pages.size());
+		return result;
+	}
+};
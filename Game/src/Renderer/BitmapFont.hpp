@@ -0,0 +1,403 @@
+﻿/**
+* @file BitmapFont.hpp
+* @brief 文字をあらかじめ1枚の画像に描いておくビットマップフォントと、文字列の配置をキャッシュするクラスです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderQueue.hpp"
+#include "RenderBackend.hpp"
+#include "../Utility/Utility.hpp"
+#include <DxLib.h>
+#include <memory>
+#include <array>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+//!ビットマップフォントの1文字の、フォントの画像上の範囲と送り幅です
+struct Glyph
+{
+	int x = 0;
+	int y = 0;
+	int w = 0;
+	int h = 0;
+	//!次の文字までの幅
+	int advance = 0;
+	bool isValid = false;
+};
+
+/**
+* @brief 読み込むときに文字を1枚の画像に描いておくフォントです
+* @details 1バイトの文字だけを扱います。文字ごとの描画はこの画像の範囲を描くだけなので、DXライブラリの文字列描画のように毎回文字を描き直しません
+*/
+class BitmapFont final
+{
+private:
+	//!文字の間の余白。拡大や補間で隣の文字がにじまないようにします
+	static constexpr int GLYPH_PADDING = 1;
+	std::array<Glyph, 256> glyphs_{};
+	int handle_ = -1;
+	int lineHeight_ = 0;
+	int pageW_ = 0;
+	int pageH_ = 0;
+public:
+	BitmapFont() = default;
+	BitmapFont(const BitmapFont&) = delete;
+	BitmapFont& operator=(const BitmapFont&) = delete;
+	~BitmapFont()
+	{
+		if (handle_ != -1)
+		{
+			DeleteGraph(handle_);
+		}
+	}
+	/**
+	* @brief フォントを作って文字を画像に描きます
+	* @param fontName フォント名。CreateFontToHandleと同じです
+	* @param size 文字の大きさ
+	* @param thick 文字の太さ。-1なら標準です
+	* @param fontType DX_FONTTYPE_NORMALなど。CreateFontToHandleと同じです
+	* @param chars 画像に描く文字。空なら表示できるASCII文字(0x20から0x7E)です
+	* @return 成功したらtrue
+	*/
+	bool create(const std::string& fontName, const int size, const int thick, const int fontType, const std::string& chars)
+	{
+		std::string list = chars;
+		if (list.empty())
+		{
+			for (int c = 0x20; c <= 0x7e; ++c)
+			{
+				list += char(c);
+			}
+		}
+		const int font = CreateFontToHandle(fontName.empty() ? nullptr : fontName.c_str(), size, thick, fontType);
+		if (font == -1)
+		{
+			return false;
+		}
+		lineHeight_ = std::max(GetFontLineSpaceToHandle(font), GetFontSizeToHandle(font));
+		//文字の幅を求めて、幅の決まった画像に左から順に並べる
+		int totalW = 0;
+		for (const char c : list)
+		{
+			Glyph& g = glyphs_[static_cast<unsigned char>(c)];
+			const char str[2] = { c, '\0' };
+			g.advance = GetDrawStringWidthToHandle(str, 1, font);
+			g.w = g.advance;
+			g.h = lineHeight_;
+			totalW += g.w + GLYPH_PADDING * 2;
+		}
+		pageW_ = 64;
+		while (pageW_ * pageW_ < totalW * (lineHeight_ + GLYPH_PADDING * 2) && pageW_ < 4096)
+		{
+			pageW_ *= 2;
+		}
+		int x = 0, y = 0;
+		for (const char c : list)
+		{
+			Glyph& g = glyphs_[static_cast<unsigned char>(c)];
+			if (x + g.w + GLYPH_PADDING * 2 > pageW_)
+			{
+				x = 0;
+				y += lineHeight_ + GLYPH_PADDING * 2;
+			}
+			g.x = x + GLYPH_PADDING;
+			g.y = y + GLYPH_PADDING;
+			x += g.w + GLYPH_PADDING * 2;
+		}
+		pageH_ = y + lineHeight_ + GLYPH_PADDING * 2;
+		const int softImage = MakeARGB8ColorSoftImage(pageW_, pageH_);
+		FillSoftImage(softImage, 255, 255, 255, 0);
+		for (const char c : list)
+		{
+			Glyph& g = glyphs_[static_cast<unsigned char>(c)];
+			const char str[2] = { c, '\0' };
+			if (c != ' ')
+			{
+				BltStringSoftImageToHandle(g.x, g.y, str, softImage, -1, font, FALSE);
+			}
+			g.isValid = true;
+		}
+		DeleteFontToHandle(font);
+		if (handle_ != -1)
+		{
+			DeleteGraph(handle_);
+		}
+		handle_ = CreateGraphFromSoftImage(softImage);
+		DeleteSoftImage(softImage);
+		return handle_ != -1;
+	}
+	//!文字を返します。画像に描いていない文字ならisValidがfalseです
+	[[nodiscard]] const Glyph& getGlyph(const char c) const
+	{
+		return glyphs_[static_cast<unsigned char>(c)];
+	}
+	//!文字を描いた画像のハンドルを返します
+	[[nodiscard]] int getHandle() const
+	{
+		return handle_;
+	}
+	//!1行の高さを返します
+	[[nodiscard]] int lineHeight() const
+	{
+		return lineHeight_;
+	}
+	//!文字を描いた画像の大きさを返します
+	void getPageSize(int* w, int* h) const
+	{
+		*w = pageW_;
+		*h = pageH_;
+	}
+};
+
+/**
+* @brief ビットマップフォントを登録名で管理します
+* @details 同じ登録名で読み込み直すと、前のフォントを指すTextLayoutは使えなくなります
+*/
+class FontAtlas final
+{
+private:
+	FontAtlas() = delete;
+	class Singleton final
+	{
+	private:
+		std::unordered_map<std::string, std::unique_ptr<BitmapFont>> fonts_;
+	public:
+		/**
+		* @brief フォントを読み込みます
+		* @param name 登録名
+		* @param fontName フォント名。空ならDXライブラリの標準のフォントです
+		* @param size 文字の大きさ
+		* @param thick 文字の太さ。-1なら標準です
+		* @param fontType DX_FONTTYPE_NORMALなど
+		* @param chars 画像に描く文字。空なら表示できるASCII文字です
+		* @return 成功したらtrue。すでに登録した名前ならそのまま使います
+		*/
+		bool load(const std::string& name, const std::string& fontName, const int size, const int thick = -1,
+			const int fontType = DX_FONTTYPE_ANTIALIASING, const std::string& chars = "")
+		{
+			if (fonts_.count(name))
+			{
+				return true;
+			}
+			auto font = std::make_unique<BitmapFont>();
+			if (!font->create(fontName, size, thick, fontType, chars))
+			{
+				DOUT << "BitmapFont :" + name + " load is failed" << std::endl;
+				return false;
+			}
+			fonts_[name] = std::move(font);
+			return true;
+		}
+		//!フォントを返します。無ければnullptr
+		[[nodiscard]] const BitmapFont* find(const std::string& name) const
+		{
+			const auto it = fonts_.find(name);
+			return it != fonts_.end() ? it->second.get() : nullptr;
+		}
+		//!フォントがあればtrue
+		[[nodiscard]] bool hasFont(const std::string& name) const
+		{
+			return fonts_.count(name) != 0;
+		}
+		//!フォントを解放します
+		void remove(const std::string& name)
+		{
+			fonts_.erase(name);
+		}
+		//!すべてのフォントを解放します
+		void removeAll()
+		{
+			fonts_.clear();
+		}
+	};
+public:
+	static Singleton& Get()
+	{
+		static std::unique_ptr<Singleton> instance = std::make_unique<Singleton>();
+		return *instance;
+	}
+};
+
+/**
+* @brief 文字列を配置した結果をキャッシュします
+* @details 文字列が変わったときだけ文字を並べ直し、1文字ごとの描画命令を作っておきます。
+* 描画はキャッシュした命令の座標をずらしてRenderQueueに積むだけです
+* - すべての文字は同じ画像と同じマテリアルなので、SpriteBatchでまとめて描画されます
+* - 改行('\n')で次の行に移ります。フォントに無い文字は空白の幅だけ空けます
+*/
+class TextLayout final
+{
+private:
+	const BitmapFont* font_ = nullptr;
+	std::string text_;
+	//!文字ごとの描画命令。座標は文字列の左上からの位置です
+	std::vector<RenderQueue::Command> commands_;
+	RenderQueue::MaterialCache materialCache_;
+	float width_ = 0.f;
+	float height_ = 0.f;
+	size_t layoutNum_ = 0;
+
+	void layout()
+	{
+		++layoutNum_;
+		commands_.clear();
+		width_ = 0.f;
+		height_ = 0.f;
+		if (font_ == nullptr)
+		{
+			return;
+		}
+		const int space = font_->getGlyph(' ').advance;
+		int x = 0, y = 0;
+		for (const char c : text_)
+		{
+			if (c == '\n')
+			{
+				x = 0;
+				y += font_->lineHeight();
+				continue;
+			}
+			const Glyph& g = font_->getGlyph(c);
+			if (!g.isValid)
+			{
+				x += space;
+				continue;
+			}
+			if (c != ' ')
+			{
+				RenderQueue::Command cmd;
+				cmd.type = RenderQueue::CommandType::RECT_ROTA_GRAPH;
+				cmd.x = float(x);
+				cmd.y = float(y);
+				cmd.srcX = g.x;
+				cmd.srcY = g.y;
+				cmd.srcW = g.w;
+				cmd.srcH = g.h;
+				commands_.emplace_back(cmd);
+			}
+			x += g.advance;
+			width_ = std::max(width_, float(x));
+		}
+		height_ = text_.empty() ? 0.f : float(y + font_->lineHeight());
+	}
+public:
+	explicit TextLayout(const BitmapFont* font = nullptr) :
+		font_(font)
+	{}
+	//!使うフォントを指定します。変わったときだけ並べ直します
+	void setFont(const BitmapFont* font)
+	{
+		if (font_ != font)
+		{
+			font_ = font;
+			layout();
+		}
+	}
+	/**
+	* @brief 文字列を指定します
+	* @return 文字列が変わって並べ直したらtrue
+	*/
+	bool setText(const char* text)
+	{
+		if (text_ == text)
+		{
+			return false;
+		}
+		text_ = text;
+		layout();
+		return true;
+	}
+	/**
+	* @brief 整数を文字列にして指定します。文字列の領域は使い回すので、値が変わらなければ何もしません
+	* @param value 表示する値
+	* @param minDigits 最小の桁数。足りない桁は0で埋めます
+	* @return 文字列が変わって並べ直したらtrue
+	*/
+	bool setNumber(const long long value, const int minDigits = 0)
+	{
+		char buffer[32];
+		char* end = buffer + sizeof(buffer) - 1;
+		char* p = end;
+		*p = '\0';
+		unsigned long long n = value < 0 ? 0ull - static_cast<unsigned long long>(value) : static_cast<unsigned long long>(value);
+		do
+		{
+			*--p = char('0' + n % 10);
+			n /= 10;
+		} while (n != 0 && p > buffer + 1);
+		while (end - p < std::min(minDigits, int(sizeof(buffer)) - 2) && p > buffer + 1)
+		{
+			*--p = '0';
+		}
+		if (value < 0)
+		{
+			*--p = '-';
+		}
+		return setText(p);
+	}
+	/**
+	* @brief 左上を指定して描画します
+	* @param material 色とブレンド。画像ハンドルはフォントのものに置き換えます
+	* @details RenderQueueが命令をため中なら命令を積み、そうでなければそのまま描画します
+	*/
+	void draw(const float x, const float y, RenderQueue::Material material)
+	{
+		if (font_ == nullptr || commands_.empty())
+		{
+			return;
+		}
+		material.handle = font_->getHandle();
+		if (RenderQueue::Get().isRecording())
+		{
+			const uint16_t id = RenderQueue::Get().intern(material, materialCache_);
+			for (const auto& it : commands_)
+			{
+				RenderQueue::Command c = it;
+				c.material = id;
+				c.x += x;
+				c.y += y;
+				RenderQueue::Get().push(c);
+			}
+			return;
+		}
+		RenderBackend::Get().setBlend(material.blendMode, material.alpha);
+		RenderBackend::Get().setBright(material.red, material.green, material.blue);
+		for (const auto& c : commands_)
+		{
+			RenderBackend::Get().drawRectRotaGraph(c.x + x, c.y + y, c.srcX, c.srcY, c.srcW, c.srcH,
+				0.f, 0.f, 1.0, 1.0, 0.0, material.handle, false);
+		}
+		RenderBackend::Get().setBlend(DX_BLENDMODE_NOBLEND, 255);
+		RenderBackend::Get().setBright(255, 255, 255);
+	}
+	//!今の文字列を返します
+	[[nodiscard]] const std::string& getText() const
+	{
+		return text_;
+	}
+	//!文字列の幅を返します
+	[[nodiscard]] float width() const
+	{
+		return width_;
+	}
+	//!文字列の高さを返します
+	[[nodiscard]] float height() const
+	{
+		return height_;
+	}
+	//!描画する文字の数を返します
+	[[nodiscard]] size_t glyphNum() const
+	{
+		return commands_.size();
+	}
+	//!これまでに並べ直した回数を返します
+	[[nodiscard]] size_t layoutNum() const
+	{
+		return layoutNum_;
+	}
+};
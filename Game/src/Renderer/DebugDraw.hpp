@@ -0,0 +1,266 @@
+﻿/**
+* @file DebugDraw.hpp
+* @brief 当たり判定などのデバッグ表示を1フレーム分ためて、まとめて描画します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderBackend.hpp"
+#include <DxLib.h>
+#include <memory>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+//デバッグビルドでだけデバッグ表示を有効にします。DEBUG_DRAW_DISABLEを定義するとデバッグビルドでも無効になります
+#if defined(_DEBUG) && !defined(DEBUG_DRAW_DISABLE)
+#define DEBUG_DRAW_ENABLE
+#endif
+
+/**
+* @brief 線と図形をためて、フレームの最後に線のリストと三角形のリストでまとめて描画します
+* @details 図形ごとにDrawCircleAAなどを呼ぶ代わりに頂点を積むので、図形がいくつあっても描画は数回の呼び出しで済みます
+* - 図形はカテゴリごとにsetEnable()で表示を切り替えられます。無効なカテゴリの図形は積みません
+* - 積むのはスレッドセーフなので、並列に描画命令を積む間でも使えます
+* - ためた図形は、次にRenderQueueがflush()かpublish()でスナップショットを作るときに移され、スプライトの上に描画されます。
+*   命令をため始める前のupdate()の中で積んだ図形も、そのフレームに描画されます
+* - DEBUG_DRAW_ENABLEが定義されていないビルドでは何もしない関数になり、Frameも空になります
+*/
+class DebugDraw final
+{
+public:
+	//!表示を切り替える単位です
+	enum class Category : uint32_t
+	{
+		COLLIDER,	//当たり判定の形状
+		QUERY,		//BroadPhaseの範囲検索
+		USER,		//その他
+		MAX,
+	};
+#ifdef DEBUG_DRAW_ENABLE
+	//!1フレーム分の頂点です
+	struct Frame
+	{
+		//!2頂点で1本の線
+		std::vector<VERTEX2D> lines;
+		//!3頂点で1つの三角形
+		std::vector<VERTEX2D> triangles;
+		void clear()
+		{
+			lines.clear();
+			triangles.clear();
+		}
+	};
+private:
+	DebugDraw() = delete;
+	class Singleton final
+	{
+	private:
+		//!1回の描画に渡す頂点の最大数。2と3の倍数で16bitのインデックスに収まる数です
+		static constexpr size_t CHUNK_VERTEX_MAX = 65532;
+		std::mutex mutex_;
+		Frame recording_;
+		std::atomic<uint32_t> enableMask_{ 1u << uint32_t(Category::COLLIDER) };
+		//!三角形のリストを描画するための0から並んだインデックス
+		std::vector<unsigned short> sequence_;
+
+		[[nodiscard]] static VERTEX2D MakeVertex(const float x, const float y, const unsigned int color)
+		{
+			VERTEX2D v;
+			v.pos = VGet(x, y, 0.f);
+			v.rhw = 1.f;
+			v.dif = GetColorU8(int((color >> 16) & 0xff), int((color >> 8) & 0xff), int(color & 0xff), 255);
+			v.u = 0.f;
+			v.v = 0.f;
+			return v;
+		}
+		//!頂点の並びを閉じた線にして積みます
+		void pushLoop(const float* xs, const float* ys, const size_t num, const unsigned int color)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (size_t i = 0; i < num; ++i)
+			{
+				const size_t next = (i + 1) % num;
+				recording_.lines.emplace_back(MakeVertex(xs[i], ys[i], color));
+				recording_.lines.emplace_back(MakeVertex(xs[next], ys[next], color));
+			}
+		}
+		//!頂点の並びを扇形の三角形にして積みます
+		void pushFan(const float* xs, const float* ys, const size_t num, const unsigned int color)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			for (size_t i = 1; i + 1 < num; ++i)
+			{
+				recording_.triangles.emplace_back(MakeVertex(xs[0], ys[0], color));
+				recording_.triangles.emplace_back(MakeVertex(xs[i], ys[i], color));
+				recording_.triangles.emplace_back(MakeVertex(xs[i + 1], ys[i + 1], color));
+			}
+		}
+	public:
+		//!カテゴリの表示を切り替えます
+		void setEnable(const Category category, const bool isEnable)
+		{
+			const uint32_t bit = 1u << uint32_t(category);
+			if (isEnable)
+			{
+				enableMask_.fetch_or(bit);
+				return;
+			}
+			enableMask_.fetch_and(~bit);
+		}
+		//!カテゴリの表示を反転します
+		void toggle(const Category category)
+		{
+			enableMask_.fetch_xor(1u << uint32_t(category));
+		}
+		//!カテゴリを表示するならtrue
+		[[nodiscard]] bool isEnabled(const Category category) const
+		{
+			return (enableMask_.load(std::memory_order_relaxed) & (1u << uint32_t(category))) != 0;
+		}
+		//!線を積みます
+		void line(const Category category, const float x1, const float y1, const float x2, const float y2, const unsigned int color)
+		{
+			if (!isEnabled(category))
+			{
+				return;
+			}
+			std::lock_guard<std::mutex> lock(mutex_);
+			recording_.lines.emplace_back(MakeVertex(x1, y1, color));
+			recording_.lines.emplace_back(MakeVertex(x2, y2, color));
+		}
+		//!軸に沿った矩形を積みます
+		void box(const Category category, const float x1, const float y1, const float x2, const float y2,
+			const unsigned int color, const bool isFill = false)
+		{
+			quad(category, x1, y1, x2, y1, x2, y2, x1, y2, color, isFill);
+		}
+		//!4頂点を順につないだ四角形を積みます
+		void quad(const Category category, const float x1, const float y1, const float x2, const float y2,
+			const float x3, const float y3, const float x4, const float y4, const unsigned int color, const bool isFill = false)
+		{
+			if (!isEnabled(category))
+			{
+				return;
+			}
+			const float xs[4] = { x1, x2, x3, x4 };
+			const float ys[4] = { y1, y2, y3, y4 };
+			isFill ? pushFan(xs, ys, 4, color) : pushLoop(xs, ys, 4, color);
+		}
+		/**
+		* @brief 円を積みます
+		* @param posNum 円周の分割数。3から64までです
+		*/
+		void circle(const Category category, const float x, const float y, const float r,
+			const unsigned int color, const bool isFill = false, const int posNum = 24)
+		{
+			if (!isEnabled(category))
+			{
+				return;
+			}
+			const size_t num = size_t(std::clamp(posNum, 3, 64));
+			float xs[64], ys[64];
+			//円周上の点は1つ前の点を回転させて求める
+			const float step = 6.28318530718f / float(num);
+			const float c = std::cos(step);
+			const float s = std::sin(step);
+			float dx = r;
+			float dy = 0.f;
+			for (size_t i = 0; i < num; ++i)
+			{
+				xs[i] = x + dx;
+				ys[i] = y + dy;
+				const float nx = dx * c - dy * s;
+				dy = dx * s + dy * c;
+				dx = nx;
+			}
+			isFill ? pushFan(xs, ys, num, color) : pushLoop(xs, ys, num, color);
+		}
+		//!カプセルを積みます
+		void capsule(const Category category, const float x1, const float y1, const float x2, const float y2,
+			const float r, const unsigned int color)
+		{
+			if (!isEnabled(category))
+			{
+				return;
+			}
+			const float dx = x2 - x1;
+			const float dy = y2 - y1;
+			const float length = std::sqrt(dx * dx + dy * dy);
+			const float nx = length > 0.f ? -dy / length * r : 0.f;
+			const float ny = length > 0.f ? dx / length * r : r;
+			circle(category, x1, y1, r, color);
+			circle(category, x2, y2, r, color);
+			line(category, x1 + nx, y1 + ny, x2 + nx, y2 + ny, color);
+			line(category, x1 - nx, y1 - ny, x2 - nx, y2 - ny, color);
+		}
+		//!ためた図形をframeに移します。確保した領域は入れ替えて使い回します
+		void publish(Frame& frame)
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			std::swap(frame.lines, recording_.lines);
+			std::swap(frame.triangles, recording_.triangles);
+			recording_.clear();
+		}
+		//!frameの図形を描画します。描画の状態は初期状態にしてから呼んでください
+		void draw(const Frame& frame)
+		{
+			for (size_t i = 0; i < frame.lines.size(); i += CHUNK_VERTEX_MAX)
+			{
+				const size_t num = std::min(CHUNK_VERTEX_MAX, frame.lines.size() - i);
+				RenderBackend::Get().drawLineList(&frame.lines[i], int(num));
+			}
+			if (frame.triangles.empty())
+			{
+				return;
+			}
+			if (sequence_.empty())
+			{
+				sequence_.resize(CHUNK_VERTEX_MAX);
+				for (size_t i = 0; i < CHUNK_VERTEX_MAX; ++i)
+				{
+					sequence_[i] = static_cast<unsigned short>(i);
+				}
+			}
+			for (size_t i = 0; i < frame.triangles.size(); i += CHUNK_VERTEX_MAX)
+			{
+				const size_t num = std::min(CHUNK_VERTEX_MAX, frame.triangles.size() - i);
+				RenderBackend::Get().drawPrimitiveIndexed(&frame.triangles[i], int(num), sequence_.data(), int(num), DX_NONE_GRAPH);
+			}
+		}
+	};
+#else
+	struct Frame
+	{
+		void clear() {}
+	};
+private:
+	DebugDraw() = delete;
+	//!デバッグ表示が無効なビルドでは何もしません
+	class Singleton final
+	{
+	public:
+		void setEnable(const Category, const bool) {}
+		void toggle(const Category) {}
+		[[nodiscard]] constexpr bool isEnabled(const Category) const { return false; }
+		void line(const Category, const float, const float, const float, const float, const unsigned int) {}
+		void box(const Category, const float, const float, const float, const float, const unsigned int, const bool = false) {}
+		void quad(const Category, const float, const float, const float, const float,
+			const float, const float, const float, const float, const unsigned int, const bool = false) {}
+		void circle(const Category, const float, const float, const float, const unsigned int, const bool = false, const int = 24) {}
+		void capsule(const Category, const float, const float, const float, const float, const float, const unsigned int) {}
+		void publish(Frame&) {}
+		void draw(const Frame&) {}
+	};
+#endif
+public:
+	static Singleton& Get()
+	{
+		static std::unique_ptr<Singleton> instance = std::make_unique<Singleton>();
+		return *instance;
+	}
+};
@@ -0,0 +1,75 @@
+﻿/**
+* @file DebugDrawVerifier.hpp
+* @brief DebugDrawに積んだ図形がRenderQueueのフレームに届くかを検証します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "DebugDraw.hpp"
+#include "RenderQueue.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "../Utility/Utility.hpp"
+#include <DxLib.h>
+#include <cstdint>
+#include <cassert>
+
+/**
+* @brief DebugDrawの検証です
+* @details 次のことを確かめます
+* - RenderQueueが命令をため始める前、つまりupdate()の中で積んだ図形が、そのフレームに描画されること
+* - 描画した図形が次のフレームに残らないこと
+*
+* 描画の出力先を一時的にSoftwareRasterizerに替えて、画素を見ます。ゲームループを始める前に呼んでください。
+* DEBUG_DRAW_ENABLEが定義されていないビルドでは何もせずtrueを返します
+*/
+class DebugDrawVerifier final
+{
+private:
+	DebugDrawVerifier() = delete;
+	static constexpr int SIZE = 64;
+	//!背景の色です。SoftwareRasterizerの画素は不透明の黒になります
+	static constexpr uint32_t CLEAR_PIXEL = 0xff000000u;
+
+	//!命令をため始めてから描画までを1フレーム分行い、画面の中央の画素を返します
+	[[nodiscard]] static uint32_t DrawFrame(SoftwareRasterizer& raster)
+	{
+		raster.clear(0, 0, 0);
+		RenderQueue::Get().begin();
+		RenderQueue::Get().flush();
+		raster.finish(1);
+		return raster.pixels()[size_t(SIZE / 2) * SIZE + SIZE / 2];
+	}
+public:
+	/**
+	* @brief 検証を行います
+	* @return すべて正しければtrue
+	*/
+	static bool Run()
+	{
+#ifdef DEBUG_DRAW_ENABLE
+		auto& debugDraw = DebugDraw::Get();
+		const bool isQueryEnabled = debugDraw.isEnabled(DebugDraw::Category::QUERY);
+		IRenderBackend* output = &RenderBackend::GetOutput();
+		SoftwareRasterizer raster(SIZE, SIZE);
+		RenderBackend::Set(&raster);
+		debugDraw.setEnable(DebugDraw::Category::QUERY, true);
+		//前に積まれていた図形を捨てる
+		(void)DrawFrame(raster);
+
+		//BroadPhaseがupdate()の中で範囲検索を積むのと同じく、begin()の前に積む
+		debugDraw.box(DebugDraw::Category::QUERY, 8.f, 8.f, 56.f, 56.f, GetColor(255, 255, 0), true);
+		const bool isRecordedOk = DrawFrame(raster) != CLEAR_PIXEL;
+		const bool isClearedOk = DrawFrame(raster) == CLEAR_PIXEL;
+
+		debugDraw.setEnable(DebugDraw::Category::QUERY, isQueryEnabled);
+		RenderBackend::Set(output);
+		const bool isOk = isRecordedOk && isClearedOk;
+		DOUT << "DebugDrawVerifier : shapes before begin() " << (isRecordedOk ? "ok" : "NG")
+			<< ", next frame " << (isClearedOk ? "ok" : "NG") << std::endl;
+		assert(isOk && "debug draw shapes are lost or left over");
+		return isOk;
+#else
+		return true;
+#endif
+	}
+};
@@ -0,0 +1,355 @@
+﻿/**
+* @file DeferredBackend.hpp
+* @brief 描画の呼び出しを記録して、後で別の出力先に描画し直します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderBackend.hpp"
+#include "../Utility/BinaryStream.hpp"
+#include <DxLib.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+/**
+* @brief 呼ばれた描画をそのまま記録する出力先です
+* @details replay()で記録した順に別の出力先へ描画します。描画しないスレッドから直接描画するコンポーネントの呼び出しを運ぶのに使います
+* - 頂点とインデックスは記録するときに複製します
+* - getGraphSize()、getTextureRegion()と描画先の作成、削除、問い合わせは記録せず、RenderBackend::GetOutput()にそのまま渡します
+* - write()とread()で記録をバイト列にして保存できます
+*/
+class DeferredBackend final : public IRenderBackend
+{
+private:
+	enum class CallType : uint8_t
+	{
+		DRAW_MODE,
+		BLEND,
+		BRIGHT,
+		ROTA_GRAPH,
+		RECT_ROTA_GRAPH,
+		PRIMITIVE,
+		LINE_LIST,
+		LINE,
+		BOX,
+		CIRCLE,
+		QUADRANGLE,
+		SET_TARGET,
+		CLEAR_TARGET,
+		BLIT_TARGET,
+		MAX,
+	};
+	//!1回の呼び出しの引数です。使う欄は種類ごとに違います
+	struct Call
+	{
+		CallType type = CallType::DRAW_MODE;
+		bool flag = false;
+		unsigned int color = 0;
+		int i[6]{};
+		float f[9]{};
+		double d[3]{};
+	};
+	std::vector<Call> calls_;
+	std::vector<VERTEX2D> vertices_;
+	std::vector<unsigned short> indices_;
+
+	[[nodiscard]] Call& add(const CallType type)
+	{
+		calls_.emplace_back();
+		calls_.back().type = type;
+		return calls_.back();
+	}
+public:
+	//!記録を捨てます。確保した領域は使い回します
+	void clear()
+	{
+		calls_.clear();
+		vertices_.clear();
+		indices_.clear();
+	}
+	//!記録が無ければtrue
+	[[nodiscard]] bool empty() const
+	{
+		return calls_.empty();
+	}
+	//!記録した呼び出しの数を返します
+	[[nodiscard]] size_t size() const
+	{
+		return calls_.size();
+	}
+	//!記録をバイト列に書き出します
+	void write(BinaryWriter& out) const
+	{
+		out.write(uint32_t(calls_.size()));
+		out.write(uint32_t(vertices_.size()));
+		out.write(uint32_t(indices_.size()));
+		for (const auto& c : calls_)
+		{
+			out.write(uint8_t(c.type));
+			out.write(uint8_t(c.flag));
+			out.write(c.color);
+			out.writeArray(c.i, 6);
+			out.writeArray(c.f, 9);
+			out.writeArray(c.d, 3);
+		}
+		out.writeArray(vertices_.data(), vertices_.size());
+		out.writeArray(indices_.data(), indices_.size());
+	}
+	/**
+	* @brief write()で書き出した記録を読み込みます。今の記録は捨てます
+	* @return 読み込めなかったり、頂点の範囲が壊れていたらfalse
+	*/
+	bool read(BinaryReader& in)
+	{
+		clear();
+		uint32_t callNum = 0, vertexNum = 0, indexNum = 0;
+		in.read(callNum);
+		in.read(vertexNum);
+		in.read(indexNum);
+		//壊れた数で大きな領域を確保しないように、残りのバイト数で確かめる
+		if (!in.isOk() || in.remain() < size_t(callNum) * 2)
+		{
+			return false;
+		}
+		calls_.resize(callNum);
+		for (auto& c : calls_)
+		{
+			uint8_t type = 0, flag = 0;
+			in.read(type);
+			in.read(flag);
+			in.read(c.color);
+			in.readArray(c.i, 6);
+			in.readArray(c.f, 9);
+			in.readArray(c.d, 3);
+			if (type >= uint8_t(CallType::MAX))
+			{
+				return false;
+			}
+			c.type = CallType(type);
+			c.flag = flag != 0;
+		}
+		if (!in.isOk() || in.remain() < size_t(vertexNum) * sizeof(VERTEX2D) + size_t(indexNum) * sizeof(unsigned short))
+		{
+			return false;
+		}
+		vertices_.resize(vertexNum);
+		indices_.resize(indexNum);
+		in.readArray(vertices_.data(), vertices_.size());
+		in.readArray(indices_.data(), indices_.size());
+		for (const auto& c : calls_)
+		{
+			const bool hasVertex = c.type == CallType::PRIMITIVE || c.type == CallType::LINE_LIST;
+			if (hasVertex && (c.i[1] < 0 || c.i[2] < 0 || size_t(c.i[1]) + size_t(c.i[2]) > vertices_.size()))
+			{
+				return false;
+			}
+			if (c.type != CallType::PRIMITIVE)
+			{
+				continue;
+			}
+			if (c.i[3] < 0 || c.i[4] < 0 || size_t(c.i[3]) + size_t(c.i[4]) > indices_.size())
+			{
+				return false;
+			}
+			for (int k = 0; k < c.i[4]; ++k)
+			{
+				if (indices_[size_t(c.i[3] + k)] >= c.i[2])
+				{
+					return false;
+				}
+			}
+		}
+		return in.isOk();
+	}
+	//!記録した順にtargetへ描画します。記録は残ります
+	void replay(IRenderBackend& target) const
+	{
+		replay(target, 0, calls_.size());
+	}
+	//!記録したbegin番目からend番目の手前までの呼び出しを、記録した順にtargetへ描画します
+	void replay(IRenderBackend& target, const size_t begin, const size_t end) const
+	{
+		assert(begin <= end && end <= calls_.size() && "replay range is out of range");
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Call& c = calls_[i];
+			switch (c.type)
+			{
+			case CallType::DRAW_MODE:
+				target.setDrawMode(c.i[0]);
+				break;
+			case CallType::BLEND:
+				target.setBlend(c.i[0], c.i[1]);
+				break;
+			case CallType::BRIGHT:
+				target.setBright(c.i[0], c.i[1], c.i[2]);
+				break;
+			case CallType::ROTA_GRAPH:
+				target.drawRotaGraph(c.f[0], c.f[1], c.f[2], c.f[3], c.d[0], c.d[1], c.d[2], c.i[0], c.flag);
+				break;
+			case CallType::RECT_ROTA_GRAPH:
+				target.drawRectRotaGraph(c.f[0], c.f[1], c.i[1], c.i[2], c.i[3], c.i[4], c.f[2], c.f[3],
+					c.d[0], c.d[1], c.d[2], c.i[0], c.flag);
+				break;
+			case CallType::PRIMITIVE:
+				target.drawPrimitiveIndexed(&vertices_[size_t(c.i[1])], c.i[2], &indices_[size_t(c.i[3])], c.i[4], c.i[0]);
+				break;
+			case CallType::LINE_LIST:
+				target.drawLineList(&vertices_[size_t(c.i[1])], c.i[2]);
+				break;
+			case CallType::LINE:
+				target.drawLineAA(c.f[0], c.f[1], c.f[2], c.f[3], c.color, c.f[4]);
+				break;
+			case CallType::BOX:
+				target.drawBoxAA(c.f[0], c.f[1], c.f[2], c.f[3], c.color, c.flag, c.f[4]);
+				break;
+			case CallType::CIRCLE:
+				target.drawCircleAA(c.f[0], c.f[1], c.f[2], c.i[0], c.color, c.flag, c.f[3]);
+				break;
+			case CallType::QUADRANGLE:
+				target.drawQuadrangleAA(c.f[0], c.f[1], c.f[2], c.f[3], c.f[4], c.f[5], c.f[6], c.f[7], c.color, c.flag, c.f[8]);
+				break;
+			case CallType::SET_TARGET:
+				target.setRenderTarget(c.i[0]);
+				break;
+			case CallType::CLEAR_TARGET:
+				target.clearRenderTarget();
+				break;
+			case CallType::BLIT_TARGET:
+				target.blitRenderTarget(c.i[0]);
+				break;
+			case CallType::MAX:
+				break;
+			}
+		}
+	}
+	void setDrawMode(const int drawMode) override
+	{
+		add(CallType::DRAW_MODE).i[0] = drawMode;
+	}
+	void setBlend(const int blendMode, const int alpha) override
+	{
+		Call& c = add(CallType::BLEND);
+		c.i[0] = blendMode;
+		c.i[1] = alpha;
+	}
+	void setBright(const int red, const int green, const int blue) override
+	{
+		Call& c = add(CallType::BRIGHT);
+		c.i[0] = red;
+		c.i[1] = green;
+		c.i[2] = blue;
+	}
+	void getGraphSize(const int handle, int* w, int* h) override
+	{
+		RenderBackend::GetOutput().getGraphSize(handle, w, h);
+	}
+	void getTextureRegion(const int handle, int* x, int* y, int* texW, int* texH) override
+	{
+		RenderBackend::GetOutput().getTextureRegion(handle, x, y, texW, texH);
+	}
+	void drawRotaGraph(const float x, const float y, const float cx, const float cy,
+		const double scaleX, const double scaleY, const double angle, const int handle, const bool isTurn) override
+	{
+		Call& c = add(CallType::ROTA_GRAPH);
+		c.f[0] = x; c.f[1] = y; c.f[2] = cx; c.f[3] = cy;
+		c.d[0] = scaleX; c.d[1] = scaleY; c.d[2] = angle;
+		c.i[0] = handle;
+		c.flag = isTurn;
+	}
+	void drawRectRotaGraph(const float x, const float y, const int srcX, const int srcY, const int w, const int h,
+		const float cx, const float cy, const double scaleX, const double scaleY, const double angle,
+		const int handle, const bool isTurn) override
+	{
+		Call& c = add(CallType::RECT_ROTA_GRAPH);
+		c.f[0] = x; c.f[1] = y; c.f[2] = cx; c.f[3] = cy;
+		c.i[0] = handle; c.i[1] = srcX; c.i[2] = srcY; c.i[3] = w; c.i[4] = h;
+		c.d[0] = scaleX; c.d[1] = scaleY; c.d[2] = angle;
+		c.flag = isTurn;
+	}
+	void drawPrimitiveIndexed(const VERTEX2D* vertices, const int vertexNum,
+		const unsigned short* indices, const int indexNum, const int handle) override
+	{
+		Call& c = add(CallType::PRIMITIVE);
+		c.i[0] = handle;
+		c.i[1] = int(vertices_.size());
+		c.i[2] = vertexNum;
+		c.i[3] = int(indices_.size());
+		c.i[4] = indexNum;
+		vertices_.insert(vertices_.end(), vertices, vertices + vertexNum);
+		indices_.insert(indices_.end(), indices, indices + indexNum);
+	}
+	void drawLineList(const VERTEX2D* vertices, const int vertexNum) override
+	{
+		Call& c = add(CallType::LINE_LIST);
+		c.i[1] = int(vertices_.size());
+		c.i[2] = vertexNum;
+		vertices_.insert(vertices_.end(), vertices, vertices + vertexNum);
+	}
+	void drawLineAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const float thickness) override
+	{
+		Call& c = add(CallType::LINE);
+		c.f[0] = x1; c.f[1] = y1; c.f[2] = x2; c.f[3] = y2; c.f[4] = thickness;
+		c.color = color;
+	}
+	void drawBoxAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		Call& c = add(CallType::BOX);
+		c.f[0] = x1; c.f[1] = y1; c.f[2] = x2; c.f[3] = y2; c.f[4] = thickness;
+		c.color = color;
+		c.flag = isFill;
+	}
+	void drawCircleAA(const float x, const float y, const float r, const int posNum,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		Call& c = add(CallType::CIRCLE);
+		c.f[0] = x; c.f[1] = y; c.f[2] = r; c.f[3] = thickness;
+		c.i[0] = posNum;
+		c.color = color;
+		c.flag = isFill;
+	}
+	void drawQuadrangleAA(const float x1, const float y1, const float x2, const float y2,
+		const float x3, const float y3, const float x4, const float y4,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		Call& c = add(CallType::QUADRANGLE);
+		c.f[0] = x1; c.f[1] = y1; c.f[2] = x2; c.f[3] = y2;
+		c.f[4] = x3; c.f[5] = y3; c.f[6] = x4; c.f[7] = y4;
+		c.f[8] = thickness;
+		c.color = color;
+		c.flag = isFill;
+	}
+	int createRenderTarget(const int w, const int h) override
+	{
+		return RenderBackend::GetOutput().createRenderTarget(w, h);
+	}
+	void deleteRenderTarget(const int handle) override
+	{
+		RenderBackend::GetOutput().deleteRenderTarget(handle);
+	}
+	int getRenderTarget() override
+	{
+		return RenderBackend::GetOutput().getRenderTarget();
+	}
+	void setRenderTarget(const int handle) override
+	{
+		add(CallType::SET_TARGET).i[0] = handle;
+	}
+	void clearRenderTarget() override
+	{
+		calls_.emplace_back();
+		calls_.back().type = CallType::CLEAR_TARGET;
+	}
+	void getRenderTargetSize(int* w, int* h) override
+	{
+		RenderBackend::GetOutput().getRenderTargetSize(w, h);
+	}
+	void blitRenderTarget(const int handle) override
+	{
+		add(CallType::BLIT_TARGET).i[0] = handle;
+	}
+};
@@ -0,0 +1,251 @@
+﻿/**
+* @file ImageProcess.hpp
+* @brief 画像を読み込むときに乗算済みアルファへの変換、透明な余白の切り詰め、画素の形式の選択を行います
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include <DxLib.h>
+#include <emmintrin.h>
+#include <string>
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+//!読み込んだ画像を置く画素の形式です
+enum class PixelFormat
+{
+	//!すべての画素が不透明ならRGB8、そうでなければRGBA8にします
+	AUTO,
+	//!アルファ付きの32ビット
+	RGBA8,
+	//!アルファ無しの32ビット。アルファは捨てるので不透明な画像に使ってください
+	RGB8
+};
+
+//!画像を読み込むときに行う処理の指定です
+struct ImageLoadOption
+{
+	//!色にアルファを掛けておきます。描画コンポーネントは乗算済みα用のブレンドで描画します
+	bool isPremultiply = true;
+	//!周りの完全に透明な部分を切り詰めます
+	bool isTrim = true;
+	PixelFormat format = PixelFormat::AUTO;
+};
+
+//!余白を切り詰めた画像が、元の画像のどこにあったかです
+struct ImageTrim
+{
+	//!切り詰めた画像の左上の、元の画像での位置
+	int offsetX = 0;
+	int offsetY = 0;
+	//!切り詰めた画像の大きさ
+	int w = 0;
+	int h = 0;
+	//!元の画像の大きさ
+	int sourceW = 0;
+	int sourceH = 0;
+};
+
+/**
+* @brief 読み込んだ画像の画素を、描画しやすい形に直します
+* @details 画像はARGB8のソフトイメージとして読み込み、メモリを直接書き換えます
+* - 乗算済みアルファに直すと、バイリニア補間で透明な画素の色がにじまず、加算と通常の合成を同じ画像で使い分けられます
+* - 余白を切り詰めると、描画で塗る面積とアトラスで使う面積が減ります。描画の基準座標はImageTrimで元の画像に合わせてください
+* - 変換は画像の読み込み時に一度だけ行うので、ゲーム中には呼ばないでください
+*/
+class ImageProcess final
+{
+public:
+	//!切り詰めるときに残す透明な画素の幅です。バイリニア補間で縁が元の画像と同じようににじむようにします
+	static constexpr int TRIM_MARGIN = 1;
+private:
+	ImageProcess() = delete;
+	//!0～255*255の値を255で割って四捨五入します
+	[[nodiscard]] static uint32_t Div255(uint32_t x) noexcept
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+	//!8個の16ビットの値を255で割って四捨五入します。Div255()と同じ結果になります
+	[[nodiscard]] static __m128i Div255x8(__m128i x) noexcept
+	{
+		x = _mm_add_epi16(x, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+	//!ソフトイメージのy行目の先頭を返します
+	[[nodiscard]] static uint32_t* Row(const int softImage, const int y)
+	{
+		return reinterpret_cast<uint32_t*>(static_cast<uint8_t*>(GetImageAddressSoftImage(softImage)) +
+			size_t(y) * size_t(GetPitchSoftImage(softImage)));
+	}
+public:
+	//!Load()の結果です
+	struct Result
+	{
+		//!処理した画像のソフトイメージ。読み込めなければ-1です。使い終わったらDeleteSoftImage()で解放してください
+		int softImage = -1;
+		ImageTrim trim;
+		//!余白を切り詰めたらtrue
+		bool isTrimmed = false;
+		//!乗算済みアルファに直したらtrue。不透明な画像は直しても変わらないのでfalseです
+		bool isPremultiplied = false;
+		//!アルファ付きの形式ならtrue
+		bool hasAlpha = false;
+	};
+	/**
+	* @brief 0xAARRGGBBの画素の色にアルファを掛けます
+	* @param isSimd falseなら1画素ずつ計算します。結果はどちらも同じです
+	* @details SSE2で4画素ずつ、16ビットに広げて掛けてから255で割って四捨五入します
+	*/
+	static void Premultiply(uint32_t* pixels, const size_t num, const bool isSimd = true) noexcept
+	{
+		size_t i = 0;
+		if (isSimd)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			//アルファのチャンネルには255を掛けて値を変えない
+			const __m128i alphaMask = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+			const __m128i alphaOne = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+			for (; i + 4 <= num; i += 4)
+			{
+				const __m128i p = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pixels + i));
+				const __m128i lo = _mm_unpacklo_epi8(p, zero);
+				const __m128i hi = _mm_unpackhi_epi8(p, zero);
+				const __m128i aLo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				const __m128i aHi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+				const __m128i mLo = _mm_or_si128(_mm_andnot_si128(alphaMask, aLo), alphaOne);
+				const __m128i mHi = _mm_or_si128(_mm_andnot_si128(alphaMask, aHi), alphaOne);
+				const __m128i result = _mm_packus_epi16(
+					Div255x8(_mm_mullo_epi16(lo, mLo)), Div255x8(_mm_mullo_epi16(hi, mHi)));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + i), result);
+			}
+		}
+		for (; i < num; ++i)
+		{
+			const uint32_t p = pixels[i];
+			const uint32_t a = p >> 24;
+			pixels[i] = (a << 24) |
+				(Div255(((p >> 16) & 0xff) * a) << 16) |
+				(Div255(((p >> 8) & 0xff) * a) << 8) |
+				Div255((p & 0xff) * a);
+		}
+	}
+	/**
+	* @brief アルファが0でない画素を囲む範囲を求めます
+	* @param pitch 1行のバイト数
+	* @param trim 範囲が返ります
+	* @return すべて透明ならfalse
+	*/
+	[[nodiscard]] static bool FindOpaqueBounds(const uint32_t* pixels, const int w, const int h, const int pitch, ImageTrim& trim) noexcept
+	{
+		int x0 = w, y0 = h, x1 = -1, y1 = -1;
+		for (int y = 0; y < h; ++y)
+		{
+			const uint32_t* row = reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(pixels) + size_t(y) * size_t(pitch));
+			int left = 0;
+			while (left < w && (row[left] >> 24) == 0)
+			{
+				++left;
+			}
+			if (left == w)
+			{
+				continue;
+			}
+			int right = w - 1;
+			while ((row[right] >> 24) == 0)
+			{
+				--right;
+			}
+			x0 = std::min(x0, left);
+			x1 = std::max(x1, right);
+			y0 = std::min(y0, y);
+			y1 = y;
+		}
+		if (x1 < 0)
+		{
+			return false;
+		}
+		trim.offsetX = x0;
+		trim.offsetY = y0;
+		trim.w = x1 - x0 + 1;
+		trim.h = y1 - y0 + 1;
+		trim.sourceW = w;
+		trim.sourceH = h;
+		return true;
+	}
+	//!すべての画素が不透明ならtrue
+	[[nodiscard]] static bool IsOpaque(const uint32_t* pixels, const int w, const int h, const int pitch) noexcept
+	{
+		for (int y = 0; y < h; ++y)
+		{
+			const uint32_t* row = reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(pixels) + size_t(y) * size_t(pitch));
+			for (int x = 0; x < w; ++x)
+			{
+				if ((row[x] >> 24) != 0xff)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+	/**
+	* @brief 画像をARGB8で読み込み、指定した処理をしたソフトイメージを作ります
+	* @param path ファイルパス
+	* @param option 行う処理
+	* @details 形式をRGB8にした場合はアルファを捨てるので、乗算済みアルファには直しません
+	*/
+	[[nodiscard]] static Result Load(const std::string& path, const ImageLoadOption& option)
+	{
+		Result result;
+		const int source = LoadARGB8ColorSoftImage(path.c_str());
+		if (source == -1)
+		{
+			return result;
+		}
+		int w = 0, h = 0;
+		GetSoftImageSize(source, &w, &h);
+		const uint32_t* pixels = Row(source, 0);
+		const int pitch = GetPitchSoftImage(source);
+		const bool isOpaque = IsOpaque(pixels, w, h, pitch);
+		result.hasAlpha = option.format == PixelFormat::RGBA8 || (option.format == PixelFormat::AUTO && !isOpaque);
+
+		ImageTrim trim{ 0, 0, w, h, w, h };
+		if (option.isTrim && !isOpaque && FindOpaqueBounds(pixels, w, h, pitch, trim))
+		{
+			const int x0 = std::max(0, trim.offsetX - TRIM_MARGIN);
+			const int y0 = std::max(0, trim.offsetY - TRIM_MARGIN);
+			trim.w = std::min(w, trim.offsetX + trim.w + TRIM_MARGIN) - x0;
+			trim.h = std::min(h, trim.offsetY + trim.h + TRIM_MARGIN) - y0;
+			trim.offsetX = x0;
+			trim.offsetY = y0;
+			result.isTrimmed = trim.w != w || trim.h != h;
+		}
+		result.trim = trim;
+		if (!result.isTrimmed && result.hasAlpha)
+		{
+			//形式も大きさも変わらないので読み込んだものをそのまま書き換える
+			result.softImage = source;
+		}
+		else
+		{
+			result.softImage = result.hasAlpha ? MakeARGB8ColorSoftImage(trim.w, trim.h) : MakeXRGB8ColorSoftImage(trim.w, trim.h);
+			for (int y = 0; y < trim.h; ++y)
+			{
+				std::memcpy(Row(result.softImage, y), Row(source, trim.offsetY + y) + trim.offsetX, sizeof(uint32_t) * size_t(trim.w));
+			}
+			DeleteSoftImage(source);
+		}
+		if (option.isPremultiply && result.hasAlpha && !isOpaque)
+		{
+			for (int y = 0; y < trim.h; ++y)
+			{
+				Premultiply(Row(result.softImage, y), size_t(trim.w));
+			}
+			result.isPremultiplied = true;
+		}
+		return result;
+	}
+};
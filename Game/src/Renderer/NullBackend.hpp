@@ -0,0 +1,138 @@
+﻿/**
+* @file NullBackend.hpp
+* @brief 何も描画しない描画先です
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderBackend.hpp"
+#include <DxLib.h>
+#include <unordered_map>
+#include <utility>
+#include <cstddef>
+
+/**
+* @brief 描画の呼び出しを数えるだけの出力先です
+* @details RenderQueueなど描画先より手前の処理だけの時間を計測するのに使います
+* - 画像の大きさはsetGraphSize()で登録したものを返します。テクスチャは画像と同じ大きさとします
+* - 描画先は今の描画先と同じ大きさのものを作ったことにします
+*/
+class NullBackend final : public IRenderBackend
+{
+private:
+	std::unordered_map<int, std::pair<int, int>> sizes_;
+	int width_;
+	int height_;
+	int target_ = DX_SCREEN_BACK;
+	int nextTarget_ = 0x40000000;
+	size_t callNum_ = 0;
+public:
+	//!描画先の大きさを指定して作ります
+	NullBackend(const int width, const int height) :
+		width_(width),
+		height_(height)
+	{}
+	//!getGraphSize()で返す画像の大きさを登録します
+	void setGraphSize(const int handle, const int w, const int h)
+	{
+		sizes_[handle] = std::make_pair(w, h);
+	}
+	//!描画と状態の変更が呼ばれた回数を返します
+	[[nodiscard]] size_t callNum() const
+	{
+		return callNum_;
+	}
+	//!呼ばれた回数を0に戻します
+	void resetCallNum()
+	{
+		callNum_ = 0;
+	}
+
+	void setDrawMode(const int) override
+	{
+		++callNum_;
+	}
+	void setBlend(const int, const int) override
+	{
+		++callNum_;
+	}
+	void setBright(const int, const int, const int) override
+	{
+		++callNum_;
+	}
+	void getGraphSize(const int handle, int* w, int* h) override
+	{
+		const auto it = sizes_.find(handle);
+		*w = it != sizes_.end() ? it->second.first : 0;
+		*h = it != sizes_.end() ? it->second.second : 0;
+	}
+	void getTextureRegion(const int handle, int* x, int* y, int* texW, int* texH) override
+	{
+		*x = 0;
+		*y = 0;
+		getGraphSize(handle, texW, texH);
+	}
+	void drawRotaGraph(const float, const float, const float, const float,
+		const double, const double, const double, const int, const bool) override
+	{
+		++callNum_;
+	}
+	void drawRectRotaGraph(const float, const float, const int, const int, const int, const int,
+		const float, const float, const double, const double, const double, const int, const bool) override
+	{
+		++callNum_;
+	}
+	void drawPrimitiveIndexed(const VERTEX2D*, const int, const unsigned short*, const int, const int) override
+	{
+		++callNum_;
+	}
+	void drawLineList(const VERTEX2D*, const int) override
+	{
+		++callNum_;
+	}
+	void drawLineAA(const float, const float, const float, const float, const unsigned int, const float) override
+	{
+		++callNum_;
+	}
+	void drawBoxAA(const float, const float, const float, const float, const unsigned int, const bool, const float) override
+	{
+		++callNum_;
+	}
+	void drawCircleAA(const float, const float, const float, const int, const unsigned int, const bool, const float) override
+	{
+		++callNum_;
+	}
+	void drawQuadrangleAA(const float, const float, const float, const float,
+		const float, const float, const float, const float, const unsigned int, const bool, const float) override
+	{
+		++callNum_;
+	}
+	int createRenderTarget(const int, const int) override
+	{
+		return nextTarget_++;
+	}
+	void deleteRenderTarget(const int) override
+	{}
+	int getRenderTarget() override
+	{
+		return target_;
+	}
+	void setRenderTarget(const int handle) override
+	{
+		target_ = handle;
+		++callNum_;
+	}
+	void clearRenderTarget() override
+	{
+		++callNum_;
+	}
+	void getRenderTargetSize(int* w, int* h) override
+	{
+		*w = width_;
+		*h = height_;
+	}
+	void blitRenderTarget(const int) override
+	{
+		++callNum_;
+	}
+};
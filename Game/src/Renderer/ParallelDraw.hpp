@@ -0,0 +1,110 @@
+﻿/**
+* @file ParallelDraw.hpp
+* @brief Entityの描画命令をスレッドプールで並列に作ります
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "../ECS/ECS.hpp"
+#include "../Utility/ThreadPool.hpp"
+#include "RenderQueue.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cassert>
+
+/**
+* @brief EntityManager::orderByDraw()でRenderQueueに命令を積む処理を、スレッドごとの範囲に分けて行います
+* @details グループ順に並べたEntityを連続した範囲に分け、範囲ごとにRenderQueueの別々の入れ物へ命令を積みます。
+* 入れ物は範囲の順に結合するので、並べ替えた結果はorderByDraw()で逐次に積んだ場合と完全に同じです
+* - 座標の変換、描画範囲の判定、マテリアルの変換が並列になります。並べ替えと描画は呼び出したスレッドで行います
+* - 命令をため中のdraw2D()はRenderQueueに積むだけで、RenderBackendを使いません。描画の出力先に問い合わせる画像の大きさはinitialize()で求めます
+* - 範囲ごとのスレッドはRenderQueue::SlotScopeの中でdraw2D()を呼ぶので、RenderBackendを使うとデバッグビルドではassertで止まります
+* - DebugDrawに積む図形は排他して積むので、範囲をまたいだ図形の順番は実行ごとに変わります
+*/
+class ParallelDraw final
+{
+private:
+	ParallelDraw() = delete;
+	//!範囲の先頭のグループと、グループの中の位置です
+	struct ChunkBegin
+	{
+		ECS::Group group = 0;
+		size_t index = 0;
+	};
+	//!全体の番号からグループとグループの中の位置を求めます
+	[[nodiscard]] static ChunkBegin Locate(ECS::EntityManager& entityManager, const ECS::Group maxGroup, size_t index)
+	{
+		ChunkBegin begin;
+		while (begin.group < maxGroup && index >= entityManager.getEntitiesByGroup(begin.group).size())
+		{
+			index -= entityManager.getEntitiesByGroup(begin.group).size();
+			++begin.group;
+		}
+		begin.index = index;
+		return begin;
+	}
+	//!全体の番号でbeginからnum個のEntityに対して関数を呼びます。グループが変わると先にonGroupを呼びます
+	template<class Func, class GroupFunc>
+	static void ForEach(ECS::EntityManager& entityManager, const ECS::Group maxGroup, const size_t begin, size_t num,
+		Func&& func, GroupFunc&& onGroup)
+	{
+		ChunkBegin at = Locate(entityManager, maxGroup, begin);
+		for (; at.group < maxGroup && num > 0; ++at.group, at.index = 0)
+		{
+			const auto& entities = entityManager.getEntitiesByGroup(at.group);
+			if (at.index >= entities.size())
+			{
+				continue;
+			}
+			onGroup(at.group);
+			for (; at.index < entities.size() && num > 0; ++at.index, --num)
+			{
+				func(*entities[at.index]);
+			}
+		}
+	}
+public:
+	//!1つの範囲に入れるEntityの最小数です。これより少ない場合はスレッドを分けません
+	static constexpr size_t CHUNK_MIN = 256;
+	/**
+	* @brief グループ順にEntityのdraw2D()を呼び、グループの番号をレイヤーにしてRenderQueueに命令を積みます
+	* @param entityManager EntityManager
+	* @param maxGroup 最大グループ数
+	* @param threadNum 使うスレッドの数。0ならThreadPoolのスレッド数になります
+	* @return 並列に積んだらtrue
+	* @details RenderQueue::begin()からflush()の間に呼んでください。
+	* orderByDraw(maxGroup, [](group) { RenderQueue::Get().setLayer(group); })と同じ命令が積まれます
+	*/
+	static bool Record(ECS::EntityManager& entityManager, const ECS::Group maxGroup, const size_t threadNum = 0)
+	{
+		assert(RenderQueue::Get().isRecording() && "RenderQueue::begin() is not called");
+		size_t entityNum = 0;
+		for (ECS::Group i = 0; i < maxGroup; ++i)
+		{
+			entityNum += entityManager.getEntitiesByGroup(i).size();
+		}
+		const size_t useThreadNum = threadNum == 0 ? ThreadPool::Get().size() : threadNum;
+		const size_t chunkNum = std::min({ useThreadNum, entityNum / CHUNK_MIN, RenderQueue::SLOT_MAX });
+		auto setLayer = [](const ECS::Group group) { RenderQueue::Get().setLayer(group); };
+		if (chunkNum <= 1)
+		{
+			entityManager.orderByDraw(maxGroup, setLayer);
+			return false;
+		}
+		RenderQueue::Get().beginSlots(chunkNum);
+		ThreadPool::Get().parallelFor(chunkNum, chunkNum, [&](const size_t begin, const size_t end, const size_t)
+		{
+			for (size_t chunk = begin; chunk < end; ++chunk)
+			{
+				RenderQueue::SlotScope scope(chunk);
+				const size_t first = entityNum * chunk / chunkNum;
+				ForEach(entityManager, maxGroup, first, entityNum * (chunk + 1) / chunkNum - first,
+					[](ECS::Entity& e) { e.draw2D(); }, setLayer);
+			}
+		});
+		RenderQueue::Get().mergeSlots();
+		//この後に積む命令のレイヤーもorderByDraw()の後と同じにする
+		setLayer(maxGroup - 1);
+		return true;
+	}
+};
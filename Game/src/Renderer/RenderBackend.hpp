@@ -0,0 +1,251 @@
+﻿/**
+* @file RenderBackend.hpp
+* @brief 描画の出力先を切り替えるためのインターフェースです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include <DxLib.h>
+#include <cassert>
+
+/**
+* @brief 描画コンポーネントやRenderQueueが使う描画機能の一覧です
+* @details 引数はDXライブラリの同じ名前の関数と同じです。色はGetColor()で作った値です
+*/
+class IRenderBackend
+{
+public:
+	virtual ~IRenderBackend() = default;
+	//!SetDrawModeと同じです
+	virtual void setDrawMode(const int drawMode) = 0;
+	//!SetDrawBlendModeと同じです
+	virtual void setBlend(const int blendMode, const int alpha) = 0;
+	//!SetDrawBrightと同じです
+	virtual void setBright(const int red, const int green, const int blue) = 0;
+	//!GetGraphSizeと同じです
+	virtual void getGraphSize(const int handle, int* w, int* h) = 0;
+	/**
+	* @brief 画像が置かれているテクスチャと、その中の画像の左上の位置を返します
+	* @details drawPrimitiveIndexed()のUVはテクスチャ全体に対する割合です。
+	* DXライブラリは2のn乗でない画像を大きなテクスチャに置き、DerivationGraphやLoadDivGraphの画像は元の画像のテクスチャを使うので、
+	* UVは画像の大きさではなくこの大きさで求めてください
+	*/
+	virtual void getTextureRegion(const int handle, int* x, int* y, int* texW, int* texH) = 0;
+	//!DrawRotaGraph3Fと同じです。透過は常に有効です
+	virtual void drawRotaGraph(const float x, const float y, const float cx, const float cy,
+		const double scaleX, const double scaleY, const double angle, const int handle, const bool isTurn) = 0;
+	//!DrawRectRotaGraph3Fと同じです。透過は常に有効です
+	virtual void drawRectRotaGraph(const float x, const float y, const int srcX, const int srcY, const int w, const int h,
+		const float cx, const float cy, const double scaleX, const double scaleY, const double angle,
+		const int handle, const bool isTurn) = 0;
+	//!DX_PRIMTYPE_TRIANGLELISTのDrawPrimitiveIndexed2Dと同じです。透過は常に有効です
+	virtual void drawPrimitiveIndexed(const VERTEX2D* vertices, const int vertexNum,
+		const unsigned short* indices, const int indexNum, const int handle) = 0;
+	//!DX_PRIMTYPE_LINELISTのDrawPrimitive2Dと同じです。画像は使いません
+	virtual void drawLineList(const VERTEX2D* vertices, const int vertexNum) = 0;
+	//!DrawLineAAと同じです
+	virtual void drawLineAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const float thickness) = 0;
+	//!DrawBoxAAと同じです
+	virtual void drawBoxAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const bool isFill, const float thickness) = 0;
+	//!DrawCircleAAと同じです
+	virtual void drawCircleAA(const float x, const float y, const float r, const int posNum,
+		const unsigned int color, const bool isFill, const float thickness) = 0;
+	//!DrawQuadrangleAAと同じです
+	virtual void drawQuadrangleAA(const float x1, const float y1, const float x2, const float y2,
+		const float x3, const float y3, const float x4, const float y4,
+		const unsigned int color, const bool isFill, const float thickness) = 0;
+	//!MakeScreenと同じです。アルファチャンネルの無い描画先を作ります
+	virtual int createRenderTarget(const int w, const int h) = 0;
+	//!createRenderTarget()で作った描画先を削除します
+	virtual void deleteRenderTarget(const int handle) = 0;
+	//!GetDrawScreenと同じです
+	virtual int getRenderTarget() = 0;
+	//!SetDrawScreenと同じです
+	virtual void setRenderTarget(const int handle) = 0;
+	//!ClearDrawScreenと同じです
+	virtual void clearRenderTarget() = 0;
+	//!今の描画先の大きさを返します
+	virtual void getRenderTargetSize(int* w, int* h) = 0;
+	//!描画先の画像を今の描画先の左上に等倍で、ブレンドせずに描画します
+	virtual void blitRenderTarget(const int handle) = 0;
+};
+
+//!DXライブラリでそのまま描画します
+class DxLibBackend final : public IRenderBackend
+{
+public:
+	void setDrawMode(const int drawMode) override
+	{
+		SetDrawMode(drawMode);
+	}
+	void setBlend(const int blendMode, const int alpha) override
+	{
+		SetDrawBlendMode(blendMode, alpha);
+	}
+	void setBright(const int red, const int green, const int blue) override
+	{
+		SetDrawBright(red, green, blue);
+	}
+	void getGraphSize(const int handle, int* w, int* h) override
+	{
+		GetGraphSize(handle, w, h);
+	}
+	void getTextureRegion(const int handle, int* x, int* y, int* texW, int* texH) override
+	{
+		int w = 0, h = 0;
+		if (GetGraphUseBaseGraphArea(handle, x, y, &w, &h) == -1)
+		{
+			*x = 0;
+			*y = 0;
+		}
+		GetGraphTextureSize(handle, texW, texH);
+	}
+	void drawRotaGraph(const float x, const float y, const float cx, const float cy,
+		const double scaleX, const double scaleY, const double angle, const int handle, const bool isTurn) override
+	{
+		DrawRotaGraph3F(x, y, cx, cy, scaleX, scaleY, angle, handle, true, isTurn);
+	}
+	void drawRectRotaGraph(const float x, const float y, const int srcX, const int srcY, const int w, const int h,
+		const float cx, const float cy, const double scaleX, const double scaleY, const double angle,
+		const int handle, const bool isTurn) override
+	{
+		DrawRectRotaGraph3F(x, y, srcX, srcY, w, h, cx, cy, scaleX, scaleY, angle, handle, true, isTurn);
+	}
+	void drawPrimitiveIndexed(const VERTEX2D* vertices, const int vertexNum,
+		const unsigned short* indices, const int indexNum, const int handle) override
+	{
+		DrawPrimitiveIndexed2D(vertices, vertexNum, indices, indexNum, DX_PRIMTYPE_TRIANGLELIST, handle, TRUE);
+	}
+	void drawLineList(const VERTEX2D* vertices, const int vertexNum) override
+	{
+		DrawPrimitive2D(vertices, vertexNum, DX_PRIMTYPE_LINELIST, DX_NONE_GRAPH, TRUE);
+	}
+	void drawLineAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const float thickness) override
+	{
+		DrawLineAA(x1, y1, x2, y2, color, thickness);
+	}
+	void drawBoxAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		DrawBoxAA(x1, y1, x2, y2, color, isFill, thickness);
+	}
+	void drawCircleAA(const float x, const float y, const float r, const int posNum,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		DrawCircleAA(x, y, r, posNum, color, isFill, thickness);
+	}
+	void drawQuadrangleAA(const float x1, const float y1, const float x2, const float y2,
+		const float x3, const float y3, const float x4, const float y4,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		DrawQuadrangleAA(x1, y1, x2, y2, x3, y3, x4, y4, color, isFill, thickness);
+	}
+	int createRenderTarget(const int w, const int h) override
+	{
+		return MakeScreen(w, h, FALSE);
+	}
+	void deleteRenderTarget(const int handle) override
+	{
+		DeleteGraph(handle);
+	}
+	int getRenderTarget() override
+	{
+		return GetDrawScreen();
+	}
+	void setRenderTarget(const int handle) override
+	{
+		SetDrawScreen(handle);
+	}
+	void clearRenderTarget() override
+	{
+		ClearDrawScreen();
+	}
+	void getRenderTargetSize(int* w, int* h) override
+	{
+		const int handle = GetDrawScreen();
+		if (handle == DX_SCREEN_BACK || handle == DX_SCREEN_FRONT)
+		{
+			GetDrawScreenSize(w, h);
+			return;
+		}
+		GetGraphSize(handle, w, h);
+	}
+	void blitRenderTarget(const int handle) override
+	{
+		//等倍なので補間しない
+		const int drawMode = GetDrawMode();
+		SetDrawMode(DX_DRAWMODE_NEAREST);
+		DrawGraph(0, 0, handle, FALSE);
+		SetDrawMode(drawMode);
+	}
+};
+
+/**
+* @brief 今の描画の出力先を管理します
+* @details 初期状態はDxLibBackendです。SoftwareRasterizerなどを指定すると、描画コンポーネントの出力がそちらに変わります
+* - SetCapture()で指定したスレッドの描画だけを別の先(DeferredBackendなど)に記録できます
+* - SetLocked()で使えなくしたスレッドからGet()やGetOutput()を呼ぶと、デバッグビルドではassertで止まります。
+*   RenderQueueの入れ物に並列に命令を積むスレッドは記録先を持たないので、DXライブラリを直接呼ばないように使えなくします
+*/
+class RenderBackend final
+{
+private:
+	RenderBackend() = delete;
+	[[nodiscard]] static IRenderBackend*& Current()
+	{
+		static DxLibBackend dxlib;
+		static IRenderBackend* current = &dxlib;
+		if (current == nullptr)
+		{
+			current = &dxlib;
+		}
+		return current;
+	}
+	[[nodiscard]] static IRenderBackend*& Capture()
+	{
+		thread_local IRenderBackend* capture = nullptr;
+		return capture;
+	}
+	[[nodiscard]] static bool& Locked()
+	{
+		thread_local bool isLocked = false;
+		return isLocked;
+	}
+public:
+	//!今のスレッドの出力先を返します。記録中なら記録先です
+	static IRenderBackend& Get()
+	{
+		assert(!Locked() && "render backend is used while recording commands in parallel");
+		IRenderBackend* capture = Capture();
+		return capture != nullptr ? *capture : *Current();
+	}
+	//!記録中でも実際の出力先を返します
+	static IRenderBackend& GetOutput()
+	{
+		assert(!Locked() && "render backend is used while recording commands in parallel");
+		return *Current();
+	}
+	//!今のスレッドの描画を指定した先に記録します。nullptrなら記録をやめます
+	static void SetCapture(IRenderBackend* backend)
+	{
+		Capture() = backend;
+	}
+	//!trueにすると今のスレッドから出力先を使えなくします
+	static void SetLocked(const bool isLocked)
+	{
+		Locked() = isLocked;
+	}
+	//!今のスレッドから出力先を使えなければtrue
+	[[nodiscard]] static bool IsLocked()
+	{
+		return Locked();
+	}
+	//!出力先を指定します。nullptrならDxLibBackendに戻します。指定したものの寿命は呼び出し側で管理してください
+	static void Set(IRenderBackend* backend)
+	{
+		Current() = backend;
+	}
+};
@@ -0,0 +1,283 @@
+﻿/**
+* @file RenderCapture.hpp
+* @brief RenderQueueに積まれた描画命令をフレームごとにバイト列に記録します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderCommand.hpp"
+#include "RenderBackend.hpp"
+#include "DeferredBackend.hpp"
+#include "../Utility/BinaryStream.hpp"
+#include <DxLib.h>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+/**
+* @brief 描画命令のキャプチャです
+* @details RenderQueue::setCapture()で指定すると、publish()かflush()のたびに並べ替える前の命令を1フレームとして記録します
+* - 命令は種類、反転、レイヤー、直接描画したものとの前後を表す番号、マテリアルの番号、座標と変形(矩形の命令は切り出す範囲も)を書き出します
+* - マテリアルは前のフレームから増えた分だけを、画像の大きさと一緒に書き出します
+* - 積む間に直接描画したものはDeferredBackendの記録として、命令と前後する位置を決める範囲ごとのキーと一緒に書き出します
+* - save()でファイルに保存し、load()で読み込んだものをRenderReplayBenchmarkで別の出力先に流せます。
+*   値はメモリ上の表現のまま書き出すので、同じ環境で読み込んでください
+*/
+class RenderCapture final
+{
+public:
+	//!ファイルの先頭の識別子です
+	static constexpr uint32_t MAGIC = 0x50414352;	//"RCAP"
+	//!形式が変わったら増やします
+	static constexpr uint32_t VERSION = 2;
+	//!読み込んだ1フレーム分の、RenderQueueに積まれた命令です
+	struct Frame
+	{
+		//!マテリアルの番号はmaterialsの添字です
+		std::vector<RenderCommand> commands;
+		std::vector<RenderMaterial> materials;
+		//!マテリアルの番号ごとの画像の大きさ
+		std::vector<std::pair<int, int>> textureSizes;
+		//!積む間に直接描画したもの
+		DeferredBackend immediates;
+		//!immediatesを区切った範囲。区切った順に並んでいます。positionは記録しません
+		std::vector<RenderImmediateRange> immediateRanges;
+	};
+private:
+	std::vector<uint8_t> data_;
+	uint32_t frameNum_ = 0;
+	//!書き出し済みのマテリアルの数と、そのときのマテリアルの変換表の世代です
+	size_t materialNum_ = 0;
+	uint32_t generation_ = 0;
+	bool isMaterialWritten_ = false;
+public:
+	//!記録を捨てます
+	void clear()
+	{
+		data_.clear();
+		frameNum_ = 0;
+		materialNum_ = 0;
+		isMaterialWritten_ = false;
+	}
+	//!記録したフレームの数を返します
+	[[nodiscard]] size_t frameNum() const
+	{
+		return frameNum_;
+	}
+	//!記録したバイト数を返します
+	[[nodiscard]] size_t byteNum() const
+	{
+		return data_.size();
+	}
+	/**
+	* @brief 1フレーム分の命令を記録します。RenderQueueから呼ばれます
+	* @param commands 並べ替える前の命令
+	* @param materials マテリアルの変換表
+	* @param generation マテリアルの変換表の世代。変わったら変換表をすべて書き出し直します
+	* @param immediates 積む間に直接描画したもの
+	* @param immediateRanges immediatesを区切った範囲
+	*/
+	void addFrame(const std::vector<RenderCommand>& commands, const std::vector<RenderMaterial>& materials,
+		const uint32_t generation, const DeferredBackend& immediates, const std::vector<RenderImmediateRange>& immediateRanges)
+	{
+		if (!isMaterialWritten_ || generation != generation_ || materials.size() < materialNum_)
+		{
+			materialNum_ = 0;
+			generation_ = generation;
+			isMaterialWritten_ = true;
+		}
+		BinaryWriter out(data_);
+		out.write(uint32_t(commands.size()));
+		out.write(uint32_t(materialNum_));
+		out.write(uint32_t(materials.size() - materialNum_));
+		for (size_t i = materialNum_; i < materials.size(); ++i)
+		{
+			const RenderMaterial& m = materials[i];
+			int w = 0, h = 0;
+			RenderBackend::GetOutput().getGraphSize(m.handle, &w, &h);
+			const int32_t values[8] = { m.blendMode, m.alpha, m.red, m.green, m.blue, m.handle, w, h };
+			out.writeArray(values, 8);
+		}
+		materialNum_ = materials.size();
+		for (const auto& c : commands)
+		{
+			out.write(uint8_t(c.type));
+			out.write(uint8_t(c.isTurn));
+			out.write(c.layer);
+			out.write(c.segment);
+			out.write(c.material);
+			const float transform[7] = { c.x, c.y, c.cx, c.cy, c.scaleX, c.scaleY, c.angle };
+			out.writeArray(transform, 7);
+			if (c.type == RenderCommandType::RECT_ROTA_GRAPH)
+			{
+				const int32_t rect[4] = { c.srcX, c.srcY, c.srcW, c.srcH };
+				out.writeArray(rect, 4);
+			}
+		}
+		out.write(uint8_t(immediates.empty() ? 0 : 1));
+		if (!immediates.empty())
+		{
+			immediates.write(out);
+			out.write(uint32_t(immediateRanges.size()));
+			for (const auto& it : immediateRanges)
+			{
+				const uint32_t range[3] = { it.key, uint32_t(it.begin), uint32_t(it.end) };
+				out.writeArray(range, 3);
+			}
+		}
+		++frameNum_;
+	}
+	/**
+	* @brief 記録したすべてのフレームを読み込みます
+	* @return 記録が壊れていたらfalse
+	*/
+	[[nodiscard]] bool decode(std::vector<Frame>& frames) const
+	{
+		frames.clear();
+		frames.reserve(frameNum_);
+		BinaryReader in(data_.data(), data_.size());
+		std::vector<RenderMaterial> materials;
+		std::vector<std::pair<int, int>> textureSizes;
+		for (uint32_t i = 0; i < frameNum_; ++i)
+		{
+			uint32_t commandNum = 0, materialBegin = 0, materialNum = 0;
+			in.read(commandNum);
+			in.read(materialBegin);
+			in.read(materialNum);
+			if (!in.isOk() || materialBegin > materials.size() || in.remain() < size_t(materialNum) * 32 + size_t(commandNum) * 34)
+			{
+				return false;
+			}
+			materials.resize(materialBegin);
+			textureSizes.resize(materialBegin);
+			for (uint32_t k = 0; k < materialNum; ++k)
+			{
+				int32_t values[8];
+				in.readArray(values, 8);
+				RenderMaterial m;
+				m.blendMode = values[0];
+				m.alpha = values[1];
+				m.red = values[2];
+				m.green = values[3];
+				m.blue = values[4];
+				m.handle = values[5];
+				materials.emplace_back(m);
+				textureSizes.emplace_back(values[6], values[7]);
+			}
+			frames.emplace_back();
+			Frame& frame = frames.back();
+			frame.materials = materials;
+			frame.textureSizes = textureSizes;
+			frame.commands.resize(commandNum);
+			for (auto& c : frame.commands)
+			{
+				uint8_t type = 0, isTurn = 0;
+				in.read(type);
+				in.read(isTurn);
+				in.read(c.layer);
+				in.read(c.segment);
+				in.read(c.material);
+				float transform[7];
+				in.readArray(transform, 7);
+				if (type > uint8_t(RenderCommandType::RECT_ROTA_GRAPH) || c.material >= materials.size())
+				{
+					return false;
+				}
+				c.type = RenderCommandType(type);
+				c.isTurn = isTurn != 0;
+				c.x = transform[0];
+				c.y = transform[1];
+				c.cx = transform[2];
+				c.cy = transform[3];
+				c.scaleX = transform[4];
+				c.scaleY = transform[5];
+				c.angle = transform[6];
+				if (c.type == RenderCommandType::RECT_ROTA_GRAPH)
+				{
+					int32_t rect[4];
+					in.readArray(rect, 4);
+					c.srcX = rect[0];
+					c.srcY = rect[1];
+					c.srcW = rect[2];
+					c.srcH = rect[3];
+				}
+			}
+			uint8_t hasImmediates = 0;
+			in.read(hasImmediates);
+			if (hasImmediates != 0)
+			{
+				uint32_t rangeNum = 0;
+				if (!frame.immediates.read(in) || !in.read(rangeNum) || in.remain() < size_t(rangeNum) * 12)
+				{
+					return false;
+				}
+				frame.immediateRanges.resize(rangeNum);
+				for (auto& it : frame.immediateRanges)
+				{
+					uint32_t range[3];
+					in.readArray(range, 3);
+					if (range[1] > range[2] || range[2] > frame.immediates.size())
+					{
+						return false;
+					}
+					it.key = range[0];
+					it.begin = range[1];
+					it.end = range[2];
+				}
+			}
+			if (!in.isOk())
+			{
+				return false;
+			}
+		}
+		return in.isEnd();
+	}
+	//!記録をファイルに保存します。失敗したらfalse
+	bool save(const std::string& path) const
+	{
+		std::ofstream ofs(path, std::ios::binary);
+		if (!ofs)
+		{
+			return false;
+		}
+		std::vector<uint8_t> header;
+		BinaryWriter out(header);
+		out.write(MAGIC);
+		out.write(VERSION);
+		out.write(frameNum_);
+		ofs.write(reinterpret_cast<const char*>(header.data()), std::streamsize(header.size()));
+		ofs.write(reinterpret_cast<const char*>(data_.data()), std::streamsize(data_.size()));
+		return bool(ofs);
+	}
+	/**
+	* @brief save()で保存したファイルを読み込みます。今の記録は捨てます
+	* @return 読み込めないか形式が違えばfalse
+	*/
+	bool load(const std::string& path)
+	{
+		clear();
+		std::ifstream ifs(path, std::ios::binary);
+		if (!ifs)
+		{
+			return false;
+		}
+		std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+		BinaryReader in(bytes.data(), bytes.size());
+		uint32_t magic = 0, version = 0, frameNum = 0;
+		in.read(magic);
+		in.read(version);
+		in.read(frameNum);
+		if (!in.isOk() || magic != MAGIC || version != VERSION)
+		{
+			return false;
+		}
+		const size_t headerSize = bytes.size() - in.remain();
+		data_.assign(bytes.begin() + std::ptrdiff_t(headerSize), bytes.end());
+		frameNum_ = frameNum;
+		return true;
+	}
+};
@@ -0,0 +1,73 @@
+﻿/**
+* @file RenderCommand.hpp
+* @brief RenderQueueに積む描画命令とマテリアルです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include <DxLib.h>
+#include <cstdint>
+#include <cstddef>
+
+//!描画の状態をまとめたものです
+struct RenderMaterial
+{
+	int blendMode = DX_BLENDMODE_NOBLEND;
+	int alpha = 255;
+	int red = 255;
+	int green = 255;
+	int blue = 255;
+	int handle = -1;
+	[[nodiscard]] bool operator==(const RenderMaterial& m) const noexcept
+	{
+		return blendMode == m.blendMode && alpha == m.alpha &&
+			red == m.red && green == m.green && blue == m.blue && handle == m.handle;
+	}
+	[[nodiscard]] bool operator!=(const RenderMaterial& m) const noexcept { return !(*this == m); }
+};
+
+//!描画命令の種類です
+enum class RenderCommandType : uint8_t
+{
+	//!DrawRotaGraph3F
+	ROTA_GRAPH,
+	//!DrawRectRotaGraph3F
+	RECT_ROTA_GRAPH,
+};
+
+//!描画命令です。DxLibの描画関数の引数をそのまま持ちます
+struct RenderCommand
+{
+	//!マテリアルの番号が無いことを表します
+	static constexpr uint16_t INVALID_MATERIAL = 0xffff;
+	RenderCommandType type = RenderCommandType::ROTA_GRAPH;
+	bool isTurn = false;
+	uint8_t layer = 0;
+	//!同じレイヤーで、直接描画したものとの前後を表す番号です。RenderQueueが上書きします
+	uint8_t segment = 0;
+	uint16_t material = INVALID_MATERIAL;
+	float x = 0.f;
+	float y = 0.f;
+	float cx = 0.f;
+	float cy = 0.f;
+	float scaleX = 1.f;
+	float scaleY = 1.f;
+	//!回転(ラジアン)
+	float angle = 0.f;
+	int srcX = 0;
+	int srcY = 0;
+	int srcW = 0;
+	int srcH = 0;
+};
+
+//!RenderQueueが命令を積む間に直接描画したものの記録の範囲と、それを描画する位置です
+struct RenderImmediateRange
+{
+	//!並べ替えのキー。このキー以上の命令より前に描画します
+	uint32_t key = 0;
+	//!並べ替えた命令のこの番号の前に描画します
+	size_t position = 0;
+	//!DeferredBackendに記録した呼び出しの範囲
+	size_t begin = 0;
+	size_t end = 0;
+};
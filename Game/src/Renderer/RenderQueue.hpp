@@ -0,0 +1,888 @@
+﻿/**
+* @file RenderQueue.hpp
+* @brief 描画命令を1フレーム分ためて、描画の状態ごとに並べ替えてから描画します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderCommand.hpp"
+#include "SpriteBatch.hpp"
+#include "RenderBackend.hpp"
+#include "DeferredBackend.hpp"
+#include "DebugDraw.hpp"
+#include "RenderCapture.hpp"
+#include <DxLib.h>
+#include <memory>
+#include <vector>
+#include <array>
+#include <unordered_map>
+#include <mutex>
+#include <atomic>
+#include <bitset>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <utility>
+#include <algorithm>
+
+/**
+* @brief 描画命令をためて、まとめて描画するキューです
+* @details begin()からflush()までの間、SpriteDrawなどは直接描画せずに命令を積みます
+* - 色、ブレンドモード、アルファ値、画像ハンドルの組はマテリアルとして共有の番号に変換されます
+* - 命令は(レイヤー, マテリアル)のキーで基数ソートされます。レイヤーはsetLayer()で指定し、通常はグループの番号です
+* - 同じレイヤー、同じマテリアルの命令は積んだ順に描画されます。
+*   同じレイヤーでマテリアルが違う命令の前後関係は保たれないので、重なって困るものはレイヤーを分けてください
+* - flush()では直前と同じ状態の設定を省くので、SetDrawBlendModeなどの呼び出しが減ります
+* - 同じマテリアルの命令がBATCH_MIN個以上続く場合は、SpriteBatchで1回の描画にまとめます
+* - beginSlots()からmergeSlots()までの間は、SlotScopeで番号を指定したスレッドから並列に命令を積めます。
+*   命令は番号ごとの入れ物に積み、mergeSlots()で番号順に結合するので、範囲を登録順に分けていれば逐次に積んだ場合と同じ結果になります
+* - begin()を呼んだスレッドが積む間にRenderBackend::Get()で直接描画したものは記録され、呼んだときのレイヤーの中で積んだ順に命令と前後して描画されます。
+*   直接描画するたびに同じレイヤーの命令の並べ替えが前後で分かれるので、まとめて描画できる命令が減ります。
+*   1フレームに分けられるのはSEGMENT_MAX回までで、それより後に直接描画したものは同じレイヤーで最後に積んだ命令と順番が前後することがあります
+* - flush()の代わりにpublish()を呼ぶと、並べ替えた命令を描画せずにスナップショットとして残します。
+*   swapSnapshot()で表と裏を入れ替え、submit()で表のスナップショットを描画します。
+*   スナップショットは命令とマテリアルの複製を持つので、submit()の間に別のスレッドが次のフレームの命令を積めます
+* - DebugDrawにためた図形もスナップショットに移し、命令を描画した後に描画します
+* - setLayerCache()で指定したレイヤーは画面と同じ大きさの描画先にキャッシュします。
+*   命令の内容がハッシュ値で前のフレームと同じなら、描画し直さずにキャッシュを1回描画するだけで済みます。
+*   スクロールなどで内容が毎フレーム変わる間はキャッシュを使わずにそのまま描画し、2フレーム続けて同じになったらキャッシュに描画します。
+*   背景やHUDの枠など、ほとんど変わらないレイヤーに使ってください
+* - setCapture()でRenderCaptureを指定すると、並べ替える前の命令をフレームごとに記録します
+*/
+class RenderQueue final
+{
+public:
+	//!マテリアルの番号の最大数です
+	static constexpr size_t MATERIAL_MAX = 65535;
+	//!まだ変換していないマテリアルの番号です
+	static constexpr uint16_t INVALID_MATERIAL = RenderCommand::INVALID_MATERIAL;
+	//!SpriteBatchでまとめる、同じマテリアルが続く最小の数です
+	static constexpr size_t BATCH_MIN = 4;
+	//!並列に命令を積むときの入れ物の最大数です
+	static constexpr size_t SLOT_MAX = 64;
+	//!直接描画したもので、1フレームの命令の並べ替えを区切れる最大の回数です
+	static constexpr size_t SEGMENT_MAX = 255;
+
+	using Material = RenderMaterial;
+	using CommandType = RenderCommandType;
+	using Command = RenderCommand;
+	/**
+	* @brief 前回変換したマテリアルを覚えておくためのものです
+	* @details 描画するコンポーネントに持たせると、マテリアルが変わらない限りハッシュの検索を省けます
+	*/
+	struct MaterialCache
+	{
+		Material material;
+		uint16_t id = INVALID_MATERIAL;
+		uint32_t generation = 0;
+	};
+	//!1フレームの描画の統計です
+	struct Stats
+	{
+		//!描画した命令の数
+		size_t commandNum = 0;
+		//!変換済みのマテリアルの数
+		size_t materialNum = 0;
+		//!SetDrawBlendModeを呼んだ回数
+		size_t blendChangeNum = 0;
+		//!SetDrawBrightを呼んだ回数
+		size_t brightChangeNum = 0;
+		//!画像が前の命令と変わった回数。DxLibは同じ画像が続く間は描画をまとめます
+		size_t textureChangeNum = 0;
+		//!並べ替えずに積んだ順に描画した場合の、SetDrawBlendModeとSetDrawBrightの呼び出し回数
+		size_t unsortedStateChangeNum = 0;
+		//!SpriteBatchで描画した回数
+		size_t batchNum = 0;
+		//!SpriteBatchで描画した命令の数
+		size_t batchedCommandNum = 0;
+		//!レイヤーのキャッシュを使って描画を省いた命令の数
+		size_t cachedCommandNum = 0;
+	};
+	//!レイヤーのキャッシュの累計です
+	struct LayerCacheStats
+	{
+		//!キャッシュを描画し直さずに使ったフレームの数
+		size_t hitFrameNum = 0;
+		//!キャッシュを描画し直した回数
+		size_t rebuildNum = 0;
+		//!内容が前のフレームから変わったので、キャッシュを使わずに描画したフレームの数
+		size_t bypassFrameNum = 0;
+	};
+private:
+	RenderQueue() = delete;
+	[[nodiscard]] static int& CurrentSlotRef()
+	{
+		thread_local int slot = -1;
+		return slot;
+	}
+public:
+	//!今のスレッドが命令を積む入れ物の番号を返します。SlotScopeの外なら-1です
+	[[nodiscard]] static int CurrentSlot()
+	{
+		return CurrentSlotRef();
+	}
+	/**
+	* @brief 生きている間、今のスレッドが積む命令を指定した番号の入れ物に入れます
+	* @details 入れ物に積む間は直接描画したものを記録できないので、RenderBackendを使えなくします
+	*/
+	class SlotScope final
+	{
+	private:
+		int prev_;
+		bool isPrevLocked_;
+	public:
+		explicit SlotScope(const size_t slot) :
+			prev_(CurrentSlotRef()),
+			isPrevLocked_(RenderBackend::IsLocked())
+		{
+			assert(slot < SLOT_MAX && "slot is out of range");
+			CurrentSlotRef() = int(slot);
+			RenderBackend::SetLocked(true);
+		}
+		~SlotScope()
+		{
+			CurrentSlotRef() = prev_;
+			RenderBackend::SetLocked(isPrevLocked_);
+		}
+		SlotScope(const SlotScope&) = delete;
+		SlotScope& operator=(const SlotScope&) = delete;
+	};
+private:
+	class Singleton final
+	{
+	private:
+		//!現在の描画の状態です。ResetRenderState()の後の状態から始めます
+		struct State
+		{
+			Material material;
+			bool isBlendChanged = false;
+			bool isBrightChanged = false;
+		};
+		struct MaterialHash
+		{
+			[[nodiscard]] size_t operator()(const Material& m) const noexcept
+			{
+				uint64_t h = uint64_t(uint32_t(m.handle));
+				h = h * 0x9E3779B97F4A7C15ull ^ ((uint64_t(uint32_t(m.blendMode)) << 8) | uint64_t(uint32_t(m.alpha)));
+				h = h * 0x9E3779B97F4A7C15ull ^ ((uint64_t(uint32_t(m.red)) << 16) | (uint64_t(uint32_t(m.green)) << 8) | uint64_t(uint32_t(m.blue)));
+				return size_t(h ^ (h >> 29));
+			}
+		};
+
+		//!並列に積むときの入れ物です
+		struct Slot
+		{
+			std::vector<Command> commands;
+			uint8_t layer = 0;
+			uint8_t segment = 0;
+		};
+		//!直接描画したものの記録の範囲と、それを描画する位置です
+		using ImmediateRange = RenderImmediateRange;
+		//!並べ替え終わった1フレーム分の描画です。描画するスレッドはこれだけを読みます
+		struct Snapshot
+		{
+			std::vector<Command> commands;
+			std::vector<uint32_t> order;
+			std::vector<Material> materials;
+			DeferredBackend immediates;
+			//!immediatesを描画する位置。positionの順に並んでいます
+			std::vector<ImmediateRange> immediateRanges;
+			DebugDraw::Frame debugDraw;
+			//!並べ替えまでの統計。描画の統計はdraw()で足します
+			Stats stats;
+			uint32_t generation = 0;
+			//!並べ替えた命令の先頭から続く、キャッシュするレイヤーの命令の数
+			size_t cachedNum = 0;
+			//!キャッシュするレイヤーの命令の内容のハッシュ値
+			uint64_t cacheHash = 0;
+		};
+
+		std::vector<Command> commands_;
+		std::vector<Slot> slots_;
+		size_t slotNum_ = 0;
+		//!並列に積む間のマテリアルの変換を守ります
+		std::mutex internMutex_;
+		std::vector<Material> materials_;
+		//!画像の大きさと、画像を置いたテクスチャでの位置です
+		struct TextureInfo
+		{
+			int w = 0;
+			int h = 0;
+			int x = 0;
+			int y = 0;
+			int texW = 0;
+			int texH = 0;
+		};
+		//!マテリアルの番号ごとの画像の情報。描画の出力先に問い合わせるので描画するスレッドで求めます
+		std::vector<TextureInfo> textures_;
+		uint32_t textureGeneration_ = 0;
+		//!積む間に直接描画したものの記録です
+		DeferredBackend immediates_;
+		//!記録を区切った範囲です
+		std::vector<ImmediateRange> immediateRanges_;
+		//!命令の並べ替えを区切った回数
+		uint8_t segment_ = 0;
+		Snapshot front_;
+		Snapshot back_;
+		std::unordered_map<Material, uint16_t, MaterialHash> materialIds_;
+		//!マテリアルの番号ごとの並べ替えの順位
+		std::vector<uint16_t> ranks_;
+		std::vector<uint32_t> keys_;
+		std::vector<uint32_t> order_;
+		std::vector<uint32_t> temp_;
+		Stats stats_;
+		uint32_t generation_ = 1;
+		uint8_t layer_ = 0;
+		bool isRecording_ = false;
+		bool isRankDirty_ = false;
+		bool isBatchEnable_ = true;
+		SpriteBatch batch_;
+		//!キャッシュするレイヤー
+		std::bitset<256> cachedLayers_;
+		//!キャッシュの描画先と、それを作った出力先です。作っていなければ-1です
+		int cacheTarget_ = -1;
+		IRenderBackend* cacheBackend_ = nullptr;
+		int cacheW_ = 0;
+		int cacheH_ = 0;
+		uint64_t cacheHash_ = 0;
+		//!前のフレームのキャッシュするレイヤーのハッシュ値。キャッシュに描画したかによらず毎フレーム更新します
+		uint64_t prevCacheHash_ = 0;
+		//!trueならキャッシュの内容によらず次の描画で描画し直します
+		std::atomic<bool> isCacheDirty_{ true };
+		LayerCacheStats layerCacheStats_;
+		RenderCapture* capture_ = nullptr;
+
+		//!ブレンドモード、アルファ値、画像、色の順に並ぶようにマテリアルの順位を付け直します
+		void updateRanks()
+		{
+			std::vector<uint16_t> sorted(materials_.size());
+			for (size_t i = 0; i < sorted.size(); ++i)
+			{
+				sorted[i] = uint16_t(i);
+			}
+			std::sort(sorted.begin(), sorted.end(), [this](const uint16_t a, const uint16_t b)
+			{
+				const Material& ma = materials_[a];
+				const Material& mb = materials_[b];
+				if (ma.blendMode != mb.blendMode) { return ma.blendMode < mb.blendMode; }
+				if (ma.alpha != mb.alpha) { return ma.alpha < mb.alpha; }
+				if (ma.handle != mb.handle) { return ma.handle < mb.handle; }
+				if (ma.red != mb.red) { return ma.red < mb.red; }
+				if (ma.green != mb.green) { return ma.green < mb.green; }
+				return ma.blue < mb.blue;
+			});
+			ranks_.resize(materials_.size());
+			for (size_t i = 0; i < sorted.size(); ++i)
+			{
+				ranks_[sorted[i]] = uint16_t(i);
+			}
+			isRankDirty_ = false;
+		}
+		/**
+		* @brief キーを8ビットずつ下の桁から安定な計数ソートで並べます
+		* @details 全部が同じ値の桁は飛ばします。直接描画したものが無ければ区切りの番号の桁は飛ばされます
+		*/
+		void radixSort()
+		{
+			const size_t n = commands_.size();
+			order_.resize(n);
+			temp_.resize(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				order_[i] = uint32_t(i);
+			}
+			for (uint32_t shift = 0; shift < 32; shift += 8)
+			{
+				std::array<uint32_t, 257> count{};
+				for (size_t i = 0; i < n; ++i)
+				{
+					++count[((keys_[i] >> shift) & 0xff) + 1];
+				}
+				bool isSkip = false;
+				for (size_t i = 1; i < count.size(); ++i)
+				{
+					if (count[i] == n)
+					{
+						isSkip = true;
+						break;
+					}
+				}
+				if (isSkip)
+				{
+					continue;
+				}
+				for (size_t i = 1; i < count.size(); ++i)
+				{
+					count[i] += count[i - 1];
+				}
+				for (size_t i = 0; i < n; ++i)
+				{
+					const uint32_t index = order_[i];
+					temp_[count[(keys_[index] >> shift) & 0xff]++] = index;
+				}
+				order_.swap(temp_);
+			}
+		}
+		//!並べ替えのキーです。レイヤー、直接描画したもので区切った番号、マテリアルの順位の順に並べます
+		[[nodiscard]] static uint32_t SortKey(const uint8_t layer, const uint8_t segment, const uint16_t rank)
+		{
+			return (uint32_t(layer) << 24) | (uint32_t(segment) << 16) | rank;
+		}
+		/**
+		* @brief 前に区切ってから直接描画したものがあれば、今のレイヤーの今の位置に描画するように区切ります
+		* @details 命令を積む前、レイヤーを変える前と、積み終えるときに呼びます
+		*/
+		void splitImmediates()
+		{
+			const size_t begin = immediateRanges_.empty() ? 0 : immediateRanges_.back().end;
+			if (immediates_.size() == begin)
+			{
+				return;
+			}
+			//これまでに積んだ命令より後、これから積む命令より前になるように番号を進める
+			if (segment_ < SEGMENT_MAX)
+			{
+				++segment_;
+			}
+			ImmediateRange range;
+			range.key = SortKey(layer_, segment_, 0);
+			range.begin = begin;
+			range.end = immediates_.size();
+			immediateRanges_.emplace_back(range);
+		}
+		//!マテリアルに切り替えたときに必要な状態の変更を求めて数えます
+		static void Transition(State& state, const Material& m, Stats& stats)
+		{
+			state.isBlendChanged = m.blendMode != state.material.blendMode || m.alpha != state.material.alpha;
+			state.isBrightChanged = m.red != state.material.red || m.green != state.material.green || m.blue != state.material.blue;
+			if (state.isBlendChanged) { ++stats.blendChangeNum; }
+			if (state.isBrightChanged) { ++stats.brightChangeNum; }
+			if (m.handle != state.material.handle) { ++stats.textureChangeNum; }
+			state.material = m;
+		}
+		//!ResetRenderState()の後と同じ状態です。画像は変わらないものとします
+		[[nodiscard]] static Material ResetMaterial(const State& state)
+		{
+			Material m;
+			m.handle = state.material.handle;
+			return m;
+		}
+		//!マテリアルに切り替えて、必要な状態だけを設定します
+		static void Apply(State& state, const Material& m, Stats& stats)
+		{
+			Transition(state, m, stats);
+			if (state.isBlendChanged)
+			{
+				RenderBackend::Get().setBlend(m.blendMode, m.alpha);
+			}
+			if (state.isBrightChanged)
+			{
+				RenderBackend::Get().setBright(m.red, m.green, m.blue);
+			}
+		}
+		//!並べ替えたbegin番目からend番目の手前までで、同じマテリアルでまとめて描画できる命令が続く数を返します
+		[[nodiscard]] static size_t CountBatchable(const Snapshot& snapshot, const size_t begin, const size_t end)
+		{
+			const uint16_t material = snapshot.commands[snapshot.order[begin]].material;
+			size_t num = 0;
+			while (begin + num < end)
+			{
+				const Command& c = snapshot.commands[snapshot.order[begin + num]];
+				if (c.material != material || !SpriteBatch::CanBatch(c))
+				{
+					break;
+				}
+				++num;
+			}
+			return num;
+		}
+		//!同じマテリアルの命令をまとめて描画します
+		void drawBatch(State& state, const Snapshot& snapshot, const size_t begin, const size_t num, Stats& stats)
+		{
+			const uint16_t id = snapshot.commands[snapshot.order[begin]].material;
+			const Material& m = snapshot.materials[id];
+			//色は頂点に持たせるので、描画輝度は初期状態にする
+			Material batchMaterial = m;
+			batchMaterial.red = 255;
+			batchMaterial.green = 255;
+			batchMaterial.blue = 255;
+			Apply(state, batchMaterial, stats);
+			const TextureInfo& t = textures_[id];
+			batch_.begin(m.handle, t.w, t.h, t.x, t.y, t.texW, t.texH, m.red, m.green, m.blue);
+			for (size_t i = 0; i < num; ++i)
+			{
+				if (batch_.isFull())
+				{
+					batch_.flush();
+					++stats.batchNum;
+				}
+				batch_.add(snapshot.commands[snapshot.order[begin + i]]);
+			}
+			batch_.flush();
+			++stats.batchNum;
+			stats.batchedCommandNum += num;
+		}
+		static void Draw(const Command& c, const int handle)
+		{
+			switch (c.type)
+			{
+			case CommandType::ROTA_GRAPH:
+				RenderBackend::Get().drawRotaGraph(c.x, c.y, c.cx, c.cy, c.scaleX, c.scaleY, c.angle, handle, c.isTurn);
+				break;
+			case CommandType::RECT_ROTA_GRAPH:
+				RenderBackend::Get().drawRectRotaGraph(c.x, c.y, c.srcX, c.srcY, c.srcW, c.srcH, c.cx, c.cy, c.scaleX, c.scaleY, c.angle, handle, c.isTurn);
+				break;
+			}
+		}
+		/**
+		* @brief 並べ替えた命令の先頭からnum個の内容のハッシュ値を求めます
+		* @details マテリアルは番号ではなく中身で求めるので、変換表を作り直しても同じ値になります
+		*/
+		[[nodiscard]] uint64_t hashCachedLayers(const size_t num) const
+		{
+			uint64_t h = 0xCBF29CE484222325ull;
+			const auto mix = [&h](const uint32_t value)
+			{
+				h = (h ^ value) * 0x100000001B3ull;
+			};
+			const auto mixFloat = [&mix](const float value)
+			{
+				uint32_t bits;
+				std::memcpy(&bits, &value, sizeof(bits));
+				mix(bits);
+			};
+			for (size_t i = 0; i < num; ++i)
+			{
+				const Command& c = commands_[order_[i]];
+				const Material& m = materials_[c.material];
+				mix(uint32_t(c.type) | (uint32_t(c.isTurn) << 8) | (uint32_t(c.layer) << 16));
+				mixFloat(c.x);
+				mixFloat(c.y);
+				mixFloat(c.cx);
+				mixFloat(c.cy);
+				mixFloat(c.scaleX);
+				mixFloat(c.scaleY);
+				mixFloat(c.angle);
+				mix(uint32_t(c.srcX));
+				mix(uint32_t(c.srcY));
+				mix(uint32_t(c.srcW));
+				mix(uint32_t(c.srcH));
+				mix(uint32_t(m.blendMode));
+				mix(uint32_t(m.alpha));
+				mix((uint32_t(m.red) << 16) | (uint32_t(m.green) << 8) | uint32_t(m.blue));
+				mix(uint32_t(m.handle));
+			}
+			return h;
+		}
+		//!ためた命令を並べ替えて、描画に使うものをスナップショットに移します
+		void prepare(Snapshot& snapshot)
+		{
+			assert(slotNum_ == 0 && "mergeSlots() is not called");
+			RenderBackend::SetCapture(nullptr);
+			splitImmediates();
+			isRecording_ = false;
+			if (capture_ != nullptr)
+			{
+				capture_->addFrame(commands_, materials_, generation_, immediates_, immediateRanges_);
+			}
+			if (isRankDirty_)
+			{
+				updateRanks();
+			}
+			const size_t n = commands_.size();
+			keys_.resize(n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				keys_[i] = SortKey(commands_[i].layer, commands_[i].segment, ranks_[commands_[i].material]);
+			}
+			radixSort();
+			//直接描画したものは、キーが同じか大きい最初の命令の前に描画する
+			for (auto& range : immediateRanges_)
+			{
+				const auto it = std::lower_bound(order_.begin(), order_.end(), range.key, [this](const uint32_t index, const uint32_t key)
+				{
+					return keys_[index] < key;
+				});
+				range.position = size_t(it - order_.begin());
+			}
+			//レイヤーを戻して直接描画した場合は位置が戻るので、記録した順を保ったまま位置で並べる
+			std::stable_sort(immediateRanges_.begin(), immediateRanges_.end(), [](const ImmediateRange& a, const ImmediateRange& b)
+			{
+				return a.position < b.position;
+			});
+
+			Stats& stats = snapshot.stats;
+			stats = Stats();
+			stats.commandNum = n;
+			stats.materialNum = materials_.size();
+			//比較用に積んだ順のままの場合を数える
+			{
+				Stats unsorted;
+				State state;
+				for (const auto& c : commands_)
+				{
+					Transition(state, materials_[c.material], unsorted);
+				}
+				Transition(state, ResetMaterial(state), unsorted);
+				stats.unsortedStateChangeNum = unsorted.blendChangeNum + unsorted.brightChangeNum;
+			}
+			//キャッシュするのは先頭から続くレイヤーだけ。間にキャッシュしないレイヤーがあればその上は毎回描画する
+			size_t cachedNum = 0;
+			if (cachedLayers_.any())
+			{
+				while (cachedNum < n && cachedLayers_[commands_[order_[cachedNum]].layer])
+				{
+					++cachedNum;
+				}
+			}
+			snapshot.cachedNum = cachedNum;
+			snapshot.cacheHash = cachedNum > 0 ? hashCachedLayers(cachedNum) : 0;
+			//入れ替えたスナップショットの領域は次のフレームで使い回す
+			snapshot.commands.swap(commands_);
+			snapshot.order.swap(order_);
+			snapshot.materials = materials_;
+			std::swap(snapshot.immediates, immediates_);
+			snapshot.immediateRanges.swap(immediateRanges_);
+			DebugDraw::Get().publish(snapshot.debugDraw);
+			snapshot.generation = generation_;
+			commands_.clear();
+			immediates_.clear();
+			immediateRanges_.clear();
+		}
+		//!スナップショットを描画し、描画の状態を元に戻します
+		void draw(const Snapshot& snapshot)
+		{
+			if (textureGeneration_ != snapshot.generation)
+			{
+				textures_.clear();
+				textureGeneration_ = snapshot.generation;
+			}
+			while (textures_.size() < snapshot.materials.size())
+			{
+				const int handle = snapshot.materials[textures_.size()].handle;
+				TextureInfo t;
+				RenderBackend::Get().getGraphSize(handle, &t.w, &t.h);
+				RenderBackend::Get().getTextureRegion(handle, &t.x, &t.y, &t.texW, &t.texH);
+				textures_.emplace_back(t);
+			}
+			Stats stats = snapshot.stats;
+			//キャッシュは画面全体を上書きするので、キャッシュするレイヤーの間に直接描画したものがあればキャッシュを使わない
+			const bool isCacheUsable = snapshot.cachedNum > 0 &&
+				(snapshot.immediateRanges.empty() || snapshot.immediateRanges.front().position >= snapshot.cachedNum);
+			size_t begin = isCacheUsable ? drawLayerCache(snapshot, stats) : 0;
+			for (const auto& range : snapshot.immediateRanges)
+			{
+				drawRange(snapshot, begin, std::max(begin, range.position), stats);
+				begin = std::max(begin, range.position);
+				snapshot.immediates.replay(RenderBackend::Get(), range.begin, range.end);
+			}
+			drawRange(snapshot, begin, snapshot.order.size(), stats);
+			DebugDraw::Get().draw(snapshot.debugDraw);
+			stats_ = stats;
+		}
+		/**
+		* @brief キャッシュするレイヤーの命令を、内容が変わっていればキャッシュに描画し直してから画面に描画します
+		* @details 前のフレームと内容が違う場合は、次のフレームでもまた変わる見込みが高いので描画し直さず、キャッシュを使いません。
+		* 次のフレームで使えないキャッシュに描画し直すと画面への描画が1回増えるだけなので、キャッシュに描画するのは2フレーム続けて同じ内容になったときだけです
+		* @return 続きを描画する命令の番号。キャッシュの描画先を作れないか、キャッシュを使わない場合は0です
+		*/
+		[[nodiscard]] size_t drawLayerCache(const Snapshot& snapshot, Stats& stats)
+		{
+			IRenderBackend& backend = RenderBackend::Get();
+			int w = 0, h = 0;
+			backend.getRenderTargetSize(&w, &h);
+			if (cacheTarget_ == -1 || cacheBackend_ != &backend || w != cacheW_ || h != cacheH_)
+			{
+				//出力先が変わった場合は前の出力先がもう無いかもしれないので、描画先は削除しない
+				if (cacheTarget_ != -1 && cacheBackend_ == &backend)
+				{
+					backend.deleteRenderTarget(cacheTarget_);
+				}
+				cacheTarget_ = backend.createRenderTarget(w, h);
+				cacheBackend_ = &backend;
+				cacheW_ = w;
+				cacheH_ = h;
+				isCacheDirty_ = true;
+				if (cacheTarget_ == -1)
+				{
+					return 0;
+				}
+			}
+			const bool isInvalidated = isCacheDirty_.exchange(false);
+			const bool isStable = prevCacheHash_ == snapshot.cacheHash;
+			prevCacheHash_ = snapshot.cacheHash;
+			if (!isInvalidated && cacheHash_ == snapshot.cacheHash)
+			{
+				stats.cachedCommandNum = snapshot.cachedNum;
+				++layerCacheStats_.hitFrameNum;
+			}
+			else if (!isStable)
+			{
+				if (isInvalidated)
+				{
+					isCacheDirty_ = true;
+				}
+				++layerCacheStats_.bypassFrameNum;
+				return 0;
+			}
+			else
+			{
+				const int prevTarget = backend.getRenderTarget();
+				backend.setRenderTarget(cacheTarget_);
+				backend.clearRenderTarget();
+				drawRange(snapshot, 0, snapshot.cachedNum, stats);
+				backend.setRenderTarget(prevTarget);
+				cacheHash_ = snapshot.cacheHash;
+				++layerCacheStats_.rebuildNum;
+			}
+			//描画の状態は初期状態なので、ブレンドせずにそのまま写る
+			backend.blitRenderTarget(cacheTarget_);
+			return snapshot.cachedNum;
+		}
+		//!並べ替えたbegin番目からend番目の手前までの命令を描画し、描画の状態を元に戻します
+		void drawRange(const Snapshot& snapshot, const size_t begin, const size_t end, Stats& stats)
+		{
+			State state;
+			for (size_t i = begin; i < end;)
+			{
+				const size_t batchNum = isBatchEnable_ ? CountBatchable(snapshot, i, end) : 0;
+				if (batchNum >= BATCH_MIN)
+				{
+					drawBatch(state, snapshot, i, batchNum, stats);
+					i += batchNum;
+					continue;
+				}
+				const Command& c = snapshot.commands[snapshot.order[i]];
+				const Material& m = snapshot.materials[c.material];
+				Apply(state, m, stats);
+				Draw(c, m.handle);
+				++i;
+			}
+			//ResetRenderState()と同じ状態に戻す
+			Transition(state, ResetMaterial(state), stats);
+			if (state.isBlendChanged)
+			{
+				RenderBackend::Get().setBlend(DX_BLENDMODE_NOBLEND, 255);
+			}
+			if (state.isBrightChanged)
+			{
+				RenderBackend::Get().setBright(255, 255, 255);
+			}
+		}
+	public:
+		/**
+		* @brief 描画命令をため始めます
+		* @details マテリアルが増えすぎた場合はここで変換表を作り直します。MaterialCacheは世代で無効になります
+		*/
+		void begin()
+		{
+			assert(slotNum_ == 0 && "mergeSlots() is not called");
+			commands_.clear();
+			immediates_.clear();
+			immediateRanges_.clear();
+			layer_ = 0;
+			segment_ = 0;
+			isRecording_ = true;
+			RenderBackend::SetCapture(&immediates_);
+			if (materials_.size() > MATERIAL_MAX / 2)
+			{
+				materials_.clear();
+				materialIds_.clear();
+				ranks_.clear();
+				++generation_;
+			}
+		}
+		//!begin()からflush()までの間ならtrue
+		[[nodiscard]] bool isRecording() const
+		{
+			return isRecording_;
+		}
+		//!これから積む命令のレイヤーを指定します。小さい方から描画されます。SlotScopeの中ならその入れ物のレイヤーになります
+		void setLayer(const size_t layer)
+		{
+			assert(layer < 256 && "layer is out of range");
+			const int slot = CurrentSlot();
+			if (slot < 0)
+			{
+				splitImmediates();
+				layer_ = uint8_t(layer);
+				return;
+			}
+			slots_[size_t(slot)].layer = uint8_t(layer);
+		}
+		/**
+		* @brief 並列に命令を積む準備をします
+		* @param slotNum 入れ物の数。SLOT_MAX以下にしてください
+		* @details 各入れ物のレイヤーは今のレイヤーから始まります
+		*/
+		void beginSlots(const size_t slotNum)
+		{
+			assert(isRecording_ && "begin() is not called");
+			assert(slotNum <= SLOT_MAX && "too many slots");
+			splitImmediates();
+			if (slots_.size() < slotNum)
+			{
+				slots_.resize(slotNum);
+			}
+			for (size_t i = 0; i < slotNum; ++i)
+			{
+				slots_[i].commands.clear();
+				slots_[i].layer = layer_;
+				slots_[i].segment = segment_;
+			}
+			slotNum_ = slotNum;
+		}
+		/**
+		* @brief 入れ物に積んだ命令を番号順に結合します
+		* @details 並列に積み終わってから、命令を積むスレッドで呼んでください
+		*/
+		void mergeSlots()
+		{
+			//並列に積む間に直接描画したものは、入れ物の命令より後に描画する
+			splitImmediates();
+			size_t num = commands_.size();
+			for (size_t i = 0; i < slotNum_; ++i)
+			{
+				num += slots_[i].commands.size();
+			}
+			commands_.reserve(num);
+			for (size_t i = 0; i < slotNum_; ++i)
+			{
+				commands_.insert(commands_.end(), slots_[i].commands.begin(), slots_[i].commands.end());
+			}
+			slotNum_ = 0;
+		}
+		/**
+		* @brief マテリアルを共有の番号に変換します
+		* @details 並列に積む場合もあるので排他します。MaterialCacheを使うと排他を省けます
+		*/
+		[[nodiscard]] uint16_t intern(const Material& m)
+		{
+			std::lock_guard<std::mutex> lock(internMutex_);
+			const auto it = materialIds_.find(m);
+			if (it != materialIds_.end())
+			{
+				return it->second;
+			}
+			assert(materials_.size() < MATERIAL_MAX && "too many materials");
+			const uint16_t id = uint16_t(materials_.size());
+			materials_.emplace_back(m);
+			materialIds_.emplace(m, id);
+			isRankDirty_ = true;
+			return id;
+		}
+		//!前回と同じマテリアルならキャッシュの番号を使って変換します
+		[[nodiscard]] uint16_t intern(const Material& m, MaterialCache& cache)
+		{
+			if (cache.id == INVALID_MATERIAL || cache.generation != generation_ || cache.material != m)
+			{
+				cache.material = m;
+				cache.id = intern(m);
+				cache.generation = generation_;
+			}
+			return cache.id;
+		}
+		//!番号からマテリアルを返します
+		[[nodiscard]] const Material& material(const uint16_t id) const
+		{
+			return materials_[id];
+		}
+		//!同じマテリアルの命令をSpriteBatchでまとめて描画するかを指定します
+		void setBatchEnable(const bool isEnable)
+		{
+			isBatchEnable_ = isEnable;
+		}
+		//!描画命令を積みます。layerは現在のレイヤーで上書きされます。SlotScopeの中ならその入れ物に積みます
+		void push(const Command& command)
+		{
+			const int slot = CurrentSlot();
+			if (slot < 0)
+			{
+				splitImmediates();
+				commands_.emplace_back(command);
+				commands_.back().layer = layer_;
+				commands_.back().segment = segment_;
+				return;
+			}
+			Slot& s = slots_[size_t(slot)];
+			s.commands.emplace_back(command);
+			s.commands.back().layer = s.layer;
+			s.commands.back().segment = s.segment;
+		}
+		/**
+		* @brief ためた命令を並べ替えて描画し、描画の状態を元に戻します
+		* @details 状態の変更の回数はstats()で取得できます。begin()と同じスレッドで呼んでください
+		*/
+		void flush()
+		{
+			prepare(back_);
+			draw(back_);
+		}
+		/**
+		* @brief ためた命令を並べ替えて、描画せずに裏のスナップショットに残します
+		* @details begin()と同じスレッドで呼んでください。flush()と混ぜて使わないでください
+		*/
+		void publish()
+		{
+			prepare(back_);
+		}
+		//!表と裏のスナップショットを入れ替えます。publish()とsubmit()のどちらも動いていないときに呼んでください
+		void swapSnapshot()
+		{
+			std::swap(front_, back_);
+		}
+		/**
+		* @brief 表のスナップショットを描画し、描画の状態を元に戻します
+		* @details 命令を積むスレッドとは別のスレッドから呼べます。swapSnapshot()しなければ同じフレームをもう一度描画します
+		*/
+		void submit()
+		{
+			draw(front_);
+		}
+		//!直前のflush()かsubmit()の統計を返します
+		[[nodiscard]] const Stats& stats() const
+		{
+			return stats_;
+		}
+		/**
+		* @brief レイヤーの描画をキャッシュするかを指定します
+		* @details 並べ替えた命令の先頭から続く、キャッシュするレイヤーの命令だけをキャッシュします。
+		* キャッシュしないレイヤーの命令が1つでも間にあれば、その上のレイヤーはキャッシュせずに描画します
+		* - キャッシュは画面全体を上書きするので、submit()の前に画面に直接描画したものは消えます
+		* - 命令を積むスレッドで呼んでください。次のpublish()かflush()から反映されます
+		*/
+		void setLayerCache(const size_t layer, const bool isEnable)
+		{
+			assert(layer < 256 && "layer is out of range");
+			cachedLayers_.set(layer, isEnable);
+		}
+		/**
+		* @brief 命令が変わらなくても、次の描画でキャッシュを描画し直します
+		* @details 画像ハンドルの中身を書き換えた場合や、描画先が失われた場合に呼んでください
+		*/
+		void invalidateLayerCache()
+		{
+			isCacheDirty_ = true;
+		}
+		/**
+		* @brief 命令を積み終えるたびにcaptureに記録します。nullptrなら記録をやめます
+		* @details 命令を積むスレッドで呼んでください。captureの寿命は呼び出し側で管理してください
+		*/
+		void setCapture(RenderCapture* capture)
+		{
+			capture_ = capture;
+		}
+		//!レイヤーのキャッシュの累計を返します
+		[[nodiscard]] const LayerCacheStats& layerCacheStats() const
+		{
+			return layerCacheStats_;
+		}
+	};
+public:
+	static Singleton& Get()
+	{
+		static std::unique_ptr<Singleton> instance = std::make_unique<Singleton>();
+		return *instance;
+	}
+};
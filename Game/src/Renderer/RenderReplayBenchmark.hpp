@@ -0,0 +1,214 @@
+﻿/**
+* @file RenderReplayBenchmark.hpp
+* @brief RenderCaptureで記録した描画命令を流し直して、描画にかかる時間を計測します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderQueue.hpp"
+#include "RenderCapture.hpp"
+#include "NullBackend.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "../System/System.hpp"
+#include "../Utility/Utility.hpp"
+#include <vector>
+#include <string>
+#include <chrono>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+/**
+* @brief 描画命令のキャプチャを使った描画の性能計測です
+* @details ゲームを動かさずに、同じ描画命令で描画の処理を変える前と後を比べるのに使います
+* - 記録したフレームを順にRenderQueueに積み直し、flush()で出力先に描画するまでの時間をフレームごとに計測します
+* - 直接描画したものは記録したときと同じ順番で命令の間に描画し直すので、RenderQueueが同じ位置で区切り、命令と同じ順番で描画されます
+* - 出力先にNullBackendを指定すればRenderQueueの並べ替えとまとめる処理だけを、
+*   SoftwareRasterizerを指定すればラスタライズまで含めた時間を計測できます
+* - 結果はコンソールに出力されます。計測中にゲームは止まるのでデバッグ時に明示的に呼んでください
+*/
+class RenderReplayBenchmark final
+{
+private:
+	RenderReplayBenchmark() = delete;
+	//!RenderQueueの並べ替えのキーから、直接描画したもので区切った番号を取り出します
+	[[nodiscard]] static uint8_t Segment(const uint32_t key)
+	{
+		return uint8_t((key >> 16) & 0xff);
+	}
+	//!RenderQueueの並べ替えのキーから、レイヤーを取り出します
+	[[nodiscard]] static uint8_t Layer(const uint32_t key)
+	{
+		return uint8_t(key >> 24);
+	}
+public:
+	//!計測の結果です。時間はミリ秒です
+	struct Result
+	{
+		size_t frameNum = 0;
+		size_t commandNum = 0;
+		double totalMs = 0.0;
+		double averageMs = 0.0;
+		double minMs = 0.0;
+		double maxMs = 0.0;
+		//!95パーセンタイル
+		double p95Ms = 0.0;
+		//!フレームごとの時間
+		std::vector<double> frameMs;
+	};
+	//!キャプチャに出てくる画像の大きさをNullBackendに登録します
+	static void SetupTextures(const std::vector<RenderCapture::Frame>& frames, NullBackend& backend)
+	{
+		for (const auto& frame : frames)
+		{
+			for (size_t i = 0; i < frame.materials.size(); ++i)
+			{
+				backend.setGraphSize(frame.materials[i].handle, frame.textureSizes[i].first, frame.textureSizes[i].second);
+			}
+		}
+	}
+	/**
+	* @brief キャプチャに出てくる画像を、同じ大きさの白い画像としてSoftwareRasterizerに登録します
+	* @details 画素は記録していないので、塗る面積と合成の負荷だけが元の描画と同じになります
+	*/
+	static void SetupTextures(const std::vector<RenderCapture::Frame>& frames, SoftwareRasterizer& raster)
+	{
+		std::vector<uint32_t> white;
+		for (const auto& frame : frames)
+		{
+			for (size_t i = 0; i < frame.materials.size(); ++i)
+			{
+				const auto& size = frame.textureSizes[i];
+				int w = 0, h = 0;
+				raster.getGraphSize(frame.materials[i].handle, &w, &h);
+				if (size.first <= 0 || size.second <= 0 || (w == size.first && h == size.second))
+				{
+					continue;
+				}
+				white.assign(size_t(size.first) * size_t(size.second), 0xffffffffu);
+				raster.setTexture(frame.materials[i].handle, size.first, size.second, white.data());
+			}
+		}
+	}
+	/**
+	* @brief 読み込んだフレームを出力先に流し、フレームごとの時間を計測します
+	* @param frames RenderCapture::decode()で読み込んだフレーム
+	* @param backend 出力先。計測の間だけRenderBackend::Set()で切り替えます
+	* @param loopNum 全フレームを流す回数
+	* @param frameEnd フレームの最後に計測に含めて呼ぶ処理。SoftwareRasterizer::finish()などに使います
+	*/
+	static Result Run(const std::vector<RenderCapture::Frame>& frames, IRenderBackend& backend, const int loopNum = 1,
+		const std::function<void()>& frameEnd = nullptr)
+	{
+		Result result;
+		IRenderBackend& prevBackend = RenderBackend::GetOutput();
+		RenderBackend::Set(&backend);
+		auto& queue = RenderQueue::Get();
+		std::vector<uint16_t> ids;
+		for (int loop = 0; loop < loopNum; ++loop)
+		{
+			for (const auto& frame : frames)
+			{
+				queue.begin();
+				//マテリアルの変換はゲームでは命令を積むときに済んでいるので計測に含めない
+				ids.resize(frame.materials.size());
+				for (size_t i = 0; i < ids.size(); ++i)
+				{
+					ids[i] = queue.intern(frame.materials[i]);
+				}
+				const auto start = std::chrono::steady_clock::now();
+				int layer = -1;
+				size_t range = 0;
+				//区切った番号がsegment以下の範囲を、区切ったときのレイヤーで直接描画し直す。RenderQueueが記録して同じ位置で区切る
+				auto replayImmediates = [&](const uint32_t segment)
+				{
+					for (; range < frame.immediateRanges.size() && Segment(frame.immediateRanges[range].key) <= segment; ++range)
+					{
+						const auto& it = frame.immediateRanges[range];
+						layer = Layer(it.key);
+						queue.setLayer(size_t(layer));
+						frame.immediates.replay(RenderBackend::Get(), it.begin, it.end);
+					}
+				};
+				for (const auto& c : frame.commands)
+				{
+					replayImmediates(c.segment);
+					if (c.layer != layer)
+					{
+						layer = c.layer;
+						queue.setLayer(size_t(layer));
+					}
+					RenderCommand command = c;
+					command.material = ids[c.material];
+					queue.push(command);
+				}
+				replayImmediates(UINT32_MAX);
+				queue.flush();
+				if (frameEnd)
+				{
+					frameEnd();
+				}
+				const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+				result.frameMs.emplace_back(ms);
+				result.commandNum += frame.commands.size();
+			}
+		}
+		RenderBackend::Set(&prevBackend);
+		result.frameNum = result.frameMs.size();
+		if (result.frameNum == 0)
+		{
+			return result;
+		}
+		std::vector<double> sorted = result.frameMs;
+		std::sort(sorted.begin(), sorted.end());
+		for (const double it : sorted)
+		{
+			result.totalMs += it;
+		}
+		result.averageMs = result.totalMs / double(result.frameNum);
+		result.minMs = sorted.front();
+		result.maxMs = sorted.back();
+		result.p95Ms = sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)];
+		return result;
+	}
+	/**
+	* @brief キャプチャのファイルを読み込み、NullBackendとSoftwareRasterizerに流して計測します
+	* @param path RenderCapture::save()で保存したファイル
+	* @param loopNum 全フレームを流す回数
+	* @param width SoftwareRasterizerの幅
+	* @param height SoftwareRasterizerの高さ
+	* @return 読み込めなければfalse
+	*/
+	static bool Run(const std::string& path, const int loopNum = 1, const int width = System::SCREEN_WIDIH, const int height = System::SCREEN_HEIGHT)
+	{
+		RenderCapture capture;
+		std::vector<RenderCapture::Frame> frames;
+		if (!capture.load(path) || !capture.decode(frames))
+		{
+			DOUT << "RenderReplayBenchmark : " << path << " can not be read" << std::endl;
+			return false;
+		}
+		auto print = [](const char* name, const Result& result)
+		{
+			DOUT << "  " << name << " : average " << result.averageMs << ", min " << result.minMs << ", p95 " << result.p95Ms
+				<< ", max " << result.maxMs << " [milliseconds/frame]" << std::endl;
+		};
+		DOUT << "RenderReplayBenchmark : " << path << ", " << frames.size() << " frames, " << capture.byteNum() << " bytes" << std::endl;
+
+		NullBackend null(width, height);
+		SetupTextures(frames, null);
+		const Result nullResult = Run(frames, null, loopNum);
+		DOUT << "  " << nullResult.commandNum / std::max(size_t(1), nullResult.frameNum) << " commands/frame" << std::endl;
+		print("null", nullResult);
+
+		SoftwareRasterizer raster(width, height);
+		SetupTextures(frames, raster);
+		const Result rasterResult = Run(frames, raster, loopNum, [&raster]()
+		{
+			raster.finish();
+		});
+		print("software", rasterResult);
+		return true;
+	}
+};
@@ -0,0 +1,150 @@
+﻿/**
+* @file SoftwareRasterizer.hpp
+* @brief SoftwareRasterizerCoreを描画の出力先として使うためのIRenderBackendです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderBackend.hpp"
+#include "SoftwareRasterizerCore.hpp"
+#include <DxLib.h>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+static_assert(SoftwareRasterizerCore::BLEND_NOBLEND == DX_BLENDMODE_NOBLEND && SoftwareRasterizerCore::BLEND_ALPHA == DX_BLENDMODE_ALPHA &&
+	SoftwareRasterizerCore::BLEND_ADD == DX_BLENDMODE_ADD && SoftwareRasterizerCore::BLEND_SUB == DX_BLENDMODE_SUB &&
+	SoftwareRasterizerCore::BLEND_INVSRC == DX_BLENDMODE_INVSRC && SoftwareRasterizerCore::BLEND_MULA == DX_BLENDMODE_MULA &&
+	SoftwareRasterizerCore::BLEND_HALF_ADD == DX_BLENDMODE_HALF_ADD && SoftwareRasterizerCore::BLEND_PMA_ALPHA == DX_BLENDMODE_PMA_ALPHA &&
+	SoftwareRasterizerCore::BLEND_PMA_ADD == DX_BLENDMODE_PMA_ADD && SoftwareRasterizerCore::BLEND_PMA_SUB == DX_BLENDMODE_PMA_SUB &&
+	SoftwareRasterizerCore::BLEND_PMA_INVSRC == DX_BLENDMODE_PMA_INVSRC, "blend modes must match DxLib");
+static_assert(SoftwareRasterizerCore::DRAW_NEAREST == DX_DRAWMODE_NEAREST && SoftwareRasterizerCore::DRAW_BILINEAR == DX_DRAWMODE_BILINEAR,
+	"draw modes must match DxLib");
+static_assert(SoftwareRasterizerCore::SCREEN_BACK == int(DX_SCREEN_BACK), "screen handle must match DxLib");
+static_assert(sizeof(RasterVertex) == sizeof(VERTEX2D) && offsetof(RasterVertex, rhw) == offsetof(VERTEX2D, rhw) &&
+	offsetof(RasterVertex, dif) == offsetof(VERTEX2D, dif) && offsetof(RasterVertex, u) == offsetof(VERTEX2D, u) &&
+	offsetof(RasterVertex, v) == offsetof(VERTEX2D, v), "RasterVertex must have the same layout as VERTEX2D");
+
+/**
+* @brief SoftwareRasterizerCoreで描画するIRenderBackendです
+* @details 描画の処理はすべてSoftwareRasterizerCoreにあり、ここではDXライブラリの型を受け取って渡すだけです。
+* 頂点はVERTEX2Dと同じ並びのRasterVertexとしてそのまま渡します
+*/
+class SoftwareRasterizer final : public IRenderBackend, public SoftwareRasterizerCore
+{
+public:
+	/**
+	* @brief 描画先の大きさを指定して作ります
+	* @param width 幅
+	* @param height 高さ
+	*/
+	SoftwareRasterizer(const int width, const int height) :
+		SoftwareRasterizerCore(width, height)
+	{}
+	//!LoadSoftImageなどで作ったソフトウェアイメージを画像として登録します
+	void setTextureFromSoftImage(const int handle, const int softImage)
+	{
+		int w = 0, h = 0;
+		GetSoftImageSize(softImage, &w, &h);
+		std::vector<uint32_t> rgba(size_t(w) * size_t(h));
+		for (int y = 0; y < h; ++y)
+		{
+			for (int x = 0; x < w; ++x)
+			{
+				int r, g, b, a;
+				GetPixelSoftImage(softImage, x, y, &r, &g, &b, &a);
+				rgba[size_t(y) * size_t(w) + size_t(x)] = uint32_t(r) | (uint32_t(g) << 8) | (uint32_t(b) << 16) | (uint32_t(a) << 24);
+			}
+		}
+		setTexture(handle, w, h, rgba.data());
+	}
+	void setDrawMode(const int drawMode) override
+	{
+		SoftwareRasterizerCore::setDrawMode(drawMode);
+	}
+	void setBlend(const int blendMode, const int alpha) override
+	{
+		SoftwareRasterizerCore::setBlend(blendMode, alpha);
+	}
+	void setBright(const int red, const int green, const int blue) override
+	{
+		SoftwareRasterizerCore::setBright(red, green, blue);
+	}
+	void getGraphSize(const int handle, int* w, int* h) override
+	{
+		SoftwareRasterizerCore::getGraphSize(handle, w, h);
+	}
+	void getTextureRegion(const int handle, int* x, int* y, int* texW, int* texH) override
+	{
+		SoftwareRasterizerCore::getTextureRegion(handle, x, y, texW, texH);
+	}
+	void drawRotaGraph(const float x, const float y, const float cx, const float cy,
+		const double scaleX, const double scaleY, const double angle, const int handle, const bool isTurn) override
+	{
+		SoftwareRasterizerCore::drawRotaGraph(x, y, cx, cy, scaleX, scaleY, angle, handle, isTurn);
+	}
+	void drawRectRotaGraph(const float x, const float y, const int srcX, const int srcY, const int w, const int h,
+		const float cx, const float cy, const double scaleX, const double scaleY, const double angle,
+		const int handle, const bool isTurn) override
+	{
+		SoftwareRasterizerCore::drawRectRotaGraph(x, y, srcX, srcY, w, h, cx, cy, scaleX, scaleY, angle, handle, isTurn);
+	}
+	void drawPrimitiveIndexed(const VERTEX2D* vertices, const int vertexNum,
+		const unsigned short* indices, const int indexNum, const int handle) override
+	{
+		SoftwareRasterizerCore::drawPrimitiveIndexed(reinterpret_cast<const RasterVertex*>(vertices), vertexNum, indices, indexNum, handle);
+	}
+	void drawLineList(const VERTEX2D* vertices, const int vertexNum) override
+	{
+		SoftwareRasterizerCore::drawLineList(reinterpret_cast<const RasterVertex*>(vertices), vertexNum);
+	}
+	void drawLineAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const float thickness) override
+	{
+		SoftwareRasterizerCore::drawLineAA(x1, y1, x2, y2, color, thickness);
+	}
+	void drawBoxAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		SoftwareRasterizerCore::drawBoxAA(x1, y1, x2, y2, color, isFill, thickness);
+	}
+	void drawCircleAA(const float x, const float y, const float r, const int posNum,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		SoftwareRasterizerCore::drawCircleAA(x, y, r, posNum, color, isFill, thickness);
+	}
+	void drawQuadrangleAA(const float x1, const float y1, const float x2, const float y2,
+		const float x3, const float y3, const float x4, const float y4,
+		const unsigned int color, const bool isFill, const float thickness) override
+	{
+		SoftwareRasterizerCore::drawQuadrangleAA(x1, y1, x2, y2, x3, y3, x4, y4, color, isFill, thickness);
+	}
+	int createRenderTarget(const int w, const int h) override
+	{
+		return SoftwareRasterizerCore::createRenderTarget(w, h);
+	}
+	void deleteRenderTarget(const int handle) override
+	{
+		SoftwareRasterizerCore::deleteRenderTarget(handle);
+	}
+	int getRenderTarget() override
+	{
+		return SoftwareRasterizerCore::getRenderTarget();
+	}
+	void setRenderTarget(const int handle) override
+	{
+		SoftwareRasterizerCore::setRenderTarget(handle);
+	}
+	void clearRenderTarget() override
+	{
+		SoftwareRasterizerCore::clearRenderTarget();
+	}
+	void getRenderTargetSize(int* w, int* h) override
+	{
+		SoftwareRasterizerCore::getRenderTargetSize(w, h);
+	}
+	void blitRenderTarget(const int handle) override
+	{
+		SoftwareRasterizerCore::blitRenderTarget(handle);
+	}
+};
@@ -0,0 +1,1067 @@
+﻿/**
+* @file SoftwareRasterizerCore.hpp
+* @brief DXライブラリを使わずにCPUでメモリ上の画像に描画する処理です
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "../Utility/ThreadPool.hpp"
+#include <emmintrin.h>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cassert>
+
+//!RasterVertexの座標です。DXライブラリのVECTORと同じ並びです
+struct RasterVector
+{
+	float x, y, z;
+};
+//!RasterVertexの色です。DXライブラリのCOLOR_U8と同じ並びです
+struct RasterColor
+{
+	uint8_t b, g, r, a;
+};
+//!SoftwareRasterizerCoreに渡す頂点です。DXライブラリのVERTEX2Dと同じ並びです
+struct RasterVertex
+{
+	RasterVector pos;
+	float rhw;
+	RasterColor dif;
+	float u, v;
+};
+
+/**
+* @brief 描画コンポーネントが使う機能をCPUで実装したものです
+* @details DXライブラリに依存しないので、DXライブラリの無い環境でも描画結果の検証に使えます。
+* 描画の出力先にするときは、IRenderBackendにしたSoftwareRasterizerを使ってください
+* - 描画の命令は三角形にしてためておき、finish()でまとめてRGBAのフレームバッファに描画します
+* - 画面をTILE_SIZE四方のタイルに分け、三角形をタイルごとに振り分けてからタイル単位で並列に描画します。
+*   タイルの中では命令の順番通りに描画するので、スレッドの数によらず結果は同じになります
+* - NOBLEND, ALPHA, ADD, SUBの合成はSSE2で4ピクセルずつ行います。ただし時間の多くはテクスチャの読み出しと三角形の内外の判定にかかるので、
+*   全体の時間はSSE2を使わない場合とほとんど変わりません。setSimdEnable()で切り替えて同じ結果になることを確かめられます
+* - ブレンドモードと描画モードの値はDXライブラリのDX_BLENDMODE_*とDX_DRAWMODE_*と同じです。色はGetColor()と同じく0xRRGGBBです
+* - 画像はsetTexture()で登録したものだけ描画できます。DXライブラリの画像ハンドルと同じ番号で登録してください
+* - DXライブラリと同じく、画像は2のn乗の大きさのテクスチャの左上に置いたものとして扱います。
+*   drawPrimitiveIndexed()のUVはそのテクスチャ全体に対する割合なので、getTextureRegion()で求めてください
+* - 図形のアンチエイリアスは行いません。ピクセルの中心が図形に入っているかだけで塗ります
+* - createRenderTarget()で作る描画先はフレームバッファと同じ大きさです。描画先を切り替えると、それまでに積んだ三角形をfinish()で描画します
+* - save()でPPMかPNGに書き出せるので、描画結果を正解の画像と比べるテストや描画の時間の計測に使えます
+*/
+class SoftwareRasterizerCore
+{
+public:
+	//!タイルの一辺のピクセル数です
+	static constexpr int TILE_SIZE = 64;
+	//!ブレンドモードです。値はDXライブラリのDX_BLENDMODE_*と同じです
+	static constexpr int BLEND_NOBLEND = 0;
+	static constexpr int BLEND_ALPHA = 1;
+	static constexpr int BLEND_ADD = 2;
+	static constexpr int BLEND_SUB = 3;
+	static constexpr int BLEND_INVSRC = 10;
+	static constexpr int BLEND_MULA = 11;
+	static constexpr int BLEND_HALF_ADD = 15;
+	static constexpr int BLEND_PMA_ALPHA = 17;
+	static constexpr int BLEND_PMA_ADD = 18;
+	static constexpr int BLEND_PMA_SUB = 19;
+	static constexpr int BLEND_PMA_INVSRC = 20;
+	//!描画モードです。値はDXライブラリのDX_DRAWMODE_*と同じです
+	static constexpr int DRAW_NEAREST = 0;
+	static constexpr int DRAW_BILINEAR = 1;
+	//!最初の描画先のハンドルです。DXライブラリのDX_SCREEN_BACKと同じ値です
+	static constexpr int SCREEN_BACK = -2;
+	//!GetColor()と同じく0xRRGGBBの色を作ります
+	[[nodiscard]] static constexpr unsigned int Color(const int red, const int green, const int blue) noexcept
+	{
+		return (unsigned int)(red) << 16 | (unsigned int)(green) << 8 | (unsigned int)(blue);
+	}
+	//!直前のfinish()の統計です
+	struct Stats
+	{
+		//!描画した三角形の数
+		size_t triangleNum = 0;
+		//!タイルに振り分けた三角形の延べ数
+		size_t binnedNum = 0;
+		//!タイルの数
+		size_t tileNum = 0;
+	};
+private:
+	//!固定小数点の座標の1ピクセルの大きさです
+	static constexpr int64_t SUB_PIXEL = 256;
+	//!これより遠い座標の三角形は描画しません
+	static constexpr float COORD_LIMIT = 1000000.f;
+	//!描画先のハンドルの始まりです。画像ハンドルと重ならない大きな値にします
+	static constexpr int TARGET_HANDLE_BEGIN = 0x40000000;
+	struct Texture
+	{
+		int w = 0;
+		int h = 0;
+		//!画像を置いたテクスチャの大きさ。UVの基準になります
+		int texW = 0;
+		int texH = 0;
+		std::vector<uint32_t> pixels;
+	};
+	//!画像ハンドルが指す、登録した画像の中の範囲です
+	struct TextureView
+	{
+		int parent = -1;
+		int x = 0;
+		int y = 0;
+		int w = 0;
+		int h = 0;
+	};
+	struct Triangle
+	{
+		//!固定小数点の頂点座標
+		int64_t x[3];
+		int64_t y[3];
+		//!ピクセルの範囲
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+		//!テクセル座標 u = ua * x + ub * y + uc
+		float ua, ub, uc;
+		float va, vb, vc;
+		//!テクスチャが無い場合はnullptr
+		const uint32_t* texels;
+		int texW;
+		int texH;
+		//!色の乗算とアルファ
+		int red;
+		int green;
+		int blue;
+		int alpha;
+		int paramAlpha;
+		int blendMode;
+		bool isBilinear;
+	};
+	int width_;
+	int height_;
+	int tileX_;
+	int tileY_;
+	std::vector<uint32_t> pixels_;
+	std::unordered_map<int, Texture> textures_;
+	std::unordered_map<int, TextureView> views_;
+	std::vector<Triangle> triangles_;
+	//![分割の番号][タイルの番号]に振り分けた三角形の番号です
+	std::vector<std::vector<std::vector<uint32_t>>> bins_;
+	//!今の描画先以外の描画先の画素です。今の描画先の画素はpixels_にあります
+	std::unordered_map<int, std::vector<uint32_t>> targets_;
+	int target_ = SCREEN_BACK;
+	int nextTarget_ = TARGET_HANDLE_BEGIN;
+	uint32_t clearColor_ = Pack(0, 0, 0, 255);
+	int drawMode_ = DRAW_NEAREST;
+	int blendMode_ = BLEND_NOBLEND;
+	int alpha_ = 255;
+	int red_ = 255;
+	int green_ = 255;
+	int blue_ = 255;
+	bool isSimd_ = true;
+	Stats stats_;
+
+	//!0～255*255の値を255で割って四捨五入します
+	[[nodiscard]] static int Div255(int x) noexcept
+	{
+		x += 128;
+		return (x + (x >> 8)) >> 8;
+	}
+	[[nodiscard]] static uint32_t Pack(const int r, const int g, const int b, const int a) noexcept
+	{
+		return uint32_t(r) | (uint32_t(g) << 8) | (uint32_t(b) << 16) | (uint32_t(a) << 24);
+	}
+	//!1ピクセルを合成します。SSE2の合成と同じ結果になります
+	static void BlendPixel(uint32_t& dst, const uint32_t src, const int blendMode, const int paramAlpha) noexcept
+	{
+		const int a = int(src >> 24);
+		int d[3] = { int(dst & 0xff), int((dst >> 8) & 0xff), int((dst >> 16) & 0xff) };
+		const int s[3] = { int(src & 0xff), int((src >> 8) & 0xff), int((src >> 16) & 0xff) };
+		for (int i = 0; i < 3; ++i)
+		{
+			switch (blendMode)
+			{
+			case BLEND_ADD:
+				d[i] = std::min(255, d[i] + Div255(s[i] * a));
+				break;
+			case BLEND_HALF_ADD:
+				d[i] = std::min(255, d[i] + Div255(s[i] * a) / 2);
+				break;
+			case BLEND_SUB:
+				d[i] = std::max(0, d[i] - Div255(s[i] * a));
+				break;
+			case BLEND_MULA:
+				d[i] = Div255(d[i] * (Div255(s[i] * a) + 255 - a));
+				break;
+			case BLEND_INVSRC:
+				d[i] = Div255((255 - s[i]) * a + d[i] * (255 - a));
+				break;
+			case BLEND_PMA_ALPHA:
+				d[i] = std::min(255, Div255(s[i] * paramAlpha) + Div255(d[i] * (255 - a)));
+				break;
+			case BLEND_PMA_ADD:
+				d[i] = std::min(255, d[i] + Div255(s[i] * paramAlpha));
+				break;
+			case BLEND_PMA_SUB:
+				d[i] = std::max(0, d[i] - Div255(s[i] * paramAlpha));
+				break;
+			case BLEND_PMA_INVSRC:
+				d[i] = std::min(255, Div255((a - s[i]) * paramAlpha) + Div255(d[i] * (255 - a)));
+				break;
+			default:
+				d[i] = Div255(s[i] * a + d[i] * (255 - a));
+				break;
+			}
+		}
+		dst = Pack(d[0], d[1], d[2], 255);
+	}
+	//!8個の16ビットの値を255で割って四捨五入します
+	[[nodiscard]] static __m128i Div255x8(__m128i x) noexcept
+	{
+		x = _mm_add_epi16(x, _mm_set1_epi16(128));
+		return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+	}
+	//!2ピクセル分の16ビットの値のアルファを各チャンネルに広げます
+	[[nodiscard]] static __m128i BroadcastAlpha(const __m128i x) noexcept
+	{
+		return _mm_shufflehi_epi16(_mm_shufflelo_epi16(x, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	}
+	/**
+	* @brief 並んだピクセルを合成します
+	* @param src 色とアルファ(色の乗算とブレンドのアルファを掛けたもの)
+	*/
+	static void BlendSpan(uint32_t* dst, const uint32_t* src, const int num, const int blendMode,
+		const int paramAlpha, const bool isSimd) noexcept
+	{
+		int i = 0;
+		const bool isSimdMode = blendMode == BLEND_NOBLEND || blendMode == BLEND_ALPHA ||
+			blendMode == BLEND_ADD || blendMode == BLEND_SUB;
+		if (isSimd && isSimdMode)
+		{
+			const __m128i zero = _mm_setzero_si128();
+			const __m128i full = _mm_set1_epi16(255);
+			const __m128i opaque = _mm_set1_epi32(int(0xff000000u));
+			for (; i + 4 <= num; i += 4)
+			{
+				const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+				const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+				const __m128i sLo = _mm_unpacklo_epi8(s, zero);
+				const __m128i sHi = _mm_unpackhi_epi8(s, zero);
+				const __m128i aLo = BroadcastAlpha(sLo);
+				const __m128i aHi = BroadcastAlpha(sHi);
+				__m128i result;
+				if (blendMode == BLEND_ADD || blendMode == BLEND_SUB)
+				{
+					const __m128i add = _mm_packus_epi16(
+						Div255x8(_mm_mullo_epi16(sLo, aLo)), Div255x8(_mm_mullo_epi16(sHi, aHi)));
+					result = blendMode == BLEND_ADD ? _mm_adds_epu8(d, add) : _mm_subs_epu8(d, add);
+				}
+				else
+				{
+					const __m128i dLo = _mm_unpacklo_epi8(d, zero);
+					const __m128i dHi = _mm_unpackhi_epi8(d, zero);
+					const __m128i lo = Div255x8(_mm_add_epi16(_mm_mullo_epi16(sLo, aLo),
+						_mm_mullo_epi16(dLo, _mm_sub_epi16(full, aLo))));
+					const __m128i hi = Div255x8(_mm_add_epi16(_mm_mullo_epi16(sHi, aHi),
+						_mm_mullo_epi16(dHi, _mm_sub_epi16(full, aHi))));
+					result = _mm_packus_epi16(lo, hi);
+				}
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_or_si128(result, opaque));
+			}
+		}
+		for (; i < num; ++i)
+		{
+			BlendPixel(dst[i], src[i], blendMode, paramAlpha);
+		}
+	}
+	//!テクスチャの1点の色を取り出します
+	[[nodiscard]] static uint32_t Sample(const Triangle& t, const float u, const float v) noexcept
+	{
+		if (!t.isBilinear)
+		{
+			const int x = std::clamp(int(std::floor(u)), 0, t.texW - 1);
+			const int y = std::clamp(int(std::floor(v)), 0, t.texH - 1);
+			return t.texels[size_t(y) * size_t(t.texW) + size_t(x)];
+		}
+		const float fu = u - 0.5f;
+		const float fv = v - 0.5f;
+		const float flU = std::floor(fu);
+		const float flV = std::floor(fv);
+		const int fx = int((fu - flU) * 256.f);
+		const int fy = int((fv - flV) * 256.f);
+		const int x0 = std::clamp(int(flU), 0, t.texW - 1);
+		const int y0 = std::clamp(int(flV), 0, t.texH - 1);
+		const int x1 = std::clamp(int(flU) + 1, 0, t.texW - 1);
+		const int y1 = std::clamp(int(flV) + 1, 0, t.texH - 1);
+		const uint32_t c00 = t.texels[size_t(y0) * size_t(t.texW) + size_t(x0)];
+		const uint32_t c10 = t.texels[size_t(y0) * size_t(t.texW) + size_t(x1)];
+		const uint32_t c01 = t.texels[size_t(y1) * size_t(t.texW) + size_t(x0)];
+		const uint32_t c11 = t.texels[size_t(y1) * size_t(t.texW) + size_t(x1)];
+		uint32_t result = 0;
+		for (int shift = 0; shift < 32; shift += 8)
+		{
+			const int top = int((c00 >> shift) & 0xff) * (256 - fx) + int((c10 >> shift) & 0xff) * fx;
+			const int bottom = int((c01 >> shift) & 0xff) * (256 - fx) + int((c11 >> shift) & 0xff) * fx;
+			result |= uint32_t((top * (256 - fy) + bottom * fy + 32768) >> 16) << shift;
+		}
+		return result;
+	}
+	/**
+	* @brief 三角形を積みます
+	* @param px 頂点の座標
+	* @param py 頂点の座標
+	* @param u テクセル座標。テクスチャが無い場合は使いません
+	* @param v テクセル座標。テクスチャが無い場合は使いません
+	* @param texture テクスチャ。無い場合はnullptr
+	* @param red 色。描画輝度を掛ける前の値です
+	* @param vertexAlpha 頂点のアルファ。ブレンドのアルファと掛け合わせます
+	*/
+	void pushTriangle(const float* px, const float* py, const float* u, const float* v,
+		const Texture* texture, const int red, const int green, const int blue, const int vertexAlpha)
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			if (!(std::fabs(px[i]) < COORD_LIMIT && std::fabs(py[i]) < COORD_LIMIT))
+			{
+				return;
+			}
+		}
+		Triangle t;
+		for (int i = 0; i < 3; ++i)
+		{
+			t.x[i] = std::llround(double(px[i]) * double(SUB_PIXEL));
+			t.y[i] = std::llround(double(py[i]) * double(SUB_PIXEL));
+		}
+		int64_t cross = (t.x[1] - t.x[0]) * (t.y[2] - t.y[0]) - (t.y[1] - t.y[0]) * (t.x[2] - t.x[0]);
+		if (cross == 0)
+		{
+			return;
+		}
+		int order[3] = { 0, 1, 2 };
+		if (cross < 0)
+		{
+			std::swap(t.x[1], t.x[2]);
+			std::swap(t.y[1], t.y[2]);
+			std::swap(order[1], order[2]);
+			cross = -cross;
+		}
+		const int64_t minX = std::min({ t.x[0], t.x[1], t.x[2] });
+		const int64_t minY = std::min({ t.y[0], t.y[1], t.y[2] });
+		const int64_t maxX = std::max({ t.x[0], t.x[1], t.x[2] });
+		const int64_t maxY = std::max({ t.y[0], t.y[1], t.y[2] });
+		t.minX = std::max(0, int(minX / SUB_PIXEL) - 1);
+		t.minY = std::max(0, int(minY / SUB_PIXEL) - 1);
+		t.maxX = std::min(width_ - 1, int(maxX / SUB_PIXEL) + 1);
+		t.maxY = std::min(height_ - 1, int(maxY / SUB_PIXEL) + 1);
+		if (t.minX > t.maxX || t.minY > t.maxY)
+		{
+			return;
+		}
+		t.texels = nullptr;
+		t.texW = 0;
+		t.texH = 0;
+		t.ua = t.ub = t.uc = t.va = t.vb = t.vc = 0.f;
+		if (texture != nullptr)
+		{
+			t.texels = texture->pixels.data();
+			t.texW = texture->w;
+			t.texH = texture->h;
+			//頂点の座標とテクセル座標から、画面の座標をテクセル座標に変える平面の式を求める
+			const double x0 = double(px[order[0]]), y0 = double(py[order[0]]);
+			const double dx1 = double(px[order[1]]) - x0, dy1 = double(py[order[1]]) - y0;
+			const double dx2 = double(px[order[2]]) - x0, dy2 = double(py[order[2]]) - y0;
+			const double det = dx1 * dy2 - dx2 * dy1;
+			if (det == 0.0)
+			{
+				return;
+			}
+			const double du1 = double(u[order[1]]) - double(u[order[0]]), du2 = double(u[order[2]]) - double(u[order[0]]);
+			const double dv1 = double(v[order[1]]) - double(v[order[0]]), dv2 = double(v[order[2]]) - double(v[order[0]]);
+			const double ua = (du1 * dy2 - du2 * dy1) / det;
+			const double ub = (du2 * dx1 - du1 * dx2) / det;
+			const double va = (dv1 * dy2 - dv2 * dy1) / det;
+			const double vb = (dv2 * dx1 - dv1 * dx2) / det;
+			t.ua = float(ua);
+			t.ub = float(ub);
+			t.uc = float(double(u[order[0]]) - ua * x0 - ub * y0);
+			t.va = float(va);
+			t.vb = float(vb);
+			t.vc = float(double(v[order[0]]) - va * x0 - vb * y0);
+		}
+		t.red = Div255(red * red_);
+		t.green = Div255(green * green_);
+		t.blue = Div255(blue * blue_);
+		t.paramAlpha = blendMode_ == BLEND_NOBLEND ? 255 : Div255(std::clamp(alpha_, 0, 255) * vertexAlpha);
+		t.alpha = t.paramAlpha;
+		t.blendMode = blendMode_;
+		t.isBilinear = drawMode_ == DRAW_BILINEAR;
+		triangles_.emplace_back(t);
+	}
+	//!四角形を2つの三角形として積みます。頂点の並びは左上, 右上, 左下, 右下です
+	void pushQuad(const float* px, const float* py, const float* u, const float* v,
+		const Texture* texture, const int red, const int green, const int blue, const int vertexAlpha)
+	{
+		const float ax[3] = { px[0], px[1], px[2] };
+		const float ay[3] = { py[0], py[1], py[2] };
+		const float bx[3] = { px[2], px[1], px[3] };
+		const float by[3] = { py[2], py[1], py[3] };
+		if (texture != nullptr)
+		{
+			const float au[3] = { u[0], u[1], u[2] };
+			const float av[3] = { v[0], v[1], v[2] };
+			const float bu[3] = { u[2], u[1], u[3] };
+			const float bv[3] = { v[2], v[1], v[3] };
+			pushTriangle(ax, ay, au, av, texture, red, green, blue, vertexAlpha);
+			pushTriangle(bx, by, bu, bv, texture, red, green, blue, vertexAlpha);
+			return;
+		}
+		pushTriangle(ax, ay, nullptr, nullptr, nullptr, red, green, blue, vertexAlpha);
+		pushTriangle(bx, by, nullptr, nullptr, nullptr, red, green, blue, vertexAlpha);
+	}
+	//!幅のある線分を四角形として積みます
+	void pushLine(const float x1, const float y1, const float x2, const float y2, const unsigned int color, const float thickness)
+	{
+		const float dx = x2 - x1;
+		const float dy = y2 - y1;
+		const float length = std::sqrt(dx * dx + dy * dy);
+		if (length <= 0.f)
+		{
+			return;
+		}
+		const float nx = -dy / length * thickness * 0.5f;
+		const float ny = dx / length * thickness * 0.5f;
+		const float px[4] = { x1 + nx, x2 + nx, x1 - nx, x2 - nx };
+		const float py[4] = { y1 + ny, y2 + ny, y1 - ny, y2 - ny };
+		pushQuad(px, py, nullptr, nullptr, nullptr, ColorRed(color), ColorGreen(color), ColorBlue(color), 255);
+	}
+	//!軸に平行な四角形を積みます
+	void pushRect(const float x1, const float y1, const float x2, const float y2, const unsigned int color)
+	{
+		const float px[4] = { x1, x2, x1, x2 };
+		const float py[4] = { y1, y1, y2, y2 };
+		pushQuad(px, py, nullptr, nullptr, nullptr, ColorRed(color), ColorGreen(color), ColorBlue(color), 255);
+	}
+	[[nodiscard]] static int ColorRed(const unsigned int color) noexcept { return int((color >> 16) & 0xff); }
+	[[nodiscard]] static int ColorGreen(const unsigned int color) noexcept { return int((color >> 8) & 0xff); }
+	[[nodiscard]] static int ColorBlue(const unsigned int color) noexcept { return int(color & 0xff); }
+	//!n以上の最小の2のn乗を返します
+	[[nodiscard]] static int PowerOfTwo(const int n) noexcept
+	{
+		int p = 1;
+		while (p < n)
+		{
+			p *= 2;
+		}
+		return p;
+	}
+	//!画像ハンドルが指す画像と範囲を返します。登録されていなければnullptr
+	[[nodiscard]] const Texture* findTexture(const int handle, TextureView& view) const
+	{
+		const auto it = views_.find(handle);
+		if (it == views_.end())
+		{
+			return nullptr;
+		}
+		const auto texture = textures_.find(it->second.parent);
+		if (texture == textures_.end())
+		{
+			return nullptr;
+		}
+		view = it->second;
+		return &texture->second;
+	}
+	//!三角形の番号の範囲を、分割の番号ごとのタイルに振り分けます
+	void bin(const size_t chunk, const size_t begin, const size_t end)
+	{
+		auto& bins = bins_[chunk];
+		for (auto& it : bins)
+		{
+			it.clear();
+		}
+		for (size_t i = begin; i < end; ++i)
+		{
+			const Triangle& t = triangles_[i];
+			for (int ty = t.minY / TILE_SIZE; ty <= t.maxY / TILE_SIZE; ++ty)
+			{
+				for (int tx = t.minX / TILE_SIZE; tx <= t.maxX / TILE_SIZE; ++tx)
+				{
+					bins[size_t(ty) * size_t(tileX_) + size_t(tx)].emplace_back(uint32_t(i));
+				}
+			}
+		}
+	}
+	//!三角形の1つのタイルに入る部分を描画します
+	void rasterize(const Triangle& t, const int tileX0, const int tileY0, const int tileX1, const int tileY1,
+		uint32_t* srcBuffer)
+	{
+		const int x0 = std::max(tileX0, t.minX);
+		const int x1 = std::min(tileX1 - 1, t.maxX);
+		const int y0 = std::max(tileY0, t.minY);
+		const int y1 = std::min(tileY1 - 1, t.maxY);
+		if (x0 > x1 || y0 > y1)
+		{
+			return;
+		}
+		int64_t stepX[3];
+		int64_t bias[3];
+		for (int i = 0; i < 3; ++i)
+		{
+			const int j = (i + 1) % 3;
+			const int64_t dx = t.x[j] - t.x[i];
+			const int64_t dy = t.y[j] - t.y[i];
+			stepX[i] = -dy * SUB_PIXEL;
+			//辺を共有する三角形のどちらか一方だけが辺の上のピクセルを塗る
+			bias[i] = (dy > 0 || (dy == 0 && dx > 0)) ? 1 : 0;
+		}
+		for (int y = y0; y <= y1; ++y)
+		{
+			const int64_t py = int64_t(y) * SUB_PIXEL + SUB_PIXEL / 2;
+			const int64_t px = int64_t(x0) * SUB_PIXEL + SUB_PIXEL / 2;
+			int64_t e[3];
+			for (int i = 0; i < 3; ++i)
+			{
+				const int j = (i + 1) % 3;
+				e[i] = (t.x[j] - t.x[i]) * (py - t.y[i]) - (t.y[j] - t.y[i]) * (px - t.x[i]) + bias[i];
+			}
+			int spanBegin = -1;
+			int spanEnd = -1;
+			for (int x = x0; x <= x1; ++x)
+			{
+				const bool isInside = e[0] > 0 && e[1] > 0 && e[2] > 0;
+				if (isInside && spanBegin < 0)
+				{
+					spanBegin = x;
+				}
+				else if (!isInside && spanBegin >= 0)
+				{
+					spanEnd = x;
+					break;
+				}
+				e[0] += stepX[0];
+				e[1] += stepX[1];
+				e[2] += stepX[2];
+			}
+			if (spanBegin < 0)
+			{
+				continue;
+			}
+			if (spanEnd < 0)
+			{
+				spanEnd = x1 + 1;
+			}
+			const int num = spanEnd - spanBegin;
+			const float fy = float(y) + 0.5f;
+			for (int i = 0; i < num; ++i)
+			{
+				uint32_t color;
+				if (t.texels != nullptr)
+				{
+					const float fx = float(spanBegin + i) + 0.5f;
+					const uint32_t texel = Sample(t, t.ua * fx + t.ub * fy + t.uc, t.va * fx + t.vb * fy + t.vc);
+					color = Pack(
+						Div255(int(texel & 0xff) * t.red),
+						Div255(int((texel >> 8) & 0xff) * t.green),
+						Div255(int((texel >> 16) & 0xff) * t.blue),
+						Div255(int(texel >> 24) * t.alpha));
+				}
+				else
+				{
+					color = Pack(t.red, t.green, t.blue, t.alpha);
+				}
+				srcBuffer[i] = color;
+			}
+			BlendSpan(&pixels_[size_t(y) * size_t(width_) + size_t(spanBegin)], srcBuffer, num,
+				t.blendMode, t.paramAlpha, isSimd_);
+		}
+	}
+	[[nodiscard]] static uint32_t Crc32(const uint8_t* data, const size_t size, uint32_t crc = 0)
+	{
+		crc = ~crc;
+		for (size_t i = 0; i < size; ++i)
+		{
+			crc ^= data[i];
+			for (int k = 0; k < 8; ++k)
+			{
+				crc = (crc >> 1) ^ (0xedb88320u & (0u - (crc & 1u)));
+			}
+		}
+		return ~crc;
+	}
+	static void PushBigEndian(std::vector<uint8_t>& out, const uint32_t value)
+	{
+		out.emplace_back(uint8_t(value >> 24));
+		out.emplace_back(uint8_t(value >> 16));
+		out.emplace_back(uint8_t(value >> 8));
+		out.emplace_back(uint8_t(value));
+	}
+	static void PushChunk(std::vector<uint8_t>& out, const char* type, const std::vector<uint8_t>& data)
+	{
+		PushBigEndian(out, uint32_t(data.size()));
+		std::vector<uint8_t> body(type, type + 4);
+		body.insert(body.end(), data.begin(), data.end());
+		out.insert(out.end(), body.begin(), body.end());
+		PushBigEndian(out, Crc32(body.data(), body.size()));
+	}
+	//!無圧縮のPNGを作ります
+	[[nodiscard]] std::vector<uint8_t> encodePng() const
+	{
+		std::vector<uint8_t> raw;
+		raw.reserve(size_t(height_) * (size_t(width_) * 3 + 1));
+		for (int y = 0; y < height_; ++y)
+		{
+			raw.emplace_back(uint8_t(0));
+			for (int x = 0; x < width_; ++x)
+			{
+				const uint32_t p = pixels_[size_t(y) * size_t(width_) + size_t(x)];
+				raw.emplace_back(uint8_t(p));
+				raw.emplace_back(uint8_t(p >> 8));
+				raw.emplace_back(uint8_t(p >> 16));
+			}
+		}
+		//zlibの無圧縮ブロックに分けて入れる
+		std::vector<uint8_t> zlib = { 0x78, 0x01 };
+		for (size_t pos = 0; pos < raw.size() || pos == 0; pos += 65535)
+		{
+			const size_t len = std::min(size_t(65535), raw.size() - pos);
+			zlib.emplace_back(uint8_t(pos + len >= raw.size() ? 1 : 0));
+			zlib.emplace_back(uint8_t(len));
+			zlib.emplace_back(uint8_t(len >> 8));
+			zlib.emplace_back(uint8_t(~len));
+			zlib.emplace_back(uint8_t(~len >> 8));
+			zlib.insert(zlib.end(), raw.begin() + std::ptrdiff_t(pos), raw.begin() + std::ptrdiff_t(pos + len));
+			if (raw.empty())
+			{
+				break;
+			}
+		}
+		uint32_t a = 1, b = 0;
+		for (const uint8_t it : raw)
+		{
+			a = (a + it) % 65521;
+			b = (b + a) % 65521;
+		}
+		PushBigEndian(zlib, (b << 16) | a);
+		std::vector<uint8_t> header;
+		PushBigEndian(header, uint32_t(width_));
+		PushBigEndian(header, uint32_t(height_));
+		header.insert(header.end(), { 8, 2, 0, 0, 0 });
+		std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a };
+		PushChunk(png, "IHDR", header);
+		PushChunk(png, "IDAT", zlib);
+		PushChunk(png, "IEND", {});
+		return png;
+	}
+public:
+	/**
+	* @brief 描画先の大きさを指定して作ります
+	* @param width 幅
+	* @param height 高さ
+	*/
+	SoftwareRasterizerCore(const int width, const int height) :
+		width_(width),
+		height_(height),
+		tileX_((width + TILE_SIZE - 1) / TILE_SIZE),
+		tileY_((height + TILE_SIZE - 1) / TILE_SIZE),
+		pixels_(size_t(width) * size_t(height), Pack(0, 0, 0, 255))
+	{}
+	/**
+	* @brief 画像を登録します
+	* @param handle 画像ハンドル。描画の命令と同じ番号を指定します
+	* @param w 幅
+	* @param h 高さ
+	* @param rgba 1ピクセルを下位バイトからR, G, B, Aの順に持つ画素
+	*/
+	void setTexture(const int handle, const int w, const int h, const uint32_t* rgba)
+	{
+		Texture& texture = textures_[handle];
+		texture.w = w;
+		texture.h = h;
+		texture.texW = PowerOfTwo(w);
+		texture.texH = PowerOfTwo(h);
+		texture.pixels.assign(rgba, rgba + size_t(w) * size_t(h));
+		views_[handle] = TextureView{ handle, 0, 0, w, h };
+	}
+	/**
+	* @brief 登録した画像の一部を別の画像ハンドルとして登録します
+	* @details DerivationGraphやLoadDivGraphで作った画像ハンドルに使います
+	*/
+	void setSubTexture(const int handle, const int parent, const int x, const int y, const int w, const int h)
+	{
+		views_[handle] = TextureView{ parent, x, y, w, h };
+	}
+	//!今の描画先を指定した色で塗りつぶします。積んだ三角形は捨てます。clearRenderTarget()もこの色で塗りつぶします
+	void clear(const int red, const int green, const int blue)
+	{
+		triangles_.clear();
+		clearColor_ = Pack(red, green, blue, 255);
+		std::fill(pixels_.begin(), pixels_.end(), clearColor_);
+	}
+	//!falseにするとSSE2を使わずに合成します。SSE2と同じ結果になるかの確認に使います
+	void setSimdEnable(const bool isEnable)
+	{
+		isSimd_ = isEnable;
+	}
+	/**
+	* @brief 積んだ三角形をフレームバッファに描画します
+	* @param threadNum 使うスレッドの数。0ならThreadPoolのスレッド数になります
+	*/
+	void finish(const size_t threadNum = 0)
+	{
+		const size_t useThreadNum = std::max(size_t(1), threadNum == 0 ? ThreadPool::Get().size() : threadNum);
+		const size_t tileNum = size_t(tileX_) * size_t(tileY_);
+		const size_t chunkNum = std::max(size_t(1), std::min(useThreadNum, triangles_.size()));
+		if (bins_.size() < chunkNum)
+		{
+			bins_.resize(chunkNum);
+		}
+		for (size_t i = 0; i < chunkNum; ++i)
+		{
+			bins_[i].resize(tileNum);
+		}
+		//分割の番号順に連続した範囲を振り分けるので、タイルごとに分割の番号順に見れば命令の順番になる
+		ThreadPool::Get().parallelFor(chunkNum, chunkNum, [this, chunkNum](const size_t begin, const size_t end, const size_t)
+		{
+			for (size_t chunk = begin; chunk < end; ++chunk)
+			{
+				bin(chunk, triangles_.size() * chunk / chunkNum, triangles_.size() * (chunk + 1) / chunkNum);
+			}
+		});
+		//タイルごとの負荷の偏りをならすため、複数スレッドならタイル1枚ずつに分ける
+		ThreadPool::Get().parallelFor(tileNum, useThreadNum == 1 ? 1 : tileNum, [this, chunkNum](const size_t begin, const size_t end, const size_t)
+		{
+			uint32_t srcBuffer[TILE_SIZE];
+			for (size_t tile = begin; tile < end; ++tile)
+			{
+				const int tileX0 = int(tile % size_t(tileX_)) * TILE_SIZE;
+				const int tileY0 = int(tile / size_t(tileX_)) * TILE_SIZE;
+				const int tileX1 = std::min(width_, tileX0 + TILE_SIZE);
+				const int tileY1 = std::min(height_, tileY0 + TILE_SIZE);
+				for (size_t chunk = 0; chunk < chunkNum; ++chunk)
+				{
+					for (const uint32_t index : bins_[chunk][tile])
+					{
+						rasterize(triangles_[index], tileX0, tileY0, tileX1, tileY1, srcBuffer);
+					}
+				}
+			}
+		});
+		stats_.triangleNum = triangles_.size();
+		stats_.binnedNum = 0;
+		for (size_t i = 0; i < chunkNum; ++i)
+		{
+			for (const auto& it : bins_[i])
+			{
+				stats_.binnedNum += it.size();
+			}
+		}
+		stats_.tileNum = tileNum;
+		triangles_.clear();
+	}
+	//!直前のfinish()の統計を返します
+	[[nodiscard]] const Stats& stats() const
+	{
+		return stats_;
+	}
+	[[nodiscard]] int width() const
+	{
+		return width_;
+	}
+	[[nodiscard]] int height() const
+	{
+		return height_;
+	}
+	//!今の描画先の画素を返します。1ピクセルは下位バイトからR, G, B, Aの順です
+	[[nodiscard]] const std::vector<uint32_t>& pixels() const
+	{
+		return pixels_;
+	}
+	/**
+	* @brief フレームバッファを画像ファイルに書き出します
+	* @param path 拡張子が.pngならPNG、それ以外はPPMで書き出します
+	* @return 書き出せたらtrue
+	*/
+	bool save(const std::string& path) const
+	{
+		std::ofstream ofs(path, std::ios::binary);
+		if (!ofs)
+		{
+			return false;
+		}
+		if (path.size() >= 4 && path.compare(path.size() - 4, 4, ".png") == 0)
+		{
+			const auto png = encodePng();
+			ofs.write(reinterpret_cast<const char*>(png.data()), std::streamsize(png.size()));
+			return bool(ofs);
+		}
+		ofs << "P6\n" << width_ << " " << height_ << "\n255\n";
+		std::vector<uint8_t> rgb(size_t(width_) * size_t(height_) * 3);
+		for (size_t i = 0; i < pixels_.size(); ++i)
+		{
+			rgb[i * 3 + 0] = uint8_t(pixels_[i]);
+			rgb[i * 3 + 1] = uint8_t(pixels_[i] >> 8);
+			rgb[i * 3 + 2] = uint8_t(pixels_[i] >> 16);
+		}
+		ofs.write(reinterpret_cast<const char*>(rgb.data()), std::streamsize(rgb.size()));
+		return bool(ofs);
+	}
+	/**
+	* @brief save()で書き出したPPMと比べます
+	* @param path 正解の画像のPPMのパス
+	* @param tolerance チャンネルごとに許す差
+	* @return 差がtoleranceを超えるピクセルの数。読めないか大きさが違う場合はSIZE_MAX
+	*/
+	[[nodiscard]] size_t compare(const std::string& path, const int tolerance) const
+	{
+		std::ifstream ifs(path, std::ios::binary);
+		std::string magic;
+		int w = 0, h = 0, maxValue = 0;
+		if (!(ifs >> magic >> w >> h >> maxValue) || magic != "P6" || w != width_ || h != height_ || maxValue != 255)
+		{
+			return SIZE_MAX;
+		}
+		ifs.get();
+		std::vector<uint8_t> rgb(size_t(w) * size_t(h) * 3);
+		if (!ifs.read(reinterpret_cast<char*>(rgb.data()), std::streamsize(rgb.size())))
+		{
+			return SIZE_MAX;
+		}
+		size_t diffNum = 0;
+		for (size_t i = 0; i < pixels_.size(); ++i)
+		{
+			for (size_t c = 0; c < 3; ++c)
+			{
+				if (std::abs(int(rgb[i * 3 + c]) - int((pixels_[i] >> (c * 8)) & 0xff)) > tolerance)
+				{
+					++diffNum;
+					break;
+				}
+			}
+		}
+		return diffNum;
+	}
+
+	//以下の関数はIRenderBackendの同じ名前の関数と同じ働きです
+	void setDrawMode(const int drawMode)
+	{
+		drawMode_ = drawMode;
+	}
+	void setBlend(const int blendMode, const int alpha)
+	{
+		blendMode_ = blendMode;
+		alpha_ = alpha;
+	}
+	void setBright(const int red, const int green, const int blue)
+	{
+		red_ = std::clamp(red, 0, 255);
+		green_ = std::clamp(green, 0, 255);
+		blue_ = std::clamp(blue, 0, 255);
+	}
+	void getGraphSize(const int handle, int* w, int* h)
+	{
+		const auto it = views_.find(handle);
+		*w = it != views_.end() ? it->second.w : 0;
+		*h = it != views_.end() ? it->second.h : 0;
+	}
+	void getTextureRegion(const int handle, int* x, int* y, int* texW, int* texH)
+	{
+		TextureView view;
+		const Texture* texture = findTexture(handle, view);
+		*x = view.x;
+		*y = view.y;
+		*texW = texture != nullptr ? texture->texW : 0;
+		*texH = texture != nullptr ? texture->texH : 0;
+	}
+	void drawRotaGraph(const float x, const float y, const float cx, const float cy,
+		const double scaleX, const double scaleY, const double angle, const int handle, const bool isTurn)
+	{
+		TextureView view;
+		if (findTexture(handle, view) == nullptr)
+		{
+			return;
+		}
+		drawRectRotaGraph(x, y, 0, 0, view.w, view.h, cx, cy, scaleX, scaleY, angle, handle, isTurn);
+	}
+	void drawRectRotaGraph(const float x, const float y, const int srcX, const int srcY, const int w, const int h,
+		const float cx, const float cy, const double scaleX, const double scaleY, const double angle,
+		const int handle, const bool isTurn)
+	{
+		TextureView view;
+		const Texture* texture = findTexture(handle, view);
+		if (texture == nullptr)
+		{
+			return;
+		}
+		const float c = float(std::cos(angle));
+		const float s = float(std::sin(angle));
+		float px[4], py[4], u[4], v[4];
+		for (int i = 0; i < 4; ++i)
+		{
+			const float lx = (i & 1) ? float(w) : 0.f;
+			const float ly = (i & 2) ? float(h) : 0.f;
+			const float ox = (lx - cx) * float(scaleX);
+			const float oy = (ly - cy) * float(scaleY);
+			px[i] = x + ox * c - oy * s;
+			py[i] = y + ox * s + oy * c;
+			u[i] = float(view.x + srcX) + (isTurn ? float(w) - lx : lx);
+			v[i] = float(view.y + srcY) + ly;
+		}
+		pushQuad(px, py, u, v, texture, 255, 255, 255, 255);
+	}
+	void drawPrimitiveIndexed(const RasterVertex* vertices, const int vertexNum,
+		const unsigned short* indices, const int indexNum, const int handle)
+	{
+		TextureView view;
+		const Texture* texture = findTexture(handle, view);
+		const float texW = texture != nullptr ? float(texture->texW) : 0.f;
+		const float texH = texture != nullptr ? float(texture->texH) : 0.f;
+		for (int i = 0; i + 2 < indexNum; i += 3)
+		{
+			float px[3], py[3], u[3], v[3];
+			for (int k = 0; k < 3; ++k)
+			{
+				const int index = indices[i + k];
+				if (index >= vertexNum)
+				{
+					return;
+				}
+				const RasterVertex& vertex = vertices[index];
+				px[k] = vertex.pos.x;
+				py[k] = vertex.pos.y;
+				u[k] = vertex.u * texW;
+				v[k] = vertex.v * texH;
+			}
+			//頂点の色は三角形の最初の頂点のものを使う
+			const RasterColor& dif = vertices[indices[i]].dif;
+			pushTriangle(px, py, u, v, texture, dif.r, dif.g, dif.b, dif.a);
+		}
+	}
+	void drawLineList(const RasterVertex* vertices, const int vertexNum)
+	{
+		for (int i = 0; i + 1 < vertexNum; i += 2)
+		{
+			//線の色は始点の頂点のものを使う
+			const RasterColor& dif = vertices[i].dif;
+			const unsigned int color = (unsigned int)(dif.r) << 16 | (unsigned int)(dif.g) << 8 | (unsigned int)(dif.b);
+			pushLine(vertices[i].pos.x, vertices[i].pos.y, vertices[i + 1].pos.x, vertices[i + 1].pos.y, color, 1.f);
+		}
+	}
+	void drawLineAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const float thickness)
+	{
+		pushLine(x1, y1, x2, y2, color, thickness);
+	}
+	void drawBoxAA(const float x1, const float y1, const float x2, const float y2,
+		const unsigned int color, const bool isFill, const float thickness)
+	{
+		if (isFill)
+		{
+			pushRect(x1, y1, x2, y2, color);
+			return;
+		}
+		//角が重ならないように4本に分ける
+		const float t = thickness * 0.5f;
+		pushRect(x1 - t, y1 - t, x2 + t, y1 + t, color);
+		pushRect(x1 - t, y2 - t, x2 + t, y2 + t, color);
+		pushRect(x1 - t, y1 + t, x1 + t, y2 - t, color);
+		pushRect(x2 - t, y1 + t, x2 + t, y2 - t, color);
+	}
+	void drawCircleAA(const float x, const float y, const float r, const int posNum,
+		const unsigned int color, const bool isFill, const float thickness)
+	{
+		const int num = std::max(3, posNum);
+		const float outer = isFill ? r : r + thickness * 0.5f;
+		const float inner = isFill ? 0.f : std::max(0.f, r - thickness * 0.5f);
+		for (int i = 0; i < num; ++i)
+		{
+			const float a0 = 6.28318530718f * float(i) / float(num);
+			const float a1 = 6.28318530718f * float(i + 1) / float(num);
+			const float c0 = std::cos(a0), s0 = std::sin(a0);
+			const float c1 = std::cos(a1), s1 = std::sin(a1);
+			if (isFill)
+			{
+				const float px[3] = { x, x + c0 * outer, x + c1 * outer };
+				const float py[3] = { y, y + s0 * outer, y + s1 * outer };
+				pushTriangle(px, py, nullptr, nullptr, nullptr, ColorRed(color), ColorGreen(color), ColorBlue(color), 255);
+				continue;
+			}
+			const float px[4] = { x + c0 * inner, x + c1 * inner, x + c0 * outer, x + c1 * outer };
+			const float py[4] = { y + s0 * inner, y + s1 * inner, y + s0 * outer, y + s1 * outer };
+			pushQuad(px, py, nullptr, nullptr, nullptr, ColorRed(color), ColorGreen(color), ColorBlue(color), 255);
+		}
+	}
+	void drawQuadrangleAA(const float x1, const float y1, const float x2, const float y2,
+		const float x3, const float y3, const float x4, const float y4,
+		const unsigned int color, const bool isFill, const float thickness)
+	{
+		if (isFill)
+		{
+			const float px[4] = { x1, x2, x4, x3 };
+			const float py[4] = { y1, y2, y4, y3 };
+			pushQuad(px, py, nullptr, nullptr, nullptr, ColorRed(color), ColorGreen(color), ColorBlue(color), 255);
+			return;
+		}
+		pushLine(x1, y1, x2, y2, color, thickness);
+		pushLine(x2, y2, x3, y3, color, thickness);
+		pushLine(x3, y3, x4, y4, color, thickness);
+		pushLine(x4, y4, x1, y1, color, thickness);
+	}
+	int createRenderTarget(const int w, const int h)
+	{
+		assert(w == width_ && h == height_ && "render target must be the same size as the frame buffer");
+		const int handle = nextTarget_++;
+		targets_[handle].assign(size_t(w) * size_t(h), clearColor_);
+		return handle;
+	}
+	void deleteRenderTarget(const int handle)
+	{
+		assert(handle != target_ && "current render target can not be deleted");
+		targets_.erase(handle);
+	}
+	int getRenderTarget()
+	{
+		return target_;
+	}
+	void setRenderTarget(const int handle)
+	{
+		if (handle == target_)
+		{
+			return;
+		}
+		const auto it = targets_.find(handle);
+		assert(it != targets_.end() && "render target is not created");
+		finish();
+		//画素の領域を入れ替えて、今の描画先の画素をpixels_に置く
+		std::vector<uint32_t> pixels;
+		pixels.swap(it->second);
+		targets_.erase(it);
+		pixels_.swap(pixels);
+		targets_[target_].swap(pixels);
+		target_ = handle;
+	}
+	void clearRenderTarget()
+	{
+		triangles_.clear();
+		std::fill(pixels_.begin(), pixels_.end(), clearColor_);
+	}
+	void getRenderTargetSize(int* w, int* h)
+	{
+		*w = width_;
+		*h = height_;
+	}
+	void blitRenderTarget(const int handle)
+	{
+		if (handle == target_)
+		{
+			return;
+		}
+		const auto it = targets_.find(handle);
+		assert(it != targets_.end() && "render target is not created");
+		finish();
+		std::copy(it->second.begin(), it->second.end(), pixels_.begin());
+	}
+};
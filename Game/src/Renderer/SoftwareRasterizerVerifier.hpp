@@ -0,0 +1,227 @@
+﻿/**
+* @file SoftwareRasterizerVerifier.hpp
+* @brief SoftwareRasterizerの描画結果を検証し、描画の時間を計測します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "SoftwareRasterizerCore.hpp"
+#include <iostream>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+/**
+* @brief SoftwareRasterizerの検証と計測です
+* @details 次のことを確かめます
+* - 回転していない等倍の画像を整数の座標に描くと、画素がそのまま写ること
+* - 四角形を半透明で描いても、2つの三角形の境目が二重に合成されないこと
+* - ランダムな描画命令の結果が、SSE2を使わない場合や1スレッドで描いた場合と1ビットも違わないこと
+*
+* 描画結果はgoldenPathのPPMと比べ、ファイルが無い場合も失敗にします。
+* 一致しなければ描画結果をgoldenPathに.actual.ppmを付けたファイルに書き出すので、確かめてから正解と置き換えてください。
+* SoftwareRasterizerCoreだけを使うので、DXライブラリの無い環境でもビルドして実行できます
+*/
+class SoftwareRasterizerVerifier final
+{
+private:
+	SoftwareRasterizerVerifier() = delete;
+	static constexpr int WIDTH = 420;
+	static constexpr int HEIGHT = 600;
+	static constexpr int TEX_HANDLE = 1;
+	static constexpr int SUB_HANDLE = 2;
+	static constexpr int TEX_W = 32;
+	static constexpr int TEX_H = 32;
+	using Raster = SoftwareRasterizerCore;
+
+	//!Utility.hppのDOUTと同じく、デバッグビルドのときだけ標準出力に書き出します。DXライブラリに依存しないようにここで用意します
+	[[nodiscard]] static std::ostream& Log()
+	{
+#ifdef _DEBUG
+		return std::cout;
+#else
+		static std::ostream null(nullptr);
+		return null;
+#endif
+	}
+
+	static void SetupTexture(Raster& raster)
+	{
+		std::vector<uint32_t> rgba(TEX_W * TEX_H);
+		for (int y = 0; y < TEX_H; ++y)
+		{
+			for (int x = 0; x < TEX_W; ++x)
+			{
+				//縁は透明、中は位置で色が変わる半透明の模様
+				const bool isEdge = x == 0 || y == 0 || x == TEX_W - 1 || y == TEX_H - 1;
+				const uint32_t a = isEdge ? 0u : uint32_t(128 + (x * 127) / TEX_W);
+				rgba[size_t(y * TEX_W + x)] = uint32_t(x * 8) | (uint32_t(y * 8) << 8) | (uint32_t((x ^ y) * 8) << 16) | (a << 24);
+			}
+		}
+		raster.setTexture(TEX_HANDLE, TEX_W, TEX_H, rgba.data());
+		raster.setSubTexture(SUB_HANDLE, TEX_HANDLE, 8, 8, 16, 16);
+	}
+	//!ランダムな描画命令で1フレーム描きます
+	static void DrawScene(Raster& raster, const size_t spriteNum, const uint32_t seed, const size_t threadNum)
+	{
+		static constexpr int BLEND_MODES[] =
+		{
+			Raster::BLEND_NOBLEND, Raster::BLEND_ALPHA, Raster::BLEND_ADD, Raster::BLEND_SUB,
+			Raster::BLEND_HALF_ADD, Raster::BLEND_MULA, Raster::BLEND_INVSRC, Raster::BLEND_PMA_ALPHA
+		};
+		std::mt19937 mt(seed);
+		auto range = [&mt](const float min, const float max)
+		{
+			return std::uniform_real_distribution<float>(min, max)(mt);
+		};
+		raster.clear(16, 32, 48);
+		for (size_t i = 0; i < spriteNum; ++i)
+		{
+			raster.setDrawMode(mt() % 2 == 0 ? Raster::DRAW_NEAREST : Raster::DRAW_BILINEAR);
+			raster.setBlend(BLEND_MODES[mt() % (sizeof(BLEND_MODES) / sizeof(BLEND_MODES[0]))], int(mt() % 256));
+			raster.setBright(int(mt() % 256), int(mt() % 256), int(mt() % 256));
+			const float x = range(-40.f, float(WIDTH) + 40.f);
+			const float y = range(-40.f, float(HEIGHT) + 40.f);
+			switch (mt() % 5)
+			{
+			case 0:
+				raster.drawRotaGraph(x, y, 16.f, 16.f, range(0.5f, 3.f), range(0.5f, 3.f), range(-3.2f, 3.2f), TEX_HANDLE, mt() % 2 == 0);
+				break;
+			case 1:
+				raster.drawRectRotaGraph(x, y, 4, 4, 8, 8, 4.f, 4.f, 2.0, 2.0, range(-3.2f, 3.2f), SUB_HANDLE, false);
+				break;
+			case 2:
+				raster.drawLineAA(x, y, x + range(-60.f, 60.f), y + range(-60.f, 60.f), Raster::Color(255, 200, 100), range(1.f, 4.f));
+				break;
+			case 3:
+				raster.drawBoxAA(x, y, x + range(4.f, 60.f), y + range(4.f, 60.f), Raster::Color(100, 255, 100), mt() % 2 == 0, 2.f);
+				break;
+			default:
+				raster.drawCircleAA(x, y, range(4.f, 40.f), 24, Raster::Color(100, 100, 255), mt() % 2 == 0, 2.f);
+				break;
+			}
+		}
+		raster.setBlend(Raster::BLEND_NOBLEND, 255);
+		raster.setBright(255, 255, 255);
+		raster.finish(threadNum);
+	}
+	//!等倍の画像が画素のまま写るかを確かめます
+	[[nodiscard]] static bool CheckCopy()
+	{
+		Raster raster(64, 64);
+		SetupTexture(raster);
+		raster.clear(0, 0, 0);
+		raster.setBlend(Raster::BLEND_NOBLEND, 255);
+		raster.drawRotaGraph(20.f, 20.f, 16.f, 16.f, 1.0, 1.0, 0.0, TEX_HANDLE, false);
+		raster.finish(1);
+		for (int y = 0; y < TEX_H; ++y)
+		{
+			for (int x = 0; x < TEX_W; ++x)
+			{
+				const uint32_t texel = uint32_t(x * 8) | (uint32_t(y * 8) << 8) | (uint32_t((x ^ y) * 8) << 16);
+				const bool isEdge = x == 0 || y == 0 || x == TEX_W - 1 || y == TEX_H - 1;
+				//NOBLENDでも画像のアルファは透過に使う
+				const uint32_t a = isEdge ? 0u : uint32_t(128 + (x * 127) / TEX_W);
+				uint32_t expected = 0xff000000u;
+				for (int c = 0; c < 24; c += 8)
+				{
+					const int s = int((texel >> c) & 0xff);
+					expected |= uint32_t((s * int(a) + 127) / 255) << c;
+				}
+				if (raster.pixels()[size_t((y + 4) * 64 + x + 4)] != expected)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+	//!半透明の四角形の中が一様に1回だけ合成されているかを確かめます
+	[[nodiscard]] static bool CheckSeam()
+	{
+		Raster raster(128, 128);
+		raster.clear(0, 0, 0);
+		raster.setBlend(Raster::BLEND_ALPHA, 128);
+		//半ピクセルずらして、2つの三角形の境目の対角線がピクセルの中心を通るようにする
+		raster.drawBoxAA(10.5f, 10.5f, 100.5f, 100.5f, Raster::Color(255, 255, 255), true, 1.f);
+		raster.finish(4);
+		const uint32_t expected = raster.pixels()[64 * 128 + 64];
+		for (const uint32_t it : raster.pixels())
+		{
+			if (it != expected && it != 0xff000000u)
+			{
+				return false;
+			}
+		}
+		return expected != 0xff000000u;
+	}
+public:
+	/**
+	* @brief 検証と計測を行います
+	* @param spriteNum 1フレームの描画命令の数
+	* @param goldenPath 正解の画像のPPMのパス
+	* @param seed 乱数のシード
+	* @return すべて一致したらtrue
+	*/
+	static bool Run(const size_t spriteNum = 5000, const std::string& goldenPath = "Resource/golden_software_rasterizer.ppm",
+		const uint32_t seed = 2026)
+	{
+		const bool isCopyOk = CheckCopy();
+		const bool isSeamOk = CheckSeam();
+
+		Raster reference(WIDTH, HEIGHT);
+		SetupTexture(reference);
+		reference.setSimdEnable(false);
+		const auto scalarStart = std::chrono::high_resolution_clock::now();
+		DrawScene(reference, spriteNum, seed, 1);
+		const double scalarMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - scalarStart).count();
+
+		Raster simd(WIDTH, HEIGHT);
+		SetupTexture(simd);
+		const auto simdStart = std::chrono::high_resolution_clock::now();
+		DrawScene(simd, spriteNum, seed, 1);
+		const double simdMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - simdStart).count();
+
+		Raster parallel(WIDTH, HEIGHT);
+		SetupTexture(parallel);
+		const auto parallelStart = std::chrono::high_resolution_clock::now();
+		//コアが少ない環境でも振り分けの結果を確かめられるように、最低4つに分ける
+		const size_t threadNum = std::max(size_t(4), ThreadPool::Get().size());
+		DrawScene(parallel, spriteNum, seed, threadNum);
+		const double parallelMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - parallelStart).count();
+
+		const bool isSimdOk = simd.pixels() == reference.pixels();
+		const bool isParallelOk = parallel.pixels() == reference.pixels();
+		const size_t goldenDiff = parallel.compare(goldenPath, 0);
+		const bool isGoldenOk = goldenDiff == 0;
+		const std::string actualPath = goldenPath + ".actual.ppm";
+		const bool isActualSaved = !isGoldenOk && parallel.save(actualPath);
+		const bool isOk = isCopyOk && isSeamOk && isSimdOk && isParallelOk && isGoldenOk;
+		Log() << "SoftwareRasterizerVerifier : " << spriteNum << " draws, " << parallel.stats().triangleNum << " triangles, "
+			<< parallel.stats().binnedNum << " binned in " << parallel.stats().tileNum << " tiles" << std::endl;
+		Log() << "  scalar blend, 1 thread : " << scalarMs << " [milliseconds]" << std::endl;
+		Log() << "  sse2 blend, 1 thread : " << simdMs << " [milliseconds]" << std::endl;
+		Log() << "  sse2 blend, " << threadNum << " threads : " << parallelMs << " [milliseconds]" << std::endl;
+		Log() << "  copy " << (isCopyOk ? "ok" : "NG") << ", seam " << (isSeamOk ? "ok" : "NG")
+			<< ", simd " << (isSimdOk ? "ok" : "NG") << ", threads " << (isParallelOk ? "ok" : "NG") << std::endl;
+		if (goldenDiff == SIZE_MAX)
+		{
+			Log() << "  golden " << goldenPath << " : not found or wrong size" << std::endl;
+		}
+		else
+		{
+			Log() << "  golden " << goldenPath << " : " << goldenDiff << " pixels differ" << std::endl;
+		}
+		if (isActualSaved)
+		{
+			Log() << "  output saved to " << actualPath << std::endl;
+		}
+		Log() << "SoftwareRasterizerVerifier : " << (isOk ? "all checks passed" : "MISMATCH FOUND") << std::endl;
+		assert(isOk && "software rasterizer output is wrong");
+		return isOk;
+	}
+};
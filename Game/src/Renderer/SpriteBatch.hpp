@@ -0,0 +1,190 @@
+﻿/**
+* @file SpriteBatch.hpp
+* @brief 同じマテリアルのスプライトを1つの頂点配列にまとめて、1回の描画で描きます
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderCommand.hpp"
+#include "RenderBackend.hpp"
+#include <DxLib.h>
+#include <xmmintrin.h>
+#include <vector>
+#include <cstddef>
+#include <cmath>
+#include <cassert>
+
+/**
+* @brief 回転、拡大したスプライトの四角形をCPUで頂点配列にまとめます
+* @details 1枚につき4頂点を作り、インデックス付きの三角形リストとしてDrawPrimitiveIndexed2Dで描画します
+* - 4頂点の座標はSSEでまとめて求めます。回転0度、拡大率1倍の場合は掛け算を省きます
+* - 色は頂点の色に入れます。描画輝度(SetDrawBright)は初期状態にしてからflush()してください
+* - 左右反転の命令はまとめられません。CanBatch()で確認してください
+* - 頂点のUVは画像を置いたテクスチャ全体に対する割合です。画像の位置とテクスチャの大きさはIRenderBackend::getTextureRegion()で求めてください
+*/
+class SpriteBatch final
+{
+public:
+	//!1回の描画でまとめる最大の枚数です。頂点の番号が16ビットに収まる数です
+	static constexpr size_t QUAD_MAX = 16384;
+private:
+	//!使い回すために縮めない頂点の配列です。使っているのは先頭からvertexNum_個です
+	std::vector<VERTEX2D> vertices_;
+	size_t vertexNum_ = 0;
+	std::vector<unsigned short> indices_;
+	int handle_ = -1;
+	//!画像の大きさ
+	float w_ = 1.f;
+	float h_ = 1.f;
+	//!画像の左上のテクスチャでの位置
+	float texX_ = 0.f;
+	float texY_ = 0.f;
+	float invTexW_ = 1.f;
+	float invTexH_ = 1.f;
+	COLOR_U8 color_{};
+public:
+	SpriteBatch()
+	{
+		//四角形ごとの並びは左上, 右上, 左下, 右下
+		indices_.resize(QUAD_MAX * 6);
+		for (size_t i = 0; i < QUAD_MAX; ++i)
+		{
+			const unsigned short v = static_cast<unsigned short>(i * 4);
+			unsigned short* index = &indices_[i * 6];
+			index[0] = v;
+			index[1] = static_cast<unsigned short>(v + 1);
+			index[2] = static_cast<unsigned short>(v + 2);
+			index[3] = static_cast<unsigned short>(v + 2);
+			index[4] = static_cast<unsigned short>(v + 1);
+			index[5] = static_cast<unsigned short>(v + 3);
+		}
+		vertices_.resize(1024);
+	}
+	//!まとめて描画できる命令ならtrue
+	[[nodiscard]] static bool CanBatch(const RenderCommand& c) noexcept
+	{
+		return !c.isTurn;
+	}
+	//!回転0度、拡大率1倍で掛け算を省ける命令ならtrue
+	[[nodiscard]] static bool IsFastPath(const RenderCommand& c) noexcept
+	{
+		return c.angle == 0.f && c.scaleX == 1.f && c.scaleY == 1.f;
+	}
+	/**
+	* @brief 四角形の4頂点の座標を求めます
+	* @param c 描画命令
+	* @param w 四角形の幅
+	* @param h 四角形の高さ
+	* @param outX 左上, 右上, 左下, 右下の順にx座標が返ります
+	* @param outY 左上, 右上, 左下, 右下の順にy座標が返ります
+	* @details DrawRotaGraph3Fと同じく、(cx, cy)を中心に拡大、回転して(x, y)に置きます
+	*/
+	static void ComputeCorners(const RenderCommand& c, const float w, const float h, float* outX, float* outY) noexcept
+	{
+		const __m128 localX = _mm_setr_ps(-c.cx, w - c.cx, -c.cx, w - c.cx);
+		const __m128 localY = _mm_setr_ps(-c.cy, -c.cy, h - c.cy, h - c.cy);
+		const __m128 x = _mm_set1_ps(c.x);
+		const __m128 y = _mm_set1_ps(c.y);
+		if (IsFastPath(c))
+		{
+			_mm_storeu_ps(outX, _mm_add_ps(x, localX));
+			_mm_storeu_ps(outY, _mm_add_ps(y, localY));
+			return;
+		}
+		const __m128 sx = _mm_mul_ps(localX, _mm_set1_ps(c.scaleX));
+		const __m128 sy = _mm_mul_ps(localY, _mm_set1_ps(c.scaleY));
+		const __m128 sinA = _mm_set1_ps(sinf(c.angle));
+		const __m128 cosA = _mm_set1_ps(cosf(c.angle));
+		_mm_storeu_ps(outX, _mm_add_ps(x, _mm_sub_ps(_mm_mul_ps(sx, cosA), _mm_mul_ps(sy, sinA))));
+		_mm_storeu_ps(outY, _mm_add_ps(y, _mm_add_ps(_mm_mul_ps(sx, sinA), _mm_mul_ps(sy, cosA))));
+	}
+	/**
+	* @brief まとめる画像と色を指定して、頂点を空にします
+	* @param handle 画像ハンドル
+	* @param w 画像の幅
+	* @param h 画像の高さ
+	* @param texX,texY 画像の左上のテクスチャでの位置
+	* @param texW,texH 画像を置いたテクスチャの大きさ
+	* @param r,g,b 頂点の色
+	*/
+	void begin(const int handle, const int w, const int h, const int texX, const int texY, const int texW, const int texH,
+		const int r, const int g, const int b)
+	{
+		vertexNum_ = 0;
+		handle_ = handle;
+		w_ = float(w);
+		h_ = float(h);
+		texX_ = float(texX);
+		texY_ = float(texY);
+		invTexW_ = texW > 0 ? 1.f / float(texW) : 0.f;
+		invTexH_ = texH > 0 ? 1.f / float(texH) : 0.f;
+		color_.r = static_cast<unsigned char>(r);
+		color_.g = static_cast<unsigned char>(g);
+		color_.b = static_cast<unsigned char>(b);
+		color_.a = 255;
+	}
+	//!画像がテクスチャ全体と同じ場合です
+	void begin(const int handle, const int w, const int h, const int r, const int g, const int b)
+	{
+		begin(handle, w, h, 0, 0, w, h, r, g, b);
+	}
+	//!描画命令を四角形として追加します
+	void add(const RenderCommand& c)
+	{
+		assert(!isFull() && "sprite batch is full");
+		const bool isRect = c.type == RenderCommandType::RECT_ROTA_GRAPH;
+		const float w = isRect ? float(c.srcW) : w_;
+		const float h = isRect ? float(c.srcH) : h_;
+		const float srcX = texX_ + (isRect ? float(c.srcX) : 0.f);
+		const float srcY = texY_ + (isRect ? float(c.srcY) : 0.f);
+		const float u0 = srcX * invTexW_;
+		const float v0 = srcY * invTexH_;
+		const float u1 = (srcX + w) * invTexW_;
+		const float v1 = (srcY + h) * invTexH_;
+		alignas(16) float x[4];
+		alignas(16) float y[4];
+		ComputeCorners(c, w, h, x, y);
+		const float u[4] = { u0, u1, u0, u1 };
+		const float v[4] = { v0, v0, v1, v1 };
+		if (vertexNum_ + 4 > vertices_.size())
+		{
+			vertices_.resize(vertices_.size() * 2);
+		}
+		VERTEX2D* out = &vertices_[vertexNum_];
+		vertexNum_ += 4;
+		for (size_t i = 0; i < 4; ++i)
+		{
+			VERTEX2D& vertex = out[i];
+			vertex.pos = VGet(x[i], y[i], 0.f);
+			vertex.rhw = 1.f;
+			vertex.dif = color_;
+			vertex.u = u[i];
+			vertex.v = v[i];
+		}
+	}
+	//!これ以上追加できなければtrue
+	[[nodiscard]] bool isFull() const
+	{
+		return vertexNum_ >= QUAD_MAX * 4;
+	}
+	//!追加した四角形の数を返します
+	[[nodiscard]] size_t size() const
+	{
+		return vertexNum_ / 4;
+	}
+	//!作った頂点の先頭を返します。左上, 右上, 左下, 右下の順に4つずつ、size() * 4個並びます
+	[[nodiscard]] const VERTEX2D* vertices() const
+	{
+		return vertices_.data();
+	}
+	//!追加した四角形を1回の描画で描きます
+	void flush()
+	{
+		if (vertexNum_ == 0)
+		{
+			return;
+		}
+		RenderBackend::Get().drawPrimitiveIndexed(vertices_.data(), int(vertexNum_), indices_.data(), int(size() * 6), handle_);
+		vertexNum_ = 0;
+	}
+};
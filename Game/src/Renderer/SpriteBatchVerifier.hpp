@@ -0,0 +1,272 @@
+﻿/**
+* @file SpriteBatchVerifier.hpp
+* @brief SpriteBatchが作る頂点が1枚ずつ描画する場合と一致するかを、描画せずに検証します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "SpriteBatch.hpp"
+#include "SoftwareRasterizer.hpp"
+#include "../Utility/Utility.hpp"
+#include <vector>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cassert>
+
+/**
+* @brief SpriteBatchの検証と計測です
+* @details ランダムな描画命令(回転0度・等倍の高速な経路、回転・拡大したもの、DrawRectRotaGraph3Fの範囲指定)を作り、
+* SpriteBatchの頂点の座標、UV、色を、DrawRotaGraph3Fと同じ変換をdoubleで1枚ずつ求めたものと比べます。
+* また、2のn乗でない画像とその一部を指す画像ハンドルをSoftwareRasterizerでまとめて描画し、1枚ずつ描画したものと画素を比べます。
+* DxLibの描画は行わないので、ウィンドウを作る前でも呼べます。結果はコンソールに出力されます
+*/
+class SpriteBatchVerifier final
+{
+private:
+	SpriteBatchVerifier() = delete;
+	//!許容する座標の誤差(ピクセル)
+	static constexpr double POSITION_EPSILON = 1e-3;
+	//!許容するUVの誤差
+	static constexpr double UV_EPSILON = 1e-6;
+
+	/**
+	* @brief DrawRotaGraph3Fと同じ変換で1つの角の座標を求めます
+	* @param c 描画命令
+	* @param px 画像上の角のx座標(0かw)
+	* @param py 画像上の角のy座標(0かh)
+	*/
+	static void Reference(const RenderCommand& c, const double px, const double py, double& x, double& y)
+	{
+		const double lx = (px - double(c.cx)) * double(c.scaleX);
+		const double ly = (py - double(c.cy)) * double(c.scaleY);
+		const double s = std::sin(double(c.angle));
+		const double co = std::cos(double(c.angle));
+		x = double(c.x) + lx * co - ly * s;
+		y = double(c.y) + lx * s + ly * co;
+	}
+	[[nodiscard]] static RenderCommand MakeCommand(std::mt19937& mt, const int texW, const int texH)
+	{
+		auto range = [&mt](const float min, const float max)
+		{
+			return std::uniform_real_distribution<float>(min, max)(mt);
+		};
+		RenderCommand c;
+		c.x = range(-100.f, 520.f);
+		c.y = range(-100.f, 700.f);
+		const int kind = int(mt() % 3);
+		if (kind != 0)
+		{
+			c.angle = range(-6.3f, 6.3f);
+			c.scaleX = range(0.1f, 4.f);
+			c.scaleY = range(0.1f, 4.f);
+		}
+		if (mt() % 2 == 0)
+		{
+			c.type = RenderCommandType::RECT_ROTA_GRAPH;
+			c.srcX = int(mt() % uint32_t(texW));
+			c.srcY = int(mt() % uint32_t(texH));
+			c.srcW = 1 + int(mt() % uint32_t(texW - c.srcX));
+			c.srcH = 1 + int(mt() % uint32_t(texH - c.srcY));
+		}
+		const float w = c.type == RenderCommandType::RECT_ROTA_GRAPH ? float(c.srcW) : float(texW);
+		const float h = c.type == RenderCommandType::RECT_ROTA_GRAPH ? float(c.srcH) : float(texH);
+		c.cx = mt() % 2 == 0 ? w * 0.5f : range(-w, w * 2.f);
+		c.cy = mt() % 2 == 0 ? h * 0.5f : range(-h, h * 2.f);
+		return c;
+	}
+	/**
+	* @brief 2のn乗でない画像と、その一部を指す画像ハンドルをまとめて描画し、1枚ずつ描画したものと比べます
+	* @details SoftwareRasterizerはDXライブラリと同じく画像を2のn乗の大きさのテクスチャに置いたものとして扱うので、
+	* UVを画像の大きさで求めると違う場所の画素が写ります
+	*/
+	[[nodiscard]] static bool CheckTexture()
+	{
+		constexpr int SIZE = 128;
+		constexpr int PAGE_HANDLE = 1;
+		constexpr int SUB_HANDLE = 2;
+		constexpr int PAGE_W = 48;
+		constexpr int PAGE_H = 40;
+		//画素ごとに違う色の不透明な画像
+		std::vector<uint32_t> rgba(PAGE_W * PAGE_H);
+		for (int y = 0; y < PAGE_H; ++y)
+		{
+			for (int x = 0; x < PAGE_W; ++x)
+			{
+				rgba[size_t(y * PAGE_W + x)] = uint32_t(x * 5) | (uint32_t(y * 6) << 8) | (uint32_t((x + y) * 2) << 16) | 0xff000000u;
+			}
+		}
+		std::vector<RenderCommand> commands;
+		for (int i = 0; i < 8; ++i)
+		{
+			RenderCommand c;
+			c.x = float(16 + (i % 4) * 28);
+			c.y = float(16 + (i / 4) * 56);
+			c.scaleX = c.scaleY = i % 2 == 0 ? 1.f : 2.f;
+			if (i >= 4)
+			{
+				c.type = RenderCommandType::RECT_ROTA_GRAPH;
+				c.srcX = 5 + i;
+				c.srcY = 3 + i;
+				c.srcW = 11;
+				c.srcH = 9;
+			}
+			commands.emplace_back(c);
+		}
+		SoftwareRasterizer batched(SIZE, SIZE);
+		SoftwareRasterizer reference(SIZE, SIZE);
+		for (auto* raster : { &batched, &reference })
+		{
+			raster->setTexture(PAGE_HANDLE, PAGE_W, PAGE_H, rgba.data());
+			raster->setSubTexture(SUB_HANDLE, PAGE_HANDLE, 8, 6, 24, 20);
+			raster->clear(0, 0, 0);
+		}
+		IRenderBackend& prevBackend = RenderBackend::GetOutput();
+		RenderBackend::Set(&batched);
+		SpriteBatch batch;
+		for (const int handle : { SUB_HANDLE, PAGE_HANDLE })
+		{
+			int w = 0, h = 0, texX = 0, texY = 0, texW = 0, texH = 0;
+			batched.getGraphSize(handle, &w, &h);
+			batched.getTextureRegion(handle, &texX, &texY, &texW, &texH);
+			batch.begin(handle, w, h, texX, texY, texW, texH, 255, 255, 255);
+			for (const auto& c : commands)
+			{
+				if ((c.type == RenderCommandType::RECT_ROTA_GRAPH) == (handle == PAGE_HANDLE))
+				{
+					batch.add(c);
+				}
+			}
+			batch.flush();
+		}
+		RenderBackend::Set(&prevBackend);
+		for (const auto& c : commands)
+		{
+			if (c.type == RenderCommandType::RECT_ROTA_GRAPH)
+			{
+				reference.drawRectRotaGraph(c.x, c.y, c.srcX, c.srcY, c.srcW, c.srcH, c.cx, c.cy, c.scaleX, c.scaleY, c.angle, PAGE_HANDLE, false);
+			}
+			else
+			{
+				reference.drawRotaGraph(c.x, c.y, c.cx, c.cy, c.scaleX, c.scaleY, c.angle, SUB_HANDLE, false);
+			}
+		}
+		batched.finish(1);
+		reference.finish(1);
+		return batched.pixels() == reference.pixels();
+	}
+public:
+	/**
+	* @brief 検証と計測を行います
+	* @param spriteNum 検証する描画命令の数
+	* @param seed 乱数のシード
+	* @return すべて一致したらtrue
+	*/
+	static bool Run(const size_t spriteNum = 100000, const uint32_t seed = 2026)
+	{
+		std::mt19937 mt(seed);
+		constexpr int TEX_W = 32;
+		constexpr int TEX_H = 48;
+		std::vector<RenderCommand> commands(spriteNum);
+		size_t fastNum = 0;
+		for (auto& c : commands)
+		{
+			c = MakeCommand(mt, TEX_W, TEX_H);
+			if (SpriteBatch::IsFastPath(c))
+			{
+				++fastNum;
+			}
+		}
+
+		SpriteBatch batch;
+		double maxPosError = 0.0;
+		double maxUvError = 0.0;
+		size_t badNum = 0;
+		double buildMs = 0.0;
+		for (size_t begin = 0; begin < spriteNum; begin += SpriteBatch::QUAD_MAX)
+		{
+			const size_t end = begin + SpriteBatch::QUAD_MAX < spriteNum ? begin + SpriteBatch::QUAD_MAX : spriteNum;
+			batch.begin(-1, TEX_W, TEX_H, 255, 128, 64);
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (size_t i = begin; i < end; ++i)
+			{
+				batch.add(commands[i]);
+			}
+			buildMs += std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			const VERTEX2D* vertices = batch.vertices();
+			for (size_t i = begin; i < end; ++i)
+			{
+				const RenderCommand& c = commands[i];
+				const bool isRect = c.type == RenderCommandType::RECT_ROTA_GRAPH;
+				const double w = isRect ? double(c.srcW) : double(TEX_W);
+				const double h = isRect ? double(c.srcH) : double(TEX_H);
+				const double u0 = isRect ? double(c.srcX) / TEX_W : 0.0;
+				const double v0 = isRect ? double(c.srcY) / TEX_H : 0.0;
+				const double u1 = isRect ? double(c.srcX + c.srcW) / TEX_W : 1.0;
+				const double v1 = isRect ? double(c.srcY + c.srcH) / TEX_H : 1.0;
+				//左上, 右上, 左下, 右下
+				const double px[4] = { 0.0, w, 0.0, w };
+				const double py[4] = { 0.0, 0.0, h, h };
+				const double u[4] = { u0, u1, u0, u1 };
+				const double v[4] = { v0, v0, v1, v1 };
+				bool isOk = true;
+				for (size_t k = 0; k < 4; ++k)
+				{
+					const VERTEX2D& vertex = vertices[(i - begin) * 4 + k];
+					double x, y;
+					Reference(c, px[k], py[k], x, y);
+					//誤差は座標の大きさに比例させる
+					const double scale = 1.0 + std::fabs(x) + std::fabs(y);
+					const double posError = (std::fabs(x - double(vertex.pos.x)) + std::fabs(y - double(vertex.pos.y))) / scale;
+					const double uvError = std::fabs(u[k] - double(vertex.u)) + std::fabs(v[k] - double(vertex.v));
+					if (posError > maxPosError) { maxPosError = posError; }
+					if (uvError > maxUvError) { maxUvError = uvError; }
+					if (posError > POSITION_EPSILON || uvError > UV_EPSILON ||
+						vertex.dif.r != 255 || vertex.dif.g != 128 || vertex.dif.b != 64 || vertex.dif.a != 255 ||
+						vertex.rhw != 1.f || vertex.pos.z != 0.f)
+					{
+						isOk = false;
+					}
+				}
+				if (!isOk)
+				{
+					++badNum;
+				}
+			}
+		}
+		//1枚ずつ変換する場合(DrawRotaGraph3Fに渡す前にラジアンへの変換と三角関数を毎回行う)と比べる
+		double scalarMs = 0.0;
+		{
+			float sum = 0.f;
+			const auto start = std::chrono::high_resolution_clock::now();
+			for (const auto& c : commands)
+			{
+				const float s = sinf(c.angle);
+				const float co = cosf(c.angle);
+				for (int k = 0; k < 4; ++k)
+				{
+					const float lx = ((k & 1) ? float(TEX_W) - c.cx : -c.cx) * c.scaleX;
+					const float ly = ((k & 2) ? float(TEX_H) - c.cy : -c.cy) * c.scaleY;
+					sum += c.x + lx * co - ly * s + c.y + lx * s + ly * co;
+				}
+			}
+			scalarMs = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - start).count();
+			//最適化で消されないように使う
+			if (sum == 0.123f)
+			{
+				DOUT << std::endl;
+			}
+		}
+		const bool isTextureOk = CheckTexture();
+		const bool isOk = badNum == 0 && isTextureOk;
+		DOUT << "SpriteBatchVerifier : " << spriteNum << " sprites (" << fastNum << " fast path)" << std::endl;
+		DOUT << "  batch build : " << buildMs << " [milliseconds] " << buildMs * 1e6 / double(spriteNum) << " [ns/sprite]" << std::endl;
+		DOUT << "  scalar corners only : " << scalarMs << " [milliseconds] " << scalarMs * 1e6 / double(spriteNum) << " [ns/sprite]" << std::endl;
+		DOUT << "  max relative position error " << maxPosError << ", max uv error " << maxUvError << std::endl;
+		DOUT << "  non power of two texture " << (isTextureOk ? "ok" : "NG") << std::endl;
+		DOUT << "SpriteBatchVerifier : " << (isOk ? "vertices match per-sprite transform" : "MISMATCH FOUND") << " (" << badNum << " bad)" << std::endl;
+		assert(isOk && "sprite batch vertices are different from per-sprite transform");
+		return isOk;
+	}
+};
@@ -0,0 +1,454 @@
+﻿/**
+* @file TileLayer.hpp
+* @brief ステージのデータから読み込む、タイルマップのスクロール背景のレイヤーです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "RenderQueue.hpp"
+#include "RenderBackend.hpp"
+#include "Viewport.hpp"
+#include "../Class/ResourceManager.hpp"
+#include "../Utility/Utility.hpp"
+#include "../Utility/picojson.h"
+#include <DxLib.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+
+//!タイルマップの行を読み出す元です
+class ITileSource
+{
+public:
+	virtual ~ITileSource() = default;
+	//!1行のタイルの数を返します
+	[[nodiscard]] virtual size_t columnNum() const = 0;
+	//!行の数を返します
+	[[nodiscard]] virtual size_t rowNum() const = 0;
+	/**
+	* @brief firstRow行目からnum行のタイルを読み出します
+	* @param out [行 * columnNum() + 列]の並びで書き込みます
+	* @details 0は何も置かない場所、1以上はタイルセットの(値 - 1)番目のタイルです。タイルセットに無い番号の場所は描画しません
+	*/
+	virtual void loadRows(const size_t firstRow, const size_t num, uint16_t* out) = 0;
+};
+
+/**
+* @brief JSONの数値の配列で書かれた行から読み出します
+* @details 作るときに1タイル2バイトの配列に詰めるので、JSONの値はステージを読み込んだ後に解放されます。
+* picojsonは全体を読んでから値を返すので、ファイルから行ごとに読み出すことはしません
+*/
+class JsonTileSource final : public ITileSource
+{
+private:
+	std::vector<uint16_t> tiles_;
+	size_t columnNum_;
+public:
+	JsonTileSource(const picojson::array& rows, const size_t columnNum) :
+		tiles_(rows.size() * columnNum, uint16_t(0)),
+		columnNum_(columnNum)
+	{
+		for (size_t r = 0; r < rows.size(); ++r)
+		{
+			if (!rows[r].is<picojson::array>())
+			{
+				continue;
+			}
+			const auto& tiles = rows[r].get<picojson::array>();
+			for (size_t c = 0; c < std::min(columnNum_, tiles.size()); ++c)
+			{
+				if (tiles[c].is<double>())
+				{
+					tiles_[r * columnNum_ + c] = uint16_t(std::clamp(tiles[c].get<double>(), 0.0, 65535.0));
+				}
+			}
+		}
+	}
+	[[nodiscard]] size_t columnNum() const override
+	{
+		return columnNum_;
+	}
+	[[nodiscard]] size_t rowNum() const override
+	{
+		return columnNum_ > 0 ? tiles_.size() / columnNum_ : 0;
+	}
+	void loadRows(const size_t firstRow, const size_t num, uint16_t* out) override
+	{
+		std::copy_n(tiles_.begin() + firstRow * columnNum_, num * columnNum_, out);
+	}
+};
+
+/**
+* @brief 1枚のタイルセットの画像で描く、縦にスクロールするタイルマップです
+* @details マップはCHUNK_ROWS行ずつのチャンクに分けて、描画範囲に入る分と次に入ってくる分だけを読み出します。
+* 描画するのは描画範囲に入っている行と列のタイルだけなので、描画の時間は画像の大きさやステージの長さではなく、見えているタイルの数で決まります
+* - マップの行は上から順に並べます。スクロールを始めると、マップの一番下が描画範囲の下端に来ます
+* - RenderQueueが命令をため中なら、同じマテリアルの命令として積むのでSpriteBatchで1回の描画にまとまります
+* - ブレンドモードはすべてのレイヤーでアルファブレンドです。同じ画像(アトラスの同じページ)を使うレイヤーは積んだ順、つまり奥から順に描画されます
+* - タイルは整数の座標に置くので、バイリニア補間でも隣のタイルがにじみません
+*/
+class TileLayer final
+{
+public:
+	//!1つのチャンクの行数です
+	static constexpr size_t CHUNK_ROWS = 16;
+	//!描画の統計です
+	struct Stats
+	{
+		//!直前のdraw()で描画したタイルの数
+		size_t drawnTileNum = 0;
+		//!読み出したチャンクを置いている数
+		size_t residentChunkNum = 0;
+		//!これまでにチャンクを読み出した回数
+		size_t loadedChunkNum = 0;
+	};
+private:
+	static constexpr size_t NO_CHUNK = SIZE_MAX;
+	struct Chunk
+	{
+		size_t index = NO_CHUNK;
+		std::vector<uint16_t> tiles;
+	};
+	std::unique_ptr<ITileSource> source_;
+	std::string tileset_;
+	GraphicId id_;
+	//!タイルセットの画像の横に並んでいるタイルの数
+	int tilesetColumnNum_ = 0;
+	//!タイルセットの画像にあるタイルの数。これ以上の番号のタイルは描画しません
+	int tilesetTileNum_ = 0;
+	int tileW_;
+	int tileH_;
+	float speed_;
+	bool isLoop_;
+	//!スクロールした距離(ピクセル)
+	double offset_ = 0.0;
+	std::vector<Chunk> chunks_;
+	//!描画範囲に必要なチャンクの番号。stream()で使い回します
+	std::vector<size_t> needed_;
+	RenderQueue::MaterialCache materialCache_;
+	Stats stats_;
+
+	[[nodiscard]] long long mapHeight() const
+	{
+		return (long long)(source_->rowNum()) * tileH_;
+	}
+	[[nodiscard]] static long long ViewHeight()
+	{
+		return (long long)(std::ceil(Viewport::Get().bottom() - Viewport::Get().top()));
+	}
+	//!描画範囲の上端がマップの何ピクセル目にあるかを返します。ループしない場合はマップの外で負になることがあります
+	[[nodiscard]] long long viewTop() const
+	{
+		const long long mapH = mapHeight();
+		long long top = mapH - ViewHeight() - (long long)(std::floor(offset_));
+		if (isLoop_ && mapH > 0)
+		{
+			top %= mapH;
+			if (top < 0)
+			{
+				top += mapH;
+			}
+		}
+		return top;
+	}
+	//!描画範囲に入る最初の行と行の数を求めます。行の番号はループで折り返す前のものです
+	void visibleRows(const long long top, long long& first, long long& num) const
+	{
+		first = top >= 0 ? top / tileH_ : -((-top + tileH_ - 1) / tileH_);
+		const long long bottom = top + ViewHeight();
+		num = (bottom + tileH_ - 1) / tileH_ - first;
+		if (bottom < 0)
+		{
+			num = 0;
+		}
+	}
+	//!折り返す前の行の番号をマップの行の番号にします。マップの外ならfalse
+	[[nodiscard]] bool toMapRow(long long row, size_t& mapRow) const
+	{
+		const long long rowNum = (long long)(source_->rowNum());
+		if (rowNum == 0)
+		{
+			return false;
+		}
+		if (isLoop_)
+		{
+			row %= rowNum;
+			if (row < 0)
+			{
+				row += rowNum;
+			}
+		}
+		if (row < 0 || row >= rowNum)
+		{
+			return false;
+		}
+		mapRow = size_t(row);
+		return true;
+	}
+	[[nodiscard]] const Chunk* findChunk(const size_t index) const
+	{
+		for (const auto& it : chunks_)
+		{
+			if (it.index == index)
+			{
+				return &it;
+			}
+		}
+		return nullptr;
+	}
+	//!チャンクを空いている場所に読み出します。描画範囲に要らないチャンクの場所は使い回します
+	void loadChunk(const size_t index)
+	{
+		Chunk* slot = nullptr;
+		for (auto& it : chunks_)
+		{
+			if (it.index == NO_CHUNK || std::find(needed_.begin(), needed_.end(), it.index) == needed_.end())
+			{
+				slot = &it;
+				break;
+			}
+		}
+		if (slot == nullptr)
+		{
+			chunks_.emplace_back();
+			slot = &chunks_.back();
+		}
+		const size_t firstRow = index * CHUNK_ROWS;
+		const size_t rowNum = std::min(CHUNK_ROWS, source_->rowNum() - firstRow);
+		slot->tiles.resize(rowNum * source_->columnNum());
+		source_->loadRows(firstRow, rowNum, slot->tiles.data());
+		slot->index = index;
+		++stats_.loadedChunkNum;
+	}
+	//!タイルセットの画像を引き直します。画像が無ければfalse
+	[[nodiscard]] bool resolveTileset()
+	{
+		auto& graph = ResourceManager::GetGraph();
+		if (graph.isAlive(id_))
+		{
+			return tilesetTileNum_ > 0;
+		}
+		id_ = graph.findId(tileset_);
+		if (!graph.isAlive(id_))
+		{
+			return false;
+		}
+		//大きさは読み込んだときに求めたものを使い、記録中のスレッドから描画の出力先に触れないようにする
+		int w = 0, h = 0;
+		if (!graph.findSize(id_, w, h))
+		{
+			return false;
+		}
+		tilesetColumnNum_ = w / tileW_;
+		tilesetTileNum_ = tilesetColumnNum_ * (h / tileH_);
+		return tilesetTileNum_ > 0;
+	}
+public:
+	/**
+	* @brief レイヤーを作ります
+	* @param tileset タイルセットの画像の登録名
+	* @param tileW タイルの幅
+	* @param tileH タイルの高さ
+	* @param speed 1フレームにスクロールするピクセル数
+	* @param isLoop マップの上端まで来たら下端に戻るならtrue
+	* @param source マップの読み出し元
+	*/
+	TileLayer(const std::string& tileset, const int tileW, const int tileH, const float speed, const bool isLoop,
+		std::unique_ptr<ITileSource> source) :
+		source_(std::move(source)),
+		tileset_(tileset),
+		tileW_(tileW),
+		tileH_(tileH),
+		speed_(speed),
+		isLoop_(isLoop)
+	{
+		assert(source_ != nullptr && tileW_ > 0 && tileH_ > 0 && "invalid tile layer");
+	}
+	/**
+	* @brief ステージのJSONからレイヤーを読み込みます
+	* @param path ステージのJSONのパス
+	* @param layers 読み込んだレイヤーが奥から順に追加されます
+	* @return 読めなければfalse
+	* @details 書式は次の通りです。speedは省略すると1、loopは省略するとfalseです
+	* {"layers": [{"tileset": "BG", "tileWidth": 60, "tileHeight": 60, "columns": 7, "speed": 1, "loop": true, "rows": [[1, 2, ...], ...]}]}
+	*/
+	static bool LoadStage(const std::string& path, std::vector<TileLayer>& layers)
+	{
+		std::ifstream ifs(path);
+		picojson::value v;
+		if (ifs.fail() || !picojson::parse(v, ifs).empty() || !v.is<picojson::object>())
+		{
+			DOUT << path + " stage load is failed" << std::endl;
+			return false;
+		}
+		auto& root = v.get<picojson::object>();
+		if (!root["layers"].is<picojson::array>())
+		{
+			DOUT << path + " has no layers" << std::endl;
+			return false;
+		}
+		for (auto& it : root["layers"].get<picojson::array>())
+		{
+			if (!it.is<picojson::object>())
+			{
+				continue;
+			}
+			auto& layer = it.get<picojson::object>();
+			if (!layer["tileset"].is<std::string>() || !layer["tileWidth"].is<double>() || !layer["tileHeight"].is<double>() ||
+				!layer["columns"].is<double>() || !layer["rows"].is<picojson::array>())
+			{
+				DOUT << path + " has an invalid layer" << std::endl;
+				return false;
+			}
+			const float speed = layer["speed"].is<double>() ? float(layer["speed"].get<double>()) : 1.f;
+			const bool isLoop = layer["loop"].is<bool>() && layer["loop"].get<bool>();
+			layers.emplace_back(layer["tileset"].get<std::string>(),
+				int(layer["tileWidth"].get<double>()), int(layer["tileHeight"].get<double>()), speed, isLoop,
+				std::make_unique<JsonTileSource>(layer["rows"].get<picojson::array>(), size_t(layer["columns"].get<double>())));
+		}
+		return true;
+	}
+	//!1フレーム分スクロールします。ループしない場合はマップの上端で止まります
+	void scroll()
+	{
+		offset_ += speed_;
+		const double mapH = double(mapHeight());
+		if (isLoop_)
+		{
+			if (mapH > 0.0)
+			{
+				offset_ = std::fmod(offset_, mapH);
+			}
+			return;
+		}
+		offset_ = std::clamp(offset_, 0.0, std::max(0.0, mapH - double(ViewHeight())));
+	}
+	//!スクロールした距離を指定します
+	void setOffset(const double offset)
+	{
+		offset_ = offset;
+	}
+	//!スクロールした距離を返します
+	[[nodiscard]] double offset() const
+	{
+		return offset_;
+	}
+	/**
+	* @brief 描画範囲に入るチャンクと、次に上から入ってくるチャンクを読み出します
+	* @details draw()の中でも呼ばれます。読み出しの時間を描画から外したい場合は先に呼んでください
+	*/
+	void stream()
+	{
+		long long first = 0, num = 0;
+		visibleRows(viewTop(), first, num);
+		needed_.clear();
+		for (long long row = first - 1; row < first + num; ++row)
+		{
+			size_t mapRow = 0;
+			if (!toMapRow(row, mapRow))
+			{
+				continue;
+			}
+			const size_t chunk = mapRow / CHUNK_ROWS;
+			if (std::find(needed_.begin(), needed_.end(), chunk) == needed_.end())
+			{
+				needed_.emplace_back(chunk);
+			}
+		}
+		for (const size_t chunk : needed_)
+		{
+			if (findChunk(chunk) == nullptr)
+			{
+				loadChunk(chunk);
+			}
+		}
+		stats_.residentChunkNum = chunks_.size();
+	}
+	//!描画範囲に入っているタイルを描画します
+	void draw()
+	{
+		stats_.drawnTileNum = 0;
+		if (!resolveTileset())
+		{
+			return;
+		}
+		stream();
+		auto& graph = ResourceManager::GetGraph();
+		const int handle = graph.getHandle(id_);
+		AtlasRegion region;
+		const bool isAtlas = graph.findAtlasRegion(id_, region);
+		const int pageHandle = isAtlas ? region.handle : handle;
+		const int regionX = isAtlas ? region.x : 0;
+		const int regionY = isAtlas ? region.y : 0;
+		const bool isRecording = RenderQueue::Get().isRecording();
+
+		RenderQueue::Command c;
+		c.type = RenderQueue::CommandType::RECT_ROTA_GRAPH;
+		c.srcW = tileW_;
+		c.srcH = tileH_;
+		if (isRecording)
+		{
+			RenderQueue::Material m;
+			m.blendMode = DX_BLENDMODE_ALPHA;
+			m.handle = pageHandle;
+			c.material = RenderQueue::Get().intern(m, materialCache_);
+		}
+		else
+		{
+			RenderBackend::Get().setBlend(DX_BLENDMODE_ALPHA, 255);
+		}
+		const float left = Viewport::Get().left();
+		const float top = Viewport::Get().top();
+		const long long mapTop = viewTop();
+		const size_t columnNum = std::min(source_->columnNum(),
+			size_t(std::ceil((Viewport::Get().right() - left) / float(tileW_))));
+		long long first = 0, num = 0;
+		visibleRows(mapTop, first, num);
+		for (long long row = first; row < first + num; ++row)
+		{
+			size_t mapRow = 0;
+			if (!toMapRow(row, mapRow))
+			{
+				continue;
+			}
+			const Chunk* chunk = findChunk(mapRow / CHUNK_ROWS);
+			assert(chunk != nullptr && "tile chunk is not streamed");
+			const uint16_t* tiles = &chunk->tiles[(mapRow % CHUNK_ROWS) * source_->columnNum()];
+			c.y = top + float(row * tileH_ - mapTop);
+			for (size_t col = 0; col < columnNum; ++col)
+			{
+				if (tiles[col] == 0 || tiles[col] > tilesetTileNum_)
+				{
+					continue;
+				}
+				const int index = int(tiles[col]) - 1;
+				c.x = left + float(int(col) * tileW_);
+				c.srcX = regionX + (index % tilesetColumnNum_) * tileW_;
+				c.srcY = regionY + (index / tilesetColumnNum_) * tileH_;
+				++stats_.drawnTileNum;
+				if (isRecording)
+				{
+					RenderQueue::Get().push(c);
+					continue;
+				}
+				RenderBackend::Get().drawRectRotaGraph(c.x, c.y, c.srcX, c.srcY, c.srcW, c.srcH,
+					0.f, 0.f, 1.0, 1.0, 0.0, pageHandle, false);
+			}
+		}
+		if (!isRecording)
+		{
+			RenderBackend::Get().setBlend(DX_BLENDMODE_NOBLEND, 255);
+		}
+	}
+	//!描画の統計を返します
+	[[nodiscard]] const Stats& stats() const
+	{
+		return stats_;
+	}
+};
@@ -0,0 +1,153 @@
+﻿/**
+* @file Viewport.hpp
+* @brief 画面の外にあるスプライトの描画を省きます
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "../System/System.hpp"
+#include "RenderQueue.hpp"
+#include <memory>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <algorithm>
+
+/**
+* @brief 描画範囲を持ち、スプライトが範囲に入っているか判定します
+* @details SpriteDrawなどが描画の前にisVisible()で判定し、範囲の外なら描画しません
+* - 回転しているスプライトは基準座標から一番遠い角までの円で判定するので、少し大きめに判定します
+* - 描画範囲に余白を足して判定するので、画像の一部だけが見えているものは必ず描画されます
+* - 統計はRenderQueueの入れ物の番号ごとに数えるので、並列に描画命令を積む間も判定できます
+*/
+class Viewport final
+{
+public:
+	//!描画範囲の周りに足す余白の初期値です
+	static constexpr float DEFAULT_MARGIN = 32.f;
+	//!begin()からの判定の統計です
+	struct Stats
+	{
+		//!範囲に入っていて描画した数
+		size_t drawnNum = 0;
+		//!範囲の外で描画を省いた数
+		size_t culledNum = 0;
+	};
+private:
+	Viewport() = delete;
+	class Singleton final
+	{
+	private:
+		float left_ = 0.f;
+		float top_ = 0.f;
+		float right_ = float(System::SCREEN_WIDIH);
+		float bottom_ = float(System::SCREEN_HEIGHT);
+		float margin_ = DEFAULT_MARGIN;
+		bool isEnable_ = true;
+		//!偽共有を避けるため、入れ物ごとの統計をキャッシュラインに揃えます
+		struct alignas(64) Counter
+		{
+			Stats stats;
+			char padding[64 - sizeof(Stats)];
+		};
+		//!先頭はSlotScopeの外で判定した分です
+		std::array<Counter, RenderQueue::SLOT_MAX + 1> counters_;
+		[[nodiscard]] Stats& counter()
+		{
+			return counters_[size_t(RenderQueue::CurrentSlot() + 1)].stats;
+		}
+	public:
+		//!フレームの最初に呼び、統計を0に戻します
+		void begin()
+		{
+			for (auto& it : counters_)
+			{
+				it.stats = Stats();
+			}
+		}
+		//!描画範囲を指定します。初期値は画面全体です
+		void setRect(const float x, const float y, const float w, const float h)
+		{
+			left_ = x;
+			top_ = y;
+			right_ = x + w;
+			bottom_ = y + h;
+		}
+		//!描画範囲の左端を返します
+		[[nodiscard]] float left() const { return left_; }
+		//!描画範囲の上端を返します
+		[[nodiscard]] float top() const { return top_; }
+		//!描画範囲の右端を返します
+		[[nodiscard]] float right() const { return right_; }
+		//!描画範囲の下端を返します
+		[[nodiscard]] float bottom() const { return bottom_; }
+		//!描画範囲の周りに足す余白を指定します
+		void setMargin(const float margin)
+		{
+			margin_ = margin;
+		}
+		//!falseにすると判定せずにすべて描画します
+		void setEnable(const bool isEnable)
+		{
+			isEnable_ = isEnable;
+		}
+		/**
+		* @brief DrawRotaGraph3Fと同じ引数のスプライトが描画範囲に入っているか返します
+		* @param x 描画する座標
+		* @param y 描画する座標
+		* @param cx 画像の中の基準座標
+		* @param cy 画像の中の基準座標
+		* @param w 画像の幅
+		* @param h 画像の高さ
+		* @param scaleX 拡大率
+		* @param scaleY 拡大率
+		* @param degree 回転角度(度)
+		* @return 範囲に入っていればtrue
+		*/
+		[[nodiscard]] bool isVisible(const float x, const float y, const float cx, const float cy,
+			const float w, const float h, const float scaleX, const float scaleY, const float degree)
+		{
+			if (!isEnable_)
+			{
+				++counter().drawnNum;
+				return true;
+			}
+			float minX = std::min(-cx * scaleX, (w - cx) * scaleX);
+			float maxX = std::max(-cx * scaleX, (w - cx) * scaleX);
+			float minY = std::min(-cy * scaleY, (h - cy) * scaleY);
+			float maxY = std::max(-cy * scaleY, (h - cy) * scaleY);
+			if (degree != 0.f)
+			{
+				//回転しても基準座標から一番遠い角より外には出ない
+				const float farX = std::max(-minX, maxX);
+				const float farY = std::max(-minY, maxY);
+				const float radius = std::sqrt(farX * farX + farY * farY);
+				minX = minY = -radius;
+				maxX = maxY = radius;
+			}
+			const bool isVisible =
+				x + maxX >= left_ - margin_ && x + minX <= right_ + margin_ &&
+				y + maxY >= top_ - margin_ && y + minY <= bottom_ + margin_;
+			Stats& stats = counter();
+			++(isVisible ? stats.drawnNum : stats.culledNum);
+			return isVisible;
+		}
+		//!begin()からの統計を返します
+		[[nodiscard]] Stats stats() const
+		{
+			Stats total;
+			for (const auto& it : counters_)
+			{
+				total.drawnNum += it.stats.drawnNum;
+				total.culledNum += it.stats.culledNum;
+			}
+			return total;
+		}
+	};
+public:
+	static Singleton& Get()
+	{
+		static std::unique_ptr<Singleton> instance = std::make_unique<Singleton>();
+		return *instance;
+	}
+};
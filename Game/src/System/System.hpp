@@ -3,6 +3,10 @@
  * @brief Dxlibの初期化とシステムのチェックを行います
  * @author tonarinohito
  * @date 2018/10/05
+ * @par History
+ - 2026/10/18 tonarinohito
+ -# 別のスレッドからDxLibを呼ぶ場合のためにマルチスレッドの指定を追加
+ -# 論理解像度の描画先に描画し、フレームの最後に1回だけ拡大して画面に出すように変更
  */
 #pragma once
 #include <DxLib.h>
@@ -11,17 +15,33 @@
 #include "../Input/Input.hpp"
  /*!
  @brief DXlibの処理を隠蔽します
+ @details ゲームの描画はすべてSCREEN_WIDIH×SCREEN_HEIGHTの描画先に行い、isOk()の中で1回だけ画面に拡大して描画します。
+ フルスクリーンではデスクトップの解像度で起動するので、モニターの大きさによらず描画の負荷は論理解像度の分だけになります
  */
 class System final
 {
+public:
+	//!論理解像度の描画先を画面に拡大する方法です
+	enum class ScalingMode
+	{
+		//!整数倍に拡大します。ドットがぼやけませんが、余白が大きくなることがあります
+		INTEGER,
+		//!縦横比を保って画面いっぱいにバイリニア補間で拡大します
+		BILINEAR,
+	};
 private:
-	void systemInit()
+	//!ゲームが描画する論理解像度の描画先
+	int screen_ = -1;
+	ScalingMode scalingMode_;
+	void systemInit(const bool isMultiThread)
 	{
+		//更新を別のスレッドで行う場合、効果音の再生などがそのスレッドから呼ばれる
+		SetMultiThreadFlag(isMultiThread);
 		//ウィンドウがノンアクティブ時は実行しない
 		SetAlwaysRunFlag(false);
 		//ログ消し
 		SetOutApplicationLogValidFlag(false);
-		//縦横比維持
+		//フルスクリーンでも画面の解像度を変えない。縦横比を保った拡大はpresent()で行う
 		SetFullScreenResolutionMode(DX_FSRESOLUTIONMODE_DESKTOP);
 		auto IsFullScreen = []()
 		{
@@ -38,24 +58,72 @@ private:
 			return false;
 		};
 		//ウィンドウモード
-		ChangeWindowMode(IsFullScreen());
+		const bool isWindowMode = IsFullScreen();
+		ChangeWindowMode(isWindowMode);
 		//XAudio2を使用する
 		SetEnableXAudioFlag(true);
 		//ウインドウタイトルを変更
 		SetMainWindowText("Game");
-		//画面サイズ変更
-		SetGraphMode(SCREEN_WIDIH, SCREEN_HEIGHT, 32);
-		//ウィンドウモード変更
+		//画面サイズ変更。フルスクリーンではデスクトップの解像度にして、拡大は自分で行う
+		int outputW = SCREEN_WIDIH, outputH = SCREEN_HEIGHT;
+		if (!isWindowMode)
+		{
+			int colorBit;
+			GetDefaultState(&outputW, &outputH, &colorBit);
+		}
+		SetGraphMode(outputW, outputH, 32);
 		//初期化
 		DxLib_Init();
 		assert(DxLib_IsInit());
-		//裏画面設定
+		//論理解像度の描画先を作り、ゲームの描画先にする
+		screen_ = MakeScreen(SCREEN_WIDIH, SCREEN_HEIGHT, FALSE);
+		assert(screen_ != -1);
+		SetDrawScreen(screen_);
+		ClearDrawScreen();
+	}
+	//!論理解像度の描画先を裏画面に拡大して描画します
+	void present() const
+	{
 		SetDrawScreen(DX_SCREEN_BACK);
+		ClearDrawScreen();
+		int w, h;
+		GetDrawScreenSize(&w, &h);
+		const int scaleX = w / SCREEN_WIDIH;
+		const int scaleY = h / SCREEN_HEIGHT;
+		const int scale = scaleX < scaleY ? scaleX : scaleY;
+		int drawW, drawH;
+		//画面が論理解像度より小さければ整数倍でも縮小する
+		if (scalingMode_ == ScalingMode::INTEGER && scale >= 1)
+		{
+			drawW = SCREEN_WIDIH * scale;
+			drawH = SCREEN_HEIGHT * scale;
+		}
+		else if (w * SCREEN_HEIGHT < h * SCREEN_WIDIH)
+		{
+			drawW = w;
+			drawH = SCREEN_HEIGHT * w / SCREEN_WIDIH;
+		}
+		else
+		{
+			drawW = SCREEN_WIDIH * h / SCREEN_HEIGHT;
+			drawH = h;
+		}
+		const int x = (w - drawW) / 2;
+		const int y = (h - drawH) / 2;
+		SetDrawBlendMode(DX_BLENDMODE_NOBLEND, 255);
+		SetDrawBright(255, 255, 255);
+		//整数倍なら補間しない
+		const bool isBilinear = drawW % SCREEN_WIDIH != 0 || drawH % SCREEN_HEIGHT != 0;
+		SetDrawMode(isBilinear ? DX_DRAWMODE_BILINEAR : DX_DRAWMODE_NEAREST);
+		DrawExtendGraph(x, y, x + drawW, y + drawH, screen_, FALSE);
+		SetDrawMode(DX_DRAWMODE_NEAREST);
 	}
 	const bool processLoop() const
 	{
+		present();
 		if (ScreenFlip() != 0) return false;
 		if (ProcessMessage() != 0) return false;
+		SetDrawScreen(screen_);
 		if (ClearDrawScreen() != 0) return false;
 		Input::Get().updateKey();
 		return true;
@@ -65,14 +133,31 @@ public:
 	static constexpr int
 		SCREEN_WIDIH = 420,
 		SCREEN_HEIGHT = 600;
-	System()
+	/**
+	* @brief DxLibを初期化します
+	* @param isMultiThread メインスレッド以外からもDxLibを呼ぶならtrue
+	* @param scalingMode 論理解像度の描画先を画面に拡大する方法
+	*/
+	explicit System(const bool isMultiThread = false, const ScalingMode scalingMode = ScalingMode::BILINEAR) :
+		scalingMode_(scalingMode)
 	{
-		systemInit();
+		systemInit(isMultiThread);
 	}
 	~System()
 	{
+		DeleteGraph(screen_);
 		DxLib_End();
 	}
+	//!拡大の方法を指定します
+	void setScalingMode(const ScalingMode scalingMode)
+	{
+		scalingMode_ = scalingMode;
+	}
+	//!ゲームが描画する論理解像度の描画先を返します
+	[[nodiscard]] int getScreen() const
+	{
+		return screen_;
+	}
 	//!@brief Dxlibの更新処理を行います
 	[[nodiscard]] const bool isOk() const
 	{
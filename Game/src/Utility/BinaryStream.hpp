@@ -0,0 +1,106 @@
+﻿/**
+* @file BinaryStream.hpp
+* @brief 値をバイト列に書き出し、読み込みます
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include <vector>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+
+/**
+* @brief バイト列の末尾に値を書き出します
+* @details 値はメモリ上の表現のまま書き出すので、同じ環境で読み込む前提です
+*/
+class BinaryWriter final
+{
+private:
+	std::vector<uint8_t>& out_;
+public:
+	//!outの末尾に書き出します
+	explicit BinaryWriter(std::vector<uint8_t>& out) :
+		out_(out)
+	{}
+	//!値を書き出します
+	template<class T>
+	void write(const T& value)
+	{
+		writeArray(&value, 1);
+	}
+	//!num個の値を書き出します
+	template<class T>
+	void writeArray(const T* data, const size_t num)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+		if (num == 0)
+		{
+			return;
+		}
+		const size_t size = out_.size();
+		out_.resize(size + sizeof(T) * num);
+		std::memcpy(&out_[size], data, sizeof(T) * num);
+	}
+};
+
+/**
+* @brief BinaryWriterで書き出したバイト列を先頭から読み込みます
+* @details 足りない分を読もうとすると、それ以降の読み込みはすべて失敗し、値は初期値になります
+*/
+class BinaryReader final
+{
+private:
+	const uint8_t* data_;
+	size_t size_;
+	size_t pos_ = 0;
+	bool isOk_ = true;
+public:
+	BinaryReader(const uint8_t* data, const size_t size) :
+		data_(data),
+		size_(size)
+	{}
+	//!値を読み込みます。失敗したらfalse
+	template<class T>
+	bool read(T& value)
+	{
+		return readArray(&value, 1);
+	}
+	//!num個の値を読み込みます。失敗したらfalse
+	template<class T>
+	bool readArray(T* data, const size_t num)
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "T must be trivially copyable");
+		if (!isOk_ || num > (size_ - pos_) / sizeof(T))
+		{
+			isOk_ = false;
+			for (size_t i = 0; i < num; ++i)
+			{
+				data[i] = T();
+			}
+			return false;
+		}
+		if (num > 0)
+		{
+			std::memcpy(data, data_ + pos_, sizeof(T) * num);
+		}
+		pos_ += sizeof(T) * num;
+		return true;
+	}
+	//!これまでの読み込みがすべて成功していればtrue
+	[[nodiscard]] bool isOk() const
+	{
+		return isOk_;
+	}
+	//!最後まで読んだらtrue
+	[[nodiscard]] bool isEnd() const
+	{
+		return pos_ == size_;
+	}
+	//!読み込んでいない残りのバイト数を返します
+	[[nodiscard]] size_t remain() const
+	{
+		return size_ - pos_;
+	}
+};
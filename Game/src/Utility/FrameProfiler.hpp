@@ -0,0 +1,149 @@
+﻿/**
+* @file FrameProfiler.hpp
+* @brief 1フレームの処理の時間と、入力から描画までの遅延を計測します
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include "Utility.hpp"
+#include <memory>
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+/**
+* @brief フレームごとの時間を集計して、一定のフレーム数ごとに平均を出します
+* @details 次の値を計測します
+* - シミュレーション(更新と描画命令の作成)と描画の時間
+* - フレームの処理時間と、そこから求めた待ち時間を除いたフレームレート(スループット)
+* - 入力を読んでから、その入力で作ったフレームを描画し終えるまでの時間(遅延)
+*
+* 遅延からシミュレーションと描画の時間を引いたものを追加の遅延とします。
+* 逐次に処理する場合はほぼ0になり、パイプラインで処理する場合はスナップショットが描画を待った時間になります
+*/
+class FrameProfiler final
+{
+public:
+	using Clock = std::chrono::high_resolution_clock;
+	//!計測する区間です
+	enum class Section : size_t
+	{
+		SIMULATION,	//更新と描画命令の作成
+		RENDER,		//スナップショットの描画
+		MAX,
+	};
+	//!一定のフレーム数の平均です。単位はミリ秒です
+	struct Report
+	{
+		size_t frameNum = 0;
+		double simulationMs = 0.0;
+		double renderMs = 0.0;
+		//!Fpsの待ちを除いたフレームの処理時間
+		double frameMs = 0.0;
+		//!frameMsから求めたフレームレート
+		double throughput = 0.0;
+		double latencyMs = 0.0;
+		double addedLatencyMs = 0.0;
+	};
+private:
+	FrameProfiler() = delete;
+	[[nodiscard]] static double ToMs(const Clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+	class Singleton final
+	{
+	private:
+		//!平均を取るフレーム数
+		static constexpr size_t REPORT_FRAMES = 120;
+		Clock::time_point frameStart_;
+		//!今のフレームの区間ごとの時間。区間ごとに別のスレッドから書き込めます
+		std::array<double, size_t(Section::MAX)> sectionMs_{};
+		std::array<double, size_t(Section::MAX)> sectionSumMs_{};
+		double frameSumMs_ = 0.0;
+		double latencySumMs_ = 0.0;
+		size_t latencyNum_ = 0;
+		size_t frameNum_ = 0;
+		Report report_;
+	public:
+		//!フレームの処理を始めます。入力を読んだ直後に呼び、その時刻を返します
+		Clock::time_point beginFrame()
+		{
+			frameStart_ = Clock::now();
+			sectionMs_.fill(0.0);
+			return frameStart_;
+		}
+		//!区間の時間を足します
+		void addSection(const Section section, const Clock::time_point begin, const Clock::time_point end)
+		{
+			sectionMs_[size_t(section)] += ToMs(end - begin);
+		}
+		/**
+		* @brief フレームの処理を終えます。すべての区間が終わってから呼んでください
+		* @param inputTime 描画したフレームを作るのに使った入力を読んだ時刻。まだ描画していなければClock::time_point()
+		* @param presentTime そのフレームを描画し終えた時刻
+		*/
+		void endFrame(const Clock::time_point inputTime, const Clock::time_point presentTime)
+		{
+			frameSumMs_ += ToMs(Clock::now() - frameStart_);
+			for (size_t i = 0; i < sectionMs_.size(); ++i)
+			{
+				sectionSumMs_[i] += sectionMs_[i];
+			}
+			if (inputTime != Clock::time_point())
+			{
+				latencySumMs_ += ToMs(presentTime - inputTime);
+				++latencyNum_;
+			}
+			if (++frameNum_ < REPORT_FRAMES)
+			{
+				return;
+			}
+			const double n = double(frameNum_);
+			report_.frameNum = frameNum_;
+			report_.simulationMs = sectionSumMs_[size_t(Section::SIMULATION)] / n;
+			report_.renderMs = sectionSumMs_[size_t(Section::RENDER)] / n;
+			report_.frameMs = frameSumMs_ / n;
+			report_.throughput = report_.frameMs > 0.0 ? 1000.0 / report_.frameMs : 0.0;
+			report_.latencyMs = latencyNum_ > 0 ? latencySumMs_ / double(latencyNum_) : 0.0;
+			report_.addedLatencyMs = report_.latencyMs - report_.simulationMs - report_.renderMs;
+			DOUT << "FrameProfiler : sim " << report_.simulationMs << " render " << report_.renderMs
+				<< " frame " << report_.frameMs << " [milliseconds] (" << report_.throughput << " fps), latency "
+				<< report_.latencyMs << " (+" << report_.addedLatencyMs << ") [milliseconds]" << std::endl;
+			sectionSumMs_.fill(0.0);
+			frameSumMs_ = 0.0;
+			latencySumMs_ = 0.0;
+			latencyNum_ = 0;
+			frameNum_ = 0;
+		}
+		//!直前に集計した平均を返します
+		[[nodiscard]] const Report& report() const
+		{
+			return report_;
+		}
+	};
+public:
+	//!生きている間の時間を区間に足します
+	class Scope final
+	{
+	private:
+		Section section_;
+		Clock::time_point begin_;
+	public:
+		explicit Scope(const Section section) :
+			section_(section),
+			begin_(Clock::now())
+		{}
+		~Scope()
+		{
+			Get().addSection(section_, begin_, Clock::now());
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+	static Singleton& Get()
+	{
+		static std::unique_ptr<Singleton> instance = std::make_unique<Singleton>();
+		return *instance;
+	}
+};
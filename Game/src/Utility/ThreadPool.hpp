@@ -0,0 +1,153 @@
+﻿/**
+* @file ThreadPool.hpp
+* @brief 処理を複数のスレッドに分けて実行するスレッドプールです
+* @author tonarinohito
+* @date 2026/10/18
+*/
+#pragma once
+#include <memory>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+
+/**
+* @brief ゲーム中ずっと使い回すワーカースレッドを管理します
+* @details ワーカーは最初にGet()を呼んだ時に (論理コア数 - 1) 個作られます。呼び出したスレッドも処理を手伝います
+*/
+class ThreadPool final
+{
+private:
+	ThreadPool() = delete;
+	class Singleton final
+	{
+	private:
+		std::vector<std::thread> workers_;
+		std::deque<std::function<void()>> tasks_;
+		std::mutex mutex_;
+		std::condition_variable taskCond_;
+		std::condition_variable doneCond_;
+		bool isStop_ = false;
+
+		//!タスクを1つ取り出して実行します。無ければfalseが返ります
+		bool runOneTask(std::unique_lock<std::mutex>& lock)
+		{
+			if (tasks_.empty())
+			{
+				return false;
+			}
+			auto task = std::move(tasks_.front());
+			tasks_.pop_front();
+			lock.unlock();
+			task();
+			lock.lock();
+			return true;
+		}
+		void workerLoop()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (true)
+			{
+				taskCond_.wait(lock, [this] { return isStop_ || !tasks_.empty(); });
+				if (isStop_ && tasks_.empty())
+				{
+					return;
+				}
+				runOneTask(lock);
+			}
+		}
+	public:
+		Singleton()
+		{
+			const unsigned int coreNum = std::thread::hardware_concurrency();
+			const size_t workerNum = coreNum > 1 ? size_t(coreNum - 1) : 0;
+			for (size_t i = 0; i < workerNum; ++i)
+			{
+				workers_.emplace_back([this] { workerLoop(); });
+			}
+		}
+		~Singleton()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				isStop_ = true;
+			}
+			taskCond_.notify_all();
+			for (auto& it : workers_)
+			{
+				it.join();
+			}
+		}
+		//!呼び出したスレッドを含めた、同時に処理できるスレッドの数を返します
+		[[nodiscard]] size_t size() const
+		{
+			return workers_.size() + 1;
+		}
+		/**
+		* @brief 0からcount - 1までを分割して並列に処理します
+		* @param count 処理する要素数
+		* @param threadNum 分割数。0ならsize()と同じになります
+		* @param func 分割した範囲を処理する関数。引数は(範囲の先頭, 範囲の終端, 分割の番号)です
+		* @details すべての範囲の処理が終わるまで戻りません。範囲は分割の番号順に連続しています。
+		* 待っている間は呼び出したスレッドも溜まっているタスクを処理するので、ワーカーの中から呼んでも止まりません
+		*/
+		void parallelFor(const size_t count, size_t threadNum, const std::function<void(size_t, size_t, size_t)>& func)
+		{
+			if (threadNum == 0)
+			{
+				threadNum = size();
+			}
+			if (threadNum > count)
+			{
+				threadNum = count;
+			}
+			if (threadNum <= 1)
+			{
+				if (count > 0)
+				{
+					func(0, count, 0);
+				}
+				return;
+			}
+			std::atomic<size_t> remain(threadNum - 1);
+			{
+				std::lock_guard<std::mutex> lock(mutex_);
+				for (size_t i = 1; i < threadNum; ++i)
+				{
+					const size_t begin = count * i / threadNum;
+					const size_t end = count * (i + 1) / threadNum;
+					tasks_.emplace_back([this, &func, &remain, begin, end, i]
+					{
+						func(begin, end, i);
+						std::lock_guard<std::mutex> doneLock(mutex_);
+						if (--remain == 0)
+						{
+							doneCond_.notify_all();
+						}
+					});
+				}
+			}
+			//ワーカーに加えて、別のparallelFor()で待っているスレッドも起こしてタスクを手伝わせる
+			taskCond_.notify_all();
+			doneCond_.notify_all();
+			func(0, count / threadNum, 0);
+			std::unique_lock<std::mutex> lock(mutex_);
+			while (remain > 0)
+			{
+				if (!runOneTask(lock))
+				{
+					doneCond_.wait(lock, [this, &remain] { return remain == 0 || !tasks_.empty(); });
+				}
+			}
+		}
+	};
+public:
+	static Singleton& Get()
+	{
+		static std::unique_ptr<Singleton> instance = std::make_unique<Singleton>();
+		return *instance;
+	}
+};
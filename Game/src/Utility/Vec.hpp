@@ -11,6 +11,8 @@
 - 2018/10/07 tonarinohito
 -# TVecからVecTにリネーム
 -# テンプレートコンストラクタ追加
+- 2026/10/18 tonarinohito
+-# getNormalizeが破棄されたローカル変数の参照を返していたので値を返すようにした
 */
 #pragma once
 
@@ -142,10 +144,10 @@ public:
 	* @brief 自分自身を正規化した値のコピーを返します。自身の値は変わりません
 	* @return Vec2
 	*/
-	[[nodiscard]] const Vec2T&  getNormalize() const
+	[[nodiscard]] Vec2T getNormalize() const
 	{
-		Vec2T result = *this;
-		return result.normalize();
+		const T tmp = length();
+		return Vec2T(x / tmp, y / tmp);
 	}
 
 	Vec2T operator+() const
@@ -425,11 +427,10 @@ public:
 	* @brief 自分自身を正規化した値のコピーを返します。自身の値は変わりません
 	* @return Vec3
 	*/
-	[[nodiscard]] const Vec3T& getNormalize() const
+	[[nodiscard]] Vec3T getNormalize() const
 	{
-		Vec3T result = *this;
-		result.normalize();
-		return result;
+		const T tmp = length();
+		return Vec3T(x / tmp, y / tmp, z / tmp);
 	}
 	/*!
 	* @brief 2点間の距離を返します